@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# Compares the halo exchange paths on a small, communication bound deck.
+# usage: Benchmarks/halo_exchange.sh <tealeaf binary> [ranks...]
+# REPEATS (default 3) runs of each configuration are made and the fastest wallclock is reported.
+# MPIRUN (default mpirun) is the launcher, e.g. MPIRUN="mpirun --oversubscribe".
+
+set -eu
+
+if [[ $# -lt 1 ]]; then
+  echo "usage: $0 <tealeaf binary> [ranks...]" >&2
+  exit 1
+fi
+
+BINARY=$(realpath "$1")
+shift
+RANKS=("$@")
+[[ ${#RANKS[@]} -eq 0 ]] && RANKS=(2 4)
+REPEATS=${REPEATS:-3}
+MPIRUN=${MPIRUN:-mpirun}
+DECK="$(dirname "$(realpath "$0")")/tea_bm_halo.in"
+PROBLEMS="$(dirname "$(realpath "$0")")/../tea.problems"
+
+declare -A modes=(
+  ["isend"]=""
+  ["persistent"]="persistent_halo_exchange"
+)
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Prints the fastest wallclock of REPEATS runs of the deck with the given extra deck line
+function run() {
+  local ranks=$1 option=$2 best=""
+  grep -v '^\*endtea' "$DECK" >"$WORK/tea.in"
+  [[ -n "$option" ]] && echo "$option" >>"$WORK/tea.in"
+  echo '*endtea' >>"$WORK/tea.in"
+
+  for ((rr = 0; rr < REPEATS; rr++)); do
+    local time
+    time=$(cd "$WORK" && $MPIRUN -np "$ranks" "$BINARY" --file tea.in --problems "$PROBLEMS" | awk '/Wallclock:/ {t = $2} END {sub("s", "", t); print t}')
+    if [[ -z "$best" ]] || awk "BEGIN {exit !($time < $best)}"; then best=$time; fi
+  done
+  echo "$best"
+}
+
+printf "%-8s %-12s %12s %10s\n" "ranks" "mode" "wallclock" "speedup"
+for ranks in "${RANKS[@]}"; do
+  baseline=$(run "$ranks" "${modes[isend]}")
+  printf "%-8s %-12s %11ss %10s\n" "$ranks" "isend" "$baseline" "1.00"
+  for mode in persistent; do
+    time=$(run "$ranks" "${modes[$mode]}")
+    printf "%-8s %-12s %11ss %10.2f\n" "$ranks" "$mode" "$time" "$(awk "BEGIN {print $baseline / $time}")"
+  done
+done
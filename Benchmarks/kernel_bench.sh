@@ -0,0 +1,72 @@
+#!/usr/bin/env bash
+# Compares the kernels of several models, each timed in isolation by its <model>-tealeaf-bench binary.
+# usage: Benchmarks/kernel_bench.sh <bench binary> [bench binary...]
+# Build the binaries with `cmake --build <build dir> --target tealeaf-bench` in each model's build directory.
+# SIZES, HALO_DEPTHS and THREADS are comma separated lists passed to every binary, MIN_TIME is the minimum seconds per
+# measurement and FILTER only keeps the kernels whose name contains it.
+# RANKS (default 1) is the number of ranks and MPIRUN (default mpirun) the launcher, e.g. MPIRUN="mpirun --oversubscribe".
+# The table reports the bandwidth of every model in GB/s, the ratio is that of each model over the first.
+
+set -eu
+
+if [[ $# -lt 1 ]]; then
+  echo "usage: $0 <bench binary> [bench binary...]" >&2
+  exit 1
+fi
+
+SIZES=${SIZES:-32,64,128,256,512,1024,2048,4096}
+HALO_DEPTHS=${HALO_DEPTHS:-2}
+THREADS=${THREADS:-}
+MIN_TIME=${MIN_TIME:-0.2}
+FILTER=${FILTER:-}
+RANKS=${RANKS:-1}
+MPIRUN=${MPIRUN:-mpirun}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+CSVS=()
+for binary in "$@"; do
+  binary=$(realpath "$binary")
+  csv="$WORK/$(basename "$binary").csv"
+  options=(--sizes "$SIZES" --halo-depths "$HALO_DEPTHS" --min-time "$MIN_TIME" --csv "$csv")
+  [[ -n "$THREADS" ]] && options+=(--threads "$THREADS")
+  [[ -n "$FILTER" ]] && options+=(--filter "$FILTER")
+  echo "# $(basename "$binary")" >&2
+  (cd "$WORK" && $MPIRUN -np "$RANKS" "$binary" "${options[@]}" >/dev/null)
+  CSVS+=("$csv")
+done
+
+# Joins the measurements of every model on kernel, cells, halo depth and threads, in the order of the first model. The
+# fields are counted from the end of the line as the quoted model name may hold commas.
+awk -F, '
+  FNR == 1 {
+    model[++file] = FILENAME
+    sub(".*/", "", model[file])
+    sub("-tealeaf-bench.csv$", "", model[file])
+    next
+  }
+  {
+    key = $(NF - 8) "," $(NF - 7) "," $(NF - 6) "," $(NF - 5)
+    if (file == 1) order[++rows] = key
+    gb_s[file, key] = $NF
+  }
+  END {
+    printf "%-28s%8s%6s%9s", "kernel", "cells", "halo", "threads"
+    for (ff = 1; ff <= file; ff++) printf "%16s", model[ff]
+    for (ff = 2; ff <= file; ff++) printf "%10s", "ratio"
+    printf "\n"
+    for (rr = 1; rr <= rows; rr++) {
+      split(order[rr], fields, ",")
+      printf "%-28s%8s%6s%9s", fields[1], fields[2], fields[3], fields[4]
+      for (ff = 1; ff <= file; ff++) {
+        if ((ff, order[rr]) in gb_s) printf "%16.3f", gb_s[ff, order[rr]]
+        else printf "%16s", "-"
+      }
+      for (ff = 2; ff <= file; ff++) {
+        if ((ff, order[rr]) in gb_s && gb_s[1, order[rr]] > 0) printf "%10.2f", gb_s[ff, order[rr]] / gb_s[1, order[rr]]
+        else printf "%10s", "-"
+      }
+      printf "\n"
+    }
+  }' "${CSVS[@]}"
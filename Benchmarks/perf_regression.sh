@@ -0,0 +1,165 @@
+#!/usr/bin/env bash
+# Runs benchmark decks over several rank and thread counts, checks each run against tea.problems, appends the
+# wallclocks to a results store and compares them with a stored baseline.
+# usage: Benchmarks/perf_regression.sh <tealeaf binary> [deck...]
+# Decks are looked up in Benchmarks/ when not found as given, the default is tea_bm_halo.in.
+# RANKS (default "1 2") and THREADS (default "1", set as OMP_NUM_THREADS) are space separated lists, REPEATS (default 5)
+# runs of each configuration are made.
+# MPIRUN (default mpirun) is the launcher, e.g. MPIRUN="mpirun --oversubscribe". An empty MPIRUN runs the binary
+# directly, for builds without MPI, with a single rank.
+# RESULTS (default perf_results.csv) is appended with every run. BASELINE (default perf_baseline.csv) holds the runs
+# compared against, UPDATE_BASELINE=1 replaces its runs of the same binary and configurations with these ones.
+# A configuration is a regression when its mean wallclock is more than THRESHOLD (default 0.05) slower than the
+# baseline and a one-sided Welch's t-test finds the slowdown significant at the 5% level.
+# Exits non-zero when a run fails its check or a configuration regresses. Decks without an entry in tea.problems are
+# reported as unchecked.
+
+set -eu
+
+if [[ $# -lt 1 ]]; then
+  echo "usage: $0 <tealeaf binary> [deck...]" >&2
+  exit 1
+fi
+
+BENCHMARKS="$(dirname "$(realpath "$0")")"
+BINARY=$(realpath "$1")
+shift
+DECKS=("$@")
+[[ ${#DECKS[@]} -eq 0 ]] && DECKS=(tea_bm_halo.in)
+read -r -a RANK_COUNTS <<<"${RANKS:-1 2}"
+read -r -a THREAD_COUNTS <<<"${THREADS:-1}"
+REPEATS=${REPEATS:-5}
+MPIRUN=${MPIRUN-mpirun}
+RESULTS=${RESULTS:-perf_results.csv}
+BASELINE=${BASELINE:-perf_baseline.csv}
+UPDATE_BASELINE=${UPDATE_BASELINE:-0}
+THRESHOLD=${THRESHOLD:-0.05}
+PROBLEMS="$BENCHMARKS/../tea.problems"
+MODEL=$(basename "$BINARY")
+COMMIT=$(git -C "$BENCHMARKS" rev-parse --short HEAD 2>/dev/null || echo unknown)
+DATE=$(date -u +%Y-%m-%dT%H:%M:%SZ)
+HEADER="date,commit,binary,deck,ranks,threads,repeat,wallclock_s,outcome"
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Prints the outcome and the wallclock of one run of the deck
+function run() {
+  local deck=$1 ranks=$2 threads=$3 launcher=()
+  if [[ -n "$MPIRUN" ]]; then
+    read -r -a launcher <<<"$MPIRUN"
+    launcher+=(-np "$ranks")
+  elif [[ "$ranks" -ne 1 ]]; then
+    echo "MPIRUN is empty, cannot run $ranks ranks" >&2
+    exit 1
+  fi
+  (cd "$WORK" && OMP_NUM_THREADS=$threads "${launcher[@]}" "$BINARY" --file "$deck" --problems "$PROBLEMS" >run.out 2>&1) || true
+  awk '/Wallclock:/ {t = $2}
+       /Problem was not found/ {unchecked = 1}
+       /Outcome:/ {outcome = tolower($3)}
+       END {
+         sub("s", "", t)
+         if (outcome == "") outcome = "crashed"
+         else if (unchecked) outcome = "unchecked"
+         print outcome, (t == "" ? "nan" : t)
+       }' "$WORK/run.out"
+}
+
+failed=0
+echo "$HEADER" >"$WORK/runs.csv"
+for deck in "${DECKS[@]}"; do
+  [[ -f "$deck" ]] || deck="$BENCHMARKS/$deck"
+  deck=$(realpath "$deck")
+  for ranks in "${RANK_COUNTS[@]}"; do
+    for threads in "${THREAD_COUNTS[@]}"; do
+      for ((rr = 0; rr < REPEATS; rr++)); do
+        read -r outcome time < <(run "$deck" "$ranks" "$threads")
+        if [[ "$outcome" == "failed" || "$outcome" == "crashed" ]]; then
+          echo "# $(basename "$deck") on $ranks ranks and $threads threads $outcome:" >&2
+          tail -n 20 "$WORK/run.out" >&2
+          failed=1
+        fi
+        echo "$DATE,$COMMIT,$MODEL,$(basename "$deck"),$ranks,$threads,$rr,$time,$outcome" >>"$WORK/runs.csv"
+      done
+    done
+  done
+done
+
+[[ -s "$RESULTS" ]] || echo "$HEADER" >"$RESULTS"
+tail -n +2 "$WORK/runs.csv" >>"$RESULTS"
+
+if [[ "$UPDATE_BASELINE" == 1 ]]; then
+  echo "$HEADER" >"$WORK/baseline.csv"
+  # Keeps the baseline runs of other binaries and configurations
+  if [[ -s "$BASELINE" ]]; then
+    awk -F, 'FNR == 1 {next} FILENAME == ARGV[1] {replaced[$3 "," $4 "," $5 "," $6] = 1; next} !replaced[$3 "," $4 "," $5 "," $6]' \
+      "$WORK/runs.csv" "$BASELINE" >>"$WORK/baseline.csv"
+  fi
+  tail -n +2 "$WORK/runs.csv" >>"$WORK/baseline.csv"
+  mv "$WORK/baseline.csv" "$BASELINE"
+  echo "# Updated the baseline in $BASELINE"
+  exit $failed
+fi
+
+if [[ ! -s "$BASELINE" ]]; then
+  echo "# No baseline in $BASELINE, record one with UPDATE_BASELINE=1"
+  echo "$HEADER" >"$WORK/baseline.csv"
+  BASELINE="$WORK/baseline.csv"
+fi
+
+# Compares the mean wallclock of every configuration with the baseline, failed runs are left out of both
+awk -F, -v threshold="$THRESHOLD" '
+  BEGIN {
+    split("6.314 2.920 2.353 2.132 2.015 1.943 1.895 1.860 1.833 1.812 1.796 1.782 1.771 1.761 1.753 " \
+          "1.746 1.740 1.734 1.729 1.725 1.721 1.717 1.714 1.711 1.708 1.706 1.703 1.701 1.699 1.697", t_critical, " ")
+    printf "%-20s%7s%9s%14s%14s%10s%9s  %s\n", "deck", "ranks", "threads", "baseline (s)", "current (s)", "change", "t", "verdict"
+  }
+  FNR == 1 { file++; next }
+  $9 != "passed" && $9 != "unchecked" { next }
+  {
+    key = $3 "," $4 "," $5 "," $6
+    n[file, key]++
+    sum[file, key] += $8
+    sum_sq[file, key] += $8 * $8
+    if (file == 2 && !(key in seen)) { seen[key] = 1; order[++keys] = key }
+  }
+  END {
+    regressions = 0
+    for (kk = 1; kk <= keys; kk++) {
+      key = order[kk]
+      split(key, fields, ",")
+      nc = n[2, key]; mc = sum[2, key] / nc; vc = (nc > 1) ? (sum_sq[2, key] - nc * mc * mc) / (nc - 1) : 0
+      nb = n[1, key]
+      if (nb < 2 || nc < 2) {
+        printf "%-20s%7s%9s%14s%14.4f%10s%9s  %s\n", fields[2], fields[3], fields[4], "-", mc, "-", "-", "no baseline"
+        continue
+      }
+      mb = sum[1, key] / nb; vb = (sum_sq[1, key] - nb * mb * mb) / (nb - 1)
+      if (vc < 0) vc = 0
+      if (vb < 0) vb = 0
+
+      # Welch-Satterthwaite degrees of freedom for samples of unequal variance
+      se_sq = vc / nc + vb / nb
+      if (se_sq > 0) {
+        t = (mc - mb) / sqrt(se_sq)
+        df = se_sq * se_sq / ((vc / nc) ^ 2 / (nc - 1) + (vb / nb) ^ 2 / (nb - 1))
+        critical = (df >= 31) ? 1.645 : t_critical[(df < 1) ? 1 : int(df)]
+        significant = t > critical
+        faster = -t > critical
+      } else {
+        # Identical runs, any difference is significant
+        t = 0
+        significant = mc > mb
+        faster = mc < mb
+      }
+
+      change = (mc - mb) / mb
+      verdict = "ok"
+      if (significant && change > threshold) { verdict = "REGRESSION"; regressions++ }
+      else if (faster && change < -threshold) verdict = "faster"
+      printf "%-20s%7s%9s%14.4f%14.4f%9.1f%%%9.2f  %s\n", fields[2], fields[3], fields[4], mb, mc, 100 * change, t, verdict
+    }
+    exit regressions > 0
+  }' "$BASELINE" "$WORK/runs.csv" || failed=1
+
+exit $failed
@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+# Checks that the performance report models the same traffic whatever the number of chunks per rank.
+# usage: Benchmarks/report_bytes.sh <tealeaf binary> [deck]
+# The deck (default tea_bm_halo.in, looked up in Benchmarks/ when not found as given) is run once for each of the
+# CHUNKS (default "1 4") num_chunks_per_rank values with a CSV --report. Each chunk counts its own kernel calls and the
+# solvers may take an iteration more or less, so the bytes of each kernel are compared per sweep of the grid, which is
+# the bytes over the calls times the chunks per rank, and must agree to a relative TOLERANCE (default 1e-9).
+# MPIRUN (default mpirun) is the launcher, an empty MPIRUN runs the binary directly. The binary must be built with
+# -DENABLE_PROFILING=ON for the report to hold kernels.
+
+set -eu
+
+if [[ $# -lt 1 ]]; then
+  echo "usage: $0 <tealeaf binary> [deck]" >&2
+  exit 1
+fi
+
+BENCHMARKS="$(dirname "$(realpath "$0")")"
+BINARY=$(realpath "$1")
+DECK=${2:-tea_bm_halo.in}
+[[ -f "$DECK" ]] || DECK="$BENCHMARKS/$DECK"
+read -r -a CHUNK_COUNTS <<<"${CHUNKS:-1 4}"
+TOLERANCE=${TOLERANCE:-1e-9}
+MPIRUN=${MPIRUN-mpirun}
+PROBLEMS="$BENCHMARKS/../tea.problems"
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+REPORTS=()
+for chunks in "${CHUNK_COUNTS[@]}"; do
+  grep -v '^\*endtea' "$DECK" | grep -v '^num_chunks_per_rank' >"$WORK/tea_$chunks.in"
+  echo "num_chunks_per_rank=$chunks" >>"$WORK/tea_$chunks.in"
+  echo '*endtea' >>"$WORK/tea_$chunks.in"
+  launcher=()
+  [[ -n "$MPIRUN" ]] && read -r -a launcher <<<"$MPIRUN -np 1"
+  if ! (cd "$WORK" && "${launcher[@]}" "$BINARY" --file "tea_$chunks.in" --problems "$PROBLEMS" --report "report_$chunks.csv" \
+    --report-format csv >"run_$chunks.out" 2>&1); then
+    echo "# $(basename "$DECK") with $chunks chunks per rank failed:" >&2
+    tail -n 20 "$WORK/run_$chunks.out" >&2
+    exit 1
+  fi
+  REPORTS+=("$WORK/report_$chunks.csv")
+done
+
+# Compares the bytes per sweep of every modelled kernel with those of the first run
+awk -F, -v tolerance="$TOLERANCE" -v chunk_counts="${CHUNK_COUNTS[*]}" '
+  BEGIN {
+    split(chunk_counts, chunks, " ")
+    printf "%-28s", "kernel"
+    for (ff = 1; ff <= length(chunks); ff++) printf "%22s", chunks[ff] " chunks (B/sweep)"
+    printf "  %s\n", "verdict"
+  }
+  FNR == 1 { file++; next }
+  $1 == "kernel" && $10 != "" && $7 > 0 {
+    if (file == 1) order[++kernels] = $2
+    sweep[file, $2] = $10 / $7 * chunks[file]
+  }
+  END {
+    mismatches = 0
+    if (kernels == 0) {
+      print "no modelled kernels in the report, build with -DENABLE_PROFILING=ON" > "/dev/stderr"
+      exit 1
+    }
+    for (kk = 1; kk <= kernels; kk++) {
+      name = order[kk]
+      verdict = "ok"
+      printf "%-28s", name
+      for (ff = 1; ff <= file; ff++) {
+        printf "%22.6e", sweep[ff, name]
+        difference = sweep[ff, name] - sweep[1, name]
+        if (!((ff, name) in sweep) || (difference < 0 ? -difference : difference) > tolerance * sweep[1, name]) verdict = "MISMATCH"
+      }
+      if (verdict != "ok") mismatches++
+      printf "  %s\n", verdict
+    }
+    exit mismatches > 0
+  }' "${REPORTS[@]}"
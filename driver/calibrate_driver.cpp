@@ -0,0 +1,41 @@
+#include "comms.h"
+#include "drivers.h"
+#include "kernel_interface.h"
+
+// Bytes each calibration kernel moves per cell, counted like STREAM without the write allocate of the stored array. The
+// matvec reads the vector and both coefficients and writes its result, and takes 13 flops.
+static const int calibrate_bytes_per_cell[NUM_CALIBRATE_KERNELS] = {2 * sizeof(double), 2 * sizeof(double), 3 * sizeof(double),
+                                                                   4 * sizeof(double)};
+#define CALIBRATE_STENCIL_FLOPS 13
+
+// Measures the bandwidth that all ranks reach together through the model's own allocation and threading. The triad
+// becomes the STREAM peak of the performance report unless one was given with --stream-peak.
+void calibrate_driver(Chunk *chunks, Settings &settings) {
+  const int x = CALIBRATE_COLUMNS;
+  const int y = tealeaf_MAX(CALIBRATE_CELLS / CALIBRATE_COLUMNS / settings.num_ranks, 3);
+
+  double seconds[NUM_CALIBRATE_KERNELS] = {};
+  barrier();
+  if (settings.kernel_language == Kernel_Language::C) {
+    run_calibrate(&(chunks[0]), settings, x, y, seconds);
+  } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+  }
+
+  double bandwidth[NUM_CALIBRATE_KERNELS + 1] = {};
+  for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+    const double cells = (kk == CALIBRATE_STENCIL) ? static_cast<double>(x - 2) * (y - 2) : static_cast<double>(x) * y;
+    if (seconds[kk] > 0.0) bandwidth[kk] = cells * calibrate_bytes_per_cell[kk] / seconds[kk] * 1.0E-9;
+  }
+  bandwidth[NUM_CALIBRATE_KERNELS] = bandwidth[CALIBRATE_STENCIL] / calibrate_bytes_per_cell[CALIBRATE_STENCIL] * CALIBRATE_STENCIL_FLOPS;
+  sum_over_ranks(settings, bandwidth, NUM_CALIBRATE_KERNELS + 1);
+
+  if (settings.stream_peak <= 0.0) settings.stream_peak = bandwidth[CALIBRATE_TRIAD];
+  settings.stencil_peak = bandwidth[CALIBRATE_STENCIL];
+
+  print_and_log(settings, "Calibration:\n");
+  print_and_log(settings, " - Cells per array: %d\n", x * y * settings.num_ranks);
+  print_and_log(settings, " - Copy:    %.3lf GB/s\n", bandwidth[CALIBRATE_COPY]);
+  print_and_log(settings, " - Scale:   %.3lf GB/s\n", bandwidth[CALIBRATE_SCALE]);
+  print_and_log(settings, " - Triad:   %.3lf GB/s\n", bandwidth[CALIBRATE_TRIAD]);
+  print_and_log(settings, " - Stencil: %.3lf GB/s, %.3lf GFLOP/s\n", bandwidth[CALIBRATE_STENCIL], bandwidth[NUM_CALIBRATE_KERNELS]);
+}
@@ -2,25 +2,40 @@
 #include "comms.h"
 #include "drivers.h"
 #include "kernel_interface.h"
+#include <chrono>
+
+// Words streamed through memory per cell and iteration, the matvec reads p, kx and ky and writes w, the u and r update
+// reads u, p, r and w and writes u and r, and the p update reads p and r and writes p
+#define CG_BYTES_PER_CELL(settings) (13 * SOLVE_WORD_BYTES(settings))
 
 // Performs a full solve with the CG solver kernels
 void cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error) {
+  PROFILE_SCOPE(settings.kernel_profile, __func__);
   int tt;
   double rro = 0.0;
 
   // Perform CG initialisation
   cg_init_driver(chunks, settings, rx, ry, &rro);
 
+  auto start = std::chrono::steady_clock::now();
+
   // Iterate till convergence
   for (tt = 0; tt < settings.max_iters; ++tt) {
     cg_main_step_driver(chunks, settings, tt, &rro, error);
 
-    halo_update_driver(chunks, settings, 1);
+    if (!settings.overlap_halo_exchange) halo_update_driver(chunks, settings, 1);
 
     if (sqrt(fabs(*error)) < settings.eps) break;
   }
 
+  // The overlapped steps exchange their halos up front, so the fields are left stale on exit
+  if (settings.overlap_halo_exchange) halo_update_driver(chunks, settings, 1);
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
   print_and_log(settings, " CG: \t\t\t%d iterations\n", tt);
+  report_solver_iterations(settings, "CG", tt);
+  print_cg_traffic(settings, "CG", tealeaf_MIN(tt + 1, settings.max_iters), elapsed.count(), CG_BYTES_PER_CELL(settings));
 }
 
 // Invokes the CG initialisation kernels
@@ -30,10 +45,39 @@ void cg_init_driver(Chunk *chunks, Settings &settings, double rx, double ry, dou
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     if (settings.kernel_language == Kernel_Language::C) {
       run_cg_init(&(chunks[cc]), settings, rx, ry, rro);
+
+      if (settings.stored_diagonal || settings.float_coefficients || settings.interleaved_operator) {
+        run_store_operator(&(chunks[cc]), settings);
+      }
     } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
     }
   }
 
+  // The preconditioned recurrences run on r.z, and start from p = z
+  if (settings.preconditioner != Preconditioner::NONE) {
+    *rro = 0.0;
+
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_cg_init_preconditioner(&(chunks[cc]), settings, rro);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+  }
+
+  // The multigrid V-cycle couples the chunks through its coarsest level, so it runs once every chunk has its levels
+  if (settings.preconditioner == Preconditioner::MULTIGRID) {
+    multigrid_global_init_driver(chunks, settings);
+    multigrid_vcycle_driver(chunks, settings, rro);
+
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_cg_calc_p(&(chunks[cc]), settings, 0.0);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+  }
+
   // Need to update for the matvec
   reset_fields_to_exchange(settings);
   settings.fields_to_exchange[FIELD_U] = true;
@@ -50,22 +94,56 @@ void cg_init_driver(Chunk *chunks, Settings &settings, double rx, double ry, dou
   }
 }
 
-// Invokes the main CG solve kernels
-void cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *rro, double *error) {
-  double pw = 0.0;
+// Calculates w = Ap, overlapping the halo exchange of the current fields when enabled
+void cg_calc_w_driver(Chunk *chunks, Settings &settings, double *pw) {
+  double pw_sum = 0.0;
+
+  if (!settings.overlap_halo_exchange) {
+    CONCURRENT_CHUNKS_SUM(pw_sum)
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_cg_calc_w(&(chunks[cc]), settings, &pw_sum);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+    *pw += pw_sum;
+    return;
+  }
+
+  MPI_Request requests[settings.num_chunks_per_rank * NUM_NEIGHBOURS * 2];
+  int num_messages = halo_update_start_driver(chunks, settings, 1, requests);
+
+  CONCURRENT_CHUNKS_SUM(pw_sum)
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_cg_calc_w_interior(&(chunks[cc]), settings, &pw_sum);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  halo_update_finish_driver(chunks, settings, 1, requests, num_messages);
 
+  CONCURRENT_CHUNKS_SUM(pw_sum)
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     if (settings.kernel_language == Kernel_Language::C) {
-      run_cg_calc_w(&(chunks[cc]), settings, &pw);
+      run_cg_calc_w_boundary(&(chunks[cc]), settings, &pw_sum);
     } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
     }
   }
+  *pw += pw_sum;
+}
+
+// Invokes the main CG solve kernels
+void cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *rro, double *error) {
+  double pw = 0.0;
+  cg_calc_w_driver(chunks, settings, &pw);
 
   sum_over_ranks(settings, &pw);
 
   double alpha = *rro / pw;
   double rrn = 0.0;
 
+  CONCURRENT_CHUNKS_SUM(rrn)
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     // TODO: Some redundancy across chunks??
     chunks[cc].cg_alphas[tt] = alpha;
@@ -76,10 +154,13 @@ void cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *rro,
     }
   }
 
+  if (settings.preconditioner == Preconditioner::MULTIGRID) multigrid_vcycle_driver(chunks, settings, &rrn);
+
   sum_over_ranks(settings, &rrn);
 
   double beta = rrn / *rro;
 
+  CONCURRENT_CHUNKS
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     // TODO: Some redundancy across chunks??
     chunks[cc].cg_betas[tt] = beta;
@@ -3,16 +3,27 @@
 #include "drivers.h"
 #include "kernel_interface.h"
 #include <cfloat>
+#include <chrono>
 #include <cmath>
 
+// Bytes a Chebyshev iteration moves per cell without temporal blocking, the update of w, r and p reads
+// five fields and writes three, and the update of u reads two fields and writes one
+#define CHEBY_BYTES_PER_CELL(settings) (11 * SOLVE_WORD_BYTES(settings))
+
+// Once the estimated iterations have run, the norm of the residual is checked every CHEBY_NORM_ITERS iterations
+#define CHEBY_NORM_ITERS 10
+
 void cheby_calc_est_iterations(Chunk *chunks, double error, double bb, int *est_iterations);
+void cheby_calc_2norm_driver(Chunk *chunks, Settings &settings, double *error);
 
 // Performs full solve with the Chebyshev kernels
 void cheby_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error) {
+  PROFILE_SCOPE(settings.kernel_profile, __func__);
   int tt;
   double rro = 0.0;
   int est_iterations = 0;
   int num_cheby_iters = 0;
+  std::chrono::steady_clock::time_point cheby_start;
 
   // Perform CG initialisation
   cg_init_driver(chunks, settings, rx, ry, &rro);
@@ -34,9 +45,13 @@ void cheby_driver(Chunk *chunks, Settings &settings, double rx, double ry, doubl
 
       // Check if first step
       if (num_cheby_iters == 1) {
+        // The initialisation reads the halo of u, which the overlapped CG steps leave stale
+        if (settings.overlap_halo_exchange) halo_update_driver(chunks, settings, 1);
+
         // Initialise the solver
         double bb = 0.0;
         cheby_init_driver(chunks, settings, tt, &bb);
+        cheby_start = std::chrono::steady_clock::now();
 
         // Perform the main step
         cheby_main_step_driver(chunks, settings, num_cheby_iters, true, error);
@@ -44,20 +59,40 @@ void cheby_driver(Chunk *chunks, Settings &settings, double rx, double ry, doubl
         // Estimate the number of Chebyshev iterations
         cheby_calc_est_iterations(chunks, *error, bb, &est_iterations);
       } else {
-        bool is_calc_2norm = (num_cheby_iters >= est_iterations) && ((tt + 1) % 10 == 0);
+        // A temporally blocked sweep ends on the iteration that would check the norm
+        int steps = temporal_block_length(settings, tt, 1, CHEBY_NORM_ITERS);
+        int first_iter = num_cheby_iters;
+        num_cheby_iters += steps - 1;
+        tt += steps - 1;
+
+        bool is_calc_2norm = (num_cheby_iters >= est_iterations) && ((tt + 1) % CHEBY_NORM_ITERS == 0);
 
         // Perform main step
-        cheby_main_step_driver(chunks, settings, num_cheby_iters, is_calc_2norm, error);
+        if (steps > 1) {
+          cheby_blocked_step_driver(chunks, settings, first_iter, steps, is_calc_2norm, error);
+        } else {
+          cheby_main_step_driver(chunks, settings, num_cheby_iters, is_calc_2norm, error);
+        }
       }
     }
 
-    halo_update_driver(chunks, settings, 1);
+    if (!settings.overlap_halo_exchange) halo_update_driver(chunks, settings, 1);
 
     if (fabs(*error) < settings.eps) break;
   }
 
+  // The overlapped steps exchange their halos up front, so the fields are left stale on exit
+  if (settings.overlap_halo_exchange) halo_update_driver(chunks, settings, 1);
+
   print_and_log(settings, "CG: \t\t\t%d iterations\n", tt - num_cheby_iters + 1);
   print_and_log(settings, "Cheby: \t\t\t%d iterations (%d estimated)\n", num_cheby_iters, est_iterations);
+  report_solver_iterations(settings, "CG", tt - num_cheby_iters + 1);
+  report_solver_iterations(settings, "Cheby", num_cheby_iters);
+
+  if (num_cheby_iters) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - cheby_start;
+    print_sweep_bandwidth(settings, "Cheby", num_cheby_iters, elapsed.count(), CHEBY_BYTES_PER_CELL(settings));
+  }
 }
 
 // Invokes the Chebyshev initialisation kernels
@@ -86,24 +121,74 @@ void cheby_init_driver(Chunk *chunks, Settings &settings, int num_cg_iters, doub
 
 // Performs the main iteration step
 void cheby_main_step_driver(Chunk *chunks, Settings &settings, int num_cheby_iters, bool is_calc_2norm, double *error) {
-  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
-    if (settings.kernel_language == Kernel_Language::C) {
-      run_cheby_iterate(&(chunks[cc]), settings, chunks[cc].cheby_alphas[num_cheby_iters], chunks[cc].cheby_betas[num_cheby_iters]);
-    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+  if (settings.overlap_halo_exchange) {
+    // The interior of the iteration runs while u is exchanged
+    MPI_Request requests[settings.num_chunks_per_rank * NUM_NEIGHBOURS * 2];
+    int num_messages = halo_update_start_driver(chunks, settings, 1, requests);
+
+    CONCURRENT_CHUNKS
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_cheby_iterate_interior(&(chunks[cc]), settings, chunks[cc].cheby_alphas[num_cheby_iters],
+                                   chunks[cc].cheby_betas[num_cheby_iters]);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
     }
-  }
 
-  if (is_calc_2norm) {
-    *error = 0.0;
+    halo_update_finish_driver(chunks, settings, 1, requests, num_messages);
 
+    CONCURRENT_CHUNKS
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_cheby_iterate_boundary(&(chunks[cc]), settings, chunks[cc].cheby_alphas[num_cheby_iters],
+                                   chunks[cc].cheby_betas[num_cheby_iters]);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+  } else {
+    CONCURRENT_CHUNKS
     for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
       if (settings.kernel_language == Kernel_Language::C) {
-        run_calculate_2norm(&(chunks[cc]), settings, chunks[cc].r, error);
+        run_cheby_iterate(&(chunks[cc]), settings, chunks[cc].cheby_alphas[num_cheby_iters], chunks[cc].cheby_betas[num_cheby_iters]);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
       }
     }
+  }
+
+  if (is_calc_2norm) cheby_calc_2norm_driver(chunks, settings, error);
+}
+
+// Performs steps iterations as one temporally blocked sweep, which needs u and p exchanged to the depth of the steps
+void cheby_blocked_step_driver(Chunk *chunks, Settings &settings, int num_cheby_iters, int steps, bool is_calc_2norm, double *error) {
+  settings.fields_to_exchange[FIELD_P] = true;
+  halo_update_driver(chunks, settings, steps);
+  settings.fields_to_exchange[FIELD_P] = false;
+
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_cheby_iterate_blocked(&(chunks[cc]), settings, steps, &(chunks[cc].cheby_alphas[num_cheby_iters]),
+                                &(chunks[cc].cheby_betas[num_cheby_iters]));
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  if (is_calc_2norm) cheby_calc_2norm_driver(chunks, settings, error);
+}
+
+// Calculates the norm of the residual left by the last iteration
+void cheby_calc_2norm_driver(Chunk *chunks, Settings &settings, double *error) {
+  double norm = 0.0;
 
-    sum_over_ranks(settings, error);
+  CONCURRENT_CHUNKS_SUM(norm)
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_calculate_2norm(&(chunks[cc]), settings, chunks[cc].r, &norm);
+    }
   }
+  *error = norm;
+
+  sum_over_ranks(settings, error);
 }
 
 // Calculates the estimated iterations for Chebyshev solver
@@ -65,7 +65,7 @@ void initialise_chunk(Chunk *chunk, Settings &settings, int x, int y) {
   chunk->dt_init = settings.dt_init;
 
   // Allocate the neighbour list
-  chunk->neighbours = static_cast<int *>(std::malloc(sizeof(int) * NUM_FACES));
+  chunk->neighbours = static_cast<int *>(std::malloc(sizeof(int) * NUM_NEIGHBOURS));
 
   // Allocate the MPI comm buffers
   //  int lr_len = chunk->y * settings.halo_depth * NUM_FIELDS;
@@ -21,6 +21,14 @@ struct Chunk {
   FieldBufferType top_recv;
   FieldBufferType bottom_send;
   FieldBufferType bottom_recv;
+  FieldBufferType bottom_left_send;
+  FieldBufferType bottom_left_recv;
+  FieldBufferType bottom_right_send;
+  FieldBufferType bottom_right_recv;
+  FieldBufferType top_left_send;
+  FieldBufferType top_left_recv;
+  FieldBufferType top_right_send;
+  FieldBufferType top_right_recv;
 
   StagingBufferType staging_left_send;
   StagingBufferType staging_left_recv;
@@ -30,6 +38,14 @@ struct Chunk {
   StagingBufferType staging_top_recv;
   StagingBufferType staging_bottom_send;
   StagingBufferType staging_bottom_recv;
+  StagingBufferType staging_bottom_left_send;
+  StagingBufferType staging_bottom_left_recv;
+  StagingBufferType staging_bottom_right_send;
+  StagingBufferType staging_bottom_right_recv;
+  StagingBufferType staging_top_left_send;
+  StagingBufferType staging_top_left_recv;
+  StagingBufferType staging_top_right_send;
+  StagingBufferType staging_top_right_recv;
 
   // Mesh chunks
   int left;
@@ -41,6 +57,11 @@ struct Chunk {
   int x;
   int y;
 
+  // Field buffer layout, the nth buffer allocated starts n * field_stagger bytes past a field_alignment boundary
+  int field_alignment;
+  int field_stagger;
+  int num_buffers;
+
   // Field buffers
   FieldBufferType density0;
   FieldBufferType density;
@@ -56,6 +77,35 @@ struct Chunk {
   FieldBufferType kx;
   FieldBufferType ky;
   FieldBufferType sd;
+  FieldBufferType s;
+  FieldBufferType z;
+  FieldBufferType q;
+
+  // Stored operator, only allocated by the models that implement stored_diagonal and float_coefficients, kx_float and
+  // ky_float also hold the coefficients of float_fields solves
+  FieldBufferType diag;
+  float *kx_float;
+  float *ky_float;
+
+  // The coefficients of each cell stored next to each other, only allocated by the models that implement interleaved_operator
+  FieldBufferType operator_cells;
+
+  // Factors of the tridiagonal solves of the block Jacobi preconditioner, only allocated by the models that implement it
+  FieldBufferType cp;
+  FieldBufferType bfp;
+
+  // Coarse levels of the multigrid preconditioner, each a chunk of the interior of the level above aggregated 2x2 with a
+  // single halo cell, only allocated by the models that implement it
+  int mg_levels;
+  Chunk *mg_coarse;
+
+  // Single precision vectors of the mixed precision CG inner solve and of float_fields solves, which also use the others
+  float *u_float;
+  float *r_float;
+  float *w_float;
+  float *u0_float;
+  float *p_float;
+  float *sd_float;
 
   FieldBufferType cell_x;
   FieldBufferType cell_y;
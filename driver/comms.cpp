@@ -1,5 +1,9 @@
 #include "comms.h"
 #include "settings.h"
+#include "shared.h"
+#include <cstring>
+#include <map>
+#include <tuple>
 
 // Initialise MPI
 void initialise_comms(int argc, char **argv) { MPI_Init(&argc, &argv); }
@@ -10,16 +14,63 @@ void initialise_ranks(Settings &settings) {
   MPI_Comm_size(MPI_COMM_WORLD, &settings.num_ranks);
 }
 
+// The persistent send and receive requests of one message, keyed by its buffers, length, neighbour and tags.
+// The length differs for each set of exchanged fields, so every fields_to_exchange signature gets its own requests.
+using PersistentMessageKey = std::tuple<double *, double *, int, int, int, int>;
+static std::map<PersistentMessageKey, std::pair<MPI_Request, MPI_Request>> persistent_messages;
+
+// Frees the persistent requests, which must all be inactive
+static void free_persistent_messages() {
+  for (auto &message : persistent_messages) {
+    MPI_Request_free(&message.second.first);
+    MPI_Request_free(&message.second.second);
+  }
+  persistent_messages.clear();
+}
+
 // Teardown MPI
-void finalise_comms() { MPI_Finalize(); }
+void finalise_comms() {
+  free_persistent_messages();
+  MPI_Finalize();
+}
+
+// Starts the persistent requests for a message, creating them the first time it is seen.
+// Returns false when the message cannot be cached, which happens if the buffers move between exchanges.
+static bool start_persistent_message(Settings &settings, double *send_buffer, double *recv_buffer, int buffer_len, int neighbour,
+                                     int send_tag, int recv_tag, MPI_Request *send_request, MPI_Request *recv_request) {
+  PersistentMessageKey key(send_buffer, recv_buffer, buffer_len, neighbour, send_tag, recv_tag);
+  auto message = persistent_messages.find(key);
+
+  if (message == persistent_messages.end()) {
+    if (persistent_messages.size() >= size_t(settings.num_chunks_per_rank * NUM_NEIGHBOURS * NUM_FIELDS)) return false;
+
+    std::pair<MPI_Request, MPI_Request> requests;
+    MPI_Send_init(send_buffer, buffer_len, MPI_DOUBLE, neighbour, send_tag, MPI_COMM_WORLD, &requests.first);
+    MPI_Recv_init(recv_buffer, buffer_len, MPI_DOUBLE, neighbour, recv_tag, MPI_COMM_WORLD, &requests.second);
+    message = persistent_messages.emplace(key, requests).first;
+  }
+
+  MPI_Request requests[2] = {message->second.first, message->second.second};
+  MPI_Startall(2, requests);
+
+  // Completing a persistent request leaves it allocated, so the caller waits on copies of the handles
+  *send_request = requests[0];
+  *recv_request = requests[1];
+  return true;
+}
 
 // Sends a message out and receives a message in
 void send_recv_message(Settings &settings, double *send_buffer, double *recv_buffer, int buffer_len, int neighbour, int send_tag,
                        int recv_tag, MPI_Request *send_request, MPI_Request *recv_request) {
   START_PROFILING(settings.kernel_profile);
 
-  MPI_Isend(send_buffer, buffer_len, MPI_DOUBLE, neighbour, send_tag, MPI_COMM_WORLD, send_request);
-  MPI_Irecv(recv_buffer, buffer_len, MPI_DOUBLE, neighbour, recv_tag, MPI_COMM_WORLD, recv_request);
+  bool started = settings.persistent_halo_exchange &&
+                 start_persistent_message(settings, send_buffer, recv_buffer, buffer_len, neighbour, send_tag, recv_tag, send_request,
+                                          recv_request);
+  if (!started) {
+    MPI_Isend(send_buffer, buffer_len, MPI_DOUBLE, neighbour, send_tag, MPI_COMM_WORLD, send_request);
+    MPI_Irecv(recv_buffer, buffer_len, MPI_DOUBLE, neighbour, recv_tag, MPI_COMM_WORLD, recv_request);
+  }
 
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
@@ -39,6 +90,27 @@ void sum_over_ranks(Settings &settings, double *a) {
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
+// Reduce over all ranks to get the sums of several values in one message
+void sum_over_ranks(Settings &settings, double *a, int count) {
+  START_PROFILING(settings.kernel_profile);
+  MPI_Allreduce(MPI_IN_PLACE, a, count, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Starts a non-blocking sum over all ranks, a must be left untouched until the matching wait
+void sum_over_ranks_start(Settings &settings, double *a, int count, MPI_Request *request) {
+  START_PROFILING(settings.kernel_profile);
+  MPI_Iallreduce(MPI_IN_PLACE, a, count, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD, request);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Completes a sum started by sum_over_ranks_start
+void sum_over_ranks_wait(Settings &settings, MPI_Request *request) {
+  START_PROFILING(settings.kernel_profile);
+  MPI_Wait(request, MPI_STATUS_IGNORE);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
 // Reduce across all ranks to get minimum value
 void min_over_ranks(Settings &settings, double *a) {
   START_PROFILING(settings.kernel_profile);
@@ -47,6 +119,66 @@ void min_over_ranks(Settings &settings, double *a) {
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
+// Gathers count values from every rank, the values of rank rr land in all[rr * count, (rr + 1) * count)
+void gather_over_ranks(Settings &settings, const double *a, int count, double *all) {
+  START_PROFILING(settings.kernel_profile);
+  std::memcpy(all + settings.rank * count, a, sizeof(double) * count);
+  MPI_Allgather(MPI_IN_PLACE, 0, MPI_DOUBLE, all, count, MPI_DOUBLE, MPI_COMM_WORLD);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Finds the largest value over all ranks, it is not profiled as it only runs after the profile is collected
+void max_over_ranks(Settings &settings, int *a) {
+  int temp = *a;
+  MPI_Allreduce(&temp, a, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+}
+
+// Gathers count values from every rank onto the master, the values of rank rr land in all[rr * count, (rr + 1) * count).
+// Only the master reads all, it is not profiled as it only runs after the profile is collected.
+void gather_to_master(Settings &settings, const double *a, int count, double *all) {
+  if (settings.rank == MASTER) {
+    std::memcpy(all + MASTER * count, a, sizeof(double) * count);
+    MPI_Gather(MPI_IN_PLACE, count, MPI_DOUBLE, all, count, MPI_DOUBLE, MASTER, MPI_COMM_WORLD);
+  } else {
+    MPI_Gather(a, count, MPI_DOUBLE, nullptr, count, MPI_DOUBLE, MASTER, MPI_COMM_WORLD);
+  }
+}
+
+void gather_to_master(Settings &settings, const char *a, int count, char *all) {
+  if (settings.rank == MASTER) {
+    std::memcpy(all + MASTER * count, a, count);
+    MPI_Gather(MPI_IN_PLACE, count, MPI_CHAR, all, count, MPI_CHAR, MASTER, MPI_COMM_WORLD);
+  } else {
+    MPI_Gather(a, count, MPI_CHAR, nullptr, count, MPI_CHAR, MASTER, MPI_COMM_WORLD);
+  }
+}
+
+// Gathers the count values of every rank onto the master, the values of rank rr land in all[offsets[rr]] and there are
+// counts[rr] of them. Only the master reads all, counts and offsets.
+void gather_to_master(Settings &settings, const double *a, int count, double *all, const int *counts, const int *offsets) {
+  START_PROFILING(settings.kernel_profile);
+  if (settings.rank == MASTER) {
+    std::memcpy(all + offsets[MASTER], a, sizeof(double) * count);
+    MPI_Gatherv(MPI_IN_PLACE, count, MPI_DOUBLE, all, counts, offsets, MPI_DOUBLE, MASTER, MPI_COMM_WORLD);
+  } else {
+    MPI_Gatherv(a, count, MPI_DOUBLE, nullptr, nullptr, nullptr, MPI_DOUBLE, MASTER, MPI_COMM_WORLD);
+  }
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Scatters the values gathered by gather_to_master back from the master, rank rr receives its count values from
+// all[offsets[rr]]
+void scatter_from_master(Settings &settings, const double *all, const int *counts, const int *offsets, double *a, int count) {
+  START_PROFILING(settings.kernel_profile);
+  if (settings.rank == MASTER) {
+    std::memcpy(a, all + offsets[MASTER], sizeof(double) * count);
+    MPI_Scatterv(all, counts, offsets, MPI_DOUBLE, MPI_IN_PLACE, count, MPI_DOUBLE, MASTER, MPI_COMM_WORLD);
+  } else {
+    MPI_Scatterv(nullptr, nullptr, nullptr, MPI_DOUBLE, a, count, MPI_DOUBLE, MASTER, MPI_COMM_WORLD);
+  }
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
 // Synchronise all ranks
 void barrier() { MPI_Barrier(MPI_COMM_WORLD); }
 
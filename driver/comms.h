@@ -20,7 +20,16 @@ void finalise_comms();
 void initialise_comms(int argc, char **argv);
 void initialise_ranks(Settings &settings);
 void sum_over_ranks(Settings &settings, double *a);
+void sum_over_ranks(Settings &settings, double *a, int count);
 void min_over_ranks(Settings &settings, double *a);
+void gather_over_ranks(Settings &settings, const double *a, int count, double *all);
+void max_over_ranks(Settings &settings, int *a);
+void gather_to_master(Settings &settings, const double *a, int count, double *all);
+void gather_to_master(Settings &settings, const char *a, int count, char *all);
+void gather_to_master(Settings &settings, const double *a, int count, double *all, const int *counts, const int *offsets);
+void scatter_from_master(Settings &settings, const double *all, const int *counts, const int *offsets, double *a, int count);
+void sum_over_ranks_start(Settings &settings, double *a, int count, MPI_Request *request);
+void sum_over_ranks_wait(Settings &settings, MPI_Request *request);
 void wait_for_requests(Settings &settings, int num_requests, MPI_Request *requests);
 void send_recv_message(Settings &settings, double *send_buffer, double *recv_buffer, int buffer_len, int neighbour, int send_tag,
                        int recv_tag, MPI_Request *send_request, MPI_Request *recv_request);
\ No newline at end of file
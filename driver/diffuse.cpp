@@ -35,7 +35,7 @@ void solve(Chunk *chunks, Settings &settings, int tt, double *wallclock_prev) {
   reset_fields_to_exchange(settings);
   settings.fields_to_exchange[FIELD_ENERGY1] = true;
   settings.fields_to_exchange[FIELD_DENSITY] = true;
-  halo_update_driver(chunks, settings, 2);
+  halo_update_driver(chunks, settings, settings.halo_depth);
 
   double error = 1e+10;
 
@@ -45,6 +45,11 @@ void solve(Chunk *chunks, Settings &settings, int tt, double *wallclock_prev) {
     case Solver::CG_SOLVER: cg_driver(chunks, settings, rx, ry, &error); break;
     case Solver::CHEBY_SOLVER: cheby_driver(chunks, settings, rx, ry, &error); break;
     case Solver::PPCG_SOLVER: ppcg_driver(chunks, settings, rx, ry, &error); break;
+    case Solver::PIPELINED_CG_SOLVER: pipelined_cg_driver(chunks, settings, rx, ry, &error); break;
+    case Solver::GHYSELS_CG_SOLVER: ghysels_cg_driver(chunks, settings, rx, ry, &error); break;
+    case Solver::FUSED_CG_SOLVER: fused_cg_driver(chunks, settings, rx, ry, &error); break;
+    case Solver::MIXED_CG_SOLVER: mixed_cg_driver(chunks, settings, rx, ry, &error); break;
+    case Solver::MG_SOLVER: mg_driver(chunks, settings, rx, ry, &error); break;
   }
 
   // Perform solve finalisation tasks
@@ -56,10 +61,11 @@ void solve(Chunk *chunks, Settings &settings, int tt, double *wallclock_prev) {
 
   profiler_end_timer(settings.wallclock_profile, "Wallclock");
 
-  double wallclock = settings.wallclock_profile->profiler_entries[0].time;
+  double wallclock = settings.wallclock_profile->profiler_entries[profiler_get_profile_entry(settings.wallclock_profile, "Wallclock")].time;
   print_and_log(settings, " Wallclock: \t\t%.3lfs\n", wallclock);
   print_and_log(settings, " Avg. time per cell: \t%.6e\n", (wallclock - *wallclock_prev) / (settings.grid_x_cells * settings.grid_y_cells));
   print_and_log(settings, " Error: \t\t%.6e\n", error);
+  report_timestep(settings, tt + 1, dt, wallclock, error);
 }
 
 // Calculate minimum timestep
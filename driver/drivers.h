@@ -1,6 +1,30 @@
 #pragma once
 
 #include "chunk.h"
+#include "comms.h"
+
+// Runs the iterations of the chunk loop that follows as concurrent tasks when settings.concurrent_chunks is set,
+// the _SUM form also sums the named per-chunk results
+#ifdef _OPENMP
+  #define TEALEAF_PRAGMA(...) _Pragma(#__VA_ARGS__)
+  #define CONCURRENT_CHUNKS TEALEAF_PRAGMA(omp parallel for schedule(dynamic) if (settings.concurrent_chunks))
+  #define CONCURRENT_CHUNKS_SUM(...) \
+    TEALEAF_PRAGMA(omp parallel for schedule(dynamic) reduction(+ : __VA_ARGS__) if (settings.concurrent_chunks))
+#else
+  #define CONCURRENT_CHUNKS
+  #define CONCURRENT_CHUNKS_SUM(...)
+#endif
+
+// The modelled traffic and bandwidth lines of the solvers are only printed by profiled builds and by runs writing a
+// --report, so the default output of a solve is unchanged
+#ifdef ENABLE_PROFILING
+  #define PRINT_SOLVER_TRAFFIC(settings) true
+#else
+  #define PRINT_SOLVER_TRAFFIC(settings) ((settings).report_filename != nullptr)
+#endif
+
+// The bytes of a word of the vectors and coefficients of a solve, float_fields solves hold them in single precision
+#define SOLVE_WORD_BYTES(settings) ((settings).float_fields ? sizeof(float) : sizeof(double))
 
 // Initialisation drivers
 void set_chunk_data_driver(Chunk *chunk, Settings &settings);
@@ -11,10 +35,27 @@ void kernel_finalise_driver(Chunk *chunks, Settings &settings);
 // Halo drivers
 void halo_update_driver(Chunk *chunks, Settings &settings, int depth);
 void remote_halo_driver(Chunk *chunks, Settings &settings, int depth);
+int halo_update_start_driver(Chunk *chunks, Settings &settings, int depth, MPI_Request *requests);
+void halo_update_finish_driver(Chunk *chunks, Settings &settings, int depth, MPI_Request *requests, int num_messages);
+int remote_halo_start_driver(Chunk *chunks, Settings &settings, int depth, MPI_Request *requests);
+void remote_halo_finish_driver(Chunk *chunks, Settings &settings, int depth, MPI_Request *requests, int num_messages);
+
+// The buffers a face or corner is exchanged through
+struct HaloBuffers {
+  FieldBufferType send;
+  FieldBufferType recv;
+  StagingBufferType staging_send;
+  StagingBufferType staging_recv;
+};
+
+HaloBuffers halo_buffers(Chunk &chunk, int face);
+int opposite_face(int face);
+int local_neighbour(Chunk *chunks, Settings &settings, int cc, int face);
 
 // Conjugate Gradient solver drivers
 void cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error);
 void cg_init_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *rro);
+void cg_calc_w_driver(Chunk *chunks, Settings &settings, double *pw);
 void cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *rro, double *error);
 
 // Chebyshev solver drivers
@@ -22,19 +63,58 @@ void cheby_driver(Chunk *chunks, Settings &settings, double rx, double ry, doubl
 void cheby_init_driver(Chunk *chunks, Settings &settings, int num_cg_iters, double *bb);
 void cheby_coef_driver(Chunk *chunks, Settings &settings, int max_iters);
 void cheby_main_step_driver(Chunk *chunks, Settings &settings, int cheby_iters, bool is_calc_2norm, double *error);
+void cheby_blocked_step_driver(Chunk *chunks, Settings &settings, int cheby_iters, int steps, bool is_calc_2norm, double *error);
 
 // PPCG solver drivers
 void ppcg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error);
 void ppcg_init_driver(Chunk *chunks, Settings &settings, double *rro);
 void ppcg_main_step_driver(Chunk *chunks, Settings &settings, double *rro, double *error);
 
+// Pipelined CG solver drivers
+void pipelined_cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error);
+void pipelined_cg_init_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *rro, double *alpha);
+void pipelined_cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *rro, double *alpha, double *beta, double *error);
+void ghysels_cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error);
+void ghysels_cg_init_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *dots);
+void ghysels_cg_restart_driver(Chunk *chunks, Settings &settings, double *dots);
+void ghysels_cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, bool restart, double *dots, double *rro, double *alpha,
+                                 double *error);
+
+// Fused CG solver drivers
+void fused_cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error);
+void fused_cg_calc_w_driver(Chunk *chunks, Settings &settings, double *dots);
+void fused_cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *dots, double *error);
+void mixed_cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error);
+int mixed_cg_inner_solve_driver(Chunk *chunks, Settings &settings, int max_iters);
+void mixed_cg_refine_driver(Chunk *chunks, Settings &settings, double *error);
+void print_cg_traffic(Settings &settings, const char *solver, int iterations, double seconds, int bytes_per_cell);
+
 // Jacobi solver drivers
 void jacobi_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error);
 void jacobi_init_driver(Chunk *chunks, Settings &settings, double rx, double ry);
-void jacobi_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *error);
+void jacobi_main_step_driver(Chunk *chunks, Settings &settings, int tt, int steps, double *error);
+
+// Multigrid solver drivers, the V-cycle also preconditions the CG and PPCG solvers
+void mg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error);
+void mg_main_step_driver(Chunk *chunks, Settings &settings, double *error);
+void multigrid_global_init_driver(Chunk *chunks, Settings &settings);
+void multigrid_vcycle_driver(Chunk *chunks, Settings &settings, double *rz);
+
+// Temporal blocking drivers
+int temporal_block_length(Settings &settings, int tt, int check_offset, int check_interval);
+void print_sweep_bandwidth(Settings &settings, const char *solver, int iterations, double seconds, int bytes_per_cell);
+
+// Profiling reports
+void rank_profile_report(Settings &settings);
+void report_solver_iterations(Settings &settings, const char *solver, int iterations);
+void report_timestep(Settings &settings, int step, double dt, double wallclock, double error);
+void write_performance_report(Settings &settings);
+void print_kernel_profile(Settings &settings);
+bool modelled_kernel_cost(const char *kernel, int *doubles_per_cell, int *flops_per_cell);
 
 // Misc drivers
 bool field_summary_driver(Chunk *chunks, Settings &settings, bool solve_finished);
 void store_energy_driver(Chunk *chunk, Settings &settings);
 void solve_finished_driver(Chunk *chunks, Settings &settings);
 void eigenvalue_driver_initialise(Chunk *chunks, Settings &settings, int num_cg_iters);
+void calibrate_driver(Chunk *chunks, Settings &settings);
@@ -0,0 +1,126 @@
+#include "chunk.h"
+#include "comms.h"
+#include "drivers.h"
+#include "kernel_interface.h"
+#include <chrono>
+
+/*
+ *      Fused CG
+ *
+ *      Each iteration updates u, r and p and applies the next matvec in a
+ *      single sweep. The norm of the new residual is recomputed from the
+ *      dot products r.r, p.w, r.w and w.w of the previous sweep, as
+ *      |r - alpha w|^2 = r.r - 2 alpha r.w + alpha^2 w.w, so one reduction
+ *      yields both alpha and beta. Rather than exchanging p after its update,
+ *      r and w are exchanged before it and the halo ring of p is updated
+ *      redundantly.
+ */
+
+// Doubles streamed through memory per cell and iteration, the fused sweep reads u, p, r, w, kx and ky and writes u, r, p
+// and w, the models that split it into an update and a matvec sweep read p and r a second time
+#define FUSED_CG_BYTES_PER_CELL (10 * sizeof(double))
+
+// Reports the modelled memory traffic per cell of an iteration and the bandwidth it was achieved at
+void print_cg_traffic(Settings &settings, const char *solver, int iterations, double seconds, int bytes_per_cell) {
+  if (!PRINT_SOLVER_TRAFFIC(settings)) return;
+  double bytes = static_cast<double>(settings.grid_x_cells) * settings.grid_y_cells * iterations * bytes_per_cell;
+  double bandwidth = (seconds > 0.0) ? bytes / seconds * 1.0E-9 : 0.0;
+  print_and_log(settings, " %s traffic: \t%d bytes per cell per iteration at %.3lf GB/s\n", solver, bytes_per_cell, bandwidth);
+}
+
+// Performs a full solve with the fused CG solver kernels
+void fused_cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error) {
+  PROFILE_SCOPE(settings.kernel_profile, __func__);
+  int tt;
+  double rro = 0.0;
+  double dots[4];
+
+  // Perform CG initialisation
+  cg_init_driver(chunks, settings, rx, ry, &rro);
+
+  auto start = std::chrono::steady_clock::now();
+
+  fused_cg_calc_w_driver(chunks, settings, dots);
+
+  // From here on r and w are exchanged ahead of each fused sweep
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_R] = true;
+  settings.fields_to_exchange[FIELD_W] = true;
+
+  // Iterate till convergence
+  for (tt = 0; tt < settings.max_iters; ++tt) {
+    fused_cg_main_step_driver(chunks, settings, tt, dots, error);
+
+    if (sqrt(fabs(*error)) < settings.eps) break;
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  // The residual check at the end of the solve needs a consistent u
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_U] = true;
+  halo_update_driver(chunks, settings, 1);
+
+  print_and_log(settings, " Fused CG: \t\t%d iterations\n", tt);
+  report_solver_iterations(settings, "Fused CG", tt);
+  print_cg_traffic(settings, "Fused CG", tealeaf_MIN(tt + 1, settings.max_iters), elapsed.count(), FUSED_CG_BYTES_PER_CELL);
+}
+
+// Calculates w = Ap and the dot products of the first fused CG iteration
+void fused_cg_calc_w_driver(Chunk *chunks, Settings &settings, double *dots) {
+  for (int dd = 0; dd < 4; ++dd) dots[dd] = 0.0;
+
+  CONCURRENT_CHUNKS_SUM(dots[:4])
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_cg_fused_calc_w(&(chunks[cc]), settings, dots);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  sum_over_ranks(settings, dots, 4);
+}
+
+// Invokes the main fused CG solve kernels, leaving the dot products of the next iteration in dots
+void fused_cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *dots, double *error) {
+  double rro = dots[0];
+  double alpha = rro / dots[1];
+  double rrn = rro - 2.0 * alpha * dots[2] + alpha * alpha * dots[3];
+  double beta = rrn / rro;
+
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    chunks[cc].cg_alphas[tt] = alpha;
+    chunks[cc].cg_betas[tt] = beta;
+  }
+
+  *error = rrn;
+
+  // The last iteration only needs u and r
+  if (sqrt(fabs(rrn)) < settings.eps || tt == settings.max_iters - 1) {
+    double rrn_local = 0.0;
+
+    CONCURRENT_CHUNKS_SUM(rrn_local)
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_cg_calc_ur(&(chunks[cc]), settings, alpha, &rrn_local);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+    return;
+  }
+
+  halo_update_driver(chunks, settings, 1);
+
+  for (int dd = 0; dd < 4; ++dd) dots[dd] = 0.0;
+
+  // Each tile runs the update and the next matvec in one sweep while it is in cache
+  CONCURRENT_CHUNKS_SUM(dots[:4])
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_cg_fused_step(&(chunks[cc]), settings, alpha, beta, dots);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  sum_over_ranks(settings, dots, 4);
+}
@@ -17,3 +17,24 @@ void halo_update_driver(Chunk *chunks, Settings &settings, int depth) {
     }
   }
 }
+
+// Posts the remote messages of a halo update so that computation can overlap them, returning the number of requests posted
+int halo_update_start_driver(Chunk *chunks, Settings &settings, int depth, MPI_Request *requests) {
+  if (!is_fields_to_exchange(settings)) return 0;
+
+  return remote_halo_start_driver(chunks, settings, depth, requests);
+}
+
+// Completes a halo update started by halo_update_start_driver
+void halo_update_finish_driver(Chunk *chunks, Settings &settings, int depth, MPI_Request *requests, int num_messages) {
+  if (!is_fields_to_exchange(settings)) return;
+
+  remote_halo_finish_driver(chunks, settings, depth, requests, num_messages);
+
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_local_halos(&(chunks[cc]), settings, depth);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+}
@@ -1,5 +1,7 @@
 #include <cfloat>
+#include <cmath>
 #include <cstring>
+#include <unistd.h>
 
 #include "application.h"
 #include "chunk.h"
@@ -47,6 +49,9 @@ void decompose_field(Settings &settings, Chunk *chunks) {
     die(__LINE__, __FILE__, "Failed to decompose the field with given parameters.\n");
   }
 
+  settings.x_chunks = x_chunks;
+  settings.y_chunks = y_chunks;
+
   int dx = settings.grid_x_cells / x_chunks;
   int dy = settings.grid_y_cells / y_chunks;
 
@@ -81,6 +86,16 @@ void decompose_field(Settings &settings, Chunk *chunks) {
           chunks[cc].neighbours[CHUNK_RIGHT] = (xx == x_chunks - 1) ? EXTERNAL_FACE : chunk + 1;
           chunks[cc].neighbours[CHUNK_BOTTOM] = (yy == 0) ? EXTERNAL_FACE : chunk - x_chunks;
           chunks[cc].neighbours[CHUNK_TOP] = (yy == y_chunks - 1) ? EXTERNAL_FACE : chunk + x_chunks;
+
+          // The diagonal neighbours supply the halo corners in a single phase exchange
+          bool is_left = (xx == 0);
+          bool is_right = (xx == x_chunks - 1);
+          bool is_bottom = (yy == 0);
+          bool is_top = (yy == y_chunks - 1);
+          chunks[cc].neighbours[CHUNK_BOTTOM_LEFT] = (is_bottom || is_left) ? EXTERNAL_FACE : chunk - x_chunks - 1;
+          chunks[cc].neighbours[CHUNK_BOTTOM_RIGHT] = (is_bottom || is_right) ? EXTERNAL_FACE : chunk - x_chunks + 1;
+          chunks[cc].neighbours[CHUNK_TOP_LEFT] = (is_top || is_left) ? EXTERNAL_FACE : chunk + x_chunks - 1;
+          chunks[cc].neighbours[CHUNK_TOP_RIGHT] = (is_top || is_right) ? EXTERNAL_FACE : chunk + x_chunks + 1;
         }
       }
 
@@ -94,8 +109,32 @@ void decompose_field(Settings &settings, Chunk *chunks) {
 
 void initialise_model_info(Settings &settings) { run_model_info(settings); }
 
+// Splits each rank's mesh into enough chunks that the working set of one fits in the L2 cache
+static void tile_chunks(Settings &settings) {
+  long cache_bytes = settings.tile_cache_kb * 1024L;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+  if (cache_bytes <= 0) cache_bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+  if (cache_bytes <= 0) cache_bytes = 1024L * 1024L;
+
+  double rank_bytes = double(settings.grid_x_cells) * settings.grid_y_cells / settings.num_ranks * TILE_WORKING_SET_FIELDS * sizeof(double);
+  settings.num_chunks_per_rank = std::max(1, int(std::ceil(rank_bytes / cache_bytes)));
+
+  // Host models built with OpenMP sweep the tiles concurrently, running each tile's kernels on a single thread. Without
+  // OpenMP the CONCURRENT_CHUNKS loops are plain loops and the tiles run one after another.
+#ifdef _OPENMP
+  settings.concurrent_chunks = settings.model_kind == ModelKind::Host && settings.num_chunks_per_rank > 1;
+#else
+  settings.concurrent_chunks = false;
+#endif
+
+  print_and_log(settings, " - Tiles:    %d per rank for a %ld KB cache%s\n", settings.num_chunks_per_rank, cache_bytes / 1024,
+                settings.concurrent_chunks ? ", swept concurrently" : "");
+}
+
 // Initialise settings from input file
 void initialise_application(Chunk **chunks, Settings &settings, State* states) {
+  if (settings.tile_chunks) tile_chunks(settings);
 
   *chunks = (Chunk *)malloc(sizeof(Chunk) * settings.num_chunks_per_rank);
 
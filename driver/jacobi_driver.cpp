@@ -2,22 +2,40 @@
 #include "comms.h"
 #include "drivers.h"
 #include "kernel_interface.h"
+#include <chrono>
+
+// Bytes a Jacobi iteration moves per cell without temporal blocking, the copy of u reads and writes a field
+// and the update reads four fields and writes one
+#define JACOBI_BYTES_PER_CELL(settings) (7 * SOLVE_WORD_BYTES(settings))
+
+// The residual is recalculated every JACOBI_RESIDUAL_ITERS iterations
+#define JACOBI_RESIDUAL_ITERS 50
 
 // Performs a full solve with the Jacobi solver kernels
 void jacobi_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error) {
+  PROFILE_SCOPE(settings.kernel_profile, __func__);
   jacobi_init_driver(chunks, settings, rx, ry);
 
-  // Iterate till convergence
+  auto start = std::chrono::steady_clock::now();
+
+  // Iterate till convergence, running the iterations of each temporally blocked sweep at once
   int tt;
   for (tt = 0; tt < settings.max_iters; ++tt) {
-    jacobi_main_step_driver(chunks, settings, tt, error);
+    int steps = temporal_block_length(settings, tt, 0, JACOBI_RESIDUAL_ITERS);
+    tt += steps - 1;
+
+    jacobi_main_step_driver(chunks, settings, tt, steps, error);
 
     halo_update_driver(chunks, settings, 1);
 
     if (fabs(*error) < settings.eps) break;
   }
 
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
   print_and_log(settings, "Jacobi: \t\t%d iterations\n", tt);
+  report_solver_iterations(settings, "Jacobi", tt);
+  print_sweep_bandwidth(settings, "Jacobi", tealeaf_MIN(tt + 1, settings.max_iters), elapsed.count(), JACOBI_BYTES_PER_CELL(settings));
 }
 
 // Invokes the CG initialisation kernels
@@ -26,6 +44,8 @@ void jacobi_init_driver(Chunk *chunks, Settings &settings, double rx, double ry)
     if (settings.kernel_language == Kernel_Language::C) {
       run_jacobi_init(&(chunks[cc]), settings, rx, ry);
 
+      if (settings.stored_diagonal || settings.float_coefficients) run_store_operator(&(chunks[cc]), settings);
+
       run_copy_u(&(chunks[cc]), settings);
     } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
     }
@@ -36,16 +56,29 @@ void jacobi_init_driver(Chunk *chunks, Settings &settings, double rx, double ry)
   settings.fields_to_exchange[FIELD_U] = true;
 }
 
-// Invokes the main Jacobi solve kernels
-void jacobi_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *error) {
+// Invokes the main Jacobi solve kernels for the steps iterations up to tt,
+// more than one step runs as a temporally blocked sweep after exchanging u to that depth
+void jacobi_main_step_driver(Chunk *chunks, Settings &settings, int tt, int steps, double *error) {
+  if (steps > 1) halo_update_driver(chunks, settings, steps);
+
+  // The kernel overwrites its error, so the error of each chunk is summed here
+  double error_sum = 0.0;
+  CONCURRENT_CHUNKS_SUM(error_sum)
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     if (settings.kernel_language == Kernel_Language::C) {
-      run_jacobi_iterate(&(chunks[cc]), settings, error);
+      double chunk_error = 0.0;
+      if (steps > 1) {
+        run_jacobi_iterate_blocked(&(chunks[cc]), settings, steps, &chunk_error);
+      } else {
+        run_jacobi_iterate(&(chunks[cc]), settings, &chunk_error);
+      }
+      error_sum += chunk_error;
     } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
     }
   }
+  *error = error_sum;
 
-  if (tt % 50 == 0) {
+  if (tt % JACOBI_RESIDUAL_ITERS == 0) {
     halo_update_driver(chunks, settings, 1);
 
     for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
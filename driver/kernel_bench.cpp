@@ -0,0 +1,308 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+#include "application.h"
+#include "chunk.h"
+#include "comms.h"
+#include "drivers.h"
+#include "kernel_interface.h"
+#include "shared.h"
+
+/*
+ *      KERNEL BENCHMARK
+ *      Times the run_* kernels one at a time on a single chunk per rank, sweeping the grid size, the halo depth and the
+ *      thread count. Each measurement doubles its iterations until it runs for at least the minimum time.
+ */
+
+#define BENCH_DEFAULT_MIN_TIME 0.2
+#define BENCH_MAX_ITERATIONS (1L << 30)
+#define BENCH_OUT_FILENAME "kernel_bench.out"
+
+// The fields exchanged by the packing and local halo kernels, the pair exchanged before every solve
+#define BENCH_NUM_FIELDS 2
+
+struct BenchKernel {
+  const char *name;
+  void (*run)(Chunk *chunk, Settings &settings);
+  // Bytes moved by one call, zero when the kernel has no model
+  double (*bytes)(Chunk *chunk, Settings &settings);
+};
+
+static double inner_cells(Chunk *chunk, Settings &settings) {
+  return static_cast<double>(chunk->x - 2 * settings.halo_depth) * (chunk->y - 2 * settings.halo_depth);
+}
+
+// The bytes of one call from the modelled cost per cell that the performance report uses
+template <const char *Name> static double modelled_bytes(Chunk *chunk, Settings &settings) {
+  int doubles_per_cell = 0, flops_per_cell = 0;
+  if (!modelled_kernel_cost(Name, &doubles_per_cell, &flops_per_cell)) return 0.0;
+  return inner_cells(chunk, settings) * doubles_per_cell * SOLVE_WORD_BYTES(settings);
+}
+
+// Each packed or unpacked cell is read from one array and written to the other
+template <int Face> static double face_bytes(Chunk *chunk, Settings &settings) {
+  const int length = (Face == CHUNK_LEFT || Face == CHUNK_RIGHT) ? chunk->y : chunk->x;
+  return 2.0 * BENCH_NUM_FIELDS * settings.halo_depth * length * sizeof(double);
+}
+
+// Every external face of the chunk reflects halo_depth layers of each field
+static double local_halo_bytes(Chunk *chunk, Settings &settings) {
+  return 2.0 * BENCH_NUM_FIELDS * settings.halo_depth * 2.0 * (chunk->x + chunk->y) * sizeof(double);
+}
+
+static FieldBufferType face_buffer(Chunk *chunk, int face) {
+  switch (face) {
+    case CHUNK_LEFT: return chunk->left_send;
+    case CHUNK_RIGHT: return chunk->right_send;
+    case CHUNK_BOTTOM: return chunk->bottom_send;
+    default: return chunk->top_send;
+  }
+}
+
+template <int Face, bool Pack> static void pack_face(Chunk *chunk, Settings &settings) {
+  FieldBufferType fields[BENCH_NUM_FIELDS] = {chunk->density, chunk->energy};
+  const int length = (Face == CHUNK_LEFT || Face == CHUNK_RIGHT) ? chunk->y : chunk->x;
+  run_pack_or_unpack_fields(chunk, settings, settings.halo_depth, Face, Pack, fields, BENCH_NUM_FIELDS, face_buffer(chunk, Face),
+                            settings.halo_depth * length);
+}
+
+// The scalars keep every field bounded or growing linearly, so repeated calls never reach denormals or overflow
+static void bench_cg_calc_w(Chunk *chunk, Settings &settings) {
+  double pw = 0.0;
+  run_cg_calc_w(chunk, settings, &pw);
+}
+static void bench_cg_calc_ur(Chunk *chunk, Settings &settings) {
+  double rrn = 0.0;
+  run_cg_calc_ur(chunk, settings, 1.0E-12, &rrn);
+}
+static void bench_cg_calc_p(Chunk *chunk, Settings &settings) { run_cg_calc_p(chunk, settings, 1.0); }
+static void bench_cheby_iterate(Chunk *chunk, Settings &settings) { run_cheby_iterate(chunk, settings, 1.0, 0.0); }
+static void bench_ppcg_inner_iteration(Chunk *chunk, Settings &settings) { run_ppcg_inner_iteration(chunk, settings, 1.0, 0.0); }
+static void bench_jacobi_iterate(Chunk *chunk, Settings &settings) {
+  double error = 0.0;
+  run_jacobi_iterate(chunk, settings, &error);
+}
+static void bench_calculate_residual(Chunk *chunk, Settings &settings) { run_calculate_residual(chunk, settings); }
+static void bench_calculate_2norm(Chunk *chunk, Settings &settings) {
+  double norm = 0.0;
+  run_calculate_2norm(chunk, settings, chunk->r, &norm);
+}
+static void bench_copy_u(Chunk *chunk, Settings &settings) { run_copy_u(chunk, settings); }
+static void bench_local_halos(Chunk *chunk, Settings &settings) { run_local_halos(chunk, settings, settings.halo_depth); }
+static void bench_field_summary(Chunk *chunk, Settings &settings) {
+  double vol = 0.0, mass = 0.0, ie = 0.0, temp = 0.0;
+  run_field_summary(chunk, settings, &vol, &mass, &ie, &temp);
+}
+
+static const char cg_calc_w_name[] = "run_cg_calc_w";
+static const char cg_calc_ur_name[] = "run_cg_calc_ur";
+static const char cg_calc_p_name[] = "run_cg_calc_p";
+static const char cheby_iterate_name[] = "run_cheby_iterate";
+static const char ppcg_inner_iteration_name[] = "run_ppcg_inner_iteration";
+static const char jacobi_iterate_name[] = "run_jacobi_iterate";
+static const char calculate_residual_name[] = "run_calculate_residual";
+static const char calculate_2norm_name[] = "run_calculate_2norm";
+static const char copy_u_name[] = "run_copy_u";
+static const char field_summary_name[] = "run_field_summary";
+
+static const BenchKernel bench_kernels[] = {
+    {cg_calc_w_name, bench_cg_calc_w, modelled_bytes<cg_calc_w_name>},
+    {cg_calc_ur_name, bench_cg_calc_ur, modelled_bytes<cg_calc_ur_name>},
+    {cg_calc_p_name, bench_cg_calc_p, modelled_bytes<cg_calc_p_name>},
+    {cheby_iterate_name, bench_cheby_iterate, modelled_bytes<cheby_iterate_name>},
+    {ppcg_inner_iteration_name, bench_ppcg_inner_iteration, modelled_bytes<ppcg_inner_iteration_name>},
+    {jacobi_iterate_name, bench_jacobi_iterate, modelled_bytes<jacobi_iterate_name>},
+    {calculate_residual_name, bench_calculate_residual, modelled_bytes<calculate_residual_name>},
+    {calculate_2norm_name, bench_calculate_2norm, modelled_bytes<calculate_2norm_name>},
+    {copy_u_name, bench_copy_u, modelled_bytes<copy_u_name>},
+    {"run_pack_left", pack_face<CHUNK_LEFT, true>, face_bytes<CHUNK_LEFT>},
+    {"run_pack_right", pack_face<CHUNK_RIGHT, true>, face_bytes<CHUNK_RIGHT>},
+    {"run_pack_bottom", pack_face<CHUNK_BOTTOM, true>, face_bytes<CHUNK_BOTTOM>},
+    {"run_pack_top", pack_face<CHUNK_TOP, true>, face_bytes<CHUNK_TOP>},
+    {"run_unpack_left", pack_face<CHUNK_LEFT, false>, face_bytes<CHUNK_LEFT>},
+    {"run_unpack_right", pack_face<CHUNK_RIGHT, false>, face_bytes<CHUNK_RIGHT>},
+    {"run_unpack_bottom", pack_face<CHUNK_BOTTOM, false>, face_bytes<CHUNK_BOTTOM>},
+    {"run_unpack_top", pack_face<CHUNK_TOP, false>, face_bytes<CHUNK_TOP>},
+    {"run_local_halos", bench_local_halos, local_halo_bytes},
+    {field_summary_name, bench_field_summary, modelled_bytes<field_summary_name>},
+};
+
+// Parses a comma separated list of positive integers
+static std::vector<int> parse_list(const char *list) {
+  std::vector<int> values;
+  for (const char *value = list; *value;) {
+    char *end;
+    const long parsed = std::strtol(value, &end, 10);
+    if (end == value || parsed <= 0) {
+      die(__LINE__, __FILE__, "Could not parse the list %s\n", list);
+    }
+    values.push_back(static_cast<int>(parsed));
+    value = (*end == ',') ? end + 1 : end;
+  }
+  return values;
+}
+
+// Times calls of the kernel, doubling their number until they take at least min_time, and returns the seconds per call
+static double time_kernel(const BenchKernel &kernel, Chunk *chunk, Settings &settings, double min_time, long *iterations) {
+  kernel.run(chunk, settings);
+
+  for (long calls = 1;; calls *= 2) {
+    barrier();
+    auto start = std::chrono::steady_clock::now();
+    for (long ii = 0; ii < calls; ++ii) {
+      kernel.run(chunk, settings);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Every rank takes the slowest time, so that they all agree when to stop
+    double slowest = -elapsed;
+    min_over_ranks(settings, &slowest);
+    elapsed = -slowest;
+
+    if (elapsed >= min_time || calls >= BENCH_MAX_ITERATIONS) {
+      *iterations = calls;
+      return elapsed / calls;
+    }
+  }
+}
+
+// Sets up a square grid of cells by cells, decomposed over the ranks, in a uniform state with the CG operator built
+static Chunk *initialise_bench_chunk(Settings &settings, int cells, int halo_depth) {
+  settings.grid_x_cells = cells;
+  settings.grid_y_cells = cells;
+  settings.dx = (settings.grid_x_max - settings.grid_x_min) / settings.grid_x_cells;
+  settings.dy = (settings.grid_y_max - settings.grid_y_min) / settings.grid_y_cells;
+  settings.halo_depth = halo_depth;
+
+  State state{};
+  state.defined = true;
+  state.density = 100.0;
+  state.energy = 0.0001;
+  state.geometry = Geometry::RECTANGULAR;
+  settings.num_states = 1;
+
+  Chunk *chunks;
+  initialise_application(&chunks, settings, &state);
+
+  const double rx = settings.dt_init / (settings.dx * settings.dx);
+  const double ry = settings.dt_init / (settings.dy * settings.dy);
+  double rro = 0.0;
+  run_cg_init(&(chunks[0]), settings, rx, ry, &rro);
+  run_copy_u(&(chunks[0]), settings);
+
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_DENSITY] = true;
+  settings.fields_to_exchange[FIELD_ENERGY1] = true;
+  return chunks;
+}
+
+static void finalise_bench_chunk(Chunk *chunks, Settings &settings) {
+  kernel_finalise_driver(chunks, settings);
+  finalise_chunk(&(chunks[0]));
+  std::free(chunks);
+}
+
+int main(int argc, char **argv) {
+  initialise_comms(argc, argv);
+
+  Settings settings;
+  set_default_settings(settings);
+  initialise_ranks(settings);
+
+  std::strcpy(settings.tea_out_filename, BENCH_OUT_FILENAME);
+  settings.staging_buffer = true;
+
+  std::vector<int> sizes = {32, 64, 128, 256, 512, 1024, 2048, 4096};
+  std::vector<int> halo_depths = {settings.halo_depth};
+  std::vector<int> threads = {1};
+#ifdef _OPENMP
+  threads[0] = omp_get_max_threads();
+#endif
+  double min_time = BENCH_DEFAULT_MIN_TIME;
+  const char *filter = nullptr;
+  const char *csv_filename = nullptr;
+
+  for (int aa = 1; aa < argc; ++aa) {
+    if (aa + 1 == argc) break;
+    if (tealeaf_strmatch(argv[aa], "--sizes")) sizes = parse_list(argv[++aa]);
+    else if (tealeaf_strmatch(argv[aa], "--halo-depths")) halo_depths = parse_list(argv[++aa]);
+    else if (tealeaf_strmatch(argv[aa], "--threads")) threads = parse_list(argv[++aa]);
+    else if (tealeaf_strmatch(argv[aa], "--min-time")) min_time = std::atof(argv[++aa]);
+    else if (tealeaf_strmatch(argv[aa], "--filter")) filter = argv[++aa];
+    else if (tealeaf_strmatch(argv[aa], "--csv")) csv_filename = argv[++aa];
+    else if (tealeaf_strmatch(argv[aa], "--out")) settings.tea_out_filename = argv[++aa];
+  }
+
+  initialise_log(settings);
+  initialise_model_info(settings);
+
+  // The initial halo update of the application always exchanges two layers
+  for (int halo_depth : halo_depths) {
+    if (halo_depth < 2) {
+      die(__LINE__, __FILE__, "The halo depth must be at least 2, got %d\n", halo_depth);
+    }
+  }
+
+  FILE *csv = nullptr;
+  if (settings.rank == MASTER && csv_filename) {
+    csv = fopen(csv_filename, "w");
+    if (!csv) {
+      die(__LINE__, __FILE__, "Could not open benchmark file %s\n", csv_filename);
+    }
+    fprintf(csv, "model,kernel,cells,halo_depth,threads,ranks,iterations,seconds,ns_per_cell,gb_s\n");
+  }
+
+  print_and_log(settings, "Kernel benchmark:\n");
+  print_and_log(settings, " - Model: %s\n", settings.model_name.c_str());
+  print_and_log(settings, " - Ranks: %d\n", settings.num_ranks);
+  print_and_log(settings, "\n %-28s%8s%6s%9s%12s%14s%10s%10s\n", "Kernel", "Cells", "Halo", "Threads", "Iterations", "Time (us)", "ns/cell",
+                "GB/s");
+
+  for (int thread_count : threads) {
+#ifdef _OPENMP
+    omp_set_num_threads(thread_count);
+#else
+    if (thread_count != 1) {
+      print_and_log(settings, " The %s model is not built with OpenMP, ignoring %d threads\n", settings.model_name.c_str(), thread_count);
+      continue;
+    }
+#endif
+    for (int halo_depth : halo_depths) {
+      for (int cells : sizes) {
+        Chunk *chunks = initialise_bench_chunk(settings, cells, halo_depth);
+
+        for (const BenchKernel &kernel : bench_kernels) {
+          if (filter && !std::strstr(kernel.name, filter)) continue;
+
+          long iterations = 0;
+          const double seconds = time_kernel(kernel, &(chunks[0]), settings, min_time, &iterations);
+          const double per_cell = seconds / inner_cells(&(chunks[0]), settings) * 1.0E9;
+          const double bandwidth = kernel.bytes(&(chunks[0]), settings) / seconds * 1.0E-9;
+
+          print_and_log(settings, " %-28s%8d%6d%9d%12ld%14.3lf%10.3lf%10.3lf\n", kernel.name, cells, halo_depth, thread_count, iterations,
+                        seconds * 1.0E6, per_cell, bandwidth);
+          if (csv) {
+            fprintf(csv, "\"%s\",%s,%d,%d,", settings.model_name.c_str(), kernel.name, cells, halo_depth);
+            fprintf(csv, "%d,%d,%ld,%.9e,%.6e,%.6e\n", thread_count, settings.num_ranks, iterations, seconds, per_cell, bandwidth);
+          }
+        }
+
+        finalise_bench_chunk(chunks, settings);
+      }
+    }
+  }
+
+  if (csv) fclose(csv);
+  profiler_finalise(&settings.kernel_profile);
+  profiler_finalise(&settings.application_profile);
+  profiler_finalise(&settings.wallclock_profile);
+  finalise_comms();
+  return EXIT_SUCCESS;
+}
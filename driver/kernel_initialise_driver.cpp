@@ -1,16 +1,153 @@
 #include "chunk.h"
+#include "comms.h"
 #include "kernel_interface.h"
+#include <climits>
+#include <cstdint>
+#include <sys/syscall.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+// Pages sampled from each field by the page placement report, and the NUMA nodes it tells apart
+#define PAGE_REPORT_SAMPLES 1024
+#define PAGE_REPORT_NODES 8
+
+// Picks the stagger between the starts of consecutive field buffers. Buffers starting on the same alignment boundary
+// map a cell of every field to the same cache set, so the streams of a stencil evict each other. An odd number of
+// lines puts the starts in distinct sets of any cache whose ways are a power of two lines, and about an L2 way over
+// the number of streamed fields spreads them evenly.
+static int tune_field_stagger() {
+  long line = 64;
+  long l2_way = 64 * 1024;
+#ifdef _SC_LEVEL1_DCACHE_LINESIZE
+  if (sysconf(_SC_LEVEL1_DCACHE_LINESIZE) > 0) line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+  if (sysconf(_SC_LEVEL2_CACHE_SIZE) > 0 && sysconf(_SC_LEVEL2_CACHE_ASSOC) > 0) {
+    l2_way = sysconf(_SC_LEVEL2_CACHE_SIZE) / sysconf(_SC_LEVEL2_CACHE_ASSOC);
+  }
+#endif
+
+  long lines = tealeaf_MAX(1L, l2_way / TILE_WORKING_SET_FIELDS / line);
+  if (lines % 2 == 0) ++lines;
+  return static_cast<int>(lines * line);
+}
+
+// Counts the NUMA nodes holding a sample of the pages of a field, in placement[0, PAGE_REPORT_NODES], the last count
+// being pages that are not resident or lie on later nodes. Only host pointers can be queried.
+template <typename Buffer> static void sample_page_placement(Buffer field, size_t bytes, double *placement) {
+#ifdef SYS_move_pages
+  if constexpr (std::is_same_v<Buffer, double *>) {
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(field) & ~(page - 1);
+    const uintptr_t num_pages = (reinterpret_cast<uintptr_t>(field) + bytes - begin + page - 1) / page;
+    const uintptr_t count = tealeaf_MIN(num_pages, uintptr_t(PAGE_REPORT_SAMPLES));
+
+    void *pages[PAGE_REPORT_SAMPLES];
+    int status[PAGE_REPORT_SAMPLES];
+    for (uintptr_t ii = 0; ii < count; ++ii) {
+      pages[ii] = reinterpret_cast<void *>(begin + ii * num_pages / count * page);
+    }
+    if (syscall(SYS_move_pages, 0, count, pages, nullptr, status, 0) != 0) return;
+
+    for (uintptr_t ii = 0; ii < count; ++ii) {
+      placement[(status[ii] >= 0 && status[ii] < PAGE_REPORT_NODES) ? status[ii] : PAGE_REPORT_NODES] += 1.0;
+    }
+  }
+#endif
+}
+
+// Reads a size in kB from /proc/self/smaps_rollup
+static double read_smaps_kb(const char *key) {
+  double kb = 0.0;
+  FILE *fp = std::fopen("/proc/self/smaps_rollup", "r");
+  if (!fp) return kb;
+
+  char line[256];
+  while (std::fgets(line, sizeof(line), fp)) {
+    if (std::strncmp(line, key, std::strlen(key)) == 0) {
+      kb = std::atof(line + std::strlen(key));
+      break;
+    }
+  }
+  std::fclose(fp);
+  return kb;
+}
+
+// Reports the NUMA nodes that the pages of each rank's mesh fields ended up on, and the huge pages backing the rank
+static void report_page_placement(Chunk *chunks, Settings &settings) {
+  const int num_values = PAGE_REPORT_NODES + 3;
+  double placement[num_values] = {};
+
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    Chunk &chunk = chunks[cc];
+    const size_t bytes = sizeof(double) * chunk.x * chunk.y;
+    FieldBufferType fields[] = {chunk.density0, chunk.density, chunk.energy0, chunk.energy, chunk.u, chunk.u0, chunk.p, chunk.r,
+                                chunk.mi,       chunk.w,       chunk.kx,      chunk.ky,     chunk.sd, chunk.s, chunk.z,  chunk.q};
+    for (FieldBufferType field : fields) sample_page_placement(field, bytes, placement);
+  }
+  placement[PAGE_REPORT_NODES + 1] = read_smaps_kb("AnonHugePages:");
+  placement[PAGE_REPORT_NODES + 2] = read_smaps_kb("Private_Hugetlb:");
+
+  std::vector<double> all(num_values * settings.num_ranks);
+  gather_over_ranks(settings, placement, num_values, all.data());
+
+  for (int rr = 0; rr < settings.num_ranks; ++rr) {
+    const double *values = all.data() + rr * num_values;
+    double sampled = 0.0;
+    for (int nn = 0; nn <= PAGE_REPORT_NODES; ++nn) sampled += values[nn];
+
+    char line[512];
+    int len = std::snprintf(line, sizeof(line), " - Pages:    rank %d:", rr);
+    for (int nn = 0; nn <= PAGE_REPORT_NODES; ++nn) {
+      if (values[nn] == 0.0) continue;
+      if (nn < PAGE_REPORT_NODES) {
+        len += std::snprintf(line + len, sizeof(line) - len, " %.1f%% on node %d,", 100.0 * values[nn] / sampled, nn);
+      } else {
+        len += std::snprintf(line + len, sizeof(line) - len, " %.1f%% unplaced,", 100.0 * values[nn] / sampled);
+      }
+    }
+    print_and_log(settings, "%s %.0f kB of transparent and %.0f kB of explicit huge pages\n", line, values[PAGE_REPORT_NODES + 1],
+                  values[PAGE_REPORT_NODES + 2]);
+  }
+}
 
 // Invokes the kernel initialisation kernels
 void kernel_initialise_driver(Chunk *chunks, Settings &settings) {
+  const int word = sizeof(void *);
+  if (settings.field_alignment < word || (settings.field_alignment & (settings.field_alignment - 1))) {
+    die(__LINE__, __FILE__, "field_alignment must be a power of two of at least %d bytes, got %d\n", word, settings.field_alignment);
+  }
+  if (settings.interleaved_operator && settings.float_coefficients) {
+    die(__LINE__, __FILE__, "interleaved_operator cannot be combined with float_coefficients\n");
+  }
+  if (settings.field_stagger < 0) settings.field_stagger = tune_field_stagger();
+  settings.field_stagger = (settings.field_stagger + word - 1) / word * word;
+  print_and_log(settings, " - Fields:   aligned to %d bytes, staggered by %d bytes\n", settings.field_alignment, settings.field_stagger);
+
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    chunks[cc].field_alignment = settings.field_alignment;
+    chunks[cc].field_stagger = settings.field_stagger;
+    chunks[cc].num_buffers = 0;
+  }
+
+  // A chunk of more than INT_MAX cells can only be indexed with 64 bit integers
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (!settings.index_64bit && static_cast<int64_t>(chunks[cc].x) * chunks[cc].y > INT_MAX) {
+      print_and_log(settings, "\nChunk of %dx%d cells needs 64 bit indices, switching index_64bit on\n", chunks[cc].x, chunks[cc].y);
+      settings.index_64bit = true;
+    }
+  }
+
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     if (settings.kernel_language == Kernel_Language::C) {
       int lr_len = chunks[cc].y * settings.halo_depth * NUM_FIELDS;
       int tb_len = chunks[cc].x * settings.halo_depth * NUM_FIELDS;
-      run_kernel_initialise(&(chunks[cc]), settings, lr_len, tb_len);
+      int corner_len = settings.halo_depth * settings.halo_depth * NUM_FIELDS;
+      run_kernel_initialise(&(chunks[cc]), settings, lr_len, tb_len, corner_len);
     } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
     }
   }
+
+  if (settings.report_page_placement) report_page_placement(chunks, settings);
 }
 
 // Invokes the kernel finalisation drivers
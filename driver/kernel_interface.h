@@ -12,8 +12,9 @@
 void run_model_info(Settings &settings);
 void run_set_chunk_data(Chunk *chunk, Settings &settings);
 void run_set_chunk_state(Chunk *chunk, Settings &settings, State *states);
-void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len);
+void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len, int comms_corner_len);
 void run_kernel_finalise(Chunk *chunk, Settings &settings);
+void run_calibrate(Chunk *chunk, Settings &settings, int x, int y, double *seconds);
 
 // Solver-wide kernels
 void run_local_halos(Chunk *chunk, Settings &settings, int depth);
@@ -23,6 +24,8 @@ void run_local_halos(Chunk *chunk, Settings &settings, int depth);
 
 void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType field,
                         FieldBufferType destination, int offset);
+void run_pack_or_unpack_fields(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType *fields, int num_fields,
+                               FieldBufferType buffer, int field_stride);
 //
 void run_send_recv_halo(Chunk *chunk, Settings &settings,                                                       //
                         FieldBufferType src_send_buffer, FieldBufferType src_recv_buffer,                       //
@@ -42,21 +45,60 @@ void run_cg_init(Chunk *chunk, Settings &settings, double rx, double ry, double
 void run_cg_calc_w(Chunk *chunk, Settings &settings, double *pw);
 void run_cg_calc_ur(Chunk *chunk, Settings &settings, double alpha, double *rrn);
 void run_cg_calc_p(Chunk *chunk, Settings &settings, double beta);
+void run_cg_calc_w_interior(Chunk *chunk, Settings &settings, double *pw);
+void run_cg_calc_w_boundary(Chunk *chunk, Settings &settings, double *pw);
+void run_cg_init_preconditioner(Chunk *chunk, Settings &settings, double *rro);
+
+// Pipelined CG solver kernels
+void run_pipelined_cg_calc_w(Chunk *chunk, Settings &settings, double *rr, double *wr);
+void run_pipelined_cg_calc_ur(Chunk *chunk, Settings &settings, double alpha, double beta);
+void run_ghysels_cg_calc_q(Chunk *chunk, Settings &settings);
+void run_ghysels_cg_calc_urw(Chunk *chunk, Settings &settings, double alpha, double beta, double *rr, double *wr);
+
+// Fused CG solver kernels, dots accumulates r.r, p.w, r.w and w.w
+void run_cg_fused_calc_w(Chunk *chunk, Settings &settings, double *dots);
+void run_cg_fused_step(Chunk *chunk, Settings &settings, double alpha, double beta, double *dots);
+
+// Mixed precision CG solver kernels, the inner solve keeps its correction, r, w, kx and ky in single precision
+void run_mixed_cg_init(Chunk *chunk, Settings &settings, double *rro);
+void run_mixed_cg_calc_w(Chunk *chunk, Settings &settings, double *pw);
+void run_mixed_cg_calc_ur(Chunk *chunk, Settings &settings, double alpha, double *rrn);
+void run_mixed_cg_calc_p(Chunk *chunk, Settings &settings, double beta);
+void run_mixed_cg_correct(Chunk *chunk, Settings &settings);
+
+// Multigrid kernels, level 0 is the chunk and level mg_levels the coarsest level of its V-cycle
+void run_multigrid_smooth(Chunk *chunk, Settings &settings, int level, bool zero_start);
+void run_multigrid_restrict(Chunk *chunk, Settings &settings, int level);
+void run_multigrid_prolong(Chunk *chunk, Settings &settings, int level);
+void run_multigrid_pack_halo(Chunk *chunk, Settings &settings, int level, int face, bool pack, FieldBufferType buffer);
+void run_multigrid_global_operator(Chunk *chunk, Settings &settings, double *diagonal, double *west, double *south);
+void run_multigrid_copy_coarsest(Chunk *chunk, Settings &settings, bool to_coarse, double *coarse);
+void run_mg_calc_u(Chunk *chunk, Settings &settings);
 
 // Chebyshev solver kernels
 void run_cheby_init(Chunk *chunk, Settings &settings);
 void run_cheby_iterate(Chunk *chunk, Settings &settings, double alpha, double beta);
+void run_cheby_iterate_interior(Chunk *chunk, Settings &settings, double alpha, double beta);
+void run_cheby_iterate_boundary(Chunk *chunk, Settings &settings, double alpha, double beta);
+void run_cheby_iterate_blocked(Chunk *chunk, Settings &settings, int steps, const double *alphas, const double *betas);
 
 // Jacobi solver kernels
 void run_jacobi_init(Chunk *chunk, Settings &settings, double rx, double ry);
 void run_jacobi_iterate(Chunk *chunk, Settings &settings, double *error);
+void run_jacobi_iterate_blocked(Chunk *chunk, Settings &settings, int steps, double *error);
 
 // PPCG solver kernels
 void run_ppcg_init(Chunk *chunk, Settings &settings);
 void run_ppcg_inner_iteration(Chunk *chunk, Settings &settings, double alpha, double beta);
+void run_ppcg_inner_iteration_ca(Chunk *chunk, Settings &settings, int ext, double alpha, double beta);
+void run_ppcg_inner_iteration_interior(Chunk *chunk, Settings &settings);
+void run_ppcg_inner_iteration_boundary(Chunk *chunk, Settings &settings, double alpha, double beta);
+void run_ppcg_calc_sd(Chunk *chunk, Settings &settings, double alpha, double beta);
 
 // Shared solver kernels
 void run_copy_u(Chunk *chunk, Settings &settings);
 void run_calculate_residual(Chunk *chunk, Settings &settings);
+void run_store_operator(Chunk *chunk, Settings &settings);
 void run_calculate_2norm(Chunk *chunk, Settings &settings, FieldBufferType buffer, double *norm);
+void run_calculate_rz(Chunk *chunk, Settings &settings, double *rz);
 void run_finalise(Chunk *chunk, Settings &settings);
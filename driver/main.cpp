@@ -15,6 +15,11 @@ void settings_overload(Settings &settings, int argc, char **argv) {
       if (tealeaf_strmatch(argv[aa + 1], "cheby")) settings.solver = Solver::CHEBY_SOLVER;
       if (tealeaf_strmatch(argv[aa + 1], "ppcg")) settings.solver = Solver::PPCG_SOLVER;
       if (tealeaf_strmatch(argv[aa + 1], "jacobi")) settings.solver = Solver::JACOBI_SOLVER;
+      if (tealeaf_strmatch(argv[aa + 1], "pipecg")) settings.solver = Solver::PIPELINED_CG_SOLVER;
+      if (tealeaf_strmatch(argv[aa + 1], "ghysels")) settings.solver = Solver::GHYSELS_CG_SOLVER;
+      if (tealeaf_strmatch(argv[aa + 1], "fusedcg")) settings.solver = Solver::FUSED_CG_SOLVER;
+      if (tealeaf_strmatch(argv[aa + 1], "mixedcg")) settings.solver = Solver::MIXED_CG_SOLVER;
+      if (tealeaf_strmatch(argv[aa + 1], "mg")) settings.solver = Solver::MG_SOLVER;
     } else if (tealeaf_strmatch(argv[aa], "-x")) {
       if (aa + 1 == argc) break;
       settings.grid_x_cells = std::atoi(argv[aa]);
@@ -39,17 +44,44 @@ void settings_overload(Settings &settings, int argc, char **argv) {
     } else if (tealeaf_strmatch(argv[aa], "--out") || tealeaf_strmatch(argv[aa], "-o")) {
       if (aa + 1 == argc) break;
       settings.tea_out_filename = argv[aa + 1];
+    } else if (tealeaf_strmatch(argv[aa], "--rank-profile")) {
+      if (aa + 1 == argc) break;
+      settings.rank_profile_filename = argv[aa + 1];
+    } else if (tealeaf_strmatch(argv[aa], "--report")) {
+      if (aa + 1 == argc) break;
+      settings.report_filename = argv[aa + 1];
+    } else if (tealeaf_strmatch(argv[aa], "--report-format")) {
+      if (aa + 1 == argc) break;
+      if (tealeaf_strmatch(argv[aa + 1], "json")) settings.report_format = ReportFormat::JSON;
+      else if (tealeaf_strmatch(argv[aa + 1], "csv")) settings.report_format = ReportFormat::CSV;
+      else
+        die(__LINE__, __FILE__, "Unrecognised --report-format '%s', it can be 'json' or 'csv'.\n", argv[aa + 1]);
+    } else if (tealeaf_strmatch(argv[aa], "--stream-peak")) {
+      if (aa + 1 == argc) break;
+      settings.stream_peak = std::atof(argv[aa + 1]);
+    } else if (tealeaf_strmatch(argv[aa], "--calibrate")) {
+      settings.calibrate = true;
     } else if (tealeaf_strmatch(argv[aa], "-help") || tealeaf_strmatch(argv[aa], "--help") || tealeaf_strmatch(argv[aa], "-h")) {
       print_and_log(settings, "tealeaf <options>\n");
       print_and_log(settings, "options:\n");
       print_and_log(settings, "\t-solver, --solver, -s:\n");
-      print_and_log(settings, "\t\tCan be 'cg', 'cheby', 'ppcg', or 'jacobi'\n");
+      print_and_log(settings, "\t\tCan be 'cg', 'cheby', 'ppcg', 'pipecg', 'ghysels', 'fusedcg', 'mixedcg', 'mg', or 'jacobi'\n");
       print_and_log(settings, "\t-p, --problems:\n");
       print_and_log(settings, "\t\tProblems file path'\n");
       print_and_log(settings, "\t-i, --in, -f, --file:\n");
       print_and_log(settings, "\t\tInput deck file path'\n");
       print_and_log(settings, "\t-o, --out:\n");
       print_and_log(settings, "\t\tOutput file path'\n");
+      print_and_log(settings, "\t--rank-profile:\n");
+      print_and_log(settings, "\t\tCSV file path for the spread of each profiled region over the ranks, needs -DENABLE_PROFILING=ON'\n");
+      print_and_log(settings, "\t--report:\n");
+      print_and_log(settings, "\t\tFile path for the performance report of the timesteps, solvers and kernels'\n");
+      print_and_log(settings, "\t--report-format:\n");
+      print_and_log(settings, "\t\tCan be 'json' or 'csv'\n");
+      print_and_log(settings, "\t--stream-peak:\n");
+      print_and_log(settings, "\t\tSTREAM triad bandwidth of all ranks together in GB/s, for the fraction of peak in the report'\n");
+      print_and_log(settings, "\t--calibrate:\n");
+      print_and_log(settings, "\t\tMeasure the STREAM and matvec bandwidth through the model before the solve'\n");
       print_and_log(settings, "\t--staging-buffer:\n");
       print_and_log(settings, "\t\tIf true, use a host staging buffer for device-host MPI halo exchange.'\n");
       print_and_log(settings, "\t\tIf false, use device pointers directly for MPI halo exchange.'\n");
@@ -161,6 +193,10 @@ int main(int argc, char **argv) {
   print_and_log(settings, " - X buffer size:     %ld KB\n", chunk_comms_total_x * sizeof(double) / 1000);
   print_and_log(settings, " - Y buffer size:     %ld KB\n", chunk_comms_total_y * sizeof(double) / 1000);
 
+  if (settings.calibrate) {
+    calibrate_driver(chunks, settings);
+  }
+
   print_and_log(settings, "# ---- \n");
   print_and_log(settings, "Output: |+1\n");
 
@@ -173,7 +209,13 @@ int main(int argc, char **argv) {
 
   // Print the kernel-level profiling results
   if (settings.rank == MASTER) {
-    PRINT_PROFILING_RESULTS(settings.kernel_profile);
+    print_kernel_profile(settings);
+  }
+#ifdef ENABLE_PROFILING
+  rank_profile_report(settings);
+#endif
+  if (settings.rank == MASTER && settings.report_filename) {
+    write_performance_report(settings);
   }
 
   print_and_log(settings, "Result:\n");
@@ -186,8 +228,8 @@ int main(int argc, char **argv) {
   // Finalise each individual chunk
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     finalise_chunk(&(chunks[cc]));
-    std::free(&(chunks[cc]));
   }
+  std::free(chunks);
 
   profiler_finalise(&settings.kernel_profile);
   profiler_finalise(&settings.application_profile);
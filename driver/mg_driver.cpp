@@ -0,0 +1,521 @@
+#include "chunk.h"
+#include "comms.h"
+#include "drivers.h"
+#include "kernel_interface.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// The solve has stalled when a V-cycle reduces the norm of its correction by less than this
+#define MG_STALL_REDUCTION 0.9
+
+// The gathered grid is coarsened until both of its sides are at most MG_GATHERED_COARSEST_CELLS, which bounds the band
+// Cholesky factor of its direct solve at MG_GATHERED_COARSEST_CELLS^2 * (MG_GATHERED_COARSEST_CELLS + 1) doubles
+#define MG_GATHERED_COARSEST_CELLS 16
+
+// The multigrid V-cycle over every chunk. Each chunk coarsens its interior on its own, to as many levels as the largest
+// chunk needs to bring both sides of its interior to at most MG_COARSEST_CELLS, and the levels exchange their corrections
+// across the chunk faces like the fields of the chunks. The coarsest levels of all of the chunks tile a global grid that
+// is gathered onto the master, which carries on the V-cycle over it with the same aggregation and smoothing down to a
+// grid small enough to solve directly, then scatters the correction back to the ranks.
+struct MultigridCoarsest {
+  int cx;     // Cells across the coarsest level of the chunk
+  int cy;     // Cells up the coarsest level of the chunk
+  int first;  // Its first cell in the global grid, which is numbered along x first
+  int offset; // Its first cell in the coarsest levels of all of the chunks gathered in the order of the chunks
+};
+
+// A level of the V-cycle over the gathered grid, west and south hold the coupling of each cell across its left and
+// bottom face, which is zero on the external faces
+struct GatheredLevel {
+  int x;
+  int y;
+  std::vector<double> diagonal;
+  std::vector<double> west;
+  std::vector<double> south;
+  std::vector<double> b;
+  std::vector<double> e;
+  std::vector<double> t;
+};
+
+static std::vector<MultigridCoarsest> coarsest;
+static std::vector<int> rank_counts;
+static std::vector<int> rank_offsets;
+static std::vector<double> chunk_coarse;
+
+// Only the master holds the gathered grid and its levels
+static std::vector<double> gathered;
+static std::vector<GatheredLevel> gathered_levels;
+static std::vector<double> coarse_factor;
+
+// The cells across and up the interior of a level of the V-cycle of the chunk
+static void level_cells(Chunk &chunk, Settings &settings, int level, int *cx, int *cy) {
+  if (level == 0) {
+    *cx = chunk.x - 2 * settings.halo_depth;
+    *cy = chunk.y - 2 * settings.halo_depth;
+  } else {
+    *cx = chunk.mg_coarse[level - 1].x - 2;
+    *cy = chunk.mg_coarse[level - 1].y - 2;
+  }
+}
+
+// Factors the symmetric positive definite band matrix held by rows of its lower band, band[i * (bandwidth + 1) + d] is
+// the entry (i, i - d), into its Cholesky factor in place
+static void band_cholesky(const int64_t n, const int64_t bandwidth, double *band) {
+  const int64_t width = bandwidth + 1;
+  for (int64_t ii = 0; ii < n; ++ii) {
+    const int64_t first = std::max<int64_t>(0, ii - bandwidth);
+    for (int64_t jj = first; jj <= ii; ++jj) {
+      double sum = band[ii * width + ii - jj];
+      for (int64_t kk = first; kk < jj; ++kk) {
+        sum -= band[ii * width + ii - kk] * band[jj * width + jj - kk];
+      }
+      band[ii * width + ii - jj] = (ii == jj) ? std::sqrt(sum) : sum / band[jj * width];
+    }
+  }
+}
+
+// Solves L L^T x = b in place with the factor of band_cholesky
+static void band_cholesky_solve(const int64_t n, const int64_t bandwidth, const double *band, double *x) {
+  const int64_t width = bandwidth + 1;
+  for (int64_t ii = 0; ii < n; ++ii) {
+    for (int64_t kk = std::max<int64_t>(0, ii - bandwidth); kk < ii; ++kk) {
+      x[ii] -= band[ii * width + ii - kk] * x[kk];
+    }
+    x[ii] /= band[ii * width];
+  }
+  for (int64_t ii = n - 1; ii >= 0; --ii) {
+    for (int64_t kk = ii + 1; kk <= std::min(n - 1, ii + bandwidth); ++kk) {
+      x[ii] -= band[kk * width + kk - ii] * x[kk];
+    }
+    x[ii] /= band[ii * width];
+  }
+}
+
+// Copies between the coarsest levels of all of the chunks, in the order they are gathered in, and the global grid
+static void scatter_coarsest(const double *from, double *to, bool to_global, int global_x) {
+  for (const MultigridCoarsest &level : coarsest) {
+    for (int jc = 0; jc < level.cy; ++jc) {
+      for (int kc = 0; kc < level.cx; ++kc) {
+        const int64_t global = level.first + kc + static_cast<int64_t>(jc) * global_x;
+        const int64_t local = level.offset + kc + static_cast<int64_t>(jc) * level.cx;
+        if (to_global) {
+          to[global] = from[local];
+        } else {
+          to[local] = from[global];
+        }
+      }
+    }
+  }
+}
+
+// The first cell of the coarsest level of a chunk of the rank in chunk_coarse
+static int chunk_coarse_offset(Settings &settings, int cc) {
+  return coarsest[cc + settings.rank * settings.num_chunks_per_rank].offset - rank_offsets[settings.rank];
+}
+
+// Sums the couplings of cell (kk, jj) of a gathered level to the neighbouring values of e
+static double gathered_neighbours(const GatheredLevel &level, const double *e, int64_t kk, int64_t jj) {
+  const int64_t index = kk + jj * level.x;
+  double sum = 0.0;
+  if (kk > 0) sum += level.west[index] * e[index - 1];
+  if (kk < level.x - 1) sum += level.west[index + 1] * e[index + 1];
+  if (jj > 0) sum += level.south[index] * e[index - level.x];
+  if (jj < level.y - 1) sum += level.south[index + level.x] * e[index + level.x];
+  return sum;
+}
+
+// Performs the damped Jacobi sweeps of a gathered level, like those of the levels of the chunks
+static void gathered_smooth(GatheredLevel &level, bool zero_start) {
+  for (int ss = 0; ss < MG_SMOOTH_STEPS; ++ss) {
+    if (ss == 0 && zero_start) {
+      for (size_t ii = 0; ii < level.e.size(); ++ii) level.e[ii] = MG_JACOBI_WEIGHT * level.b[ii] / level.diagonal[ii];
+      continue;
+    }
+
+    for (int64_t jj = 0; jj < level.y; ++jj) {
+      for (int64_t kk = 0; kk < level.x; ++kk) {
+        const int64_t index = kk + jj * level.x;
+        level.t[index] = (level.b[index] + gathered_neighbours(level, level.e.data(), kk, jj)) / level.diagonal[index];
+      }
+    }
+    for (size_t ii = 0; ii < level.e.size(); ++ii) level.e[ii] += MG_JACOBI_WEIGHT * (level.t[ii] - level.e[ii]);
+  }
+}
+
+// Forms the next level of the gathered grid by aggregating its cells 2x2, like multigrid_coarsen does for the chunks
+static GatheredLevel gathered_coarsen(const GatheredLevel &fine) {
+  GatheredLevel coarse;
+  coarse.x = (fine.x + 1) / 2;
+  coarse.y = (fine.y + 1) / 2;
+  const size_t n = static_cast<size_t>(coarse.x) * coarse.y;
+  coarse.diagonal.assign(n, 0.0);
+  coarse.west.assign(n, 0.0);
+  coarse.south.assign(n, 0.0);
+  coarse.b.assign(n, 0.0);
+  coarse.e.assign(n, 0.0);
+  coarse.t.assign(n, 0.0);
+
+  for (int64_t jc = 0; jc < coarse.y; ++jc) {
+    for (int64_t kc = 0; kc < coarse.x; ++kc) {
+      const bool wide = 2 * kc + 1 < fine.x;
+      const bool tall = 2 * jc + 1 < fine.y;
+      const int64_t f = 2 * kc + 2 * jc * fine.x;
+      const int64_t index = kc + jc * coarse.x;
+
+      double diagonal = fine.diagonal[f];
+      coarse.west[index] = fine.west[f];
+      coarse.south[index] = fine.south[f];
+      if (wide) {
+        diagonal += fine.diagonal[f + 1] - 2.0 * fine.west[f + 1];
+        coarse.south[index] += fine.south[f + 1];
+      }
+      if (tall) {
+        diagonal += fine.diagonal[f + fine.x] - 2.0 * fine.south[f + fine.x];
+        coarse.west[index] += fine.west[f + fine.x];
+      }
+      if (wide && tall) {
+        diagonal += fine.diagonal[f + fine.x + 1] - 2.0 * (fine.west[f + fine.x + 1] + fine.south[f + fine.x + 1]);
+      }
+      coarse.diagonal[index] = diagonal;
+    }
+  }
+  return coarse;
+}
+
+// Solves A e = b over a level of the gathered grid and the levels below it, directly on the last level
+static void gathered_vcycle(size_t level) {
+  GatheredLevel &fine = gathered_levels[level];
+  if (level + 1 == gathered_levels.size()) {
+    fine.e = fine.b;
+    band_cholesky_solve(static_cast<int64_t>(fine.x) * fine.y, fine.x, coarse_factor.data(), fine.e.data());
+    return;
+  }
+
+  GatheredLevel &coarse = gathered_levels[level + 1];
+  gathered_smooth(fine, true);
+
+  // Sums the residual of each aggregate of cells into the right hand side of the coarse level
+  std::fill(coarse.b.begin(), coarse.b.end(), 0.0);
+  for (int64_t jj = 0; jj < fine.y; ++jj) {
+    for (int64_t kk = 0; kk < fine.x; ++kk) {
+      const int64_t index = kk + jj * fine.x;
+      coarse.b[kk / 2 + (jj / 2) * coarse.x] +=
+          fine.b[index] - (fine.diagonal[index] * fine.e[index] - gathered_neighbours(fine, fine.e.data(), kk, jj));
+    }
+  }
+
+  gathered_vcycle(level + 1);
+
+  for (int64_t jj = 0; jj < fine.y; ++jj) {
+    for (int64_t kk = 0; kk < fine.x; ++kk) {
+      fine.e[kk + jj * fine.x] += coarse.e[kk / 2 + (jj / 2) * coarse.x];
+    }
+  }
+  gathered_smooth(fine, false);
+}
+
+// Builds the levels of the gathered grid from its operator and factors the last of them
+static void gathered_levels_init(GatheredLevel global) {
+  gathered_levels.clear();
+  gathered_levels.push_back(std::move(global));
+  while (gathered_levels.back().x > MG_GATHERED_COARSEST_CELLS || gathered_levels.back().y > MG_GATHERED_COARSEST_CELLS) {
+    gathered_levels.push_back(gathered_coarsen(gathered_levels.back()));
+  }
+
+  const GatheredLevel &last = gathered_levels.back();
+  const int64_t n = static_cast<int64_t>(last.x) * last.y;
+  const int64_t width = last.x + 1;
+  coarse_factor.assign(n * width, 0.0);
+  for (int64_t gg = 0; gg < n; ++gg) {
+    coarse_factor[gg * width] = last.diagonal[gg];
+    if (gg % last.x) coarse_factor[gg * width + 1] = -last.west[gg];
+    if (gg >= last.x) coarse_factor[gg * width + last.x] = -last.south[gg];
+  }
+  band_cholesky(n, last.x, coarse_factor.data());
+}
+
+// Lays out the coarsest levels of every chunk in the global grid and gathers their operators onto the master, which
+// only rebuilds the levels of the gathered grid and refactors its last level when the operator has changed since the
+// previous solve
+void multigrid_global_init_driver(Chunk *chunks, Settings &settings) {
+  const int num_chunks = settings.x_chunks * settings.y_chunks;
+
+  // Every chunk of a column has the width of the column, and every chunk of a row its height
+  std::vector<double> sizes(2 * num_chunks, 0.0);
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    const int chunk = cc + settings.rank * settings.num_chunks_per_rank;
+    int cx;
+    int cy;
+    level_cells(chunks[cc], settings, chunks[cc].mg_levels, &cx, &cy);
+    sizes[2 * chunk] = cx;
+    sizes[2 * chunk + 1] = cy;
+  }
+  sum_over_ranks(settings, sizes.data(), 2 * num_chunks);
+
+  std::vector<int> column_first(settings.x_chunks + 1, 0);
+  std::vector<int> row_first(settings.y_chunks + 1, 0);
+  for (int xx = 0; xx < settings.x_chunks; ++xx) {
+    column_first[xx + 1] = column_first[xx] + static_cast<int>(sizes[2 * xx]);
+  }
+  for (int yy = 0; yy < settings.y_chunks; ++yy) {
+    row_first[yy + 1] = row_first[yy] + static_cast<int>(sizes[2 * yy * settings.x_chunks + 1]);
+  }
+  const int global_x = column_first[settings.x_chunks];
+  const int global_y = row_first[settings.y_chunks];
+
+  coarsest.resize(num_chunks);
+  rank_counts.assign(settings.num_ranks, 0);
+  rank_offsets.assign(settings.num_ranks, 0);
+  int offset = 0;
+  for (int chunk = 0; chunk < num_chunks; ++chunk) {
+    const int xx = chunk % settings.x_chunks;
+    const int yy = chunk / settings.x_chunks;
+    coarsest[chunk] = {column_first[xx + 1] - column_first[xx], row_first[yy + 1] - row_first[yy],
+                       column_first[xx] + row_first[yy] * global_x, offset};
+    offset += coarsest[chunk].cx * coarsest[chunk].cy;
+    rank_counts[chunk / settings.num_chunks_per_rank] += coarsest[chunk].cx * coarsest[chunk].cy;
+  }
+  for (int rr = 1; rr < settings.num_ranks; ++rr) rank_offsets[rr] = rank_offsets[rr - 1] + rank_counts[rr - 1];
+  const int count = rank_counts[settings.rank];
+  chunk_coarse.assign(count, 0.0);
+  if (settings.rank == MASTER) gathered.assign(offset, 0.0);
+
+  // The diagonal, west and south couplings of the coarsest levels of the chunks of the rank follow one another
+  std::vector<double> chunk_operator(3 * count);
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      const int first = chunk_coarse_offset(settings, cc);
+      run_multigrid_global_operator(&(chunks[cc]), settings, &chunk_operator[first], &chunk_operator[count + first],
+                                    &chunk_operator[2 * count + first]);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  GatheredLevel global;
+  global.x = global_x;
+  global.y = global_y;
+  const size_t n = static_cast<size_t>(global_x) * global_y;
+  std::vector<double> *couplings[3] = {&global.diagonal, &global.west, &global.south};
+  for (int ee = 0; ee < 3; ++ee) {
+    gather_to_master(settings, &chunk_operator[ee * count], count, gathered.data(), rank_counts.data(), rank_offsets.data());
+    if (settings.rank != MASTER) continue;
+    couplings[ee]->assign(n, 0.0);
+    scatter_coarsest(gathered.data(), couplings[ee]->data(), true, global_x);
+  }
+  if (settings.rank != MASTER) return;
+
+  // The west and south couplings of the cells on the external faces lead nowhere
+  for (size_t gg = 0; gg < n; ++gg) {
+    if (gg % global_x == 0) global.west[gg] = 0.0;
+    if (gg < static_cast<size_t>(global_x)) global.south[gg] = 0.0;
+  }
+
+  if (!gathered_levels.empty()) {
+    const GatheredLevel &previous = gathered_levels.front();
+    if (previous.x == global.x && previous.y == global.y && previous.diagonal == global.diagonal && previous.west == global.west &&
+        previous.south == global.south) {
+      return;
+    }
+  }
+
+  global.b.assign(n, 0.0);
+  global.e.assign(n, 0.0);
+  global.t.assign(n, 0.0);
+  gathered_levels_init(std::move(global));
+}
+
+// Exchanges the correction of a level of the V-cycle across the faces between chunks. The external faces keep the zero
+// halo the operators of the levels assume, as they leave out the coefficients of those faces.
+static void multigrid_halo_driver(Chunk *chunks, Settings &settings, int level) {
+  MPI_Request requests[settings.num_chunks_per_rank * NUM_FACES * 2];
+  int num_messages = 0;
+
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    int cx;
+    int cy;
+    level_cells(chunks[cc], settings, level, &cx, &cy);
+
+    for (int face = 0; face < NUM_FACES; ++face) {
+      const int neighbour = chunks[cc].neighbours[face];
+      if (neighbour == EXTERNAL_FACE) continue;
+
+      HaloBuffers buffers = halo_buffers(chunks[cc], face);
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_multigrid_pack_halo(&(chunks[cc]), settings, level, face, true, buffers.send);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+      if (local_neighbour(chunks, settings, cc, face) >= 0) continue;
+
+      const int send_tag = face + NUM_NEIGHBOURS * (neighbour % settings.num_chunks_per_rank);
+      const int recv_tag = opposite_face(face) + NUM_NEIGHBOURS * cc;
+      send_recv_message(settings, buffers.send, buffers.recv, (face == CHUNK_LEFT || face == CHUNK_RIGHT) ? cy : cx,
+                        neighbour / settings.num_chunks_per_rank, send_tag, recv_tag, &requests[num_messages], &requests[num_messages + 1]);
+      num_messages += 2;
+    }
+  }
+
+  wait_for_requests(settings, num_messages, requests);
+
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    for (int face = 0; face < NUM_FACES; ++face) {
+      if (chunks[cc].neighbours[face] == EXTERNAL_FACE) continue;
+
+      const int local = local_neighbour(chunks, settings, cc, face);
+      FieldBufferType buffer = local >= 0 ? halo_buffers(chunks[local], opposite_face(face)).send : halo_buffers(chunks[cc], face).recv;
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_multigrid_pack_halo(&(chunks[cc]), settings, level, face, false, buffer);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+  }
+}
+
+// Runs the damped Jacobi sweeps of a level, each of which reads the correction of the neighbouring chunks but the first
+// sweep from e = 0
+static void multigrid_smooth_driver(Chunk *chunks, Settings &settings, int level, bool zero_start) {
+  for (int ss = 0; ss < MG_SMOOTH_STEPS; ++ss) {
+    if (ss > 0 || !zero_start) multigrid_halo_driver(chunks, settings, level);
+
+    CONCURRENT_CHUNKS
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_multigrid_smooth(&(chunks[cc]), settings, level, zero_start && ss == 0);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+  }
+}
+
+// Solves z = M^-1 r with the multigrid V-cycle over every chunk, and adds r.z over the chunks of the rank to rz. Every
+// level is smoothed by the same number of damped Jacobi sweeps before and after its coarse correction, which keeps M
+// symmetric for CG.
+void multigrid_vcycle_driver(Chunk *chunks, Settings &settings, double *rz) {
+  const int mg_levels = chunks[0].mg_levels;
+
+  for (int ll = 0; ll < mg_levels; ++ll) {
+    multigrid_smooth_driver(chunks, settings, ll, true);
+    multigrid_halo_driver(chunks, settings, ll);
+
+    CONCURRENT_CHUNKS
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_multigrid_restrict(&(chunks[cc]), settings, ll);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+  }
+
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_multigrid_copy_coarsest(&(chunks[cc]), settings, true, &chunk_coarse[chunk_coarse_offset(settings, cc)]);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  // Each rank only sends and receives the cells of its own chunks, while the master solves over the gathered grid
+  const int count = static_cast<int>(chunk_coarse.size());
+  gather_to_master(settings, chunk_coarse.data(), count, gathered.data(), rank_counts.data(), rank_offsets.data());
+  if (settings.rank == MASTER) {
+    GatheredLevel &global = gathered_levels.front();
+    scatter_coarsest(gathered.data(), global.b.data(), true, global.x);
+    gathered_vcycle(0);
+    scatter_coarsest(global.e.data(), gathered.data(), false, global.x);
+  }
+  scatter_from_master(settings, gathered.data(), rank_counts.data(), rank_offsets.data(), chunk_coarse.data(), count);
+
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_multigrid_copy_coarsest(&(chunks[cc]), settings, false, &chunk_coarse[chunk_coarse_offset(settings, cc)]);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  for (int ll = mg_levels - 1; ll >= 0; --ll) {
+    CONCURRENT_CHUNKS
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_multigrid_prolong(&(chunks[cc]), settings, ll);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+
+    multigrid_smooth_driver(chunks, settings, ll, false);
+  }
+
+  double rz_sum = 0.0;
+  CONCURRENT_CHUNKS_SUM(rz_sum)
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_calculate_rz(&(chunks[cc]), settings, &rz_sum);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+  *rz += rz_sum;
+}
+
+// Performs a full solve with the multigrid solver, each iteration corrects u with a V-cycle on its residual. The residual
+// is recalculated rather than updated, so like the mixed precision CG solver the solve stops once it stalls at the
+// double precision floor, and says so.
+void mg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error) {
+  PROFILE_SCOPE(settings.kernel_profile, __func__);
+  int tt;
+  double rro = 0.0;
+
+  // Sets up the coefficients and the multigrid levels, and leaves the halo of u current
+  cg_init_driver(chunks, settings, rx, ry, &rro);
+
+  bool stalled = false;
+  double previous_error = 0.0;
+  for (tt = 0; tt < settings.max_iters; ++tt) {
+    mg_main_step_driver(chunks, settings, error);
+
+    if (sqrt(fabs(*error)) < settings.eps) break;
+
+    if (tt > 0 && *error > previous_error * MG_STALL_REDUCTION * MG_STALL_REDUCTION) {
+      stalled = true;
+      break;
+    }
+    previous_error = *error;
+  }
+
+  print_and_log(settings, " MG: \t\t\t%d iterations\n", tt);
+  if (stalled) {
+    print_and_log(settings, " MG: \t\t\tstopped at the double precision residual floor %.3e, above eps %.3e\n", sqrt(fabs(*error)),
+                  settings.eps);
+  }
+  report_solver_iterations(settings, "MG", tt);
+}
+
+// Invokes the main multigrid solver kernels, error is set to r.z of the correction z the V-cycle adds to u
+void mg_main_step_driver(Chunk *chunks, Settings &settings, double *error) {
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_calculate_residual(&(chunks[cc]), settings);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  double rz = 0.0;
+  multigrid_vcycle_driver(chunks, settings, &rz);
+  sum_over_ranks(settings, &rz);
+  *error = rz;
+
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_mg_calc_u(&(chunks[cc]), settings);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_U] = true;
+  halo_update_driver(chunks, settings, 1);
+}
@@ -0,0 +1,154 @@
+#include "chunk.h"
+#include "comms.h"
+#include "drivers.h"
+#include "kernel_interface.h"
+
+/*
+ *      Mixed precision CG
+ *
+ *      Iterative refinement around a single precision CG solve. Each outer
+ *      step solves Ae = r for a correction with the coefficients, r, w and e
+ *      held in single precision, adds e to u and recomputes the residual
+ *      r = u0 - Au and its norm in double precision. The halo exchange
+ *      only moves double precision fields, so p stays in double precision.
+ *
+ *      The other solvers test eps against a recursively updated residual,
+ *      which keeps shrinking past the rounding error of the operator. The
+ *      recalculated residual here bottoms out at that floor instead, so when
+ *      eps is below it refinement stops once it stalls, and says so.
+ */
+
+// Reduction of the residual norm each single precision inner solve aims for, about what single precision can deliver
+#define MIXED_CG_INNER_REDUCTION 1.0E-4
+
+// Refinement has stalled when a step reduces the double precision residual norm by less than this
+#define MIXED_CG_STALL_REDUCTION 0.5
+
+// Performs a full solve with the mixed precision CG solver kernels
+void mixed_cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error) {
+  PROFILE_SCOPE(settings.kernel_profile, __func__);
+  int tt = 0;
+  int refinements = 0;
+
+  // Perform CG initialisation, which leaves the double precision residual in r
+  cg_init_driver(chunks, settings, rx, ry, error);
+
+  // Refine till convergence or until refinement stalls at the double precision floor, the inner solves share the
+  // iteration budget
+  bool stalled = false;
+  while (tt < settings.max_iters && sqrt(fabs(*error)) >= settings.eps) {
+    double previous_error = *error;
+
+    tt += mixed_cg_inner_solve_driver(chunks, settings, settings.max_iters - tt);
+    mixed_cg_refine_driver(chunks, settings, error);
+    ++refinements;
+
+    if (*error > previous_error * MIXED_CG_STALL_REDUCTION * MIXED_CG_STALL_REDUCTION) {
+      stalled = true;
+      break;
+    }
+  }
+
+  print_and_log(settings, " Mixed CG: \t\t%d iterations in %d refinements\n", tt, refinements);
+  if (stalled && sqrt(fabs(*error)) >= settings.eps) {
+    print_and_log(settings, " Mixed CG: \t\tstopped at the double precision residual floor %.3e, above eps %.3e\n",
+                  sqrt(fabs(*error)), settings.eps);
+  }
+  report_solver_iterations(settings, "Mixed CG", tt);
+}
+
+// Solves Ae = r in single precision, returning the number of iterations taken
+int mixed_cg_inner_solve_driver(Chunk *chunks, Settings &settings, int max_iters) {
+  double rro = 0.0;
+
+  CONCURRENT_CHUNKS_SUM(rro)
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_mixed_cg_init(&(chunks[cc]), settings, &rro);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  sum_over_ranks(settings, &rro);
+
+  const double target = rro * MIXED_CG_INNER_REDUCTION * MIXED_CG_INNER_REDUCTION;
+
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_P] = true;
+
+  int tt = 0;
+  while (tt < max_iters) {
+    halo_update_driver(chunks, settings, 1);
+
+    double pw = 0.0;
+
+    CONCURRENT_CHUNKS_SUM(pw)
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_mixed_cg_calc_w(&(chunks[cc]), settings, &pw);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+
+    sum_over_ranks(settings, &pw);
+
+    double alpha = rro / pw;
+    double rrn = 0.0;
+
+    CONCURRENT_CHUNKS_SUM(rrn)
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_mixed_cg_calc_ur(&(chunks[cc]), settings, alpha, &rrn);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+
+    sum_over_ranks(settings, &rrn);
+    ++tt;
+
+    if (rrn < target || sqrt(rrn) < settings.eps) break;
+
+    double beta = rrn / rro;
+
+    CONCURRENT_CHUNKS
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_mixed_cg_calc_p(&(chunks[cc]), settings, beta);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+
+    rro = rrn;
+  }
+
+  return tt;
+}
+
+// Adds the correction to u and recalculates the residual and its norm in double precision
+void mixed_cg_refine_driver(Chunk *chunks, Settings &settings, double *error) {
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_mixed_cg_correct(&(chunks[cc]), settings);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_U] = true;
+  halo_update_driver(chunks, settings, 1);
+
+  double norm = 0.0;
+
+  CONCURRENT_CHUNKS_SUM(norm)
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_calculate_residual(&(chunks[cc]), settings);
+      run_calculate_2norm(&(chunks[cc]), settings, chunks[cc].r, &norm);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  sum_over_ranks(settings, &norm);
+  *error = norm;
+}
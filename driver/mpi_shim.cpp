@@ -22,6 +22,18 @@ int MPI_Barrier(MPI_Comm) {
   // XXX no-op, correct for 1 rank only
   return MPI_SUCCESS;
 }
+int MPI_Gather(const void *, int, MPI_Datatype, void *, int, MPI_Datatype, int, MPI_Comm) {
+  // XXX no-op, correct for 1 rank only
+  return MPI_SUCCESS;
+}
+int MPI_Gatherv(const void *, int, MPI_Datatype, void *, const int *, const int *, MPI_Datatype, int, MPI_Comm) {
+  // XXX no-op, correct for 1 rank only
+  return MPI_SUCCESS;
+}
+int MPI_Scatterv(const void *, const int *, const int *, MPI_Datatype, void *, int, MPI_Datatype, int, MPI_Comm) {
+  // XXX no-op, correct for 1 rank only
+  return MPI_SUCCESS;
+}
 int MPI_Allgather(const void *, int, MPI_Datatype, void *, int, MPI_Datatype, MPI_Comm) {
   // XXX no-op, correct for 1 rank only
   return MPI_SUCCESS;
@@ -34,6 +46,14 @@ int MPI_Allreduce(const void *, void *, int, MPI_Datatype, MPI_Op, MPI_Comm) {
   // XXX no-op, correct for 1 rank only
   return MPI_SUCCESS;
 }
+int MPI_Iallreduce(const void *, void *, int, MPI_Datatype, MPI_Op, MPI_Comm, MPI_Request *) {
+  // XXX no-op, correct for 1 rank only
+  return MPI_SUCCESS;
+}
+int MPI_Wait(MPI_Request *, MPI_Status *) {
+  // XXX no-op, correct for 1 rank only
+  return MPI_SUCCESS;
+}
 int MPI_Waitall(int, MPI_Request[], MPI_Status[]) {
   // XXX no-op, correct for 1 rank only
   return MPI_SUCCESS;
@@ -49,5 +69,23 @@ int MPI_Irecv(void *, int, MPI_Datatype, int, int, MPI_Comm, MPI_Request *) {
   std::abort();
   return MPI_ERR_COMM;
 }
+int MPI_Send_init(const void *, int, MPI_Datatype, int, int, MPI_Comm, MPI_Request *) {
+  fprintf(stderr, "MPI disabled, stub: %s\n", __func__);
+  std::abort();
+  return MPI_ERR_COMM;
+}
+int MPI_Recv_init(void *, int, MPI_Datatype, int, int, MPI_Comm, MPI_Request *) {
+  fprintf(stderr, "MPI disabled, stub: %s\n", __func__);
+  std::abort();
+  return MPI_ERR_COMM;
+}
+int MPI_Startall(int, MPI_Request[]) {
+  // XXX no-op, correct for 1 rank only
+  return MPI_SUCCESS;
+}
+int MPI_Request_free(MPI_Request *) {
+  // XXX no-op, correct for 1 rank only
+  return MPI_SUCCESS;
+}
 
 #endif
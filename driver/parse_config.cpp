@@ -39,13 +39,32 @@ void read_config(Settings &settings, State **states) {
   print_to_log(settings, "\tgrid_y_cells = %d\n", settings.grid_y_cells);
   print_to_log(settings, "\tpresteps = %d\n", settings.presteps);
   print_to_log(settings, "\tppcg_inner_steps = %d\n", settings.ppcg_inner_steps);
+  print_to_log(settings, "\tppcg_steps_per_exchange = %d\n", settings.ppcg_steps_per_exchange);
+  print_to_log(settings, "\tpreconditioner = %d\n", static_cast<int>(settings.preconditioner));
   print_to_log(settings, "\teps_lim = %f\n", settings.eps_lim);
   print_to_log(settings, "\tmax_iters = %d\n", settings.max_iters);
   print_to_log(settings, "\teps = %f\n", settings.eps);
   print_to_log(settings, "\thalo_depth = %d\n", settings.halo_depth);
   print_to_log(settings, "\tcheck_result = %d\n", settings.check_result);
+  print_to_log(settings, "\toverlap_halo_exchange = %d\n", settings.overlap_halo_exchange);
+  print_to_log(settings, "\tsingle_phase_halo_exchange = %d\n", settings.single_phase_halo_exchange);
+  print_to_log(settings, "\tpersistent_halo_exchange = %d\n", settings.persistent_halo_exchange);
   print_to_log(settings, "\tcoefficient = %d\n", settings.coefficient);
   print_to_log(settings, "\tnum_chunks_per_rank = %d\n", settings.num_chunks_per_rank);
+  print_to_log(settings, "\ttile_chunks = %d\n", settings.tile_chunks);
+  print_to_log(settings, "\ttile_cache_kb = %d\n", settings.tile_cache_kb);
+  print_to_log(settings, "\ttemporal_block_steps = %d\n", settings.temporal_block_steps);
+  print_to_log(settings, "\ttemporal_block_size = %d\n", settings.temporal_block_size);
+  print_to_log(settings, "\tfield_alignment = %d\n", settings.field_alignment);
+  print_to_log(settings, "\tfield_stagger = %d\n", settings.field_stagger);
+  print_to_log(settings, "\thuge_pages = %d\n", settings.huge_pages);
+  print_to_log(settings, "\treport_page_placement = %d\n", settings.report_page_placement);
+  print_to_log(settings, "\tstored_diagonal = %d\n", settings.stored_diagonal);
+  print_to_log(settings, "\tfloat_coefficients = %d\n", settings.float_coefficients);
+  print_to_log(settings, "\tinterleaved_operator = %d\n", settings.interleaved_operator);
+  print_to_log(settings, "\tfloat_fields = %d\n", settings.float_fields);
+  print_to_log(settings, "\tindex_64bit = %d\n", settings.index_64bit);
+  print_to_log(settings, "\tsimd_kernels = %d\n", settings.simd_kernels);
   print_to_log(settings, "\tsummary_frequency = %d\n", settings.summary_frequency);
 
   for (int ss = 0; ss < settings.num_states; ++ss) {
@@ -85,10 +104,16 @@ void read_settings(FILE *tea_in, Settings &settings) {
     if (starts_get_int("summary_frequency", line, word, &settings.summary_frequency)) continue;
     if (starts_get_int("presteps", line, word, &settings.presteps)) continue;
     if (starts_get_int("ppcg_inner_steps", line, word, &settings.ppcg_inner_steps)) continue;
+    if (starts_get_int("ppcg_steps_per_exchange", line, word, &settings.ppcg_steps_per_exchange)) continue;
     if (starts_get_double("epslim", line, word, &settings.eps_lim)) continue;
     if (starts_get_int("max_iters", line, word, &settings.max_iters)) continue;
     if (starts_get_double("eps", line, word, &settings.eps)) continue;
     if (starts_get_int("num_chunks_per_rank", line, word, &settings.num_chunks_per_rank)) continue;
+    if (starts_get_int("tile_cache_kb", line, word, &settings.tile_cache_kb)) continue;
+    if (starts_get_int("temporal_block_steps", line, word, &settings.temporal_block_steps)) continue;
+    if (starts_get_int("temporal_block_size", line, word, &settings.temporal_block_size)) continue;
+    if (starts_get_int("field_alignment", line, word, &settings.field_alignment)) continue;
+    if (starts_get_int("field_stagger", line, word, &settings.field_stagger)) continue;
     if (starts_get_int("halo_depth", line, word, &settings.halo_depth)) continue;
 
     // Parse the switches
@@ -100,8 +125,75 @@ void read_settings(FILE *tea_in, Settings &settings) {
       settings.error_switch = true;
       continue;
     }
+    if (starts_with("overlap_halo_exchange", line)) {
+      settings.overlap_halo_exchange = true;
+      continue;
+    }
+    if (starts_with("single_phase_halo_exchange", line)) {
+      settings.single_phase_halo_exchange = true;
+      continue;
+    }
+    if (starts_with("persistent_halo_exchange", line)) {
+      settings.persistent_halo_exchange = true;
+      continue;
+    }
+    if (starts_with("tile_chunks", line)) {
+      settings.tile_chunks = true;
+      continue;
+    }
+    if (starts_with("stored_diagonal", line)) {
+      settings.stored_diagonal = true;
+      continue;
+    }
+    if (starts_with("float_coefficients", line)) {
+      settings.float_coefficients = true;
+      continue;
+    }
+    if (starts_with("interleaved_operator", line)) {
+      settings.interleaved_operator = true;
+      continue;
+    }
+    if (starts_with("float_fields", line)) {
+      settings.float_fields = true;
+      continue;
+    }
+    if (starts_with("index_64bit", line)) {
+      settings.index_64bit = true;
+      continue;
+    }
+    if (starts_with("simd_kernels", line)) {
+      settings.simd_kernels = true;
+      continue;
+    }
+    if (starts_with("transparent_huge_pages", line)) {
+      settings.huge_pages = HUGE_PAGES_TRANSPARENT;
+      continue;
+    }
+    if (starts_with("explicit_huge_pages", line)) {
+      settings.huge_pages = HUGE_PAGES_EXPLICIT;
+      continue;
+    }
+    if (starts_with("report_page_placement", line)) {
+      settings.report_page_placement = true;
+      continue;
+    }
     if (starts_with("preconditioner_on", line)) {
-      settings.preconditioner = true;
+      settings.preconditioner = Preconditioner::JAC_DIAG;
+      continue;
+    }
+    if (starts_with("tl_preconditioner_type", line)) {
+      read_value(line, "tl_preconditioner_type", word);
+      if (tealeaf_strmatch(word, "none")) {
+        settings.preconditioner = Preconditioner::NONE;
+      } else if (tealeaf_strmatch(word, "jac_diag")) {
+        settings.preconditioner = Preconditioner::JAC_DIAG;
+      } else if (tealeaf_strmatch(word, "jac_block")) {
+        settings.preconditioner = Preconditioner::JAC_BLOCK;
+      } else if (tealeaf_strmatch(word, "mg")) {
+        settings.preconditioner = Preconditioner::MULTIGRID;
+      } else {
+        die(__LINE__, __FILE__, "Unknown preconditioner type '%s'.\n", word);
+      }
       continue;
     }
     if (starts_with("use_fortran_kernels", line)) {
@@ -132,6 +224,31 @@ void read_settings(FILE *tea_in, Settings &settings) {
       strcpy(settings.solver_name, "PPCG");
       continue;
     }
+    if (starts_with("use_pipelined_cg", line)) {
+      settings.solver = Solver::PIPELINED_CG_SOLVER;
+      strcpy(settings.solver_name, "Pipelined CG");
+      continue;
+    }
+    if (starts_with("use_ghysels_cg", line)) {
+      settings.solver = Solver::GHYSELS_CG_SOLVER;
+      strcpy(settings.solver_name, "Ghysels CG");
+      continue;
+    }
+    if (starts_with("use_fused_cg", line)) {
+      settings.solver = Solver::FUSED_CG_SOLVER;
+      strcpy(settings.solver_name, "Fused CG");
+      continue;
+    }
+    if (starts_with("use_mixed_cg", line)) {
+      settings.solver = Solver::MIXED_CG_SOLVER;
+      strcpy(settings.solver_name, "Mixed CG");
+      continue;
+    }
+    if (starts_with("use_mg", line)) {
+      settings.solver = Solver::MG_SOLVER;
+      strcpy(settings.solver_name, "Multigrid");
+      continue;
+    }
     if (starts_with("coefficient_density", line)) {
       settings.coefficient = CONDUCTIVITY;
       continue;
@@ -142,6 +259,50 @@ void read_settings(FILE *tea_in, Settings &settings) {
     }
   }
 
+  // Each exchange can only supply as many inner steps as there are halo layers
+  if (settings.ppcg_steps_per_exchange < 1 || settings.ppcg_steps_per_exchange > settings.halo_depth) {
+    die(__LINE__, __FILE__, "ppcg_steps_per_exchange must be between 1 and halo_depth (%d).\n", settings.halo_depth);
+  }
+  if (settings.temporal_block_steps < 1 || settings.temporal_block_steps > settings.halo_depth) {
+    die(__LINE__, __FILE__, "temporal_block_steps must be between 1 and halo_depth (%d).\n", settings.halo_depth);
+  }
+
+  // The multigrid solver iterates with the V-cycles of the multigrid preconditioner
+  if (settings.solver == Solver::MG_SOLVER) {
+    if (settings.preconditioner != Preconditioner::NONE && settings.preconditioner != Preconditioner::MULTIGRID) {
+      die(__LINE__, __FILE__, "The multigrid solver only runs with the mg preconditioner type.\n");
+    }
+    settings.preconditioner = Preconditioner::MULTIGRID;
+  }
+
+  // The other solvers run recurrences or inner iterations that do not apply the preconditioner
+  if (settings.preconditioner != Preconditioner::NONE && settings.solver != Solver::MG_SOLVER) {
+    if (settings.solver != Solver::CG_SOLVER && settings.solver != Solver::PPCG_SOLVER) {
+      die(__LINE__, __FILE__, "The preconditioner is only implemented for the CG and PPCG solvers.\n");
+    }
+    if (settings.solver == Solver::PPCG_SOLVER && (settings.ppcg_steps_per_exchange > 1 || settings.overlap_halo_exchange)) {
+      die(__LINE__, __FILE__, "The preconditioned PPCG solver supports neither ppcg_steps_per_exchange > 1 nor overlap_halo_exchange.\n");
+    }
+  }
+
+  // Single precision fields are only implemented for the solvers and kernels that take the value type of the solve
+  if (settings.float_fields) {
+    if (settings.solver != Solver::CG_SOLVER && settings.solver != Solver::CHEBY_SOLVER && settings.solver != Solver::PPCG_SOLVER &&
+        settings.solver != Solver::JACOBI_SOLVER) {
+      die(__LINE__, __FILE__, "float_fields is only implemented for the CG, Chebyshev, PPCG and Jacobi solvers.\n");
+    }
+    if (settings.preconditioner != Preconditioner::NONE || settings.stored_diagonal || settings.float_coefficients ||
+        settings.interleaved_operator || settings.simd_kernels) {
+      die(__LINE__, __FILE__,
+          "float_fields cannot be combined with a preconditioner, stored_diagonal, float_coefficients, interleaved_operator or "
+          "simd_kernels.\n");
+    }
+    if (settings.overlap_halo_exchange || settings.temporal_block_steps > 1 || settings.ppcg_steps_per_exchange > 1) {
+      die(__LINE__, __FILE__,
+          "float_fields supports neither overlap_halo_exchange, temporal_block_steps > 1 nor ppcg_steps_per_exchange > 1.\n");
+    }
+  }
+
   // Set the cell widths now
   settings.dx = (settings.grid_x_max - settings.grid_x_min) / (double)settings.grid_x_cells;
   settings.dy = (settings.grid_y_max - settings.grid_y_min) / (double)settings.grid_y_cells;
@@ -0,0 +1,214 @@
+#include "drivers.h"
+#include "shared.h"
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The modelled cost of a kernel per inner cell of the grid with separate kx and ky, in words of the precision of the solve.
+// Stored diagonals, float coefficients, the interleaved layout and the preconditioners all move less or more than this,
+// and the density and energy that field_summary and finalise read stay in double precision under float_fields.
+struct KernelCost {
+  const char *name;
+  int doubles_per_cell;
+  int flops_per_cell;
+};
+
+// The 5-point matvec reads p, kx and ky and takes 13 flops, the halo reads of p are assumed to hit in cache
+static const KernelCost kernel_costs[] = {
+    {"run_cg_calc_w", 4, 15},             // w = Ap, pw += p.w
+    {"run_cg_calc_ur", 6, 6},             // u += alpha p, r -= alpha w, rrn += r.r
+    {"run_cg_calc_p", 3, 2},              // p = beta p + r
+    {"run_cheby_iterate", 11, 18},        // w = Au, r = u0 - w, p = alpha p + beta r, then u += p
+    {"run_ppcg_inner_iteration", 10, 18}, // r -= A sd, u += sd, then sd = alpha sd + beta r
+    {"run_jacobi_iterate", 7, 15},        // r = u, then u = (u0 + off-diagonal r) / diagonal with the error summed
+    {"run_calculate_residual", 5, 14},    // r = u0 - Au
+    {"run_calculate_2norm", 1, 2},        // norm += r.r
+    {"run_copy_u", 2, 0},                 // u0 = u
+    {"run_store_energy", 2, 0},           // energy = energy0
+    {"run_finalise", 3, 1},               // energy = u / density
+    {"run_field_summary", 4, 7},          // sums of volume, mass, mass.energy0 and mass.u
+};
+
+// Looks up the modelled cost per cell of a kernel, returns false when the kernel has none
+bool modelled_kernel_cost(const char *kernel, int *doubles_per_cell, int *flops_per_cell) {
+  for (const KernelCost &cost : kernel_costs) {
+    if (!tealeaf_strmatch(cost.name, kernel)) continue;
+    *doubles_per_cell = cost.doubles_per_cell;
+    *flops_per_cell = cost.flops_per_cell;
+    return true;
+  }
+  return false;
+}
+
+struct TimestepRecord {
+  int step;
+  double dt;
+  double seconds;
+  double error;
+  std::vector<std::pair<std::string, int>> solvers;
+};
+
+static std::vector<TimestepRecord> timesteps;
+static std::vector<std::pair<std::string, int>> pending_solvers;
+static double last_wallclock = 0.0;
+
+// Records the iterations a solver took in the current timestep
+void report_solver_iterations(Settings &, const char *solver, int iterations) { pending_solvers.emplace_back(solver, iterations); }
+
+// Closes the record of a timestep, wallclock is the time since the first timestep started
+void report_timestep(Settings &, int step, double dt, double wallclock, double error) {
+  timesteps.push_back(TimestepRecord{step, dt, wallclock - last_wallclock, error, std::move(pending_solvers)});
+  pending_solvers.clear();
+  last_wallclock = wallclock;
+}
+
+// The figures of one profiled kernel, bytes and flops are negative when the kernel has no modelled cost
+struct KernelRecord {
+  const char *name;
+  int calls;
+  double seconds;
+  double self_seconds;
+  double bytes;
+  double flops;
+  double bandwidth;
+  double gflops;
+  double peak_fraction;
+};
+
+static std::vector<KernelRecord> collect_kernels(Settings &settings) {
+  std::vector<KernelRecord> kernels;
+#ifdef ENABLE_PROFILING
+  Profile *profile = settings.kernel_profile;
+  profiler_merge(profile);
+
+  // Each chunk counts its own calls, so a call moves the cells of one chunk, scaled up to the whole grid over the ranks
+  const double cells = static_cast<double>(settings.grid_x_cells) * settings.grid_y_cells / settings.num_chunks_per_rank;
+  for (int ii = 0; ii < profile->profiler_entry_count; ++ii) {
+    const ProfileEntry &entry = profile->profiler_entries[ii];
+    KernelRecord kernel{entry.name, entry.calls, entry.time, entry.self_time, -1.0, -1.0, -1.0, -1.0, -1.0};
+    int doubles_per_cell, flops_per_cell;
+    if (modelled_kernel_cost(entry.name, &doubles_per_cell, &flops_per_cell)) {
+      kernel.bytes = cells * entry.calls * doubles_per_cell * SOLVE_WORD_BYTES(settings);
+      kernel.flops = cells * entry.calls * flops_per_cell;
+      if (entry.time > 0.0) {
+        kernel.bandwidth = kernel.bytes / entry.time * 1.0E-9;
+        kernel.gflops = kernel.flops / entry.time * 1.0E-9;
+        if (settings.stream_peak > 0.0) kernel.peak_fraction = kernel.bandwidth / settings.stream_peak;
+      }
+    }
+    kernels.push_back(kernel);
+  }
+#endif
+  return kernels;
+}
+
+// Prints a figure as a JSON number, or null when it is unknown
+static void print_json_value(FILE *report, const char *key, double value, bool last = false) {
+  if (value < 0.0) {
+    fprintf(report, "\"%s\": null%s", key, last ? "" : ", ");
+  } else {
+    fprintf(report, "\"%s\": %.9e%s", key, value, last ? "" : ", ");
+  }
+}
+
+// Prints a figure as a CSV field, left empty when it is unknown
+static void print_csv_value(FILE *report, double value, bool last = false) {
+  if (value >= 0.0) fprintf(report, "%.9e", value);
+  fprintf(report, last ? "\n" : ",");
+}
+
+static void write_json_report(Settings &settings, FILE *report, const std::vector<KernelRecord> &kernels) {
+  fprintf(report, "{\n");
+  fprintf(report, "  \"problem\": {\"x_cells\": %d, \"y_cells\": %d, \"end_step\": %d, ", settings.grid_x_cells, settings.grid_y_cells,
+          settings.end_step);
+  fprintf(report, "\"ranks\": %d, \"model\": \"%s\", \"solver\": \"%s\"},\n", settings.num_ranks, settings.model_name.c_str(),
+          settings.solver_name);
+  fprintf(report, "  ");
+  print_json_value(report, "stream_peak_gb_s", (settings.stream_peak > 0.0) ? settings.stream_peak : -1.0);
+  print_json_value(report, "stencil_peak_gb_s", (settings.stencil_peak > 0.0) ? settings.stencil_peak : -1.0, true);
+  fprintf(report, ",\n");
+
+  fprintf(report, "  \"timesteps\": [");
+  for (size_t ss = 0; ss < timesteps.size(); ++ss) {
+    const TimestepRecord &step = timesteps[ss];
+    fprintf(report, "%s\n    {\"step\": %d, \"dt\": %.9e, \"seconds\": %.9e, \"error\": %.9e, \"solvers\": [", ss ? "," : "", step.step,
+            step.dt, step.seconds, step.error);
+    for (size_t ii = 0; ii < step.solvers.size(); ++ii) {
+      fprintf(report, "%s{\"solver\": \"%s\", \"iterations\": %d}", ii ? ", " : "", step.solvers[ii].first.c_str(),
+              step.solvers[ii].second);
+    }
+    fprintf(report, "]}");
+  }
+  fprintf(report, "\n  ],\n");
+
+  fprintf(report, "  \"kernels\": [");
+  for (size_t kk = 0; kk < kernels.size(); ++kk) {
+    const KernelRecord &kernel = kernels[kk];
+    fprintf(report, "%s\n    {\"name\": \"%s\", \"calls\": %d, ", kk ? "," : "", kernel.name, kernel.calls);
+    print_json_value(report, "seconds", kernel.seconds);
+    print_json_value(report, "self_seconds", kernel.self_seconds);
+    print_json_value(report, "bytes", kernel.bytes);
+    print_json_value(report, "flops", kernel.flops);
+    print_json_value(report, "gb_s", kernel.bandwidth);
+    print_json_value(report, "gflop_s", kernel.gflops);
+    print_json_value(report, "peak_fraction", kernel.peak_fraction, true);
+    fprintf(report, "}");
+  }
+  fprintf(report, "\n  ]\n}\n");
+}
+
+// Every row carries all of the columns, a timestep row has one solver per row and a kernel row leaves the timestep columns empty
+static void write_csv_report(FILE *report, const std::vector<KernelRecord> &kernels) {
+  fprintf(report, "record,name,step,dt,error,iterations,calls,seconds,self_seconds,bytes,flops,gb_s,gflop_s,peak_fraction\n");
+  for (const TimestepRecord &step : timesteps) {
+    if (step.solvers.empty()) {
+      fprintf(report, "timestep,,%d,%.9e,%.9e,,,%.9e,,,,,,\n", step.step, step.dt, step.error, step.seconds);
+    }
+    for (const auto &solver : step.solvers) {
+      fprintf(report, "timestep,%s,%d,%.9e,%.9e,%d,,%.9e,,,,,,\n", solver.first.c_str(), step.step, step.dt, step.error, solver.second,
+              step.seconds);
+    }
+  }
+  for (const KernelRecord &kernel : kernels) {
+    fprintf(report, "kernel,%s,,,,,%d,", kernel.name, kernel.calls);
+    print_csv_value(report, kernel.seconds);
+    print_csv_value(report, kernel.self_seconds);
+    print_csv_value(report, kernel.bytes);
+    print_csv_value(report, kernel.flops);
+    print_csv_value(report, kernel.bandwidth);
+    print_csv_value(report, kernel.gflops);
+    print_csv_value(report, kernel.peak_fraction, true);
+  }
+}
+
+// Prints the master's kernel profile, with the share of the stream peak each modelled kernel reached when a peak is known
+void print_kernel_profile(Settings &settings) {
+#ifdef ENABLE_PROFILING
+  if (settings.stream_peak <= 0.0) {
+    PRINT_PROFILING_RESULTS(settings.kernel_profile);
+    return;
+  }
+  std::vector<double> peak_fractions;
+  for (const KernelRecord &kernel : collect_kernels(settings)) {
+    peak_fractions.push_back(kernel.peak_fraction);
+  }
+  profiler_print_full_profile(settings.kernel_profile, peak_fractions.data());
+#endif
+}
+
+// Writes the timesteps, the solver iterations and the master's kernel profile to settings.report_filename. The bytes and
+// flops of a kernel are its modelled cost over the whole grid, so the rates are those of all ranks together.
+void write_performance_report(Settings &settings) {
+  std::vector<KernelRecord> kernels = collect_kernels(settings);
+
+  FILE *report = fopen(settings.report_filename, "w");
+  if (!report) {
+    die(__LINE__, __FILE__, "Could not open performance report file %s\n", settings.report_filename);
+  }
+  switch (settings.report_format) {
+    case ReportFormat::JSON: write_json_report(settings, report, kernels); break;
+    case ReportFormat::CSV: write_csv_report(report, kernels); break;
+  }
+  fclose(report);
+}
@@ -0,0 +1,250 @@
+#include "chunk.h"
+#include "comms.h"
+#include "drivers.h"
+#include "kernel_interface.h"
+#include <cfloat>
+
+/*
+ *      Single reduction (Chronopoulos-Gear) CG
+ *
+ *      The recurrence s = Ap lets both dot products of an iteration be
+ *      computed in the same sweep as the matvec w = Ar, so each iteration
+ *      performs one fused allreduce and two sweeps over the mesh.
+ */
+
+// Performs a full solve with the pipelined CG solver kernels
+void pipelined_cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error) {
+  PROFILE_SCOPE(settings.kernel_profile, __func__);
+  int tt;
+  double alpha = 0.0;
+  double beta = 0.0;
+  double rro = 0.0;
+
+  // Perform CG initialisation
+  pipelined_cg_init_driver(chunks, settings, rx, ry, &rro, &alpha);
+
+  // Iterate till convergence
+  for (tt = 0; tt < settings.max_iters; ++tt) {
+    pipelined_cg_main_step_driver(chunks, settings, tt, &rro, &alpha, &beta, error);
+
+    if (sqrt(fabs(*error)) < settings.eps) break;
+  }
+
+  // The residual check at the end of the solve needs a consistent u
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_U] = true;
+  halo_update_driver(chunks, settings, 1);
+
+  print_and_log(settings, " Pipelined CG: \t\t%d iterations\n", tt);
+  report_solver_iterations(settings, "Pipelined CG", tt);
+}
+
+// Invokes the pipelined CG initialisation kernels
+void pipelined_cg_init_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *rro, double *alpha) {
+  cg_init_driver(chunks, settings, rx, ry, rro);
+
+  // Only the residual is exchanged from here on
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_R] = true;
+  halo_update_driver(chunks, settings, 1);
+
+  double dots[2] = {0.0, 0.0};
+
+  CONCURRENT_CHUNKS_SUM(dots[:2])
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_pipelined_cg_calc_w(&(chunks[cc]), settings, &dots[0], &dots[1]);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  sum_over_ranks(settings, dots, 2);
+
+  *rro = dots[0];
+  *alpha = dots[0] / dots[1];
+}
+
+// Invokes the main pipelined CG solve kernels
+void pipelined_cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, double *rro, double *alpha, double *beta, double *error) {
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    chunks[cc].cg_alphas[tt] = *alpha;
+    chunks[cc].cg_betas[tt] = *beta;
+
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_pipelined_cg_calc_ur(&(chunks[cc]), settings, *alpha, *beta);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  halo_update_driver(chunks, settings, 1);
+
+  // Both dot products travel in the same reduction
+  double dots[2] = {0.0, 0.0};
+
+  CONCURRENT_CHUNKS_SUM(dots[:2])
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_pipelined_cg_calc_w(&(chunks[cc]), settings, &dots[0], &dots[1]);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  sum_over_ranks(settings, dots, 2);
+
+  double rrn = dots[0];
+  double wr = dots[1];
+
+  *beta = rrn / *rro;
+  *alpha = rrn / (wr - *beta * rrn / *alpha);
+
+  *error = rrn;
+  *rro = rrn;
+}
+
+/*
+ *      Ghysels-Vanroose pipelined CG
+ *
+ *      The extra recurrences z = As and w = Ar carry the matvec one step ahead,
+ *      so the non-blocking reduction of an iteration's dot products can run
+ *      behind the halo exchange of w and the matvec q = Aw.
+ */
+
+// Iterations without a new minimum residual before the Ghysels CG recurrences are rebuilt
+#define GHYSELS_CG_STALL_ITERS 10
+
+// Performs a full solve with the Ghysels pipelined CG solver kernels
+void ghysels_cg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error) {
+  PROFILE_SCOPE(settings.kernel_profile, __func__);
+  int tt;
+  int stalled = 0;
+  bool restart = true;
+  double alpha = 0.0;
+  double rro = 0.0;
+  double min_error = DBL_MAX;
+  double dots[2] = {0.0, 0.0};
+
+  // Perform CG initialisation
+  ghysels_cg_init_driver(chunks, settings, rx, ry, dots);
+
+  // Iterate till convergence, the residual seen by each step lags by one iteration
+  for (tt = 0; tt < settings.max_iters; ++tt) {
+    ghysels_cg_main_step_driver(chunks, settings, tt, restart, dots, &rro, &alpha, error);
+    restart = false;
+
+    if (sqrt(fabs(*error)) < settings.eps) break;
+
+    // In finite precision the recurrences drift away from the true residual,
+    // which stalls convergence, so restart from the true residual when that happens
+    if (*error < min_error) {
+      min_error = *error;
+      stalled = 0;
+    } else if (++stalled == GHYSELS_CG_STALL_ITERS) {
+      ghysels_cg_restart_driver(chunks, settings, dots);
+      restart = true;
+      stalled = 0;
+    }
+  }
+
+  // The residual check at the end of the solve needs a consistent u
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_U] = true;
+  halo_update_driver(chunks, settings, 1);
+
+  print_and_log(settings, " Ghysels CG: \t\t%d iterations\n", tt);
+  report_solver_iterations(settings, "Ghysels CG", tt);
+}
+
+// Calculates w = Ar and the local dot products that start the Ghysels CG recurrences
+static void ghysels_cg_start_recurrences(Chunk *chunks, Settings &settings, double *dots) {
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_R] = true;
+  halo_update_driver(chunks, settings, 1);
+
+  dots[0] = 0.0;
+  dots[1] = 0.0;
+
+  CONCURRENT_CHUNKS_SUM(dots[:2])
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_pipelined_cg_calc_w(&(chunks[cc]), settings, &dots[0], &dots[1]);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  // Only w is exchanged from here on
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_W] = true;
+}
+
+// Invokes the Ghysels CG initialisation kernels, leaving the local dot products of the initial residual in dots
+void ghysels_cg_init_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *dots) {
+  double rro;
+  cg_init_driver(chunks, settings, rx, ry, &rro);
+  ghysels_cg_start_recurrences(chunks, settings, dots);
+}
+
+// Recalculates the true residual r = u0 - Au and restarts the Ghysels CG recurrences from it
+void ghysels_cg_restart_driver(Chunk *chunks, Settings &settings, double *dots) {
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_U] = true;
+  halo_update_driver(chunks, settings, 1);
+
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_calculate_residual(&(chunks[cc]), settings);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  ghysels_cg_start_recurrences(chunks, settings, dots);
+}
+
+// Invokes the main Ghysels CG solve kernels, a restarted step discards the previous search directions
+void ghysels_cg_main_step_driver(Chunk *chunks, Settings &settings, int tt, bool restart, double *dots, double *rro, double *alpha,
+                                 double *error) {
+  MPI_Request request;
+  sum_over_ranks_start(settings, dots, 2, &request);
+
+  // The reduction is in flight while w is exchanged and q = Aw is computed
+  halo_update_driver(chunks, settings, 1);
+
+  CONCURRENT_CHUNKS
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_ghysels_cg_calc_q(&(chunks[cc]), settings);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  sum_over_ranks_wait(settings, &request);
+
+  double rrn = dots[0];
+  double wr = dots[1];
+  double beta = 0.0;
+
+  if (restart) {
+    *alpha = rrn / wr;
+  } else {
+    beta = rrn / *rro;
+    *alpha = rrn / (wr - beta * rrn / *alpha);
+  }
+
+  dots[0] = 0.0;
+  dots[1] = 0.0;
+
+  CONCURRENT_CHUNKS_SUM(dots[:2])
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    chunks[cc].cg_alphas[tt] = *alpha;
+    chunks[cc].cg_betas[tt] = beta;
+
+    if (settings.kernel_language == Kernel_Language::C) {
+      run_ghysels_cg_calc_urw(&(chunks[cc]), settings, *alpha, beta, &dots[0], &dots[1]);
+    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+    }
+  }
+
+  *error = rrn;
+  *rro = rrn;
+}
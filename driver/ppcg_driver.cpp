@@ -2,11 +2,15 @@
 #include "comms.h"
 #include "drivers.h"
 #include "kernel_interface.h"
+#include <algorithm>
 
 void ppcg_inner_iterations(Chunk *chunks, Settings &settings);
+void ppcg_ca_inner_iterations(Chunk *chunks, Settings &settings);
+void ppcg_overlap_inner_iterations(Chunk *chunks, Settings &settings);
 
 // Performs a full solve with the PPCG solver
 void ppcg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double *error) {
+  PROFILE_SCOPE(settings.kernel_profile, __func__);
   int tt;
   double rro = 0.0;
   int num_ppcg_iters = 0;
@@ -31,6 +35,9 @@ void ppcg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double
 
       // If first step perform initialisation
       if (num_ppcg_iters == 1) {
+        // The initialisation reads the halo of u, which the overlapped CG steps leave stale
+        if (settings.overlap_halo_exchange) halo_update_driver(chunks, settings, 1);
+
         // Initialise the eigenvalues and Chebyshev coefficients
         eigenvalue_driver_initialise(chunks, settings, tt);
         cheby_coef_driver(chunks, settings, settings.ppcg_inner_steps);
@@ -41,13 +48,18 @@ void ppcg_driver(Chunk *chunks, Settings &settings, double rx, double ry, double
       ppcg_main_step_driver(chunks, settings, &rro, error);
     }
 
-    halo_update_driver(chunks, settings, 1);
+    if (!settings.overlap_halo_exchange) halo_update_driver(chunks, settings, 1);
 
     if (fabs(*error) < settings.eps) break;
   }
 
+  // The overlapped steps exchange their halos up front, so the fields are left stale on exit
+  if (settings.overlap_halo_exchange) halo_update_driver(chunks, settings, 1);
+
   print_and_log(settings, " CG: \t\t\t%d iterations\n", tt - num_ppcg_iters + 1);
   print_and_log(settings, " PPCG: \t\t\t%d iterations (%d inner iterations per)\n", num_ppcg_iters, settings.ppcg_inner_steps);
+  report_solver_iterations(settings, "CG", tt - num_ppcg_iters + 1);
+  report_solver_iterations(settings, "PPCG", num_ppcg_iters);
 }
 
 // Invokes the PPCG initialisation kernels
@@ -69,19 +81,14 @@ void ppcg_init_driver(Chunk *chunks, Settings &settings, double *rro) {
 // Invokes the main PPCG solver kernels
 void ppcg_main_step_driver(Chunk *chunks, Settings &settings, double *rro, double *error) {
   double pw = 0.0;
-
-  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
-    if (settings.kernel_language == Kernel_Language::C) {
-      run_cg_calc_w(&(chunks[cc]), settings, &pw);
-    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
-    }
-  }
+  cg_calc_w_driver(chunks, settings, &pw);
 
   sum_over_ranks(settings, &pw);
 
   double alpha = *rro / pw;
   double rrn = 0.0;
 
+  CONCURRENT_CHUNKS_SUM(rrn)
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     if (settings.kernel_language == Kernel_Language::C) {
       run_cg_calc_ur(&(chunks[cc]), settings, alpha, &rrn);
@@ -89,13 +96,20 @@ void ppcg_main_step_driver(Chunk *chunks, Settings &settings, double *rro, doubl
     }
   }
 
+  if (settings.preconditioner == Preconditioner::MULTIGRID) multigrid_vcycle_driver(chunks, settings, &rrn);
+
   // Perform the inner iterations
   ppcg_inner_iterations(chunks, settings);
 
   rrn = 0.0;
+  CONCURRENT_CHUNKS_SUM(rrn)
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     if (settings.kernel_language == Kernel_Language::C) {
-      run_calculate_2norm(&(chunks[cc]), settings, chunks[cc].r, &rrn);
+      if (settings.preconditioner != Preconditioner::NONE) {
+        run_calculate_rz(&(chunks[cc]), settings, &rrn);
+      } else {
+        run_calculate_2norm(&(chunks[cc]), settings, chunks[cc].r, &rrn);
+      }
     }
   }
 
@@ -103,6 +117,7 @@ void ppcg_main_step_driver(Chunk *chunks, Settings &settings, double *rro, doubl
 
   double beta = rrn / *rro;
 
+  CONCURRENT_CHUNKS
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     if (settings.kernel_language == Kernel_Language::C) {
       run_cg_calc_p(&(chunks[cc]), settings, beta);
@@ -116,6 +131,7 @@ void ppcg_main_step_driver(Chunk *chunks, Settings &settings, double *rro, doubl
 
 // Performs the inner iterations of the PPCG solver
 void ppcg_inner_iterations(Chunk *chunks, Settings &settings) {
+  CONCURRENT_CHUNKS
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     if (settings.kernel_language == Kernel_Language::C) {
       run_ppcg_init(&(chunks[cc]), settings);
@@ -123,20 +139,96 @@ void ppcg_inner_iterations(Chunk *chunks, Settings &settings) {
     }
   }
 
+  if (settings.ppcg_steps_per_exchange > 1) {
+    ppcg_ca_inner_iterations(chunks, settings);
+  } else if (settings.overlap_halo_exchange) {
+    ppcg_overlap_inner_iterations(chunks, settings);
+  } else {
+    reset_fields_to_exchange(settings);
+    settings.fields_to_exchange[FIELD_SD] = true;
+
+    for (int pp = 0; pp < settings.ppcg_inner_steps; ++pp) {
+      halo_update_driver(chunks, settings, 1);
+
+      CONCURRENT_CHUNKS
+      for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+        if (settings.kernel_language == Kernel_Language::C) {
+          run_ppcg_inner_iteration(&(chunks[cc]), settings, chunks[cc].cheby_alphas[pp], chunks[cc].cheby_betas[pp]);
+        } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+        }
+      }
+
+      // The multigrid V-cycle spans every chunk, so the step finishes once it has run
+      if (settings.preconditioner == Preconditioner::MULTIGRID) {
+        double rz = 0.0;
+        multigrid_vcycle_driver(chunks, settings, &rz);
+
+        CONCURRENT_CHUNKS
+        for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+          if (settings.kernel_language == Kernel_Language::C) {
+            run_ppcg_calc_sd(&(chunks[cc]), settings, chunks[cc].cheby_alphas[pp], chunks[cc].cheby_betas[pp]);
+          } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+          }
+        }
+      }
+    }
+  }
+
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_P] = true;
+}
+
+// Performs the inner iterations with one deep halo exchange per ppcg_steps_per_exchange steps,
+// each step in between redundantly updates one ring less of the halo at internal faces.
+// A chunk runs all of the steps between exchanges back to back, so a cache sized tile stays resident.
+void ppcg_ca_inner_iterations(Chunk *chunks, Settings &settings) {
   reset_fields_to_exchange(settings);
   settings.fields_to_exchange[FIELD_SD] = true;
+  settings.fields_to_exchange[FIELD_R] = true;
+
+  for (int pp = 0; pp < settings.ppcg_inner_steps; pp += settings.ppcg_steps_per_exchange) {
+    int depth = std::min(settings.ppcg_steps_per_exchange, settings.ppcg_inner_steps - pp);
+    halo_update_driver(chunks, settings, depth);
+
+    CONCURRENT_CHUNKS
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      for (int ss = 0; ss < depth; ++ss) {
+        if (settings.kernel_language == Kernel_Language::C) {
+          run_ppcg_inner_iteration_ca(&(chunks[cc]), settings, depth - 1 - ss, chunks[cc].cheby_alphas[pp + ss],
+                                      chunks[cc].cheby_betas[pp + ss]);
+        } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+        }
+      }
+    }
+  }
+}
+
+// Performs the inner iterations with the update of each step's interior overlapping the exchange of sd
+void ppcg_overlap_inner_iterations(Chunk *chunks, Settings &settings) {
+  reset_fields_to_exchange(settings);
+  settings.fields_to_exchange[FIELD_SD] = true;
+
+  MPI_Request requests[settings.num_chunks_per_rank * NUM_NEIGHBOURS * 2];
 
   for (int pp = 0; pp < settings.ppcg_inner_steps; ++pp) {
-    halo_update_driver(chunks, settings, 1);
+    int num_messages = halo_update_start_driver(chunks, settings, 1, requests);
 
+    CONCURRENT_CHUNKS
     for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
       if (settings.kernel_language == Kernel_Language::C) {
-        run_ppcg_inner_iteration(&(chunks[cc]), settings, chunks[cc].cheby_alphas[pp], chunks[cc].cheby_betas[pp]);
+        run_ppcg_inner_iteration_interior(&(chunks[cc]), settings);
       } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
       }
     }
-  }
 
-  reset_fields_to_exchange(settings);
-  settings.fields_to_exchange[FIELD_P] = true;
+    halo_update_finish_driver(chunks, settings, 1, requests, num_messages);
+
+    CONCURRENT_CHUNKS
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      if (settings.kernel_language == Kernel_Language::C) {
+        run_ppcg_inner_iteration_boundary(&(chunks[cc]), settings, chunks[cc].cheby_alphas[pp], chunks[cc].cheby_betas[pp]);
+      } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
+      }
+    }
+  }
 }
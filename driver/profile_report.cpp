@@ -0,0 +1,131 @@
+#include "comms.h"
+#include "drivers.h"
+#include "shared.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// The values each rank sends for one of its regions
+#define RANK_PROFILE_VALUES 3
+
+// The spread of one region over the ranks, ranks that never entered the region count as zero time
+struct RankProfileRegion {
+  std::string name;
+  double calls;
+  double min;
+  double mean;
+  double max;
+  double stddev;
+  double self_mean;
+  int slowest_rank;
+  double imbalance;
+};
+
+// Matches the regions of every rank by name, in the order the master and then the other ranks first used them
+static std::vector<RankProfileRegion> collect_rank_regions(int num_ranks, int max_entries, const char *names, const double *values) {
+  std::vector<RankProfileRegion> regions;
+  std::vector<std::vector<double>> times;
+  std::vector<double> self_times;
+
+  for (int rr = 0; rr < num_ranks; ++rr) {
+    for (int ii = 0; ii < max_entries; ++ii) {
+      const char *name = names + (rr * max_entries + ii) * PROFILER_MAX_NAME;
+      const double *value = values + (rr * max_entries + ii) * RANK_PROFILE_VALUES;
+      if (name[0] == '\0') break;
+
+      size_t region = 0;
+      while (region < regions.size() && regions[region].name != name) ++region;
+      if (region == regions.size()) {
+        regions.push_back(RankProfileRegion{name, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0, 0.0});
+        times.emplace_back(num_ranks, 0.0);
+        self_times.push_back(0.0);
+      }
+      regions[region].calls += value[0];
+      times[region][rr] = value[1];
+      self_times[region] += value[2];
+    }
+  }
+
+  for (size_t region = 0; region < regions.size(); ++region) {
+    RankProfileRegion &stats = regions[region];
+    stats.min = times[region][0];
+    for (int rr = 0; rr < num_ranks; ++rr) {
+      const double time = times[region][rr];
+      stats.mean += time;
+      stats.min = tealeaf_MIN(stats.min, time);
+      if (time > stats.max) {
+        stats.max = time;
+        stats.slowest_rank = rr;
+      }
+    }
+    stats.mean /= num_ranks;
+    stats.calls /= num_ranks;
+    stats.self_mean = self_times[region] / num_ranks;
+
+    for (int rr = 0; rr < num_ranks; ++rr) {
+      const double deviation = times[region][rr] - stats.mean;
+      stats.stddev += deviation * deviation;
+    }
+    stats.stddev = std::sqrt(stats.stddev / num_ranks);
+
+    // The share of the slowest rank's time that the other ranks spend waiting for it on average
+    stats.imbalance = (stats.max > 0.0) ? 100.0 * (stats.max - stats.mean) / stats.max : 0.0;
+  }
+  return regions;
+}
+
+// Gathers the kernel profile of every rank onto the master, which prints the spread of each region over the ranks and
+// writes it to settings.rank_profile_filename when one was given. Must be called by every rank.
+void rank_profile_report(Settings &settings) {
+  Profile *profile = settings.kernel_profile;
+  profiler_merge(profile);
+
+  // Each rank sends the same number of regions, padded with empty names
+  int max_entries = profile->profiler_entry_count;
+  max_over_ranks(settings, &max_entries);
+  if (max_entries == 0) return;
+
+  std::vector<char> names(max_entries * PROFILER_MAX_NAME, '\0');
+  std::vector<double> values(max_entries * RANK_PROFILE_VALUES, 0.0);
+  for (int ii = 0; ii < profile->profiler_entry_count; ++ii) {
+    const ProfileEntry &entry = profile->profiler_entries[ii];
+    std::strncpy(names.data() + ii * PROFILER_MAX_NAME, entry.name, PROFILER_MAX_NAME - 1);
+    values[ii * RANK_PROFILE_VALUES + 0] = entry.calls;
+    values[ii * RANK_PROFILE_VALUES + 1] = entry.time;
+    values[ii * RANK_PROFILE_VALUES + 2] = entry.self_time;
+  }
+
+  const bool is_master = settings.rank == MASTER;
+  std::vector<char> all_names(is_master ? names.size() * settings.num_ranks : 0);
+  std::vector<double> all_values(is_master ? values.size() * settings.num_ranks : 0);
+  gather_to_master(settings, names.data(), static_cast<int>(names.size()), all_names.data());
+  gather_to_master(settings, values.data(), static_cast<int>(values.size()), all_values.data());
+  if (!is_master) return;
+
+  std::vector<RankProfileRegion> regions = collect_rank_regions(settings.num_ranks, max_entries, all_names.data(), all_values.data());
+
+  if (settings.num_ranks > 1) {
+    printf(" Rank Profile (inclusive time over %d ranks):\n\n", settings.num_ranks);
+    printf(" %-30s%12s%12s%12s%12s%10s%12s\n", "Kernel Name", "Min (s)", "Mean (s)", "Max (s)", "Std Dev (s)", "Slowest", "Imbalance");
+    for (const RankProfileRegion &stats : regions) {
+      printf(" %-30s%12.03F%12.03F%12.03F%12.03F%10d%11.01F%%\n", stats.name.c_str(), stats.min, stats.mean, stats.max, stats.stddev,
+             stats.slowest_rank, stats.imbalance);
+    }
+    printf("\n -------------------------------------------------------------\n\n");
+  }
+
+  if (settings.rank_profile_filename == nullptr) return;
+
+  FILE *report = fopen(settings.rank_profile_filename, "w");
+  if (!report) {
+    die(__LINE__, __FILE__, "Could not open rank profile file %s\n", settings.rank_profile_filename);
+  }
+  fprintf(report, "region,ranks,calls_mean,min_s,mean_s,max_s,stddev_s,self_mean_s,slowest_rank,imbalance_pct\n");
+  for (const RankProfileRegion &stats : regions) {
+    fprintf(report, "%s,%d,%.1f,%.9e,%.9e,%.9e,%.9e,%.9e,%d,%.3f\n", stats.name.c_str(), settings.num_ranks, stats.calls, stats.min,
+            stats.mean, stats.max, stats.stddev, stats.self_mean, stats.slowest_rank, stats.imbalance);
+  }
+  fclose(report);
+}
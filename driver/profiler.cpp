@@ -1,91 +1,210 @@
 #include "profiler.h"
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#ifdef __APPLE__
+  #include <mach/mach.h>
+  #include <mach/mach_time.h>
+#else
+  #include <ctime>
+#endif
+#if defined(PROFILER_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+  #include <x86intrin.h>
+  #define PROFILER_USE_TSC
+#endif
 
 #define tealeaf_strmatch(a, b) (strcmp(a, b) == 0)
+#define tealeaf_MIN(a, b) ((a < b) ? a : b)
+
+// The region names are shared by every profile
+static char region_names[PROFILER_MAX_ENTRIES][PROFILER_MAX_NAME];
+static std::atomic<int> region_count{0};
+static std::mutex region_mutex;
+
+// Threads are numbered in the order they first start a timer
+static std::atomic<int> thread_count{0};
+static thread_local int thread_id = -1;
+
+static double seconds_per_tick = 1.0E-9;
+
+// Reads the clock selected at compile time
+static inline uint64_t profiler_ticks() {
+#if defined(PROFILER_USE_TSC)
+  return __rdtsc();
+#elif defined(__APPLE__)
+  return mach_absolute_time();
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+#endif
+}
+
+// Works out the length of a tick of the selected clock, the time stamp counter is timed against CLOCK_MONOTONIC
+static void calibrate_ticks() {
+#if defined(PROFILER_USE_TSC)
+  struct timespec begin, now;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  const uint64_t tsc_begin = __rdtsc();
+  double elapsed = 0.0;
+  do {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (now.tv_sec - begin.tv_sec) + (now.tv_nsec - begin.tv_nsec) * 1.0E-9;
+  } while (elapsed < 0.01);
+  seconds_per_tick = elapsed / static_cast<double>(__rdtsc() - tsc_begin);
+#elif defined(__APPLE__)
+  mach_timebase_info_data_t timebase;
+  mach_timebase_info(&timebase);
+  seconds_per_tick = 1.0E-9 * timebase.numer / timebase.denom;
+#endif
+}
 
 struct Profile *profiler_initialise() {
+  static std::once_flag calibrated;
+  std::call_once(calibrated, calibrate_ticks);
+
   auto *profile = static_cast<Profile *>(std::malloc(sizeof(Profile)));
   std::memset(profile, 0, sizeof(Profile));
   return profile;
 }
 
 void profiler_finalise(Profile **profile) {
+  for (int tt = 0; tt < PROFILER_MAX_THREADS; ++tt) {
+    std::free((*profile)->threads[tt].counters);
+  }
   std::free(*profile);
   *profile = nullptr;
 }
 
-// Internally start the profiling timer
-void profiler_start_timer(Profile *profile) {
-#ifdef __APPLE__
-  profile->profiler_start = mach_absolute_time();
-#else
-  clock_gettime(CLOCK_MONOTONIC, &profile->profiler_start);
-#endif
-}
-
-// Internally end the profiling timer and store results
-void profiler_end_timer(Profile *profile, const char *entry_name) {
-#ifdef __APPLE__
-  profile->profiler_end = mach_absolute_time();
-#else
-  clock_gettime(CLOCK_MONOTONIC, &profile->profiler_end);
-#endif
+// Returns the index of a region, adding it on its first use
+int profiler_region(const char *entry_name) {
+  std::lock_guard<std::mutex> lock(region_mutex);
 
-  // Check if an entry exists
-  int ii;
-  for (ii = 0; ii < profile->profiler_entry_count; ++ii) {
-    if (tealeaf_strmatch(profile->profiler_entries[ii].name, entry_name)) {
-      break;
+  const int count = region_count.load();
+  for (int ii = 0; ii < count; ++ii) {
+    if (tealeaf_strmatch(region_names[ii], entry_name)) {
+      return ii;
     }
   }
 
   // Don't overrun
-  if (ii >= PROFILER_MAX_ENTRIES) {
+  if (count >= PROFILER_MAX_ENTRIES) {
     printf("Attempted to profile too many entries, maximum is %d\n", PROFILER_MAX_ENTRIES);
     exit(1);
   }
 
-  // Create new entry
-  if (ii == profile->profiler_entry_count) {
-    profile->profiler_entry_count++;
-    strcpy(profile->profiler_entries[ii].name, entry_name);
-    profile->profiler_entries[ii].time = 0;
-    profile->profiler_entries[ii].calls = 0;
+  strncpy(region_names[count], entry_name, PROFILER_MAX_NAME - 1);
+  region_count.store(count + 1);
+  return count;
+}
+
+// Gets the buffer of the calling thread, threads past PROFILER_MAX_THREADS are not timed
+static inline ProfileThread *profiler_thread(Profile *profile) {
+  if (thread_id < 0) thread_id = thread_count++;
+  if (thread_id >= PROFILER_MAX_THREADS) return nullptr;
+  return &profile->threads[thread_id];
+}
+
+// Internally start the profiling timer
+void profiler_start_timer(Profile *profile) {
+  ProfileThread *thread = profiler_thread(profile);
+  if (thread == nullptr) return;
+
+  if (thread->depth >= PROFILER_MAX_DEPTH) {
+    printf("Attempted to nest too many profiled regions, maximum is %d\n", PROFILER_MAX_DEPTH);
+    exit(1);
   }
+  thread->children[thread->depth] = 0;
+  thread->start[thread->depth++] = profiler_ticks();
+}
 
-  // Update number of calls and time
-#ifdef __APPLE__
-  double elapsed = (profile->profiler_end - profile->profiler_start) * 1.0E-9;
-#else
-  double elapsed = (profile->profiler_end.tv_sec - profile->profiler_start.tv_sec) +
-                   (profile->profiler_end.tv_nsec - profile->profiler_start.tv_nsec) * 1.0E-9;
-#endif
+// Internally end the innermost timer of the thread and add it to a region
+void profiler_end_region(Profile *profile, int region) {
+  const uint64_t end = profiler_ticks();
+  ProfileThread *thread = profiler_thread(profile);
+  if (thread == nullptr || thread->depth == 0) return;
 
-  profile->profiler_entries[ii].time += elapsed;
-  profile->profiler_entries[ii].calls++;
+  if (thread->counters == nullptr) {
+    thread->counters = static_cast<ProfileCounter *>(std::calloc(PROFILER_MAX_ENTRIES, sizeof(ProfileCounter)));
+  }
+
+  const int depth = --thread->depth;
+  const uint64_t elapsed = end - thread->start[depth];
+  ProfileCounter &counter = thread->counters[region];
+  counter.calls++;
+  counter.ticks += elapsed;
+  counter.self_ticks += elapsed - thread->children[depth];
+  if (depth > 0) {
+    thread->children[depth - 1] += elapsed;
+  }
+}
+
+// Internally end the profiling timer of a region given by name, the name is looked up on every call
+void profiler_end_timer(Profile *profile, const char *entry_name) { profiler_end_region(profile, profiler_region(entry_name)); }
+
+// Sums the counters of every thread into the entries of the profile, in the order the regions were first used
+void profiler_merge(Profile *profile) {
+  profile->profiler_entry_count = 0;
+  const int count = region_count.load();
+  const int threads = tealeaf_MIN(thread_count.load(), PROFILER_MAX_THREADS);
+  for (int ii = 0; ii < count; ++ii) {
+    ProfileCounter total = {};
+    for (int tt = 0; tt < threads; ++tt) {
+      if (profile->threads[tt].counters == nullptr) continue;
+      total.calls += profile->threads[tt].counters[ii].calls;
+      total.ticks += profile->threads[tt].counters[ii].ticks;
+      total.self_ticks += profile->threads[tt].counters[ii].self_ticks;
+    }
+    if (total.calls == 0) continue;
+
+    ProfileEntry &entry = profile->profiler_entries[profile->profiler_entry_count++];
+    strcpy(entry.name, region_names[ii]);
+    entry.calls = static_cast<int>(total.calls);
+    entry.time = total.ticks * seconds_per_tick;
+    entry.self_time = total.self_ticks * seconds_per_tick;
+  }
 }
 
-// Print the profiling results to output
-void profiler_print_full_profile(Profile *profile) {
+// Print the profiling results to output, peak_fractions holds a fraction of the peak bandwidth for each merged entry, negative
+// where the entry has none, or is null to leave the column out
+void profiler_print_full_profile(Profile *profile, const double *peak_fractions) {
+  profiler_merge(profile);
+
   printf("\n -------------------------------------------------------------\n");
   printf("\n Profiling Results:\n\n");
-  printf(" %-30s%8s%20s\n", "Kernel Name", "Calls", "Runtime (s)");
+  printf(" %-30s%8s%20s%20s", "Kernel Name", "Calls", "Runtime (s)", "Self (s)");
+  if (peak_fractions) {
+    printf("%10s", "% Peak");
+  }
+  printf("\n");
 
   double total_elapsed_time = 0.0;
   for (int ii = 0; ii < profile->profiler_entry_count; ++ii) {
-    total_elapsed_time += profile->profiler_entries[ii].time;
-    printf(" %-30s%8d%20.03F\n", profile->profiler_entries[ii].name, profile->profiler_entries[ii].calls,
-           profile->profiler_entries[ii].time);
+    total_elapsed_time += profile->profiler_entries[ii].self_time;
+    printf(" %-30s%8d%20.03F%20.03F", profile->profiler_entries[ii].name, profile->profiler_entries[ii].calls,
+           profile->profiler_entries[ii].time, profile->profiler_entries[ii].self_time);
+    if (!peak_fractions) {
+      printf("\n");
+    } else if (peak_fractions[ii] < 0.0) {
+      printf("%10s\n", "-");
+    } else {
+      printf("%10.1f\n", 100.0 * peak_fractions[ii]);
+    }
   }
 
-  printf("\n Total elapsed time: %.03Fs, entries * are excluded.\n", total_elapsed_time);
+  printf("\n Total elapsed time: %.03Fs, the sum of the self times over every thread.\n", total_elapsed_time);
+  if (peak_fractions) {
+    printf(" %% Peak is the modelled bandwidth of a kernel over the stream peak.\n");
+  }
   printf("\n -------------------------------------------------------------\n\n");
 }
 
 // Prints profile without extra details
 void profiler_print_simple_profile(Profile *profile) {
+  profiler_merge(profile);
+
   for (int ii = 0; ii < profile->profiler_entry_count; ++ii) {
     printf("\033[1m\033[30m%s\033[0m: %.3lfs (%d calls)\n", profile->profiler_entries[ii].name, profile->profiler_entries[ii].time,
            profile->profiler_entries[ii].calls);
@@ -94,6 +213,8 @@ void profiler_print_simple_profile(Profile *profile) {
 
 // Gets an individual profile entry
 int profiler_get_profile_entry(Profile *profile, const char *entry_name) {
+  profiler_merge(profile);
+
   for (int ii = 0; ii < profile->profiler_entry_count; ++ii) {
     if (tealeaf_strmatch(profile->profiler_entries[ii].name, entry_name)) {
       return ii;
@@ -1,39 +1,47 @@
 #pragma once
 
-#ifdef __APPLE__
-  #include <mach/mach.h>
-  #include <mach/mach_time.h>
-#else
-  #include <ctime>
-#endif
+#include <cstdint>
 
 /*
  *		PROFILING TOOL
- *		Not thread safe.
+ *		Each call site interns its region name once, the timers nest and every thread times into its own buffer.
  */
 
 #define PROFILER_MAX_NAME 128
 #define PROFILER_MAX_ENTRIES 2048
+#define PROFILER_MAX_DEPTH 64
+#define PROFILER_MAX_THREADS 256
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// The merged counters of a region, time includes the nested regions and self_time excludes them
 struct ProfileEntry {
   int calls;
   double time;
+  double self_time;
   char name[PROFILER_MAX_NAME];
 };
 
+struct ProfileCounter {
+  int64_t calls;
+  uint64_t ticks;
+  uint64_t self_ticks;
+};
+
+// The open timers of a thread and its counters, indexed by region
+struct ProfileThread {
+  int depth;
+  uint64_t start[PROFILER_MAX_DEPTH];
+  uint64_t children[PROFILER_MAX_DEPTH];
+  ProfileCounter *counters;
+};
+
 struct Profile {
-#ifdef __APPLE__
-  uint64_t profiler_start;
-  uint64_t profiler_end;
-#else
-  struct timespec profiler_start;
-  struct timespec profiler_end;
-#endif
+  ProfileThread threads[PROFILER_MAX_THREADS];
 
+  // Filled from the thread buffers when the profile is printed or queried
   int profiler_entry_count;
   ProfileEntry profiler_entries[PROFILER_MAX_ENTRIES];
 };
@@ -41,24 +49,47 @@ struct Profile {
 Profile *profiler_initialise();
 void profiler_finalise(Profile **profile);
 
+int profiler_region(const char *entry_name);
 void profiler_start_timer(Profile *profile);
+void profiler_end_region(Profile *profile, int region);
 void profiler_end_timer(Profile *profile, const char *entry_name);
+void profiler_merge(Profile *profile);
 void profiler_print_simple_profile(Profile *profile);
-void profiler_print_full_profile(Profile *profile);
+void profiler_print_full_profile(Profile *profile, const double *peak_fractions);
 int profiler_get_profile_entry(Profile *profile, const char *entry_name);
 
 #ifdef __cplusplus
 }
+
+// Times the enclosing scope as a region
+class ProfileScope {
+  Profile *profile;
+  int region;
+
+public:
+  ProfileScope(Profile *profile, int region) : profile(profile), region(region) { profiler_start_timer(profile); }
+  ~ProfileScope() { profiler_end_region(profile, region); }
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+};
 #endif
 
-// Allows compile-time optimised conditional profiling
+// Allows compile-time optimised conditional profiling, the region of a call site is interned on its first call
 #ifdef ENABLE_PROFILING
 
   #define START_PROFILING(profile) profiler_start_timer(profile)
 
-  #define STOP_PROFILING(profile, name) profiler_end_timer(profile, name)
+  #define STOP_PROFILING(profile, name)                            \
+    do {                                                           \
+      static const int profiler_region_id = profiler_region(name); \
+      profiler_end_region(profile, profiler_region_id);            \
+    } while (false)
+
+  #define PROFILE_SCOPE(profile, name)                              \
+    static const int profiler_scope_region = profiler_region(name); \
+    ProfileScope profiler_scope(profile, profiler_scope_region)
 
-  #define PRINT_PROFILING_RESULTS(profile) profiler_print_full_profile(profile)
+  #define PRINT_PROFILING_RESULTS(profile) profiler_print_full_profile(profile, nullptr)
 
 #else
 
@@ -68,6 +99,9 @@ int profiler_get_profile_entry(Profile *profile, const char *entry_name);
   #define STOP_PROFILING(profile, name) \
     do {                                \
     } while (false)
+  #define PROFILE_SCOPE(profile, name) \
+    do {                               \
+    } while (false)
   #define PRINT_PROFILING_RESULTS(profile) \
     do {                                   \
     } while (false)
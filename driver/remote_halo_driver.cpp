@@ -3,159 +3,205 @@
 #include "drivers.h"
 #include "kernel_interface.h"
 
-// Attempts to pack buffers
+// Attempts to pack buffers, all of the exchanged fields of a face are packed by one kernel
 int invoke_pack_or_unpack(Chunk *chunk, Settings &settings, int face, int depth, int offset, bool pack, FieldBufferType buffer) {
-  int buffer_len = 0;
+  FieldBufferType fields[NUM_FIELDS];
+  int num_fields = 0;
 
   for (int ii = 0; ii < NUM_FIELDS; ++ii) {
     if (!settings.fields_to_exchange[ii]) {
       continue;
     }
 
-    FieldBufferType field;
     switch (ii) {
-      case FIELD_DENSITY: field = chunk->density; break;
-      case FIELD_ENERGY0: field = chunk->energy0; break;
-      case FIELD_ENERGY1: field = chunk->energy; break;
-      case FIELD_U: field = chunk->u; break;
-      case FIELD_P: field = chunk->p; break;
-      case FIELD_SD: field = chunk->sd; break;
+      case FIELD_DENSITY: fields[num_fields++] = chunk->density; break;
+      case FIELD_ENERGY0: fields[num_fields++] = chunk->energy0; break;
+      case FIELD_ENERGY1: fields[num_fields++] = chunk->energy; break;
+      case FIELD_U: fields[num_fields++] = chunk->u; break;
+      case FIELD_P: fields[num_fields++] = chunk->p; break;
+      case FIELD_SD: fields[num_fields++] = chunk->sd; break;
+      case FIELD_R: fields[num_fields++] = chunk->r; break;
+      case FIELD_W: fields[num_fields++] = chunk->w; break;
       default: die(__LINE__, __FILE__, "Incorrect field provided: %d.\n", ii + 1);
     }
+  }
 
-    //    double *offset_buffer = buffer + buffer_len;
-    //    buffer_len += depth * offset;
-    //
-    //    if (settings.kernel_language == Kernel_Language::C) {
-    //      run_pack_or_unpack(chunk, settings, depth, face, pack, field, offset_buffer);
-    //    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
-    //    }
-
-    if (settings.kernel_language == Kernel_Language::C) {
-      run_pack_or_unpack(chunk, settings, depth, face, pack, field, buffer, buffer_len);
-    } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
-    }
-    buffer_len += depth * offset;
+  if (num_fields == 0) {
+    return 0;
+  }
+
+  if (settings.kernel_language == Kernel_Language::C) {
+    run_pack_or_unpack_fields(chunk, settings, depth, face, pack, fields, num_fields, buffer, depth * offset);
+  } else if (settings.kernel_language == Kernel_Language::FORTRAN) {
   }
 
-  return buffer_len;
+  return num_fields * depth * offset;
 }
 
-// Invokes the kernels that perform remote halo exchanges
-void remote_halo_driver(Chunk *chunks, Settings &settings, int depth) {
-#ifndef NO_MPI
-  // Two sends and two receives
-  int max_messages = settings.num_chunks_per_rank * 4;
-  MPI_Request requests[max_messages];
+// Returns the buffers a face or corner is exchanged through
+HaloBuffers halo_buffers(Chunk &chunk, int face) {
+  switch (face) {
+    case CHUNK_LEFT: return {chunk.left_send, chunk.left_recv, chunk.staging_left_send, chunk.staging_left_recv};
+    case CHUNK_RIGHT: return {chunk.right_send, chunk.right_recv, chunk.staging_right_send, chunk.staging_right_recv};
+    case CHUNK_BOTTOM: return {chunk.bottom_send, chunk.bottom_recv, chunk.staging_bottom_send, chunk.staging_bottom_recv};
+    case CHUNK_TOP: return {chunk.top_send, chunk.top_recv, chunk.staging_top_send, chunk.staging_top_recv};
+    case CHUNK_BOTTOM_LEFT:
+      return {chunk.bottom_left_send, chunk.bottom_left_recv, chunk.staging_bottom_left_send, chunk.staging_bottom_left_recv};
+    case CHUNK_BOTTOM_RIGHT:
+      return {chunk.bottom_right_send, chunk.bottom_right_recv, chunk.staging_bottom_right_send, chunk.staging_bottom_right_recv};
+    case CHUNK_TOP_LEFT: return {chunk.top_left_send, chunk.top_left_recv, chunk.staging_top_left_send, chunk.staging_top_left_recv};
+    case CHUNK_TOP_RIGHT: return {chunk.top_right_send, chunk.top_right_recv, chunk.staging_top_right_send, chunk.staging_top_right_recv};
+    default: die(__LINE__, __FILE__, "Incorrect face provided: %d.\n", face);
+  }
+  return {};
+}
 
-  int num_messages = 0;
+// The face or corner of the neighbour that faces this one
+int opposite_face(int face) {
+  switch (face) {
+    case CHUNK_LEFT: return CHUNK_RIGHT;
+    case CHUNK_RIGHT: return CHUNK_LEFT;
+    case CHUNK_BOTTOM: return CHUNK_TOP;
+    case CHUNK_TOP: return CHUNK_BOTTOM;
+    case CHUNK_BOTTOM_LEFT: return CHUNK_TOP_RIGHT;
+    case CHUNK_BOTTOM_RIGHT: return CHUNK_TOP_LEFT;
+    case CHUNK_TOP_LEFT: return CHUNK_BOTTOM_RIGHT;
+    case CHUNK_TOP_RIGHT: return CHUNK_BOTTOM_LEFT;
+    default: die(__LINE__, __FILE__, "Incorrect face provided: %d.\n", face);
+  }
+  return EXTERNAL_FACE;
+}
 
-  // TODO: THE TAGS NEED TO BE DIFFERENT BY CHUNK ??
+// The length of one field's strip in the buffers of a face or corner
+static int halo_offset(Chunk &chunk, int face, int depth) {
+  if (face == CHUNK_LEFT || face == CHUNK_RIGHT) return chunk.y;
+  if (face == CHUNK_BOTTOM || face == CHUNK_TOP) return chunk.x;
+  return depth;
+}
 
-  // Pack lr buffers and send messages
-  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
-    if (chunks[cc].neighbours[CHUNK_LEFT] != EXTERNAL_FACE) {
-      int buffer_len = invoke_pack_or_unpack(&(chunks[cc]), settings, CHUNK_LEFT, depth, chunks[cc].y, true, chunks[cc].left_send);
-      run_send_recv_halo(&chunks[cc], settings,                                      //
-                         chunks[cc].left_send, chunks[cc].left_recv,                 //
-                         chunks[cc].staging_left_send, chunks[cc].staging_left_recv, //
-                         buffer_len, chunks[cc].neighbours[CHUNK_LEFT], 0, 1,        //
-                         &(requests[num_messages]), &(requests[num_messages + 1]));
-
-      num_messages += 2;
-    }
+// Returns the index of the neighbour in this rank's chunks, or -1 if another rank owns it
+int local_neighbour(Chunk *chunks, Settings &settings, int cc, int face) {
+  int neighbour = chunks[cc].neighbours[face];
+  if (neighbour / settings.num_chunks_per_rank != settings.rank) return -1;
+  return neighbour % settings.num_chunks_per_rank;
+}
 
-    if (chunks[cc].neighbours[CHUNK_RIGHT] != EXTERNAL_FACE) {
-      int buffer_len = invoke_pack_or_unpack(&(chunks[cc]), settings, CHUNK_RIGHT, depth, chunks[cc].y, true, chunks[cc].right_send);
-      run_send_recv_halo(&chunks[cc], settings,                                        //
-                         chunks[cc].right_send, chunks[cc].right_recv,                 //
-                         chunks[cc].staging_right_send, chunks[cc].staging_right_recv, //
-                         buffer_len, chunks[cc].neighbours[CHUNK_RIGHT], 1, 0,         //
-                         &(requests[num_messages]), &(requests[num_messages + 1]));
+// Packs a face or corner and posts its messages, returning the number of requests posted.
+// A neighbour on the same rank reads straight from the send buffer instead, so no message is needed.
+static int start_halo(Chunk *chunks, Settings &settings, int cc, int face, int depth, MPI_Request *requests) {
+  Chunk &chunk = chunks[cc];
+  int neighbour = chunk.neighbours[face];
+  if (neighbour == EXTERNAL_FACE) return 0;
+
+  HaloBuffers buffers = halo_buffers(chunk, face);
+  int buffer_len = invoke_pack_or_unpack(&chunk, settings, face, depth, halo_offset(chunk, face, depth), true, buffers.send);
+  if (local_neighbour(chunks, settings, cc, face) >= 0) return 0;
+
+  // Each message is tagged with the direction it travels in and the chunk it is sent to,
+  // so that the messages between several chunks on a pair of ranks cannot be confused
+  int send_tag = face + NUM_NEIGHBOURS * (neighbour % settings.num_chunks_per_rank);
+  int recv_tag = opposite_face(face) + NUM_NEIGHBOURS * cc;
+  run_send_recv_halo(&chunk, settings,                                                                        //
+                     buffers.send, buffers.recv,                                                              //
+                     buffers.staging_send, buffers.staging_recv,                                              //
+                     buffer_len, neighbour / settings.num_chunks_per_rank, send_tag, recv_tag, &requests[0], //
+                     &requests[1]);
+  return 2;
+}
 
-      num_messages += 2;
-    }
-  }
+// Copies a received face or corner back from its staging buffer
+static void restore_halo(Chunk *chunks, Settings &settings, int cc, int face, int depth, int num_fields) {
+  Chunk &chunk = chunks[cc];
+  if (chunk.neighbours[face] == EXTERNAL_FACE || local_neighbour(chunks, settings, cc, face) >= 0) return;
 
+  HaloBuffers buffers = halo_buffers(chunk, face);
+  run_restore_recv_halo(&chunk, settings, buffers.recv, buffers.staging_recv, num_fields * depth * halo_offset(chunk, face, depth));
+}
+
+// Unpacks a face or corner, from the facing send buffer when the neighbour is on the same rank
+static void finish_halo(Chunk *chunks, Settings &settings, int cc, int face, int depth) {
+  Chunk &chunk = chunks[cc];
+  if (chunk.neighbours[face] == EXTERNAL_FACE) return;
+
+  int local = local_neighbour(chunks, settings, cc, face);
+  FieldBufferType buffer = local >= 0 ? halo_buffers(chunks[local], opposite_face(face)).send : halo_buffers(chunk, face).recv;
+  invoke_pack_or_unpack(&chunk, settings, face, depth, halo_offset(chunk, face, depth), false, buffer);
+}
+
+// Waits for the messages of the given faces and corners and unpacks them
+static void finish_halos(Chunk *chunks, Settings &settings, int depth, const int *faces, int num_faces, MPI_Request *requests,
+                         int num_messages) {
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
     run_before_waitall_halo(&chunks[cc], settings);
   }
   wait_for_requests(settings, num_messages, requests);
-  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
-    int buffer_len = 0;
-    for (int ii = 0; ii < NUM_FIELDS; ++ii) {
-      if (!settings.fields_to_exchange[ii]) continue;
-      buffer_len += depth * chunks[cc].y;
-    }
-    if (chunks[cc].neighbours[CHUNK_LEFT] != EXTERNAL_FACE)
-      run_restore_recv_halo(&chunks[cc], settings, chunks[cc].left_recv, chunks[cc].staging_left_recv, buffer_len);
-    if (chunks[cc].neighbours[CHUNK_RIGHT] != EXTERNAL_FACE)
-      run_restore_recv_halo(&chunks[cc], settings, chunks[cc].right_recv, chunks[cc].staging_right_recv, buffer_len);
+
+  int num_fields = 0;
+  for (int ii = 0; ii < NUM_FIELDS; ++ii) {
+    if (settings.fields_to_exchange[ii]) num_fields++;
   }
 
-  // Unpack lr buffers
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
-    if (chunks[cc].neighbours[CHUNK_LEFT] != EXTERNAL_FACE) {
-      invoke_pack_or_unpack(&(chunks[cc]), settings, CHUNK_LEFT, depth, chunks[cc].y, false, chunks[cc].left_recv);
-    }
-
-    if (chunks[cc].neighbours[CHUNK_RIGHT] != EXTERNAL_FACE) {
-      invoke_pack_or_unpack(&(chunks[cc]), settings, CHUNK_RIGHT, depth, chunks[cc].y, false, chunks[cc].right_recv);
+    for (int ff = 0; ff < num_faces; ++ff) {
+      restore_halo(chunks, settings, cc, faces[ff], depth, num_fields);
     }
   }
 
-  num_messages = 0;
-
-  // Pack tb buffers and send messages
   for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
-    if (chunks[cc].neighbours[CHUNK_BOTTOM] != EXTERNAL_FACE) {
-      int buffer_len = invoke_pack_or_unpack(&(chunks[cc]), settings, CHUNK_BOTTOM, depth, chunks[cc].x, true, chunks[cc].bottom_send);
-      run_send_recv_halo(&chunks[cc], settings,                                          //
-                         chunks[cc].bottom_send, chunks[cc].bottom_recv,                 //
-                         chunks[cc].staging_bottom_send, chunks[cc].staging_bottom_recv, //
-                         buffer_len, chunks[cc].neighbours[CHUNK_BOTTOM], 0, 1,          //
-                         &(requests[num_messages]), &(requests[num_messages + 1]));
-
-      num_messages += 2;
+    for (int ff = 0; ff < num_faces; ++ff) {
+      finish_halo(chunks, settings, cc, faces[ff], depth);
     }
+  }
+}
 
-    if (chunks[cc].neighbours[CHUNK_TOP] != EXTERNAL_FACE) {
-      int buffer_len = invoke_pack_or_unpack(&(chunks[cc]), settings, CHUNK_TOP, depth, chunks[cc].x, true, chunks[cc].top_send);
-      run_send_recv_halo(&chunks[cc], settings,                                    //
-                         chunks[cc].top_send, chunks[cc].top_recv,                 //
-                         chunks[cc].staging_top_send, chunks[cc].staging_top_recv, //
-                         buffer_len, chunks[cc].neighbours[CHUNK_TOP], 1, 0,       //
-                         &(requests[num_messages]), &(requests[num_messages + 1]));
+// The faces and corners in the order they are exchanged by a single phase update
+static const int all_halos[NUM_NEIGHBOURS] = {CHUNK_LEFT,        CHUNK_RIGHT,        CHUNK_BOTTOM,   CHUNK_TOP,
+                                              CHUNK_BOTTOM_LEFT, CHUNK_BOTTOM_RIGHT, CHUNK_TOP_LEFT, CHUNK_TOP_RIGHT};
 
-      num_messages += 2;
-    }
-  }
-  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
-    run_before_waitall_halo(&chunks[cc], settings);
+// Invokes the kernels that perform remote halo exchanges
+void remote_halo_driver(Chunk *chunks, Settings &settings, int depth) {
+  if (settings.single_phase_halo_exchange) {
+    MPI_Request requests[settings.num_chunks_per_rank * NUM_NEIGHBOURS * 2];
+    int num_messages = remote_halo_start_driver(chunks, settings, depth, requests);
+    remote_halo_finish_driver(chunks, settings, depth, requests, num_messages);
+    return;
   }
-  wait_for_requests(settings, num_messages, requests);
-  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
-    int buffer_len = 0;
-    for (int ii = 0; ii < NUM_FIELDS; ++ii) {
-      if (!settings.fields_to_exchange[ii]) continue;
-      buffer_len += depth * chunks[cc].x;
+
+  // Two sends and two receives
+  int max_messages = settings.num_chunks_per_rank * 4;
+  MPI_Request requests[max_messages];
+
+  // The lr exchange completes before the tb buffers are packed, so the tb strips carry the corners
+  const int lr_halos[2] = {CHUNK_LEFT, CHUNK_RIGHT};
+  const int tb_halos[2] = {CHUNK_BOTTOM, CHUNK_TOP};
+  for (const int *halos : {lr_halos, tb_halos}) {
+    int num_messages = 0;
+    for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+      for (int ff = 0; ff < 2; ++ff) {
+        num_messages += start_halo(chunks, settings, cc, halos[ff], depth, &requests[num_messages]);
+      }
     }
-    if (chunks[cc].neighbours[CHUNK_BOTTOM] != EXTERNAL_FACE)
-      run_restore_recv_halo(&chunks[cc], settings, chunks[cc].bottom_recv, chunks[cc].staging_bottom_recv, buffer_len);
-    if (chunks[cc].neighbours[CHUNK_TOP] != EXTERNAL_FACE)
-      run_restore_recv_halo(&chunks[cc], settings, chunks[cc].top_recv, chunks[cc].staging_top_recv, buffer_len);
+    finish_halos(chunks, settings, depth, halos, 2, requests, num_messages);
   }
+}
 
-  // Unpack tb buffers
-  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
-    if (chunks[cc].neighbours[CHUNK_BOTTOM] != EXTERNAL_FACE) {
-      invoke_pack_or_unpack(&(chunks[cc]), settings, CHUNK_BOTTOM, depth, chunks[cc].x, false, chunks[cc].bottom_recv);
-    }
+// Packs all four faces and posts their messages at once, returning the number of requests posted.
+// Deeper exchanges also send the corner blocks to the diagonal neighbours, which a depth of one never reads.
+int remote_halo_start_driver(Chunk *chunks, Settings &settings, int depth, MPI_Request *requests) {
+  int num_halos = depth > 1 ? NUM_NEIGHBOURS : NUM_FACES;
+  int num_messages = 0;
 
-    if (chunks[cc].neighbours[CHUNK_TOP] != EXTERNAL_FACE) {
-      invoke_pack_or_unpack(&(chunks[cc]), settings, CHUNK_TOP, depth, chunks[cc].x, false, chunks[cc].top_recv);
+  for (int cc = 0; cc < settings.num_chunks_per_rank; ++cc) {
+    for (int ff = 0; ff < num_halos; ++ff) {
+      num_messages += start_halo(chunks, settings, cc, all_halos[ff], depth, &requests[num_messages]);
     }
   }
 
-#endif
+  return num_messages;
+}
+
+// Waits for the messages posted by remote_halo_start_driver and unpacks the faces and corners
+void remote_halo_finish_driver(Chunk *chunks, Settings &settings, int depth, MPI_Request *requests, int num_messages) {
+  int num_halos = depth > 1 ? NUM_NEIGHBOURS : NUM_FACES;
+  finish_halos(chunks, settings, depth, all_halos, num_halos, requests, num_messages);
 }
@@ -36,9 +36,30 @@ void set_default_settings(Settings &settings) {
   settings.eps_lim = DEF_EPS_LIM;
   settings.check_result = DEF_CHECK_RESULT;
   settings.ppcg_inner_steps = DEF_PPCG_INNER_STEPS;
+  settings.ppcg_steps_per_exchange = DEF_PPCG_STEPS_PER_EXCHANGE;
   settings.preconditioner = DEF_PRECONDITIONER;
+  settings.overlap_halo_exchange = DEF_OVERLAP_HALO_EXCHANGE;
+  settings.single_phase_halo_exchange = DEF_SINGLE_PHASE_HALO_EXCHANGE;
+  settings.persistent_halo_exchange = DEF_PERSISTENT_HALO_EXCHANGE;
+  settings.tile_chunks = DEF_TILE_CHUNKS;
+  settings.tile_cache_kb = DEF_TILE_CACHE_KB;
+  settings.temporal_block_steps = DEF_TEMPORAL_BLOCK_STEPS;
+  settings.temporal_block_size = DEF_TEMPORAL_BLOCK_SIZE;
+  settings.field_alignment = DEF_FIELD_ALIGNMENT;
+  settings.field_stagger = DEF_FIELD_STAGGER;
+  settings.huge_pages = DEF_HUGE_PAGES;
+  settings.stored_diagonal = DEF_STORED_DIAGONAL;
+  settings.float_coefficients = DEF_FLOAT_COEFFICIENTS;
+  settings.interleaved_operator = DEF_INTERLEAVED_OPERATOR;
+  settings.float_fields = DEF_FLOAT_FIELDS;
+  settings.index_64bit = DEF_INDEX_64BIT;
+  settings.simd_kernels = DEF_SIMD_KERNELS;
+  settings.report_page_placement = DEF_REPORT_PAGE_PLACEMENT;
+  settings.concurrent_chunks = false;
   settings.num_states = DEF_NUM_STATES;
   settings.num_chunks = DEF_NUM_CHUNKS;
+  settings.x_chunks = DEF_NUM_CHUNKS;
+  settings.y_chunks = DEF_NUM_CHUNKS;
   settings.num_chunks_per_rank = DEF_NUM_CHUNKS_PER_RANK;
   settings.num_ranks = DEF_NUM_RANKS;
   settings.halo_depth = DEF_HALO_DEPTH;
@@ -49,6 +70,12 @@ void set_default_settings(Settings &settings) {
   settings.fields_to_exchange = (bool *)malloc(sizeof(bool) * NUM_FIELDS);
   settings.solver_name = (char *)malloc(sizeof(char) * MAX_CHAR_LEN);
   settings.device_selector = nullptr;
+  settings.rank_profile_filename = nullptr;
+  settings.report_filename = nullptr;
+  settings.report_format = DEF_REPORT_FORMAT;
+  settings.calibrate = DEF_CALIBRATE;
+  settings.stream_peak = DEF_STREAM_PEAK;
+  settings.stencil_peak = DEF_STREAM_PEAK;
 }
 
 // Resets all of the fields to be exchanged
@@ -4,7 +4,10 @@
 #include <cstdint>
 #include <string>
 
-#define NUM_FIELDS 6
+#define NUM_FIELDS 8
+
+// The number of mesh sized arrays a solver step streams through, used to size cache tiles
+#define TILE_WORKING_SET_FIELDS 13
 
 // Default settings
 #define DEF_TEA_IN_FILENAME "tea.in"
@@ -32,9 +35,30 @@
 #define DEF_EPS_LIM 1E-5
 #define DEF_CHECK_RESULT 1
 #define DEF_PPCG_INNER_STEPS 10
-#define DEF_PRECONDITIONER 0
+#define DEF_PPCG_STEPS_PER_EXCHANGE 1
+#define DEF_OVERLAP_HALO_EXCHANGE false
+#define DEF_SINGLE_PHASE_HALO_EXCHANGE false
+#define DEF_PERSISTENT_HALO_EXCHANGE false
+#define DEF_TILE_CHUNKS false
+#define DEF_TILE_CACHE_KB 0
+#define DEF_TEMPORAL_BLOCK_STEPS 1
+#define DEF_TEMPORAL_BLOCK_SIZE 64
+#define DEF_FIELD_ALIGNMENT 64
+#define DEF_FIELD_STAGGER -1
+#define DEF_HUGE_PAGES HUGE_PAGES_NONE
+#define DEF_REPORT_PAGE_PLACEMENT false
+#define DEF_STORED_DIAGONAL false
+#define DEF_FLOAT_COEFFICIENTS false
+#define DEF_INTERLEAVED_OPERATOR false
+#define DEF_FLOAT_FIELDS false
+#define DEF_INDEX_64BIT false
+#define DEF_SIMD_KERNELS false
+#define DEF_PRECONDITIONER Preconditioner::NONE
 #define DEF_SOLVER Solver::CG_SOLVER
 #define DEF_STAGING_BUFFER StagingBuffer::AUTO
+#define DEF_REPORT_FORMAT ReportFormat::JSON
+#define DEF_STREAM_PEAK 0.0
+#define DEF_CALIBRATE false
 #define DEF_NUM_STATES 0
 #define DEF_NUM_CHUNKS 1
 #define DEF_NUM_CHUNKS_PER_RANK 1
@@ -44,7 +68,20 @@
 #define DEF_IS_OFFLOAD false
 
 // The type of solver to be run
-enum class Solver { JACOBI_SOLVER, CG_SOLVER, CHEBY_SOLVER, PPCG_SOLVER };
+enum class Solver {
+  JACOBI_SOLVER,
+  CG_SOLVER,
+  CHEBY_SOLVER,
+  PPCG_SOLVER,
+  PIPELINED_CG_SOLVER,
+  GHYSELS_CG_SOLVER,
+  FUSED_CG_SOLVER,
+  MIXED_CG_SOLVER,
+  MG_SOLVER
+};
+
+// The preconditioner applied by the CG and PPCG solvers
+enum class Preconditioner { NONE, JAC_DIAG, JAC_BLOCK, MULTIGRID };
 
 // The language of the kernels to be run
 enum class Kernel_Language { C, FORTRAN };
@@ -53,6 +90,9 @@ enum class StagingBuffer { ENABLE, DISABLE, AUTO };
 
 enum class ModelKind { Host, Offload, Unified };
 
+// The format of the performance report
+enum class ReportFormat { JSON, CSV };
+
 // The main settings structure
 struct Settings {
   // Set of system-wide profiles
@@ -70,11 +110,20 @@ struct Settings {
   int max_iters;
   int coefficient;
   int ppcg_inner_steps;
+  int ppcg_steps_per_exchange;
   int summary_frequency;
   int halo_depth;
   int num_states;
   int num_chunks;
   int num_chunks_per_rank;
+  int x_chunks;
+  int y_chunks;
+  int tile_cache_kb;
+  int temporal_block_steps;
+  int temporal_block_size;
+  int field_alignment;
+  int field_stagger;
+  int huge_pages;
   int num_ranks;
   bool *fields_to_exchange;
 
@@ -82,7 +131,18 @@ struct Settings {
 
   bool error_switch;
   bool check_result;
-  bool preconditioner;
+  bool overlap_halo_exchange;
+  bool single_phase_halo_exchange;
+  bool persistent_halo_exchange;
+  bool tile_chunks;
+  bool stored_diagonal;
+  bool float_coefficients;
+  bool interleaved_operator;
+  bool float_fields;
+  bool index_64bit;
+  bool simd_kernels;
+  bool report_page_placement;
+  bool concurrent_chunks;
 
   double eps;
   double dt_init;
@@ -93,8 +153,17 @@ struct Settings {
   char *tea_in_filename;
   char *tea_out_filename;
   char *test_problem_filename;
+  char *rank_profile_filename;
+  char *report_filename;
+  ReportFormat report_format;
+
+  // The STREAM triad and the calibrated matvec bandwidth of all ranks together in GB/s, zero if unknown
+  bool calibrate;
+  double stream_peak;
+  double stencil_peak;
 
   Solver solver;
+  Preconditioner preconditioner;
   char *solver_name;
 
   Kernel_Language kernel_language;
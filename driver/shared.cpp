@@ -1,5 +1,7 @@
 #include "shared.h"
 #include "comms.h"
+#include <sys/mman.h>
+#include <unistd.h>
 
 // Initialises the log file pointer
 void initialise_log(Settings &settings) {
@@ -98,6 +100,161 @@ void die(int lineNum, const char *file, const char *format, ...) {
   abort_comms();
 }
 
+// Allocates bytes starting offset bytes past an alignment boundary, alignment must be a power of two and offset a
+// multiple of the pointer size. Explicit huge pages are mapped from the reserved 2MB pages, falling back to transparent
+// huge pages when none are left. The block and the length of its mapping, 0 if it came from malloc, are recorded just
+// before the buffer for field_free.
+void *field_alloc(size_t bytes, size_t alignment, size_t offset, int huge_pages) {
+  const size_t length = bytes + alignment + offset + 2 * sizeof(void *);
+  char *raw = nullptr;
+  size_t mapped = 0;
+
+#ifdef MAP_HUGETLB
+  if (huge_pages == HUGE_PAGES_EXPLICIT) {
+    mapped = (length + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *map = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (map == MAP_FAILED) mapped = 0;
+    else
+      raw = static_cast<char *>(map);
+  }
+#endif
+  if (!raw) raw = static_cast<char *>(std::malloc(length));
+  if (!raw) return nullptr;
+
+  uintptr_t start = reinterpret_cast<uintptr_t>(raw + 2 * sizeof(void *));
+  start = (start + alignment - 1) & ~(uintptr_t(alignment) - 1);
+  void **buffer = reinterpret_cast<void **>(start + offset);
+  buffer[-1] = raw;
+  buffer[-2] = reinterpret_cast<void *>(mapped);
+
+#ifdef MADV_HUGEPAGE
+  // Only whole pages can be advised, the kernel backs the 2MB aligned parts of the range with huge pages
+  if (huge_pages != HUGE_PAGES_NONE && !mapped) {
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    const uintptr_t begin = (reinterpret_cast<uintptr_t>(buffer) + page - 1) & ~(page - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(buffer) + bytes) & ~(page - 1);
+    if (end > begin) madvise(reinterpret_cast<void *>(begin), end - begin, MADV_HUGEPAGE);
+  }
+#endif
+  return buffer;
+}
+
+// Frees a buffer allocated by field_alloc
+void field_free(void *ptr) {
+  if (!ptr) return;
+
+  void *raw = static_cast<void **>(ptr)[-1];
+  const size_t mapped = reinterpret_cast<size_t>(static_cast<void **>(ptr)[-2]);
+  if (mapped) munmap(raw, mapped);
+  else
+    std::free(raw);
+}
+
+// Finds the lower left cell of the depth x depth corner block exchanged with a diagonal neighbour
+void corner_origin(int x, int y, int depth, int halo_depth, int corner, bool pack, int *col, int *row) {
+  bool is_left = (corner == CHUNK_BOTTOM_LEFT || corner == CHUNK_TOP_LEFT);
+  bool is_bottom = (corner == CHUNK_BOTTOM_LEFT || corner == CHUNK_BOTTOM_RIGHT);
+
+  // Packed blocks lie just inside the interior, unpacked blocks just outside of it
+  if (pack) {
+    *col = is_left ? halo_depth : x - halo_depth - depth;
+    *row = is_bottom ? halo_depth : y - halo_depth - depth;
+  } else {
+    *col = is_left ? halo_depth - depth : x - halo_depth;
+    *row = is_bottom ? halo_depth - depth : y - halo_depth;
+  }
+}
+
+// Finds the cells [col_min, col_max) x [row_min, row_max) that a face or corner is packed from, or unpacked into
+void halo_region(int x, int y, int depth, int halo_depth, int face, bool pack, int *col_min, int *col_max, int *row_min, int *row_max) {
+  // The lr strips cover the interior rows, the tb strips whole rows including the lr halos
+  switch (face) {
+    case CHUNK_LEFT:
+    case CHUNK_RIGHT:
+      if (face == CHUNK_LEFT) *col_min = pack ? halo_depth : halo_depth - depth;
+      else
+        *col_min = pack ? x - halo_depth - depth : x - halo_depth;
+      *col_max = *col_min + depth;
+      *row_min = halo_depth;
+      *row_max = y - halo_depth;
+      break;
+    case CHUNK_BOTTOM:
+    case CHUNK_TOP:
+      if (face == CHUNK_BOTTOM) *row_min = pack ? halo_depth : halo_depth - depth;
+      else
+        *row_min = pack ? y - halo_depth - depth : y - halo_depth;
+      *row_max = *row_min + depth;
+      *col_min = 0;
+      *col_max = x;
+      break;
+    default:
+      corner_origin(x, y, depth, halo_depth, face, pack, col_min, row_min);
+      *col_max = *col_min + depth;
+      *row_max = *row_min + depth;
+  }
+}
+
+// Counts the tiles of tile_size x tile_size cells that cover the interior, a tile_size of 0 covers it with one tile
+int num_blocked_tiles(int x, int y, int halo_depth, int tile_size) {
+  if (tile_size <= 0) return 1;
+
+  int tiles_x = (x - 2 * halo_depth + tile_size - 1) / tile_size;
+  int tiles_y = (y - 2 * halo_depth + tile_size - 1) / tile_size;
+  return tiles_x * tiles_y;
+}
+
+// Finds the cells of a tile of the interior, tiles are numbered along rows from the bottom left
+void blocked_tile(int x, int y, int halo_depth, int tile_size, const int *chunk_neighbours, int tile, BlockedTile *blocked) {
+  int tile_x = (tile_size > 0) ? tile_size : x - 2 * halo_depth;
+  int tile_y = (tile_size > 0) ? tile_size : y - 2 * halo_depth;
+  int tiles_x = (x - 2 * halo_depth + tile_x - 1) / tile_x;
+
+  blocked->x_min = halo_depth + (tile % tiles_x) * tile_x;
+  blocked->x_max = tealeaf_MIN(blocked->x_min + tile_x, x - halo_depth);
+  blocked->y_min = halo_depth + (tile / tiles_x) * tile_y;
+  blocked->y_max = tealeaf_MIN(blocked->y_min + tile_y, y - halo_depth);
+
+  for (int face = 0; face < NUM_FACES; ++face) {
+    blocked->is_external[face] = chunk_neighbours[face] == EXTERNAL_FACE;
+  }
+
+  // Tiles grow into the halo at internal faces and stop at the interior at external faces
+  blocked->x_floor = blocked->is_external[CHUNK_LEFT] ? halo_depth : 0;
+  blocked->x_ceil = blocked->is_external[CHUNK_RIGHT] ? x - halo_depth : x;
+  blocked->y_floor = blocked->is_external[CHUNK_BOTTOM] ? halo_depth : 0;
+  blocked->y_ceil = blocked->is_external[CHUNK_TOP] ? y - halo_depth : y;
+}
+
+// Finds the cells [x_min, x_max) x [y_min, y_max) of a tile grown by grow cells, stopping external_grow cells
+// beyond the external faces of the chunk
+void blocked_tile_region(const BlockedTile &blocked, int grow, int external_grow, int *x_min, int *x_max, int *y_min, int *y_max) {
+  *x_min = tealeaf_MAX(blocked.x_min - grow, blocked.x_floor - external_grow);
+  *x_max = tealeaf_MIN(blocked.x_max + grow, blocked.x_ceil + external_grow);
+  *y_min = tealeaf_MAX(blocked.y_min - grow, blocked.y_floor - external_grow);
+  *y_max = tealeaf_MIN(blocked.y_max + grow, blocked.y_ceil + external_grow);
+}
+
+// Reflects the scratch copy of a tile, which starts at cell (lx_min, ly_min) and is lx cells wide,
+// across the external faces of the chunk that bound the cells [x_min, x_max) x [y_min, y_max)
+void reflect_blocked_tile(const BlockedTile &blocked, int lx_min, int ly_min, int lx, int x_min, int x_max, int y_min, int y_max,
+                          double *scratch) {
+  const bool is_left = blocked.is_external[CHUNK_LEFT] && x_min == blocked.x_floor;
+  const bool is_right = blocked.is_external[CHUNK_RIGHT] && x_max == blocked.x_ceil;
+  const bool is_bottom = blocked.is_external[CHUNK_BOTTOM] && y_min == blocked.y_floor;
+  const bool is_top = blocked.is_external[CHUNK_TOP] && y_max == blocked.y_ceil;
+
+  for (int jj = y_min; jj < y_max; ++jj) {
+    const int row = (jj - ly_min) * lx;
+    if (is_left) scratch[row + x_min - 1 - lx_min] = scratch[row + x_min - lx_min];
+    if (is_right) scratch[row + x_max - lx_min] = scratch[row + x_max - 1 - lx_min];
+  }
+  for (int kk = x_min; kk < x_max; ++kk) {
+    const int col = kk - lx_min;
+    if (is_bottom) scratch[(y_min - 1 - ly_min) * lx + col] = scratch[(y_min - ly_min) * lx + col];
+    if (is_top) scratch[(y_max - ly_min) * lx + col] = scratch[(y_max - 1 - ly_min) * lx + col];
+  }
+}
+
 // Write out data for visualisation in visit
 void write_to_visit(const int nx, const int ny, const int x_off, const int y_off, const double *data, const char *name, const int step,
                     const double time) {
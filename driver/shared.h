@@ -2,6 +2,7 @@
 
 #include "profiler.h"
 #include <cstdarg>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -18,6 +19,10 @@ void print_to_log(Settings &settings, const char *format, ...);
 void print_and_log(Settings &settings, const char *format, ...);
 void plot_2d(int x, int y, const double *buffer, const char *name);
 void die(int lineNum, const char *file, const char *format, ...);
+void corner_origin(int x, int y, int depth, int halo_depth, int corner, bool pack, int *col, int *row);
+void halo_region(int x, int y, int depth, int halo_depth, int face, bool pack, int *col_min, int *col_max, int *row_min, int *row_max);
+void *field_alloc(size_t bytes, size_t alignment, size_t offset, int huge_pages);
+void field_free(void *ptr);
 
 // Write out data for visualisation in visit
 void write_to_visit(int nx, int ny, int x_off, int y_off, const double *data, const char *name, int step, double time);
@@ -34,6 +39,12 @@ void write_to_visit(int nx, int ny, int x_off, int y_off, const double *data, co
 #define CHUNK_RIGHT 1
 #define CHUNK_BOTTOM 2
 #define CHUNK_TOP 3
+#define NUM_CORNERS 4
+#define CHUNK_BOTTOM_LEFT 4
+#define CHUNK_BOTTOM_RIGHT 5
+#define CHUNK_TOP_LEFT 6
+#define CHUNK_TOP_RIGHT 7
+#define NUM_NEIGHBOURS (NUM_FACES + NUM_CORNERS)
 #define EXTERNAL_FACE -1
 
 #define FIELD_DENSITY 0
@@ -42,13 +53,41 @@ void write_to_visit(int nx, int ny, int x_off, int y_off, const double *data, co
 #define FIELD_U 3
 #define FIELD_P 4
 #define FIELD_SD 5
+#define FIELD_R 6
+#define FIELD_W 7
 
 #define CONDUCTIVITY 1
 #define RECIP_CONDUCTIVITY 2
 
+#define HUGE_PAGES_NONE 0
+#define HUGE_PAGES_TRANSPARENT 1
+#define HUGE_PAGES_EXPLICIT 2
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
 #define CG_ITERS_FOR_EIGENVALUES 20
 #define ERROR_SWITCH_MAX 1.0
 
+// The rows of cells coupled by each tridiagonal solve of the block Jacobi preconditioner
+#define JAC_BLOCK_SIZE 4
+
+// The multigrid preconditioner coarsens a chunk until both sides of its interior are at most MG_COARSEST_CELLS, solves
+// the coarsest levels of every chunk together and smooths every other level with MG_SMOOTH_STEPS damped Jacobi sweeps
+#define MG_MAX_LEVELS 24
+#define MG_COARSEST_CELLS 4
+#define MG_SMOOTH_STEPS 2
+#define MG_JACOBI_WEIGHT 0.8
+
+// The calibration streams arrays of CALIBRATE_CELLS cells over all ranks, enough to spill the last level cache, laid out
+// in rows of CALIBRATE_COLUMNS cells, and keeps the best of CALIBRATE_REPEATS runs of each kernel
+#define CALIBRATE_CELLS (1 << 24)
+#define CALIBRATE_COLUMNS 4096
+#define CALIBRATE_REPEATS 10
+#define CALIBRATE_COPY 0
+#define CALIBRATE_SCALE 1
+#define CALIBRATE_TRIAD 2
+#define CALIBRATE_STENCIL 3
+#define NUM_CALIBRATE_KERNELS 4
+
 #define tealeaf_MIN(a, b) ((a < b) ? a : b)
 #define tealeaf_MAX(a, b) ((a > b) ? a : b)
 #define tealeaf_strmatch(a, b) (strcmp(a, b) == 0)
@@ -59,9 +98,155 @@ void write_to_visit(int nx, int ny, int x_off, int y_off, const double *data, co
   (1.0 + (kx[index + 1] + kx[index]) + (ky[index + x] + ky[index])) * a[index] - \
       (kx[index + 1] * a[index + 1] + kx[index] * a[index - 1]) - (ky[index + x] * a[index + x] + ky[index] * a[index - x])
 
+// The diagonal of the operator for the kernels templated on its storage, read from diag when StoredDiagonal is set,
+// kx and ky may be stored as float but the arithmetic stays in double
+#define tealeaf_DIAG (StoredDiagonal ? diag[index] : 1.0 + (double(kx[index + 1]) + kx[index]) + (double(ky[index + x]) + ky[index]))
+
+// Sparse Matrix Vector Product over the stored operator
+#define tealeaf_SMVP_STORED(a)                                                          \
+  tealeaf_DIAG * a[index] - (kx[index + 1] * a[index + 1] + kx[index] * a[index - 1]) - \
+      (ky[index + x] * a[index + x] + ky[index] * a[index - x])
+
+// Runs kernel<Index>(...) with the index type selected for the run, 64 bit indices address chunks of more than INT_MAX cells
+#define tealeaf_INDEX_DISPATCH(settings, kernel, ...) \
+  if (settings.index_64bit) {                         \
+    kernel<int64_t>(__VA_ARGS__);                     \
+  } else {                                            \
+    kernel<int>(__VA_ARGS__);                         \
+  }
+
+// The vectors of a solve held in the precision Value it runs in, float_fields solves run on the single precision copies
+// of the chunk. The models that implement float_fields define solve_fields for both precisions.
+struct Chunk;
+template <typename Value> struct SolveFields {
+  Value *u;
+  Value *u0;
+  Value *p;
+  Value *r;
+  Value *w;
+  Value *sd;
+  Value *kx;
+  Value *ky;
+};
+template <typename Value> SolveFields<Value> solve_fields(Chunk *chunk);
+template <> SolveFields<double> solve_fields(Chunk *chunk);
+template <> SolveFields<float> solve_fields(Chunk *chunk);
+
+// The single precision copy of a vector of the chunk handed to a kernel, nullptr for the fields only held in double precision
+float *float_field(Chunk *chunk, const double *field);
+
+// Runs kernel<Index, Value>(...) in the precision of the solve, the arguments name the vectors of the solve through fields
+#define tealeaf_VALUE_DISPATCH_INDEX(Index, settings, chunk, kernel, ...)            \
+  if (settings.float_fields) {                                                       \
+    [[maybe_unused]] const SolveFields<float> fields = solve_fields<float>(chunk);   \
+    kernel<Index, float>(__VA_ARGS__);                                               \
+  } else {                                                                           \
+    [[maybe_unused]] const SolveFields<double> fields = solve_fields<double>(chunk); \
+    kernel<Index, double>(__VA_ARGS__);                                              \
+  }
+
+#define tealeaf_VALUE_DISPATCH(settings, chunk, kernel, ...)                    \
+  if (settings.index_64bit) {                                                   \
+    tealeaf_VALUE_DISPATCH_INDEX(int64_t, settings, chunk, kernel, __VA_ARGS__) \
+  } else {                                                                      \
+    tealeaf_VALUE_DISPATCH_INDEX(int, settings, chunk, kernel, __VA_ARGS__)     \
+  }
+
+// Runs kernel<Index, Value, Coefficient, StoredDiagonal>(..., kx, ky, diag) in the precision of the solve on the operator
+// storage selected for the run, the arguments name the vectors of the solve through fields. A float_fields solve holds
+// kx and ky with its vectors, the double precision solves may store them as float or store the diagonal.
+#define tealeaf_OPERATOR_DISPATCH_INDEX(Index, settings, chunk, kernel, ...)                           \
+  if (settings.float_fields) {                                                                         \
+    [[maybe_unused]] const SolveFields<float> fields = solve_fields<float>(chunk);                     \
+    kernel<Index, float, float, false>(__VA_ARGS__, fields.kx, fields.ky, chunk->diag);                \
+  } else {                                                                                             \
+    [[maybe_unused]] const SolveFields<double> fields = solve_fields<double>(chunk);                   \
+    if (settings.float_coefficients && settings.stored_diagonal) {                                     \
+      kernel<Index, double, float, true>(__VA_ARGS__, chunk->kx_float, chunk->ky_float, chunk->diag);  \
+    } else if (settings.float_coefficients) {                                                          \
+      kernel<Index, double, float, false>(__VA_ARGS__, chunk->kx_float, chunk->ky_float, chunk->diag); \
+    } else if (settings.stored_diagonal) {                                                             \
+      kernel<Index, double, double, true>(__VA_ARGS__, chunk->kx, chunk->ky, chunk->diag);             \
+    } else {                                                                                           \
+      kernel<Index, double, double, false>(__VA_ARGS__, chunk->kx, chunk->ky, chunk->diag);            \
+    }                                                                                                  \
+  }
+
+#define tealeaf_OPERATOR_DISPATCH(settings, chunk, kernel, ...)                    \
+  if (settings.index_64bit) {                                                      \
+    tealeaf_OPERATOR_DISPATCH_INDEX(int64_t, settings, chunk, kernel, __VA_ARGS__) \
+  } else {                                                                         \
+    tealeaf_OPERATOR_DISPATCH_INDEX(int, settings, chunk, kernel, __VA_ARGS__)     \
+  }
+
+// Runs kernel<Index, Coefficient, StoredDiagonal>(..., kx, ky, diag) on the double precision operator storage selected for
+// the run, for the kernels that only run double precision solves
+#define tealeaf_DOUBLE_OPERATOR_DISPATCH_INDEX(Index, settings, chunk, kernel, ...)          \
+  if (settings.float_coefficients && settings.stored_diagonal) {                             \
+    kernel<Index, float, true>(__VA_ARGS__, chunk->kx_float, chunk->ky_float, chunk->diag);  \
+  } else if (settings.float_coefficients) {                                                  \
+    kernel<Index, float, false>(__VA_ARGS__, chunk->kx_float, chunk->ky_float, chunk->diag); \
+  } else if (settings.stored_diagonal) {                                                     \
+    kernel<Index, double, true>(__VA_ARGS__, chunk->kx, chunk->ky, chunk->diag);             \
+  } else {                                                                                   \
+    kernel<Index, double, false>(__VA_ARGS__, chunk->kx, chunk->ky, chunk->diag);            \
+  }
+
+#define tealeaf_DOUBLE_OPERATOR_DISPATCH(settings, chunk, kernel, ...)                    \
+  if (settings.index_64bit) {                                                             \
+    tealeaf_DOUBLE_OPERATOR_DISPATCH_INDEX(int64_t, settings, chunk, kernel, __VA_ARGS__) \
+  } else {                                                                                \
+    tealeaf_DOUBLE_OPERATOR_DISPATCH_INDEX(int, settings, chunk, kernel, __VA_ARGS__)     \
+  }
+
+// The interleaved operator stores kx, ky and, when StoredDiagonal is set, the diagonal of each cell next to each other in op
+#define tealeaf_OP_STRIDE (StoredDiagonal ? 3 : 2)
+#define tealeaf_OP_KX(i) op[(i) * tealeaf_OP_STRIDE]
+#define tealeaf_OP_KY(i) op[(i) * tealeaf_OP_STRIDE + 1]
+#define tealeaf_DIAG_INTERLEAVED                                                                                                 \
+  (StoredDiagonal ? op[index * 3 + 2]                                                                                            \
+                  : 1.0 + (tealeaf_OP_KX(index + 1) + tealeaf_OP_KX(index)) + (tealeaf_OP_KY(index + x) + tealeaf_OP_KY(index)))
+
+// Sparse Matrix Vector Product over the interleaved operator
+#define tealeaf_SMVP_INTERLEAVED(a)                                                                                     \
+  tealeaf_DIAG_INTERLEAVED * a[index] - (tealeaf_OP_KX(index + 1) * a[index + 1] + tealeaf_OP_KX(index) * a[index - 1]) - \
+      (tealeaf_OP_KY(index + x) * a[index + x] + tealeaf_OP_KY(index) * a[index - x])
+
+// Runs kernel<Index, StoredDiagonal>(..., op) on the interleaved operator of the chunk
+#define tealeaf_INTERLEAVED_DISPATCH(settings, chunk, kernel, ...) \
+  if (settings.index_64bit && settings.stored_diagonal) {          \
+    kernel<int64_t, true>(__VA_ARGS__, chunk->operator_cells);     \
+  } else if (settings.index_64bit) {                               \
+    kernel<int64_t, false>(__VA_ARGS__, chunk->operator_cells);    \
+  } else if (settings.stored_diagonal) {                           \
+    kernel<int, true>(__VA_ARGS__, chunk->operator_cells);         \
+  } else {                                                         \
+    kernel<int, false>(__VA_ARGS__, chunk->operator_cells);        \
+  }
+
 #define GET_ARRAY_VALUE(len, buffer) \
   temp = 0.0;                        \
   for (int ii = 0; ii < len; ++ii) { \
     temp += buffer[ii];              \
   }                                  \
   printf("%s = %.12E\n", #buffer, temp);
+
+// A tile [x_min, x_max) x [y_min, y_max) of the interior swept by the temporally blocked iterations, the tile
+// may grow as far as [x_floor, x_ceil) x [y_floor, y_ceil), which stops at the external faces of the chunk
+struct BlockedTile {
+  int x_min;
+  int x_max;
+  int y_min;
+  int y_max;
+  int x_floor;
+  int x_ceil;
+  int y_floor;
+  int y_ceil;
+  bool is_external[NUM_FACES];
+};
+
+int num_blocked_tiles(int x, int y, int halo_depth, int tile_size);
+void blocked_tile(int x, int y, int halo_depth, int tile_size, const int *chunk_neighbours, int tile, BlockedTile *blocked);
+void blocked_tile_region(const BlockedTile &blocked, int grow, int external_grow, int *x_min, int *x_max, int *y_min, int *y_max);
+void reflect_blocked_tile(const BlockedTile &blocked, int lx_min, int ly_min, int lx, int x_min, int x_max, int y_min, int y_max,
+                          double *scratch);
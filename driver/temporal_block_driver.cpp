@@ -0,0 +1,18 @@
+#include "drivers.h"
+
+// Finds how many iterations from tt to run as one temporally blocked sweep, a sweep ends on the next iteration tc
+// with (tc + check_offset) % check_interval == 0, so that the solver checks its residual where it would without blocking
+int temporal_block_length(Settings &settings, int tt, int check_offset, int check_interval) {
+  int to_check = (check_interval - (tt + check_offset) % check_interval) % check_interval;
+  int steps = tealeaf_MIN(settings.temporal_block_steps, to_check + 1);
+  return tealeaf_MIN(steps, settings.max_iters - tt);
+}
+
+// Reports the rate of the iterations of a solver as the memory bandwidth that the naive path, which makes
+// one sweep per iteration, would need for it, so that runs with and without temporal blocking compare directly
+void print_sweep_bandwidth(Settings &settings, const char *solver, int iterations, double seconds, int bytes_per_cell) {
+  if (!PRINT_SOLVER_TRAFFIC(settings)) return;
+  double bytes = static_cast<double>(settings.grid_x_cells) * settings.grid_y_cells * iterations * bytes_per_cell;
+  double bandwidth = (seconds > 0.0) ? bytes / seconds * 1.0E-9 : 0.0;
+  print_and_log(settings, " %s bandwidth: \t%.3lf GB/s (%d iterations per sweep)\n", solver, bandwidth, settings.temporal_block_steps);
+}
@@ -162,3 +162,89 @@ void run_cg_calc_p(Chunk *chunk, Settings &settings, double beta) {
 
   KERNELS_END();
 }
+
+void run_cg_init_preconditioner(Chunk *, Settings &settings, double *) {
+  die(__LINE__, __FILE__, "Preconditioning is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+// Split CG kernels, this model computes the whole sweep once the halo exchange has completed
+void run_cg_calc_w_interior(Chunk *, Settings &, double *) {}
+
+void run_cg_calc_w_boundary(Chunk *chunk, Settings &settings, double *pw) { run_cg_calc_w(chunk, settings, pw); }
+
+// Pipelined CG solver kernels
+void run_pipelined_cg_calc_w(Chunk *, Settings &settings, double *, double *) {
+  die(__LINE__, __FILE__, "The pipelined CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_pipelined_cg_calc_ur(Chunk *, Settings &settings, double, double) {
+  die(__LINE__, __FILE__, "The pipelined CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+// Ghysels pipelined CG solver kernels
+void run_ghysels_cg_calc_q(Chunk *, Settings &settings) {
+  die(__LINE__, __FILE__, "The Ghysels CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_ghysels_cg_calc_urw(Chunk *, Settings &settings, double, double, double *, double *) {
+  die(__LINE__, __FILE__, "The Ghysels CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+// Fused CG solver kernels
+void run_cg_fused_calc_w(Chunk *, Settings &settings, double *) {
+  die(__LINE__, __FILE__, "The fused CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_cg_fused_step(Chunk *, Settings &settings, double, double, double *) {
+  die(__LINE__, __FILE__, "The fused CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+// Mixed precision CG solver kernels
+void run_mixed_cg_init(Chunk *, Settings &settings, double *) {
+  die(__LINE__, __FILE__, "The mixed precision CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_mixed_cg_calc_w(Chunk *, Settings &settings, double *) {
+  die(__LINE__, __FILE__, "The mixed precision CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_mixed_cg_calc_ur(Chunk *, Settings &settings, double, double *) {
+  die(__LINE__, __FILE__, "The mixed precision CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_mixed_cg_calc_p(Chunk *, Settings &settings, double) {
+  die(__LINE__, __FILE__, "The mixed precision CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_mixed_cg_correct(Chunk *, Settings &settings) {
+  die(__LINE__, __FILE__, "The mixed precision CG solver is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+// Multigrid kernels
+void run_multigrid_smooth(Chunk *, Settings &settings, int, bool) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_restrict(Chunk *, Settings &settings, int) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_prolong(Chunk *, Settings &settings, int) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_pack_halo(Chunk *, Settings &settings, int, int, bool, FieldBufferType) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_global_operator(Chunk *, Settings &settings, double *, double *, double *) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_copy_coarsest(Chunk *, Settings &settings, bool, double *) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_mg_calc_u(Chunk *, Settings &settings) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
@@ -85,3 +85,7 @@ void run_jacobi_iterate(Chunk *chunk, Settings &settings, double *error) {
   sum_reduce_buffer(chunk->ext->d_reduce_buffer, error, num_blocks);
   KERNELS_END();
 }
+
+void run_jacobi_iterate_blocked(Chunk *, Settings &settings, int, double *) {
+  die(__LINE__, __FILE__, "temporal_block_steps > 1 is not implemented for the %s model\n", settings.model_name.c_str());
+}
@@ -1,6 +1,7 @@
 #include "hip/hip_runtime.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <string>
@@ -47,7 +48,10 @@ void run_model_info(Settings &settings){
 #endif
 }
 
-void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len) {
+void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len, int comms_corner_len) {
+  if (settings.float_fields) {
+    die(__LINE__, __FILE__, "float_fields is not implemented for the %s model\n", settings.model_name.c_str());
+  }
   int count;
   hipGetDeviceCount(&count);
   std::vector<std::pair<int, std::string>> devices(count);
@@ -103,6 +107,14 @@ void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, i
   chunk->staging_top_recv = static_cast<double *>(std::malloc(sizeof(double) * comms_tb_len));
   chunk->staging_bottom_send = static_cast<double *>(std::malloc(sizeof(double) * comms_tb_len));
   chunk->staging_bottom_recv = static_cast<double *>(std::malloc(sizeof(double) * comms_tb_len));
+  chunk->staging_bottom_left_send = static_cast<double *>(std::malloc(sizeof(double) * comms_corner_len));
+  chunk->staging_bottom_left_recv = static_cast<double *>(std::malloc(sizeof(double) * comms_corner_len));
+  chunk->staging_bottom_right_send = static_cast<double *>(std::malloc(sizeof(double) * comms_corner_len));
+  chunk->staging_bottom_right_recv = static_cast<double *>(std::malloc(sizeof(double) * comms_corner_len));
+  chunk->staging_top_left_send = static_cast<double *>(std::malloc(sizeof(double) * comms_corner_len));
+  chunk->staging_top_left_recv = static_cast<double *>(std::malloc(sizeof(double) * comms_corner_len));
+  chunk->staging_top_right_send = static_cast<double *>(std::malloc(sizeof(double) * comms_corner_len));
+  chunk->staging_top_right_recv = static_cast<double *>(std::malloc(sizeof(double) * comms_corner_len));
 
   allocate_device_buffer(&chunk->density0, chunk->x, chunk->y);
   allocate_device_buffer(&chunk->density, chunk->x, chunk->y);
@@ -141,6 +153,14 @@ void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, i
   allocate_device_buffer(&chunk->top_recv, comms_tb_len, 1);
   allocate_device_buffer(&chunk->bottom_send, comms_tb_len, 1);
   allocate_device_buffer(&chunk->bottom_recv, comms_tb_len, 1);
+  allocate_device_buffer(&chunk->bottom_left_send, comms_corner_len, 1);
+  allocate_device_buffer(&chunk->bottom_left_recv, comms_corner_len, 1);
+  allocate_device_buffer(&chunk->bottom_right_send, comms_corner_len, 1);
+  allocate_device_buffer(&chunk->bottom_right_recv, comms_corner_len, 1);
+  allocate_device_buffer(&chunk->top_left_send, comms_corner_len, 1);
+  allocate_device_buffer(&chunk->top_left_recv, comms_corner_len, 1);
+  allocate_device_buffer(&chunk->top_right_send, comms_corner_len, 1);
+  allocate_device_buffer(&chunk->top_right_recv, comms_corner_len, 1);
 
   allocate_host_buffer(&(chunk->cg_alphas), settings.max_iters, 1);
   allocate_host_buffer(&(chunk->cg_betas), settings.max_iters, 1);
@@ -263,3 +283,92 @@ void run_kernel_finalise(Chunk *chunk, Settings &) {
   std::free(chunk->cheby_alphas);
   std::free(chunk->cheby_betas);
 }
+
+__global__ void calibrate_init(const int64_t cells, double *a, double *b, double *c, double *w) {
+  const int64_t gid = threadIdx.x + blockIdx.x * static_cast<int64_t>(blockDim.x);
+  if (gid >= cells) return;
+  a[gid] = 1.0;
+  b[gid] = 2.0;
+  c[gid] = 0.0;
+  w[gid] = 0.0;
+}
+
+__global__ void calibrate_copy(const int64_t cells, const double *a, double *c) {
+  const int64_t gid = threadIdx.x + blockIdx.x * static_cast<int64_t>(blockDim.x);
+  if (gid < cells) c[gid] = a[gid];
+}
+
+__global__ void calibrate_scale(const int64_t cells, const double scalar, const double *c, double *b) {
+  const int64_t gid = threadIdx.x + blockIdx.x * static_cast<int64_t>(blockDim.x);
+  if (gid < cells) b[gid] = scalar * c[gid];
+}
+
+__global__ void calibrate_triad(const int64_t cells, const double scalar, const double *b, const double *c, double *a) {
+  const int64_t gid = threadIdx.x + blockIdx.x * static_cast<int64_t>(blockDim.x);
+  if (gid < cells) a[gid] = b[gid] + scalar * c[gid];
+}
+
+// The matvec of the solvers with a as the vector and b and c as the coefficients
+__global__ void calibrate_stencil(const int x, const int y, const double *a, const double *kx, const double *ky, double *w) {
+  const int64_t index = threadIdx.x + blockIdx.x * static_cast<int64_t>(blockDim.x);
+  const int kk = index % x;
+  const int jj = index / x;
+  if (index < static_cast<int64_t>(x) * y && kk > 0 && kk < x - 1 && jj > 0 && jj < y - 1) {
+    w[index] = tealeaf_SMVP(a);
+  }
+}
+
+void run_calibrate(Chunk *, Settings &, int x, int y, double *seconds) {
+  const int64_t cells = static_cast<int64_t>(x) * y;
+  const int num_blocks = static_cast<int>((cells + BLOCK_SIZE - 1) / BLOCK_SIZE);
+  double *a, *b, *c, *w;
+  allocate_device_buffer(&a, x, y);
+  allocate_device_buffer(&b, x, y);
+  allocate_device_buffer(&c, x, y);
+  allocate_device_buffer(&w, x, y);
+
+  const double scalar = 3.0;
+  calibrate_init<<<num_blocks, BLOCK_SIZE>>>(cells, a, b, c, w);
+  check_errors(__LINE__, __FILE__);
+
+  for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+    seconds[kk] = 0.0;
+  }
+
+  for (int rep = 0; rep < CALIBRATE_REPEATS; ++rep) {
+    double elapsed[NUM_CALIBRATE_KERNELS];
+    auto start = std::chrono::steady_clock::now();
+    calibrate_copy<<<num_blocks, BLOCK_SIZE>>>(cells, a, c);
+    hipDeviceSynchronize();
+    auto end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_COPY] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    calibrate_scale<<<num_blocks, BLOCK_SIZE>>>(cells, scalar, c, b);
+    hipDeviceSynchronize();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_SCALE] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    calibrate_triad<<<num_blocks, BLOCK_SIZE>>>(cells, scalar, b, c, a);
+    hipDeviceSynchronize();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_TRIAD] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    calibrate_stencil<<<num_blocks, BLOCK_SIZE>>>(x, y, a, b, c, w);
+    hipDeviceSynchronize();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_STENCIL] = std::chrono::duration<double>(end - start).count();
+
+    for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+      if (rep == 0 || elapsed[kk] < seconds[kk]) seconds[kk] = elapsed[kk];
+    }
+  }
+  check_errors(__LINE__, __FILE__);
+
+  hipFree(a);
+  hipFree(b);
+  hipFree(c);
+  hipFree(w);
+}
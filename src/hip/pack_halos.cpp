@@ -55,55 +55,78 @@ __global__ void unpack_right(const int x, const int y, const int depth, const in
 
 __global__ void pack_top(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer,
                          int buffer_offset) {
-  const int x_inner = x - 2 * halo_depth;
-
   const int gid = threadIdx.x + blockDim.x * blockIdx.x;
-  if (gid >= x_inner * depth) return;
+  if (gid >= x * depth) return;
 
-  const int lines = gid / x_inner;
-  const int offset = x * (y - halo_depth - depth) + lines * 2 * halo_depth;
+  const int offset = x * (y - halo_depth - depth);
   buffer[gid + buffer_offset] = field[offset + gid];
 }
 
 __global__ void pack_bottom(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer,
                             int buffer_offset) {
-  const int x_inner = x - 2 * halo_depth;
-
   const int gid = threadIdx.x + blockDim.x * blockIdx.x;
-  if (gid >= x_inner * depth) return;
+  if (gid >= x * depth) return;
 
-  const int lines = gid / x_inner;
-  const int offset = x * halo_depth + lines * 2 * halo_depth;
+  const int offset = x * halo_depth;
   buffer[gid + buffer_offset] = field[offset + gid];
 }
 
 __global__ void unpack_top(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer,
                            int buffer_offset) {
-  const int x_inner = x - 2 * halo_depth;
-
   const int gid = threadIdx.x + blockDim.x * blockIdx.x;
-  if (gid >= x_inner * depth) return;
+  if (gid >= x * depth) return;
 
-  const int lines = gid / x_inner;
-  const int offset = x * (y - halo_depth) + lines * 2 * halo_depth;
+  const int offset = x * (y - halo_depth);
   field[offset + gid] = buffer[gid + buffer_offset];
 }
 
 __global__ void unpack_bottom(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer,
                               int buffer_offset) {
-  const int x_inner = x - 2 * halo_depth;
-
   const int gid = threadIdx.x + blockDim.x * blockIdx.x;
-  if (gid >= x_inner * depth) return;
+  if (gid >= x * depth) return;
 
-  const int lines = gid / x_inner;
-  const int offset = x * (halo_depth - depth) + lines * 2 * halo_depth;
+  const int offset = x * (halo_depth - depth);
   field[offset + gid] = buffer[gid + buffer_offset];
 }
 
+__global__ void pack_corner(const int x, const int depth, const int col, const int row, const double *field, double *buffer,
+                            int buffer_offset) {
+  const int gid = threadIdx.x + blockDim.x * blockIdx.x;
+  if (gid >= depth * depth) return;
+
+  const int offset = col + (row + gid / depth) * x + gid % depth;
+  buffer[gid + buffer_offset] = field[offset];
+}
+
+__global__ void unpack_corner(const int x, const int depth, const int col, const int row, double *field, const double *buffer,
+                              int buffer_offset) {
+  const int gid = threadIdx.x + blockDim.x * blockIdx.x;
+  if (gid >= depth * depth) return;
+
+  const int offset = col + (row + gid / depth) * x + gid % depth;
+  field[offset] = buffer[gid + buffer_offset];
+}
+
+// The field pointers of a fused pack, passed to the kernel by value
+struct FieldPointers {
+  double *fields[NUM_FIELDS];
+};
+
+__global__ void pack_or_unpack_fields(const int x, const int col_min, const int row_min, const int width, const int cells, const bool pack,
+                                      FieldPointers fields, const int num_fields, double *buffer, const int field_stride) {
+  const int gid = threadIdx.x + blockDim.x * blockIdx.x;
+  if (gid >= num_fields * cells) return;
+
+  const int ff = gid / cells;
+  const int cell = gid % cells;
+  const int offset = col_min + cell % width + (row_min + cell / width) * x;
+  if (pack) buffer[ff * field_stride + cell] = fields.fields[ff][offset];
+  else
+    fields.fields[ff][offset] = buffer[ff * field_stride + cell];
+}
+
 // Either packs or unpacks data from/to buffers.
 void pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool pack, double *field, double *buffer, int offset) {
-  const int x_inner = chunk->x - 2 * settings.halo_depth;
   const int y_inner = chunk->y - 2 * settings.halo_depth;
   switch (face) {
     case CHUNK_LEFT: {
@@ -121,19 +144,31 @@ void pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool
       break;
     }
     case CHUNK_TOP: {
-      int num_blocks = std::ceil((x_inner * depth) / double(BLOCK_SIZE));
+      int num_blocks = std::ceil((chunk->x * depth) / double(BLOCK_SIZE));
       if (pack) pack_top<<<num_blocks, BLOCK_SIZE>>>(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
       else
         unpack_top<<<num_blocks, BLOCK_SIZE>>>(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
       break;
     }
     case CHUNK_BOTTOM: {
-      int num_blocks = std::ceil((x_inner * depth) / double(BLOCK_SIZE));
+      int num_blocks = std::ceil((chunk->x * depth) / double(BLOCK_SIZE));
       if (pack) pack_bottom<<<num_blocks, BLOCK_SIZE>>>(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
       else
         unpack_bottom<<<num_blocks, BLOCK_SIZE>>>(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
       break;
     }
+    case CHUNK_BOTTOM_LEFT:
+    case CHUNK_BOTTOM_RIGHT:
+    case CHUNK_TOP_LEFT:
+    case CHUNK_TOP_RIGHT: {
+      int col, row;
+      corner_origin(chunk->x, chunk->y, depth, settings.halo_depth, face, pack, &col, &row);
+      int num_blocks = std::ceil((depth * depth) / double(BLOCK_SIZE));
+      if (pack) pack_corner<<<num_blocks, BLOCK_SIZE>>>(chunk->x, depth, col, row, field, buffer, offset);
+      else
+        unpack_corner<<<num_blocks, BLOCK_SIZE>>>(chunk->x, depth, col, row, field, buffer, offset);
+      break;
+    }
     default: die(__LINE__, __FILE__, "Incorrect face provided: %d.\n", face);
   }
 }
@@ -145,6 +180,26 @@ void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, b
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
+// Packs or unpacks the face region of every field in one kernel launch, field ff occupies buffer[ff * field_stride, ...).
+void run_pack_or_unpack_fields(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType *fields, int num_fields,
+                               FieldBufferType buffer, int field_stride) {
+  START_PROFILING(settings.kernel_profile);
+  int col_min, col_max, row_min, row_max;
+  halo_region(chunk->x, chunk->y, depth, settings.halo_depth, face, pack, &col_min, &col_max, &row_min, &row_max);
+  const int width = col_max - col_min;
+  const int cells = width * (row_max - row_min);
+
+  FieldPointers field_pointers;
+  for (int ff = 0; ff < num_fields; ++ff) {
+    field_pointers.fields[ff] = fields[ff];
+  }
+
+  int num_blocks = std::ceil((num_fields * cells) / double(BLOCK_SIZE));
+  pack_or_unpack_fields<<<num_blocks, BLOCK_SIZE>>>(chunk->x, col_min, row_min, width, cells, pack, field_pointers, num_fields, buffer,
+                                                    field_stride);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
 void run_send_recv_halo(Chunk *, Settings &settings,                                                            //
                         FieldBufferType src_send_buffer, FieldBufferType src_recv_buffer,                       //
                         StagingBufferType dest_staging_send_buffer, StagingBufferType dest_staging_recv_buffer, //
@@ -182,8 +182,17 @@ void run_calculate_2norm(Chunk *chunk, Settings &settings, double *buffer, doubl
   KERNELS_END();
 }
 
+void run_calculate_rz(Chunk *, Settings &settings, double *) {
+  die(__LINE__, __FILE__, "Preconditioning is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
 void run_finalise(Chunk *chunk, Settings &settings) {
   KERNELS_START(2 * settings.halo_depth);
   finalise<<<num_blocks, BLOCK_SIZE>>>(x_inner, y_inner, settings.halo_depth, chunk->density, chunk->u, chunk->energy);
   KERNELS_END();
 }
+
+void run_store_operator(Chunk *, Settings &settings) {
+  die(__LINE__, __FILE__, "stored_diagonal, float_coefficients and interleaved_operator are not implemented for the %s model\n",
+      settings.model_name.c_str());
+}
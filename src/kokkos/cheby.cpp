@@ -68,4 +68,15 @@ void run_cheby_iterate(Chunk *chunk, Settings &settings, double alpha, double be
   cheby_calc_u(chunk->x, chunk->y, settings.halo_depth, *chunk->p, *chunk->u);
 
   STOP_PROFILING(settings.kernel_profile, __func__);
-}
\ No newline at end of file
+}
+
+// Split Chebyshev kernels, this model computes the whole sweep once the halo exchange has completed
+void run_cheby_iterate_interior(Chunk *, Settings &, double, double) {}
+
+void run_cheby_iterate_boundary(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  run_cheby_iterate(chunk, settings, alpha, beta);
+}
+
+void run_cheby_iterate_blocked(Chunk *, Settings &settings, int, const double *, const double *) {
+  die(__LINE__, __FILE__, "temporal_block_steps > 1 is not implemented for the %s model\n", settings.model_name.c_str());
+}
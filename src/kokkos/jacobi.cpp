@@ -69,4 +69,8 @@ void run_jacobi_iterate(Chunk *chunk, Settings &settings, double *error) {
   jacobi_iterate(chunk->x, chunk->y, settings.halo_depth, *chunk->u, *chunk->u0, *chunk->r, *chunk->kx, *chunk->ky, error);
 
   STOP_PROFILING(settings.kernel_profile, __func__);
-}
\ No newline at end of file
+}
+
+void run_jacobi_iterate_blocked(Chunk *, Settings &settings, int, double *) {
+  die(__LINE__, __FILE__, "temporal_block_steps > 1 is not implemented for the %s model\n", settings.model_name.c_str());
+}
@@ -2,6 +2,7 @@
 #include "kokkos_shared.hpp"
 #include "settings.h"
 #include "shared.h"
+#include <chrono>
 
 // Initialises the vertices
 void set_chunk_data_vertices(const int x, const int y, const int halo_depth, KView &vertex_x, KView &vertex_y, const double x_min,
@@ -136,7 +137,10 @@ void run_model_info(Settings &settings) {
   settings.model_kind = ModelKind::Offload;
 }
 
-void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len) {
+void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len, int comms_corner_len) {
+  if (settings.float_fields) {
+    die(__LINE__, __FILE__, "float_fields is not implemented for the %s model\n", settings.model_name.c_str());
+  }
 
   Kokkos::initialize();
 
@@ -151,6 +155,14 @@ void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, i
   chunk->staging_top_recv = new KView::HostMirror{};
   chunk->staging_bottom_send = new KView::HostMirror{};
   chunk->staging_bottom_recv = new KView::HostMirror{};
+  chunk->staging_bottom_left_send = new KView::HostMirror{};
+  chunk->staging_bottom_left_recv = new KView::HostMirror{};
+  chunk->staging_bottom_right_send = new KView::HostMirror{};
+  chunk->staging_bottom_right_recv = new KView::HostMirror{};
+  chunk->staging_top_left_send = new KView::HostMirror{};
+  chunk->staging_top_left_recv = new KView::HostMirror{};
+  chunk->staging_top_right_send = new KView::HostMirror{};
+  chunk->staging_top_right_recv = new KView::HostMirror{};
 
   chunk->density0 = new KView(Kokkos::ViewAllocateWithoutInitializing("density0"), chunk->x * chunk->y);
   chunk->density = new KView(Kokkos::ViewAllocateWithoutInitializing("density"), chunk->x * chunk->y);
@@ -185,6 +197,14 @@ void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, i
   chunk->top_recv = new KView(Kokkos::ViewAllocateWithoutInitializing("top_recv"), comms_tb_len);
   chunk->bottom_send = new KView(Kokkos::ViewAllocateWithoutInitializing("bottom_send"), comms_tb_len);
   chunk->bottom_recv = new KView(Kokkos::ViewAllocateWithoutInitializing("bottom_recv"), comms_tb_len);
+  chunk->bottom_left_send = new KView(Kokkos::ViewAllocateWithoutInitializing("bottom_left_send"), comms_corner_len);
+  chunk->bottom_left_recv = new KView(Kokkos::ViewAllocateWithoutInitializing("bottom_left_recv"), comms_corner_len);
+  chunk->bottom_right_send = new KView(Kokkos::ViewAllocateWithoutInitializing("bottom_right_send"), comms_corner_len);
+  chunk->bottom_right_recv = new KView(Kokkos::ViewAllocateWithoutInitializing("bottom_right_recv"), comms_corner_len);
+  chunk->top_left_send = new KView(Kokkos::ViewAllocateWithoutInitializing("top_left_send"), comms_corner_len);
+  chunk->top_left_recv = new KView(Kokkos::ViewAllocateWithoutInitializing("top_left_recv"), comms_corner_len);
+  chunk->top_right_send = new KView(Kokkos::ViewAllocateWithoutInitializing("top_right_send"), comms_corner_len);
+  chunk->top_right_recv = new KView(Kokkos::ViewAllocateWithoutInitializing("top_right_recv"), comms_corner_len);
 
   allocate_buffer(&(chunk->cg_alphas), settings.max_iters, 1);
   allocate_buffer(&(chunk->cg_betas), settings.max_iters, 1);
@@ -201,3 +221,69 @@ void run_kernel_finalise(Chunk *chunk, Settings &) {
   // TODO: Actually shouldn't be called on a per chunk basis, only by rank
   Kokkos::finalize();
 }
+
+void run_calibrate(Chunk *, Settings &, int x, int y, double *seconds) {
+  const int cells = x * y;
+  KView a(Kokkos::ViewAllocateWithoutInitializing("calibrate_a"), cells);
+  KView b(Kokkos::ViewAllocateWithoutInitializing("calibrate_b"), cells);
+  KView c(Kokkos::ViewAllocateWithoutInitializing("calibrate_c"), cells);
+  KView w(Kokkos::ViewAllocateWithoutInitializing("calibrate_w"), cells);
+
+  const double scalar = 3.0;
+  Kokkos::parallel_for(
+      cells, KOKKOS_LAMBDA(const int index) {
+        a(index) = 1.0;
+        b(index) = 2.0;
+        c(index) = 0.0;
+        w(index) = 0.0;
+      });
+  Kokkos::fence();
+
+  for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+    seconds[kk] = 0.0;
+  }
+
+  for (int rep = 0; rep < CALIBRATE_REPEATS; ++rep) {
+    double elapsed[NUM_CALIBRATE_KERNELS];
+    auto start = std::chrono::steady_clock::now();
+    Kokkos::parallel_for(
+        cells, KOKKOS_LAMBDA(const int index) { c(index) = a(index); });
+    Kokkos::fence();
+    auto end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_COPY] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    Kokkos::parallel_for(
+        cells, KOKKOS_LAMBDA(const int index) { b(index) = scalar * c(index); });
+    Kokkos::fence();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_SCALE] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    Kokkos::parallel_for(
+        cells, KOKKOS_LAMBDA(const int index) { a(index) = b(index) + scalar * c(index); });
+    Kokkos::fence();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_TRIAD] = std::chrono::duration<double>(end - start).count();
+
+    // The matvec of the solvers with a as the vector and b and c as the coefficients
+    KView kx = b;
+    KView ky = c;
+    start = std::chrono::steady_clock::now();
+    Kokkos::parallel_for(
+        cells, KOKKOS_LAMBDA(const int index) {
+          const int kk = index % x;
+          const int jj = index / x;
+          if (kk > 0 && kk < x - 1 && jj > 0 && jj < y - 1) {
+            w(index) = tealeaf_SMVP(a);
+          }
+        });
+    Kokkos::fence();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_STENCIL] = std::chrono::duration<double>(end - start).count();
+
+    for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+      if (rep == 0 || elapsed[kk] < seconds[kk]) seconds[kk] = elapsed[kk];
+    }
+  }
+}
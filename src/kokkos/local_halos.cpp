@@ -72,7 +72,8 @@ void update_face(const int x, const int y, const int halo_depth, const int *chun
 
 // The kernel for updating halos locally
 void local_halos(const int x, const int y, const int depth, const int halo_depth, const int *chunk_neighbours,
-                 const bool *fields_to_exchange, KView &density, KView &energy0, KView &energy, KView &u, KView &p, KView &sd) {
+                 const bool *fields_to_exchange, KView &density, KView &energy0, KView &energy, KView &u, KView &p, KView &sd, KView &r,
+                 KView &w) {
   if (fields_to_exchange[FIELD_DENSITY]) {
     update_face(x, y, halo_depth, chunk_neighbours, depth, density);
   }
@@ -91,12 +92,18 @@ void local_halos(const int x, const int y, const int depth, const int halo_depth
   if (fields_to_exchange[FIELD_SD]) {
     update_face(x, y, halo_depth, chunk_neighbours, depth, sd);
   }
+  if (fields_to_exchange[FIELD_R]) {
+    update_face(x, y, halo_depth, chunk_neighbours, depth, r);
+  }
+  if (fields_to_exchange[FIELD_W]) {
+    update_face(x, y, halo_depth, chunk_neighbours, depth, w);
+  }
 }
 
 // Solver-wide kernels
 void run_local_halos(Chunk *chunk, Settings &settings, int depth) {
   START_PROFILING(settings.kernel_profile);
   local_halos(chunk->x, chunk->y, depth, settings.halo_depth, chunk->neighbours, settings.fields_to_exchange, *chunk->density,
-              *chunk->energy0, *chunk->energy, *chunk->u, *chunk->p, *chunk->sd);
+              *chunk->energy0, *chunk->energy, *chunk->u, *chunk->p, *chunk->sd, *chunk->r, *chunk->w);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
@@ -79,6 +79,24 @@ void unpack_right(const int x, const int y, const int depth, const int halo_dept
       });
 }
 
+// Packs the corner block whose lower left cell is (col, row)
+void pack_corner(const int x, const int depth, const int col, const int row, KView &field, KView &buffer, int buffer_offset) {
+  Kokkos::parallel_for(
+      depth * depth, KOKKOS_LAMBDA(const int index) {
+        const int offset = col + (row + index / depth) * x + index % depth;
+        buffer(index + buffer_offset) = field(offset);
+      });
+}
+
+// Unpacks the corner block whose lower left cell is (col, row)
+void unpack_corner(const int x, const int depth, const int col, const int row, KView &field, KView &buffer, int buffer_offset) {
+  Kokkos::parallel_for(
+      depth * depth, KOKKOS_LAMBDA(const int index) {
+        const int offset = col + (row + index / depth) * x + index % depth;
+        field(offset) = buffer(index + buffer_offset);
+      });
+}
+
 void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool pack, KView *field, KView *buffer, int offset) {
   START_PROFILING(settings.kernel_profile);
   switch (face) {
@@ -102,11 +120,50 @@ void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, b
       else
         unpack_bottom(chunk->x, chunk->y, depth, settings.halo_depth, *field, *buffer, offset);
       break;
+    case CHUNK_BOTTOM_LEFT:
+    case CHUNK_BOTTOM_RIGHT:
+    case CHUNK_TOP_LEFT:
+    case CHUNK_TOP_RIGHT: {
+      int col, row;
+      corner_origin(chunk->x, chunk->y, depth, settings.halo_depth, face, pack, &col, &row);
+      if (pack) pack_corner(chunk->x, depth, col, row, *field, *buffer, offset);
+      else
+        unpack_corner(chunk->x, depth, col, row, *field, *buffer, offset);
+      break;
+    }
     default: die(__LINE__, __FILE__, "Incorrect face provided: %d.\n", face);
   }
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
+// Packs or unpacks the face region of every field in one parallel loop, field ff occupies buffer[ff * field_stride, ...).
+void run_pack_or_unpack_fields(Chunk *chunk, Settings &settings, int depth, int face, bool pack, KView **fields, int num_fields,
+                               KView *buffer, int field_stride) {
+  START_PROFILING(settings.kernel_profile);
+  const int x = chunk->x;
+  int col_min, col_max, row_min, row_max;
+  halo_region(x, chunk->y, depth, settings.halo_depth, face, pack, &col_min, &col_max, &row_min, &row_max);
+  const int width = col_max - col_min;
+  const int cells = width * (row_max - row_min);
+
+  Kokkos::Array<KView, NUM_FIELDS> field_views;
+  for (int ff = 0; ff < num_fields; ++ff) {
+    field_views[ff] = *fields[ff];
+  }
+  KView buffer_view = *buffer;
+
+  Kokkos::parallel_for(
+      num_fields * cells, KOKKOS_LAMBDA(const int index) {
+        const int ff = index / cells;
+        const int cell = index % cells;
+        const int offset = col_min + cell % width + (row_min + cell / width) * x;
+        if (pack) buffer_view(ff * field_stride + cell) = field_views[ff](offset);
+        else
+          field_views[ff](offset) = buffer_view(ff * field_stride + cell);
+      });
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
 void run_send_recv_halo(Chunk *chunk, Settings &settings,                                                       //
                         FieldBufferType src_send_buffer, FieldBufferType src_recv_buffer,                       //
                         StagingBufferType dest_staging_send_buffer, StagingBufferType dest_staging_recv_buffer, //
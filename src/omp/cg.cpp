@@ -1,13 +1,19 @@
 #include "chunk.h"
+#include "preconditioner.h"
 #include "shared.h"
+#include <omp.h>
+#ifndef OMP_TARGET
+  #include "simd_row.h"
+#endif
 
 /*
  *		CONJUGATE GRADIENT SOLVER KERNEL
  */
 
 // Initialises the CG solver
-void cg_init(const int x, const int y, const int halo_depth, const int coefficient, double rx, double ry, double *rro,
-             const double *density, const double *energy, double *u, double *p, double *r, double *w, double *kx, double *ky) {
+template <typename Index, typename Value>
+void cg_init(const int x, const int y, const int halo_depth, const int coefficient, double rx, double ry, const bool float_coefficients,
+             double *rro, const double *density, const double *energy, Value *u, Value *p, Value *r, Value *w, Value *kx, Value *ky) {
   if (coefficient != CONDUCTIVITY && coefficient != RECIP_CONDUCTIVITY) {
     die(__LINE__, __FILE__, "Coefficient %d is not valid.\n", coefficient);
   }
@@ -17,23 +23,24 @@ void cg_init(const int x, const int y, const int halo_depth, const int coefficie
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = 0; jj < y; ++jj) {
-    for (int kk = 0; kk < x; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = 0; jj < y; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      const Index index = kk + jj * x;
       p[index] = 0.0;
       r[index] = 0.0;
       u[index] = energy[index] * density[index];
     }
   }
 
+  // The coefficients also cover the halo, the communication-avoiding PPCG inner steps apply the stencil there
 #ifdef OMP_TARGET
   #pragma omp target teams distribute parallel for simd collapse(2)
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = 1; jj < y - 1; ++jj) {
-    for (int kk = 1; kk < x - 1; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = 0; jj < y; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      const Index index = kk + jj * x;
       w[index] = (coefficient == CONDUCTIVITY) ? density[index] : 1.0 / density[index];
     }
   }
@@ -43,11 +50,15 @@ void cg_init(const int x, const int y, const int halo_depth, const int coefficie
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < y - 1; ++jj) {
-    for (int kk = halo_depth; kk < x - 1; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = 1; jj < y; ++jj) {
+    for (Index kk = 1; kk < x; ++kk) {
+      const Index index = kk + jj * x;
       kx[index] = rx * (w[index - 1] + w[index]) / (2.0 * w[index - 1] * w[index]);
       ky[index] = ry * (w[index - x] + w[index]) / (2.0 * w[index - x] * w[index]);
+      if (float_coefficients) {
+        kx[index] = static_cast<float>(kx[index]);
+        ky[index] = static_cast<float>(ky[index]);
+      }
     }
   }
 
@@ -58,9 +69,9 @@ void cg_init(const int x, const int y, const int halo_depth, const int coefficie
 #else
   #pragma omp parallel for reduction(+ : rro_temp)
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
       const double smvp = tealeaf_SMVP(u);
       w[index] = smvp;
       r[index] = u[index] - w[index];
@@ -74,7 +85,9 @@ void cg_init(const int x, const int y, const int halo_depth, const int coefficie
 }
 
 // Calculates w
-void cg_calc_w(const int x, const int y, const int halo_depth, double *pw, const double *p, double *w, const double *kx, const double *ky) {
+template <typename Index, typename Value, typename Coefficient, bool StoredDiagonal>
+void cg_calc_w(const int x, const int y, const int halo_depth, double *pw, const Value *p, Value *w, const Coefficient *kx,
+               const Coefficient *ky, const double *diag) {
   double pw_temp = 0.0;
 
 #ifdef OMP_TARGET
@@ -82,10 +95,32 @@ void cg_calc_w(const int x, const int y, const int halo_depth, double *pw, const
 #else
   #pragma omp parallel for reduction(+ : pw_temp)
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
-      const double smvp = tealeaf_SMVP(p);
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP_STORED(p);
+      w[index] = smvp;
+      pw_temp += w[index] * p[index];
+    }
+  }
+
+  *pw += pw_temp;
+}
+
+// Calculates w over the interleaved operator
+template <typename Index, bool StoredDiagonal>
+void cg_calc_w_interleaved(const int x, const int y, const int halo_depth, double *pw, const double *p, double *w, const double *op) {
+  double pw_temp = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : pw_temp) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : pw_temp)
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP_INTERLEAVED(p);
       w[index] = smvp;
       pw_temp += w[index] * p[index];
     }
@@ -95,8 +130,9 @@ void cg_calc_w(const int x, const int y, const int halo_depth, double *pw, const
 }
 
 // Calculates u and r
-void cg_calc_ur(const int x, const int y, const int halo_depth, const double alpha, double *rrn, double *u, const double *p, double *r,
-                const double *w) {
+template <typename Index, typename Value>
+void cg_calc_ur(const int x, const int y, const int halo_depth, const double alpha, double *rrn, Value *u, const Value *p, Value *r,
+                const Value *w) {
   double rrn_temp = 0.0;
 
 #ifdef OMP_TARGET
@@ -104,9 +140,9 @@ void cg_calc_ur(const int x, const int y, const int halo_depth, const double alp
 #else
   #pragma omp parallel for reduction(+ : rrn_temp)
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
 
       u[index] += alpha * p[index];
       r[index] -= alpha * w[index];
@@ -117,18 +153,616 @@ void cg_calc_ur(const int x, const int y, const int halo_depth, const double alp
   *rrn += rrn_temp;
 }
 
+// Sets up the preconditioner and starts the preconditioned CG recurrences from p = z = M^-1 r
+template <typename Index>
+void cg_init_preconditioner(const int x, const int y, const int halo_depth, const Preconditioner preconditioner,
+                            const int *chunk_neighbours, double *rro, const double *r, double *p, double *z, const double *kx,
+                            const double *ky, double *mi, double *cp, double *bfp, const int mg_levels, Chunk *mg_coarse, double *q) {
+  if (preconditioner == Preconditioner::JAC_BLOCK) {
+    jacobi_block_init<Index>(x, y, halo_depth, kx, ky, cp, bfp);
+  } else if (preconditioner == Preconditioner::MULTIGRID) {
+    // The drivers start p = z once the V-cycle has run over every chunk
+    multigrid_init<Index>(x, y, halo_depth, chunk_neighbours, mg_levels, mg_coarse, kx, ky, mi, z);
+    return;
+  } else {
+    jacobi_diag_init<Index>(x, y, halo_depth, kx, ky, mi);
+  }
+
+  *rro += apply_preconditioner<Index>(x, y, halo_depth, preconditioner, kx, ky, r, z, mi, cp, bfp, mg_levels, mg_coarse, q);
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      p[index] = z[index];
+    }
+  }
+}
+
+// Calculates u, r and the preconditioned residual z, rrn accumulates r.z
+template <typename Index>
+void cg_calc_ur_preconditioned(const int x, const int y, const int halo_depth, const Preconditioner preconditioner, const double alpha,
+                               double *rrn, double *u, const double *p, double *r, const double *w, double *z, const double *kx,
+                               const double *ky, const double *mi, const double *cp, const double *bfp, const int mg_levels,
+                               Chunk *mg_coarse, double *q) {
+  if (preconditioner != Preconditioner::JAC_DIAG) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+    for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+      for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+        const Index index = kk + jj * x;
+        u[index] += alpha * p[index];
+        r[index] -= alpha * w[index];
+      }
+    }
+
+    *rrn += apply_preconditioner<Index>(x, y, halo_depth, preconditioner, kx, ky, r, z, mi, cp, bfp, mg_levels, mg_coarse, q);
+    return;
+  }
+
+  double rrn_temp = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : rrn_temp) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : rrn_temp)
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      u[index] += alpha * p[index];
+      r[index] -= alpha * w[index];
+      z[index] = mi[index] * r[index];
+      rrn_temp += r[index] * z[index];
+    }
+  }
+
+  *rrn += rrn_temp;
+}
+
+// Adds the multigrid correction z to u
+template <typename Index> void mg_calc_u(const int x, const int y, const int halo_depth, const double *z, double *u) {
+  #pragma omp parallel for
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      u[index] += z[index];
+    }
+  }
+}
+
 // Calculates p
-void cg_calc_p(const int x, const int y, const int halo_depth, const double beta, double *p, const double *r) {
+template <typename Index, typename Value>
+void cg_calc_p(const int x, const int y, const int halo_depth, const double beta, Value *p, const Value *r) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+
+      p[index] = beta * p[index] + r[index];
+    }
+  }
+}
+
+// Calculates w with explicit vector code, each row peels cells up to the first aligned store of w and finishes the
+// cells that do not fill a vector with scalar code
+template <typename Index, typename Coefficient, bool StoredDiagonal>
+void cg_calc_w_simd(const int x, const int y, const int halo_depth, double *pw, const double *p, double *w, const Coefficient *kx,
+                    const Coefficient *ky, const double *diag) {
+#ifdef OMP_TARGET
+  // Offloaded, the plain kernel is vectorised by the target compiler
+  cg_calc_w<Index, Coefficient, StoredDiagonal>(x, y, halo_depth, pw, p, w, kx, ky, diag);
+#else
+  double pw_temp = 0.0;
+
+  #pragma omp parallel for reduction(+ : pw_temp)
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    const Index row_end = jj * x + x - halo_depth;
+    Index index = jj * x + halo_depth;
+    const Index peel_end = index + simd_peel<Index>(w + index, row_end - index);
+
+    for (; index < peel_end; ++index) {
+      w[index] = tealeaf_SMVP_STORED(p);
+      pw_temp += w[index] * p[index];
+    }
+
+    simd_double pw_vector = 0.0;
+    for (; index + static_cast<Index>(simd_double::size()) <= row_end; index += simd_double::size()) {
+      const simd_double smvp = simd_smvp<Index, Coefficient, StoredDiagonal>(x, index, p, kx, ky, diag);
+      smvp.copy_to(w + index, stdx::vector_aligned);
+      pw_vector += smvp * simd_load(p + index);
+    }
+    pw_temp += stdx::reduce(pw_vector);
+
+    for (; index < row_end; ++index) {
+      w[index] = tealeaf_SMVP_STORED(p);
+      pw_temp += w[index] * p[index];
+    }
+  }
+
+  *pw += pw_temp;
+#endif
+}
+
+// Calculates u and r with explicit vector code
+template <typename Index>
+void cg_calc_ur_simd(const int x, const int y, const int halo_depth, const double alpha, double *rrn, double *u, const double *p,
+                     double *r, const double *w) {
+#ifdef OMP_TARGET
+  cg_calc_ur<Index>(x, y, halo_depth, alpha, rrn, u, p, r, w);
+#else
+  double rrn_temp = 0.0;
+
+  #pragma omp parallel for reduction(+ : rrn_temp)
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    const Index row_end = jj * x + x - halo_depth;
+    Index index = jj * x + halo_depth;
+    const Index peel_end = index + simd_peel<Index>(r + index, row_end - index);
+
+    for (; index < peel_end; ++index) {
+      u[index] += alpha * p[index];
+      r[index] -= alpha * w[index];
+      rrn_temp += r[index] * r[index];
+    }
+
+    simd_double rrn_vector = 0.0;
+    for (; index + static_cast<Index>(simd_double::size()) <= row_end; index += simd_double::size()) {
+      const simd_double u_vector = simd_load(u + index) + alpha * simd_load(p + index);
+      const simd_double r_vector = simd_load(r + index) - alpha * simd_load(w + index);
+      u_vector.copy_to(u + index, stdx::element_aligned);
+      r_vector.copy_to(r + index, stdx::vector_aligned);
+      rrn_vector += r_vector * r_vector;
+    }
+    rrn_temp += stdx::reduce(rrn_vector);
+
+    for (; index < row_end; ++index) {
+      u[index] += alpha * p[index];
+      r[index] -= alpha * w[index];
+      rrn_temp += r[index] * r[index];
+    }
+  }
+
+  *rrn += rrn_temp;
+#endif
+}
+
+// Calculates p with explicit vector code
+template <typename Index>
+void cg_calc_p_simd(const int x, const int y, const int halo_depth, const double beta, double *p, const double *r) {
+#ifdef OMP_TARGET
+  cg_calc_p<Index>(x, y, halo_depth, beta, p, r);
+#else
+  #pragma omp parallel for
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    const Index row_end = jj * x + x - halo_depth;
+    Index index = jj * x + halo_depth;
+    const Index peel_end = index + simd_peel<Index>(p + index, row_end - index);
+
+    for (; index < peel_end; ++index) {
+      p[index] = beta * p[index] + r[index];
+    }
+
+    for (; index + static_cast<Index>(simd_double::size()) <= row_end; index += simd_double::size()) {
+      const simd_double p_vector = beta * simd_load(p + index) + simd_load(r + index);
+      p_vector.copy_to(p + index, stdx::vector_aligned);
+    }
+
+    for (; index < row_end; ++index) {
+      p[index] = beta * p[index] + r[index];
+    }
+  }
+#endif
+}
+
+// Calculates w = Ar and the dot products needed by the pipelined CG step
+template <typename Index>
+void pipelined_cg_calc_w(const int x, const int y, const int halo_depth, double *rr, double *wr, const double *r, double *w,
+                         const double *kx, const double *ky) {
+  double rr_temp = 0.0;
+  double wr_temp = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : rr_temp, wr_temp) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : rr_temp, wr_temp)
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP(r);
+      w[index] = smvp;
+      rr_temp += r[index] * r[index];
+      wr_temp += w[index] * r[index];
+    }
+  }
+
+  *rr += rr_temp;
+  *wr += wr_temp;
+}
+
+// Calculates p, s = Ap, u and r in a single sweep
+template <typename Index>
+void pipelined_cg_calc_ur(const int x, const int y, const int halo_depth, const double alpha, const double beta, double *u, double *p,
+                          double *r, double *s, const double *w) {
 #ifdef OMP_TARGET
   #pragma omp target teams distribute parallel for simd collapse(2)
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
 
       p[index] = beta * p[index] + r[index];
+      s[index] = beta * s[index] + w[index];
+      u[index] += alpha * p[index];
+      r[index] -= alpha * s[index];
+    }
+  }
+}
+
+// Calculates q = Aw for the Ghysels pipelined CG step
+template <typename Index>
+void ghysels_cg_calc_q(const int x, const int y, const int halo_depth, const double *w, double *q, const double *kx, const double *ky) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP(w);
+      q[index] = smvp;
+    }
+  }
+}
+
+// Updates the Ghysels pipelined CG recurrences and calculates the dot products for the next step
+template <typename Index>
+void ghysels_cg_calc_urw(const int x, const int y, const int halo_depth, const double alpha, const double beta, double *rr, double *wr,
+                         double *u, double *p, double *r, double *s, double *w, double *z, const double *q) {
+  double rr_temp = 0.0;
+  double wr_temp = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : rr_temp, wr_temp) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : rr_temp, wr_temp)
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+
+      z[index] = beta * z[index] + q[index];
+      s[index] = beta * s[index] + w[index];
+      p[index] = beta * p[index] + r[index];
+      u[index] += alpha * p[index];
+      r[index] -= alpha * s[index];
+      w[index] -= alpha * z[index];
+      rr_temp += r[index] * r[index];
+      wr_temp += w[index] * r[index];
+    }
+  }
+
+  *rr += rr_temp;
+  *wr += wr_temp;
+}
+
+// Calculates w over the cells [x_min, x_max) x [y_min, y_max)
+template <typename Index>
+void cg_calc_w_region(const int x, const int x_min, const int x_max, const int y_min, const int y_max, double *pw, const double *p,
+                      double *w, const double *kx, const double *ky) {
+  double pw_temp = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : pw_temp) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : pw_temp)
+#endif
+  for (Index jj = y_min; jj < y_max; ++jj) {
+    for (Index kk = x_min; kk < x_max; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP(p);
+      w[index] = smvp;
+      pw_temp += w[index] * p[index];
+    }
+  }
+
+  *pw += pw_temp;
+}
+
+// Calculates w on the outermost ring of the interior, the only cells whose stencil reads the halo
+template <typename Index>
+void cg_calc_w_boundary(const int x, const int y, const int halo_depth, double *pw, const double *p, double *w, const double *kx,
+                        const double *ky) {
+  const int top = tealeaf_MAX(y - halo_depth - 1, halo_depth + 1);
+  const int right = tealeaf_MAX(x - halo_depth - 1, halo_depth + 1);
+  cg_calc_w_region<Index>(x, halo_depth, x - halo_depth, halo_depth, halo_depth + 1, pw, p, w, kx, ky);
+  cg_calc_w_region<Index>(x, halo_depth, x - halo_depth, top, y - halo_depth, pw, p, w, kx, ky);
+  cg_calc_w_region<Index>(x, halo_depth, halo_depth + 1, halo_depth + 1, y - halo_depth - 1, pw, p, w, kx, ky);
+  cg_calc_w_region<Index>(x, right, x - halo_depth, halo_depth + 1, y - halo_depth - 1, pw, p, w, kx, ky);
+}
+
+// Calculates w = Ap and the dot products r.r, p.w, r.w and w.w that a fused CG iteration needs
+template <typename Index>
+void cg_fused_calc_w(const int x, const int y, const int halo_depth, double *dots, const double *p, const double *r, double *w,
+                     const double *kx, const double *ky) {
+  double rr_temp = 0.0;
+  double pw_temp = 0.0;
+  double rw_temp = 0.0;
+  double ww_temp = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : rr_temp, pw_temp, rw_temp, ww_temp) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : rr_temp, pw_temp, rw_temp, ww_temp)
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP(p);
+      w[index] = smvp;
+      rr_temp += r[index] * r[index];
+      pw_temp += p[index] * smvp;
+      rw_temp += r[index] * smvp;
+      ww_temp += smvp * smvp;
+    }
+  }
+
+  dots[0] += rr_temp;
+  dots[1] += pw_temp;
+  dots[2] += rw_temp;
+  dots[3] += ww_temp;
+}
+
+// Updates u, r and p on row jj, the halo ring around the interior only gets p = beta p + r - alpha w from the exchanged r and w
+template <typename Index>
+static inline void cg_fused_update_row(const int x, const int y, const int halo_depth, const Index jj, const double alpha,
+                                       const double beta, double *u, double *p, double *r, const double *w) {
+  const Index row = jj * x;
+
+  if (jj == halo_depth - 1 || jj == y - halo_depth) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      p[row + kk] = beta * p[row + kk] + r[row + kk] - alpha * w[row + kk];
+    }
+    return;
+  }
+
+  for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+    const Index index = row + kk;
+    u[index] += alpha * p[index];
+    r[index] -= alpha * w[index];
+    p[index] = beta * p[index] + r[index];
+  }
+
+  for (const int kk : {halo_depth - 1, x - halo_depth}) {
+    p[row + kk] = beta * p[row + kk] + r[row + kk] - alpha * w[row + kk];
+  }
+}
+
+// Calculates w = Ap on row jj and accumulates the dot products of the next fused CG iteration
+template <typename Index>
+static inline void cg_fused_calc_w_row(const int x, const int halo_depth, const Index jj, double *dots, const double *p, const double *r,
+                                       double *w, const double *kx, const double *ky) {
+  double rr_temp = 0.0;
+  double pw_temp = 0.0;
+  double rw_temp = 0.0;
+  double ww_temp = 0.0;
+
+  #pragma omp simd reduction(+ : rr_temp, pw_temp, rw_temp, ww_temp)
+  for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+    const Index index = kk + jj * x;
+    const double smvp = tealeaf_SMVP(p);
+    w[index] = smvp;
+    rr_temp += r[index] * r[index];
+    pw_temp += p[index] * smvp;
+    rw_temp += r[index] * smvp;
+    ww_temp += smvp * smvp;
+  }
+
+  dots[0] += rr_temp;
+  dots[1] += pw_temp;
+  dots[2] += rw_temp;
+  dots[3] += ww_temp;
+}
+
+// Performs a fused CG iteration: u += alpha p, r -= alpha w and p = beta p + r, then w = Ap and the dot products of the
+// next iteration. Each thread updates the first and last rows of its block up front, then runs the update one row ahead
+// of the matvec, so the matvec reads p, r and w while they are still in cache.
+template <typename Index>
+void cg_fused_step(const int x, const int y, const int halo_depth, const double alpha, const double beta, double *dots, double *u,
+                   double *p, double *r, double *w, const double *kx, const double *ky) {
+#ifdef OMP_TARGET
+  // Offloaded, the update and the matvec run as two kernels
+  #pragma omp target teams distribute parallel for simd collapse(2)
+  for (Index jj = halo_depth - 1; jj < y - halo_depth + 1; ++jj) {
+    for (Index kk = halo_depth - 1; kk < x - halo_depth + 1; ++kk) {
+      const Index index = kk + jj * x;
+      const bool is_ring_row = jj == halo_depth - 1 || jj == y - halo_depth;
+      const bool is_ring_column = kk == halo_depth - 1 || kk == x - halo_depth;
+
+      if (is_ring_row && is_ring_column) continue;
+      if (is_ring_row || is_ring_column) {
+        p[index] = beta * p[index] + r[index] - alpha * w[index];
+      } else {
+        u[index] += alpha * p[index];
+        r[index] -= alpha * w[index];
+        p[index] = beta * p[index] + r[index];
+      }
+    }
+  }
+
+  cg_fused_calc_w<Index>(x, y, halo_depth, dots, p, r, w, kx, ky);
+#else
+  const int rows = y - 2 * halo_depth;
+  double rr_temp = 0.0;
+  double pw_temp = 0.0;
+  double rw_temp = 0.0;
+  double ww_temp = 0.0;
+
+  #pragma omp parallel reduction(+ : rr_temp, pw_temp, rw_temp, ww_temp)
+  {
+    const int num_threads = omp_get_num_threads();
+    const int thread = omp_get_thread_num();
+    const int j_min = halo_depth + (rows * thread) / num_threads;
+    const int j_max = halo_depth + (rows * (thread + 1)) / num_threads;
+
+    // The rows next to another thread's block, and the halo ring at either end, are updated before any matvec
+    if (j_min < j_max) {
+      if (j_min == halo_depth) cg_fused_update_row<Index>(x, y, halo_depth, halo_depth - 1, alpha, beta, u, p, r, w);
+      if (j_max == y - halo_depth) cg_fused_update_row<Index>(x, y, halo_depth, y - halo_depth, alpha, beta, u, p, r, w);
+      cg_fused_update_row<Index>(x, y, halo_depth, j_min, alpha, beta, u, p, r, w);
+      if (j_max - 1 > j_min) cg_fused_update_row<Index>(x, y, halo_depth, j_max - 1, alpha, beta, u, p, r, w);
+    }
+
+    #pragma omp barrier
+
+    double thread_dots[4] = {0.0, 0.0, 0.0, 0.0};
+
+    for (Index jj = j_min; jj < j_max; ++jj) {
+      if (jj + 1 < j_max - 1) cg_fused_update_row<Index>(x, y, halo_depth, jj + 1, alpha, beta, u, p, r, w);
+      cg_fused_calc_w_row<Index>(x, halo_depth, jj, thread_dots, p, r, w, kx, ky);
+    }
+
+    rr_temp += thread_dots[0];
+    pw_temp += thread_dots[1];
+    rw_temp += thread_dots[2];
+    ww_temp += thread_dots[3];
+  }
+
+  dots[0] += rr_temp;
+  dots[1] += pw_temp;
+  dots[2] += rw_temp;
+  dots[3] += ww_temp;
+#endif
+}
+
+// Starts a mixed precision CG inner solve of Ae = r from e = 0, the coefficients, r and the correction e are held in single
+// precision, p stays in double precision so that it can be exchanged with the other fields
+template <typename Index>
+void mixed_cg_init(const int x, const int y, const int halo_depth, double *rro, const double *r, double *p, const double *kx,
+                   const double *ky, float *u_float, float *r_float, float *kx_float, float *ky_float) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = 0; jj < y; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      const Index index = kk + jj * x;
+      kx_float[index] = static_cast<float>(kx[index]);
+      ky_float[index] = static_cast<float>(ky[index]);
+    }
+  }
+
+  double rro_temp = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : rro_temp) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : rro_temp)
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      u_float[index] = 0.0f;
+      r_float[index] = static_cast<float>(r[index]);
+      p[index] = r_float[index];
+      rro_temp += p[index] * p[index];
+    }
+  }
+
+  *rro += rro_temp;
+}
+
+// Calculates w = Ap with the single precision coefficients
+template <typename Index>
+void mixed_cg_calc_w(const int x, const int y, const int halo_depth, double *pw, const double *p, float *w_float, const float *kx,
+                     const float *ky) {
+  double pw_temp = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : pw_temp) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : pw_temp)
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const float smvp = tealeaf_SMVP(p);
+      w_float[index] = smvp;
+      pw_temp += smvp * p[index];
+    }
+  }
+
+  *pw += pw_temp;
+}
+
+// Calculates the single precision correction and residual
+template <typename Index>
+void mixed_cg_calc_ur(const int x, const int y, const int halo_depth, const double alpha, double *rrn, float *u_float, const double *p,
+                      float *r_float, const float *w_float) {
+  double rrn_temp = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : rrn_temp) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : rrn_temp)
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+
+      u_float[index] += static_cast<float>(alpha * p[index]);
+      r_float[index] -= static_cast<float>(alpha * w_float[index]);
+      rrn_temp += static_cast<double>(r_float[index]) * r_float[index];
+    }
+  }
+
+  *rrn += rrn_temp;
+}
+
+// Calculates p from the single precision residual
+template <typename Index>
+void mixed_cg_calc_p(const int x, const int y, const int halo_depth, const double beta, double *p, const float *r_float) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+
+      p[index] = beta * p[index] + r_float[index];
+    }
+  }
+}
+
+// Adds the correction of an inner solve to u in double precision
+template <typename Index> void mixed_cg_correct(const int x, const int y, const int halo_depth, double *u, const float *u_float) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+
+      u[index] += u_float[index];
     }
   }
 }
@@ -136,25 +770,199 @@ void cg_calc_p(const int x, const int y, const int halo_depth, const double beta
 // CG solver kernels
 void run_cg_init(Chunk *chunk, Settings &settings, double rx, double ry, double *rro) {
   START_PROFILING(settings.kernel_profile);
-  cg_init(chunk->x, chunk->y, settings.halo_depth, settings.coefficient, rx, ry, rro, chunk->density, chunk->energy, chunk->u, chunk->p,
-          chunk->r, chunk->w, chunk->kx, chunk->ky);
+  tealeaf_VALUE_DISPATCH(settings, chunk, cg_init, chunk->x, chunk->y, settings.halo_depth, settings.coefficient, rx, ry,
+                         settings.float_coefficients, rro, chunk->density, chunk->energy, fields.u, fields.p, fields.r, fields.w, fields.kx,
+                         fields.ky);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_cg_calc_w(Chunk *chunk, Settings &settings, double *pw) {
   START_PROFILING(settings.kernel_profile);
-  cg_calc_w(chunk->x, chunk->y, settings.halo_depth, pw, chunk->p, chunk->w, chunk->kx, chunk->ky);
+  if (settings.interleaved_operator) {
+    tealeaf_INTERLEAVED_DISPATCH(settings, chunk, cg_calc_w_interleaved, chunk->x, chunk->y, settings.halo_depth, pw, chunk->p, chunk->w);
+  } else if (settings.simd_kernels) {
+    tealeaf_DOUBLE_OPERATOR_DISPATCH(settings, chunk, cg_calc_w_simd, chunk->x, chunk->y, settings.halo_depth, pw, chunk->p, chunk->w);
+  } else {
+    tealeaf_OPERATOR_DISPATCH(settings, chunk, cg_calc_w, chunk->x, chunk->y, settings.halo_depth, pw, fields.p, fields.w);
+  }
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_cg_calc_ur(Chunk *chunk, Settings &settings, double alpha, double *rrn) {
   START_PROFILING(settings.kernel_profile);
-  cg_calc_ur(chunk->x, chunk->y, settings.halo_depth, alpha, rrn, chunk->u, chunk->p, chunk->r, chunk->w);
+  if (settings.preconditioner != Preconditioner::NONE) {
+    tealeaf_INDEX_DISPATCH(settings, cg_calc_ur_preconditioned, chunk->x, chunk->y, settings.halo_depth, settings.preconditioner, alpha,
+                           rrn, chunk->u, chunk->p, chunk->r, chunk->w, chunk->z, chunk->kx, chunk->ky, chunk->mi, chunk->cp, chunk->bfp,
+                           chunk->mg_levels, chunk->mg_coarse, chunk->q);
+  } else if (settings.simd_kernels) {
+    tealeaf_INDEX_DISPATCH(settings, cg_calc_ur_simd, chunk->x, chunk->y, settings.halo_depth, alpha, rrn, chunk->u, chunk->p, chunk->r,
+                           chunk->w);
+  } else {
+    tealeaf_VALUE_DISPATCH(settings, chunk, cg_calc_ur, chunk->x, chunk->y, settings.halo_depth, alpha, rrn, fields.u, fields.p,
+                           fields.r, fields.w);
+  }
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_cg_calc_p(Chunk *chunk, Settings &settings, double beta) {
   START_PROFILING(settings.kernel_profile);
-  cg_calc_p(chunk->x, chunk->y, settings.halo_depth, beta, chunk->p, chunk->r);
+  // The preconditioned search direction is built from z rather than r
+  double *r = (settings.preconditioner != Preconditioner::NONE) ? chunk->z : chunk->r;
+  if (settings.simd_kernels) {
+    tealeaf_INDEX_DISPATCH(settings, cg_calc_p_simd, chunk->x, chunk->y, settings.halo_depth, beta, chunk->p, r);
+  } else if (settings.preconditioner != Preconditioner::NONE) {
+    tealeaf_INDEX_DISPATCH(settings, cg_calc_p, chunk->x, chunk->y, settings.halo_depth, beta, chunk->p, r);
+  } else {
+    tealeaf_VALUE_DISPATCH(settings, chunk, cg_calc_p, chunk->x, chunk->y, settings.halo_depth, beta, fields.p, fields.r);
+  }
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_cg_init_preconditioner(Chunk *chunk, Settings &settings, double *rro) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, cg_init_preconditioner, chunk->x, chunk->y, settings.halo_depth, settings.preconditioner,
+                         chunk->neighbours, rro, chunk->r, chunk->p, chunk->z, chunk->kx, chunk->ky, chunk->mi, chunk->cp, chunk->bfp,
+                         chunk->mg_levels, chunk->mg_coarse, chunk->q);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Split CG kernels, the interior runs while the halo exchange is in flight
+void run_cg_calc_w_interior(Chunk *chunk, Settings &settings, double *pw) {
+  START_PROFILING(settings.kernel_profile);
+  const int halo_depth = settings.halo_depth;
+  tealeaf_INDEX_DISPATCH(settings, cg_calc_w_region, chunk->x, halo_depth + 1, chunk->x - halo_depth - 1, halo_depth + 1,
+                         chunk->y - halo_depth - 1, pw, chunk->p, chunk->w, chunk->kx, chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_cg_calc_w_boundary(Chunk *chunk, Settings &settings, double *pw) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, cg_calc_w_boundary, chunk->x, chunk->y, settings.halo_depth, pw, chunk->p, chunk->w, chunk->kx,
+                         chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Pipelined CG solver kernels
+void run_pipelined_cg_calc_w(Chunk *chunk, Settings &settings, double *rr, double *wr) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, pipelined_cg_calc_w, chunk->x, chunk->y, settings.halo_depth, rr, wr, chunk->r, chunk->w, chunk->kx,
+                         chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_pipelined_cg_calc_ur(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, pipelined_cg_calc_ur, chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->u, chunk->p, chunk->r,
+                         chunk->s, chunk->w);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Ghysels pipelined CG solver kernels
+void run_ghysels_cg_calc_q(Chunk *chunk, Settings &settings) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, ghysels_cg_calc_q, chunk->x, chunk->y, settings.halo_depth, chunk->w, chunk->q, chunk->kx, chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_ghysels_cg_calc_urw(Chunk *chunk, Settings &settings, double alpha, double beta, double *rr, double *wr) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, ghysels_cg_calc_urw, chunk->x, chunk->y, settings.halo_depth, alpha, beta, rr, wr, chunk->u, chunk->p,
+                         chunk->r, chunk->s, chunk->w, chunk->z, chunk->q);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Fused CG solver kernels
+void run_cg_fused_calc_w(Chunk *chunk, Settings &settings, double *dots) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, cg_fused_calc_w, chunk->x, chunk->y, settings.halo_depth, dots, chunk->p, chunk->r, chunk->w, chunk->kx,
+                         chunk->ky);
   STOP_PROFILING(settings.kernel_profile, __func__);
-}
\ No newline at end of file
+}
+
+void run_cg_fused_step(Chunk *chunk, Settings &settings, double alpha, double beta, double *dots) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, cg_fused_step, chunk->x, chunk->y, settings.halo_depth, alpha, beta, dots, chunk->u, chunk->p, chunk->r,
+                         chunk->w, chunk->kx, chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Mixed precision CG solver kernels
+void run_mixed_cg_init(Chunk *chunk, Settings &settings, double *rro) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_init, chunk->x, chunk->y, settings.halo_depth, rro, chunk->r, chunk->p, chunk->kx, chunk->ky,
+                         chunk->u_float, chunk->r_float, chunk->kx_float, chunk->ky_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_mixed_cg_calc_w(Chunk *chunk, Settings &settings, double *pw) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_calc_w, chunk->x, chunk->y, settings.halo_depth, pw, chunk->p, chunk->w_float, chunk->kx_float,
+                         chunk->ky_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_mixed_cg_calc_ur(Chunk *chunk, Settings &settings, double alpha, double *rrn) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_calc_ur, chunk->x, chunk->y, settings.halo_depth, alpha, rrn, chunk->u_float, chunk->p,
+                         chunk->r_float, chunk->w_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_mixed_cg_calc_p(Chunk *chunk, Settings &settings, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_calc_p, chunk->x, chunk->y, settings.halo_depth, beta, chunk->p, chunk->r_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_mixed_cg_correct(Chunk *chunk, Settings &settings) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_correct, chunk->x, chunk->y, settings.halo_depth, chunk->u, chunk->u_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Multigrid kernels
+void run_multigrid_smooth(Chunk *chunk, Settings &settings, int level, bool zero_start) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, multigrid_smooth, multigrid_level(chunk, settings.halo_depth, level), 1, zero_start);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_multigrid_restrict(Chunk *chunk, Settings &settings, int level) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, multigrid_restrict, multigrid_level(chunk, settings.halo_depth, level),
+                         multigrid_level(chunk, settings.halo_depth, level + 1), chunk->mg_coarse[level].r);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_multigrid_prolong(Chunk *chunk, Settings &settings, int level) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, multigrid_prolong, multigrid_level(chunk, settings.halo_depth, level),
+                         multigrid_level(chunk, settings.halo_depth, level + 1));
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_multigrid_pack_halo(Chunk *chunk, Settings &settings, int level, int face, bool pack, FieldBufferType buffer) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, multigrid_pack_halo, multigrid_level(chunk, settings.halo_depth, level), face, pack, buffer);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_multigrid_global_operator(Chunk *chunk, Settings &settings, double *diagonal, double *west, double *south) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, multigrid_global_operator, multigrid_level(chunk, settings.halo_depth, chunk->mg_levels), diagonal, west,
+                         south);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_multigrid_copy_coarsest(Chunk *chunk, Settings &settings, bool to_coarse, double *coarse) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, multigrid_copy_coarsest, multigrid_level(chunk, settings.halo_depth, chunk->mg_levels), to_coarse,
+                         coarse);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_mg_calc_u(Chunk *chunk, Settings &settings) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mg_calc_u, chunk->x, chunk->y, settings.halo_depth, chunk->z, chunk->u);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
@@ -1,36 +1,38 @@
 #include "chunk.h"
 #include "shared.h"
+#include <utility>
 
 /*
  *		CHEBYSHEV SOLVER KERNEL
  */
 
 // Calculates the new value for u.
-void cheby_calc_u(const int x, const int y, const int halo_depth, double *u, const double *p) {
+template <typename Index, typename Value> void cheby_calc_u(const int x, const int y, const int halo_depth, Value *u, const Value *p) {
 #ifdef OMP_TARGET
   #pragma omp target teams distribute parallel for simd collapse(2)
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
       u[index] += p[index];
     }
   }
 }
 
 // Initialises the Chebyshev solver
-void cheby_init(const int x, const int y, const int halo_depth, const double theta, double *u, const double *u0, double *p, double *r,
-                double *w, const double *kx, const double *ky) {
+template <typename Index, typename Value>
+void cheby_init(const int x, const int y, const int halo_depth, const double theta, Value *u, const Value *u0, Value *p, Value *r,
+                Value *w, const Value *kx, const Value *ky) {
 #ifdef OMP_TARGET
   #pragma omp target teams distribute parallel for simd collapse(2)
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
       const double smvp = tealeaf_SMVP(u);
       w[index] = smvp;
       r[index] = u0[index] - w[index];
@@ -38,41 +40,214 @@ void cheby_init(const int x, const int y, const int halo_depth, const double the
     }
   }
 
-  cheby_calc_u(x, y, halo_depth, u, p);
+  cheby_calc_u<Index>(x, y, halo_depth, u, p);
 }
 
 // The main chebyshev iteration
-void cheby_iterate(const int x, const int y, const int halo_depth, double alpha, double beta, double *u, const double *u0, double *p,
-                   double *r, double *w, const double *kx, const double *ky) {
+template <typename Index, typename Value, typename Coefficient, bool StoredDiagonal>
+void cheby_iterate(const int x, const int y, const int halo_depth, double alpha, double beta, Value *u, const Value *u0, Value *p,
+                   Value *r, Value *w, const Coefficient *kx, const Coefficient *ky, const double *diag) {
 #ifdef OMP_TARGET
   #pragma omp target teams distribute parallel for simd collapse(2)
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP_STORED(u);
+      w[index] = smvp;
+      r[index] = u0[index] - w[index];
+      p[index] = alpha * p[index] + beta * r[index];
+    }
+  }
+
+  cheby_calc_u<Index>(x, y, halo_depth, u, p);
+}
+
+// The main chebyshev iteration over the interleaved operator
+template <typename Index, bool StoredDiagonal>
+void cheby_iterate_interleaved(const int x, const int y, const int halo_depth, double alpha, double beta, double *u, const double *u0,
+                               double *p, double *r, double *w, const double *op) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP_INTERLEAVED(u);
+      w[index] = smvp;
+      r[index] = u0[index] - w[index];
+      p[index] = alpha * p[index] + beta * r[index];
+    }
+  }
+
+  cheby_calc_u<Index>(x, y, halo_depth, u, p);
+}
+
+// Calculates w, r and p of the Chebyshev iteration over the cells [x_min, x_max) x [y_min, y_max)
+template <typename Index>
+void cheby_calc_wrp_region(const int x, const int x_min, const int x_max, const int y_min, const int y_max, double alpha, double beta,
+                           const double *u, const double *u0, double *p, double *r, double *w, const double *kx, const double *ky) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = y_min; jj < y_max; ++jj) {
+    for (Index kk = x_min; kk < x_max; ++kk) {
+      const Index index = kk + jj * x;
       const double smvp = tealeaf_SMVP(u);
       w[index] = smvp;
       r[index] = u0[index] - w[index];
       p[index] = alpha * p[index] + beta * r[index];
     }
   }
+}
+
+// Finishes the Chebyshev iteration on the outermost ring of the interior, then updates u everywhere
+template <typename Index>
+void cheby_iterate_boundary(const int x, const int y, const int halo_depth, double alpha, double beta, double *u, const double *u0,
+                            double *p, double *r, double *w, const double *kx, const double *ky) {
+  const int top = tealeaf_MAX(y - halo_depth - 1, halo_depth + 1);
+  const int right = tealeaf_MAX(x - halo_depth - 1, halo_depth + 1);
+  cheby_calc_wrp_region<Index>(x, halo_depth, x - halo_depth, halo_depth, halo_depth + 1, alpha, beta, u, u0, p, r, w, kx, ky);
+  cheby_calc_wrp_region<Index>(x, halo_depth, x - halo_depth, top, y - halo_depth, alpha, beta, u, u0, p, r, w, kx, ky);
+  cheby_calc_wrp_region<Index>(x, halo_depth, halo_depth + 1, halo_depth + 1, y - halo_depth - 1, alpha, beta, u, u0, p, r, w, kx, ky);
+  cheby_calc_wrp_region<Index>(x, right, x - halo_depth, halo_depth + 1, y - halo_depth - 1, alpha, beta, u, u0, p, r, w, kx, ky);
 
-  cheby_calc_u(x, y, halo_depth, u, p);
+  cheby_calc_u<Index>(x, y, halo_depth, u, p);
+}
+
+// Runs the Chebyshev steps of a block on one tile from scratch copies lu and lp of u and p,
+// each step updates the tile grown by the number of steps still to run, and the last step writes the tile back
+template <typename Index>
+static void cheby_iterate_tile(const int x, const BlockedTile &blocked, const int steps, const double *alphas, const double *betas,
+                               const double *u, const double *u0, const double *p, double *u_next, double *p_next, double *r,
+                               const double *kx, const double *ky, double *lu, double *lp) {
+  int lx_min, lx_max, ly_min, ly_max;
+  blocked_tile_region(blocked, steps, 1, &lx_min, &lx_max, &ly_min, &ly_max);
+  const int lx = lx_max - lx_min;
+
+  for (Index jj = ly_min; jj < ly_max; ++jj) {
+    for (Index kk = lx_min; kk < lx_max; ++kk) {
+      const int local = (kk - lx_min) + (jj - ly_min) * lx;
+      lu[local] = u[kk + jj * x];
+      lp[local] = p[kk + jj * x];
+    }
+  }
+
+  for (int ss = 0; ss < steps; ++ss) {
+    int x_min, x_max, y_min, y_max;
+    blocked_tile_region(blocked, steps - 1 - ss, 0, &x_min, &x_max, &y_min, &y_max);
+    reflect_blocked_tile(blocked, lx_min, ly_min, lx, x_min, x_max, y_min, y_max, lu);
+
+    const bool is_last = (ss == steps - 1);
+    for (Index jj = y_min; jj < y_max; ++jj) {
+      for (Index kk = x_min; kk < x_max; ++kk) {
+        const Index index = kk + jj * x;
+        const int local = (kk - lx_min) + (jj - ly_min) * lx;
+        const double smvp = (1.0 + (kx[index + 1] + kx[index]) + (ky[index + x] + ky[index])) * lu[local] -
+                            (kx[index + 1] * lu[local + 1] + kx[index] * lu[local - 1]) -
+                            (ky[index + x] * lu[local + lx] + ky[index] * lu[local - lx]);
+        const double res = u0[index] - smvp;
+        lp[local] = alphas[ss] * lp[local] + betas[ss] * res;
+        if (is_last) r[index] = res;
+      }
+    }
+
+    for (Index jj = y_min; jj < y_max; ++jj) {
+      for (Index kk = x_min; kk < x_max; ++kk) {
+        const int local = (kk - lx_min) + (jj - ly_min) * lx;
+        lu[local] += lp[local];
+        if (is_last) {
+          u_next[kk + jj * x] = lu[local];
+          p_next[kk + jj * x] = lp[local];
+        }
+      }
+    }
+  }
+}
+
+// Runs steps Chebyshev iterations with the halos of u and p exchanged to that depth, sweeping the interior in tiles that
+// each run all of the steps while they are in cache. The tiles read u and p and write u_next and p_next,
+// so that no tile overwrites the cells another tile still reads.
+template <typename Index>
+void cheby_iterate_blocked(const int x, const int y, const int halo_depth, const int steps, const int tile_size,
+                           const int *chunk_neighbours, const double *alphas, const double *betas, const double *u, const double *u0,
+                           const double *p, double *u_next, double *p_next, double *r, const double *kx, const double *ky) {
+  const int num_tiles = num_blocked_tiles(x, y, halo_depth, tile_size);
+  const int tile_x = (tile_size > 0) ? tealeaf_MIN(tile_size, x - 2 * halo_depth) : x - 2 * halo_depth;
+  const int tile_y = (tile_size > 0) ? tealeaf_MIN(tile_size, y - 2 * halo_depth) : y - 2 * halo_depth;
+  const size_t scratch_len = (tile_x + 2 * steps) * (tile_y + 2 * steps);
+
+#pragma omp parallel
+  {
+    auto *lu = static_cast<double *>(std::malloc(sizeof(double) * scratch_len));
+    auto *lp = static_cast<double *>(std::malloc(sizeof(double) * scratch_len));
+
+#pragma omp for schedule(static)
+    for (int tt = 0; tt < num_tiles; ++tt) {
+      BlockedTile blocked;
+      blocked_tile(x, y, halo_depth, tile_size, chunk_neighbours, tt, &blocked);
+      cheby_iterate_tile<Index>(x, blocked, steps, alphas, betas, u, u0, p, u_next, p_next, r, kx, ky, lu, lp);
+    }
+
+    std::free(lu);
+    std::free(lp);
+  }
 }
 
 // Chebyshev solver kernels
 void run_cheby_init(Chunk *chunk, Settings &settings) {
   START_PROFILING(settings.kernel_profile);
-  cheby_init(chunk->x, chunk->y, settings.halo_depth, chunk->theta, chunk->u, chunk->u0, chunk->p, chunk->r, chunk->w, chunk->kx,
-             chunk->ky);
+  tealeaf_VALUE_DISPATCH(settings, chunk, cheby_init, chunk->x, chunk->y, settings.halo_depth, chunk->theta, fields.u, fields.u0,
+                         fields.p, fields.r, fields.w, fields.kx, fields.ky);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_cheby_iterate(Chunk *chunk, Settings &settings, double alpha, double beta) {
   START_PROFILING(settings.kernel_profile);
-  cheby_iterate(chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->u, chunk->u0, chunk->p, chunk->r, chunk->w, chunk->kx,
-                chunk->ky);
+  if (settings.interleaved_operator) {
+    tealeaf_INTERLEAVED_DISPATCH(settings, chunk, cheby_iterate_interleaved, chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->u,
+                                 chunk->u0, chunk->p, chunk->r, chunk->w);
+  } else {
+    tealeaf_OPERATOR_DISPATCH(settings, chunk, cheby_iterate, chunk->x, chunk->y, settings.halo_depth, alpha, beta, fields.u, fields.u0,
+                              fields.p, fields.r, fields.w);
+  }
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
+
+// Split Chebyshev kernels, the interior runs while the halo exchange is in flight
+void run_cheby_iterate_interior(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  const int halo_depth = settings.halo_depth;
+  tealeaf_INDEX_DISPATCH(settings, cheby_calc_wrp_region, chunk->x, halo_depth + 1, chunk->x - halo_depth - 1, halo_depth + 1,
+                         chunk->y - halo_depth - 1, alpha, beta, chunk->u, chunk->u0, chunk->p, chunk->r, chunk->w, chunk->kx, chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_cheby_iterate_boundary(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, cheby_iterate_boundary, chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->u, chunk->u0,
+                         chunk->p, chunk->r, chunk->w, chunk->kx, chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_cheby_iterate_blocked(Chunk *chunk, Settings &settings, int steps, const double *alphas, const double *betas) {
+#ifdef OMP_TARGET
+  die(__LINE__, __FILE__, "temporal_block_steps > 1 is not implemented for the %s model\n", settings.model_name.c_str());
+#else
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, cheby_iterate_blocked, chunk->x, chunk->y, settings.halo_depth, steps, settings.temporal_block_size,
+                         chunk->neighbours, alphas, betas, chunk->u, chunk->u0, chunk->p, chunk->w, chunk->sd, chunk->r, chunk->kx,
+                         chunk->ky);
+
+  // The new u and p were written to w and sd, which the Chebyshev iteration only uses as scratch
+  std::swap(chunk->u, chunk->w);
+  std::swap(chunk->p, chunk->sd);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+#endif
+}
@@ -7,7 +7,7 @@ void solve(Chunk *chunks, Settings &settings, int tt, double *wallclock_prev);
 
 // An implementation specific overload of the main timestep loop
 bool diffuse_overload(Chunk *chunks, Settings &settings) {
-  int n = chunks->x * chunks->y;
+  int64_t n = static_cast<int64_t>(chunks->x) * chunks->y;
 
   print_and_log(settings, "This implementation overloads the diffuse function.\n");
 
@@ -15,6 +15,9 @@ bool diffuse_overload(Chunk *chunks, Settings &settings) {
   // into local variables for OMP 4.0 to accept them in mapping clauses
   double *r = chunks->r;
   double *sd = chunks->sd;
+  double *s = chunks->s;
+  double *z = chunks->z;
+  double *q = chunks->q;
   double *kx = chunks->kx;
   double *ky = chunks->ky;
   double *w = chunks->w;
@@ -38,18 +41,56 @@ bool diffuse_overload(Chunk *chunks, Settings &settings) {
   double *top_recv = chunks->top_recv;
   double *bottom_send = chunks->bottom_send;
   double *bottom_recv = chunks->bottom_recv;
+  double *bottom_left_send = chunks->bottom_left_send;
+  double *bottom_left_recv = chunks->bottom_left_recv;
+  double *bottom_right_send = chunks->bottom_right_send;
+  double *bottom_right_recv = chunks->bottom_right_recv;
+  double *top_left_send = chunks->top_left_send;
+  double *top_left_recv = chunks->top_left_recv;
+  double *top_right_send = chunks->top_right_send;
+  double *top_right_recv = chunks->top_right_recv;
 
   settings.is_offload = true;
 
   int lr_len = chunks->y * settings.halo_depth * NUM_FIELDS;
   int tb_len = chunks->x * settings.halo_depth * NUM_FIELDS;
+  int corner_len = settings.halo_depth * settings.halo_depth * NUM_FIELDS;
 
   #pragma omp target enter data map(to : r[ : n], sd[ : n], kx[ : n], ky[ : n], w[ : n], p[ : n], cheby_alphas[ : settings.max_iters], \
                                         cheby_betas[ : settings.max_iters], cg_alphas[ : settings.max_iters],                          \
                                         cg_betas[ : settings.max_iters])                                                               \
-      map(to : density[ : n], energy[ : n], density0[ : n], energy0[ : n], u[ : n], u0[ : n]),                                         \
+      map(to : density[ : n], energy[ : n], density0[ : n], energy0[ : n], u[ : n], u0[ : n], s[ : n], z[ : n], q[ : n]),              \
       map(alloc : left_send[ : lr_len], left_recv[ : lr_len], right_send[ : lr_len], right_recv[ : lr_len], top_send[ : tb_len],       \
-              top_recv[ : tb_len], bottom_send[ : tb_len], bottom_recv[ : tb_len])
+              top_recv[ : tb_len], bottom_send[ : tb_len], bottom_recv[ : tb_len])                                                     \
+      map(alloc : bottom_left_send[ : corner_len], bottom_left_recv[ : corner_len], bottom_right_send[ : corner_len],                  \
+              bottom_right_recv[ : corner_len], top_left_send[ : corner_len], top_left_recv[ : corner_len],                            \
+              top_right_send[ : corner_len], top_right_recv[ : corner_len])
+
+  // The stored operator and the single precision vectors are only mapped when the run allocated them
+  double *diag = chunks->diag;
+  float *kx_float = chunks->kx_float;
+  float *ky_float = chunks->ky_float;
+  float *u_float = chunks->u_float;
+  float *r_float = chunks->r_float;
+  float *w_float = chunks->w_float;
+  float *u0_float = chunks->u0_float;
+  float *p_float = chunks->p_float;
+  float *sd_float = chunks->sd_float;
+  double *operator_cells = chunks->operator_cells;
+  double *mi = chunks->mi;
+  double *cp = chunks->cp;
+  double *bfp = chunks->bfp;
+  int64_t diag_len = settings.stored_diagonal ? n : 0;
+  int64_t float_len = (settings.float_coefficients || settings.float_fields || settings.solver == Solver::MIXED_CG_SOLVER) ? n : 0;
+  int64_t mixed_len = (settings.float_fields || settings.solver == Solver::MIXED_CG_SOLVER) ? n : 0;
+  int64_t fields_len = settings.float_fields ? n : 0;
+  int64_t operator_len = settings.interleaved_operator ? n * (settings.stored_diagonal ? 3 : 2) : 0;
+  int64_t mi_len = (settings.preconditioner == Preconditioner::JAC_DIAG) ? n : 0;
+  int64_t block_len = (settings.preconditioner == Preconditioner::JAC_BLOCK) ? n : 0;
+  #pragma omp target enter data map(alloc : diag[ : diag_len], kx_float[ : float_len], ky_float[ : float_len], u_float[ : mixed_len], \
+                                        r_float[ : mixed_len], w_float[ : mixed_len], operator_cells[ : operator_len], mi[ : mi_len],   \
+                                        cp[ : block_len], bfp[ : block_len], u0_float[ : fields_len], p_float[ : fields_len],           \
+                                        sd_float[ : fields_len])
 
   double wallclock_prev = 0.0;
   for (int tt = 0; tt < settings.end_step; ++tt) {
@@ -57,6 +98,8 @@ bool diffuse_overload(Chunk *chunks, Settings &settings) {
   }
 
   #pragma omp target exit data map(from : density[ : n], energy[ : n], density0[ : n], energy0[ : n], u[ : n], u0[ : n])
+  // The final field summary of a float_fields run reads the temperature from u_float
+  #pragma omp target update from(u_float[ : fields_len])
 
   settings.is_offload = false;
 
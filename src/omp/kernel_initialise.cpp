@@ -1,21 +1,63 @@
 #include "kernel_interface.h"
+#include <chrono>
+#include <cstdlib>
 #include <omp.h>
 
 // Allocates, and zeroes and individual buffer
-void allocate_buffer(double **a, int x, int y) {
-  *a = static_cast<double *>(std::malloc(sizeof(double) * x * y));
+template <typename T> static void allocate_buffer(Chunk *chunk, Settings &settings, T **a, int x, int y) {
+  const size_t offset = static_cast<size_t>(chunk->num_buffers++) * chunk->field_stagger;
+  *a = static_cast<T *>(field_alloc(sizeof(T) * x * y, chunk->field_alignment, offset, settings.huge_pages));
   if (*a == nullptr) {
     die(__LINE__, __FILE__, "Error allocating buffer %s\n");
   }
-#pragma omp parallel for
-  for (int jj = 0; jj < y; ++jj) {
-    for (int kk = 0; kk < x; ++kk) {
-      const int index = kk + jj * x;
+
+  // First touch places each page on the NUMA domain of the thread that zeroes it. The interior rows are split with the
+  // static schedule of the kernels' row loops and the halo rows go to the threads of the first and last interior rows.
+  const int64_t halo_depth = (y > 2 * settings.halo_depth) ? settings.halo_depth : 0;
+#pragma omp parallel for schedule(static)
+  for (int64_t jj = halo_depth; jj < y - halo_depth; ++jj) {
+    const int64_t row_min = (jj == halo_depth) ? 0 : jj;
+    const int64_t row_max = (jj == y - halo_depth - 1) ? y : jj + 1;
+    for (int64_t index = row_min * x; index < row_max * x; ++index) {
       (*a)[index] = 0.0;
     }
   }
 }
 
+// Allocates the coarse levels of the multigrid preconditioner, each halves both sides of the interior of the level above.
+// The multigrid kernels only run on the host.
+static void allocate_multigrid(Chunk *chunk, Settings &settings) {
+#ifdef OMP_TARGET
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+#endif
+  // Every chunk takes the levels of the widest and tallest chunks, so the levels of neighbouring chunks line up
+  int x_cells = (settings.grid_x_cells + settings.x_chunks - 1) / settings.x_chunks;
+  int y_cells = (settings.grid_y_cells + settings.y_chunks - 1) / settings.y_chunks;
+  chunk->mg_levels = 0;
+  while ((x_cells > MG_COARSEST_CELLS || y_cells > MG_COARSEST_CELLS) && chunk->mg_levels < MG_MAX_LEVELS) {
+    x_cells = (x_cells + 1) / 2;
+    y_cells = (y_cells + 1) / 2;
+    chunk->mg_levels++;
+  }
+
+  chunk->mg_coarse = static_cast<Chunk *>(std::calloc(chunk->mg_levels, sizeof(Chunk)));
+  x_cells = chunk->x - 2 * settings.halo_depth;
+  y_cells = chunk->y - 2 * settings.halo_depth;
+  for (int ll = 0; ll < chunk->mg_levels; ++ll) {
+    x_cells = (x_cells + 1) / 2;
+    y_cells = (y_cells + 1) / 2;
+    Chunk *coarse = &chunk->mg_coarse[ll];
+    coarse->x = x_cells + 2;
+    coarse->y = y_cells + 2;
+    allocate_buffer(chunk, settings, &(coarse->kx), coarse->x, coarse->y);
+    allocate_buffer(chunk, settings, &(coarse->ky), coarse->x, coarse->y);
+    allocate_buffer(chunk, settings, &(coarse->mi), coarse->x, coarse->y);
+    allocate_buffer(chunk, settings, &(coarse->u), coarse->x, coarse->y);
+    allocate_buffer(chunk, settings, &(coarse->r), coarse->x, coarse->y);
+    allocate_buffer(chunk, settings, &(coarse->w), coarse->x, coarse->y);
+  }
+}
+
 // Initialisation kernels
 void run_set_chunk_data(Chunk *chunk, Settings &settings) {
   double xMin = settings.grid_x_min + settings.dx * (double)chunk->left;
@@ -32,7 +74,7 @@ void run_set_chunk_data(Chunk *chunk, Settings &settings) {
   for (int ii = 0; ii < chunk->y; ++ii) {
     chunk->cell_y[ii] = 0.5 * (chunk->vertex_y[ii] + chunk->vertex_y[ii + 1]);
   }
-  for (int ii = 0; ii < chunk->x * chunk->y; ++ii) {
+  for (int64_t ii = 0; ii < static_cast<int64_t>(chunk->x) * chunk->y; ++ii) {
     chunk->volume[ii] = settings.dx * settings.dy;
     chunk->x_area[ii] = settings.dy;
     chunk->y_area[ii] = settings.dx;
@@ -41,14 +83,14 @@ void run_set_chunk_data(Chunk *chunk, Settings &settings) {
 
 void run_set_chunk_state(Chunk *chunk, Settings &settings, State *states) {
   // Set the initial state
-  for (int ii = 0; ii != chunk->x * chunk->y; ++ii) {
+  for (int64_t ii = 0; ii != static_cast<int64_t>(chunk->x) * chunk->y; ++ii) {
     chunk->energy0[ii] = states[0].energy;
     chunk->density[ii] = states[0].density;
   }
   // Apply all of the states in turn
   for (int ss = 1; ss < settings.num_states; ++ss) {
-    for (int jj = 0; jj < chunk->y; ++jj) {
-      for (int kk = 0; kk < chunk->x; ++kk) {
+    for (int64_t jj = 0; jj < chunk->y; ++jj) {
+      for (int64_t kk = 0; kk < chunk->x; ++kk) {
         int applyState = 0;
 
         if (states[ss].geometry == Geometry::RECTANGULAR) {
@@ -65,7 +107,7 @@ void run_set_chunk_state(Chunk *chunk, Settings &settings, State *states) {
 
         // Check if state applies at this vertex, and apply
         if (applyState) {
-          const int index1 = kk + jj * chunk->x;
+          const int64_t index1 = kk + jj * chunk->x;
           chunk->energy0[index1] = states[ss].energy;
           chunk->density[index1] = states[ss].density;
         }
@@ -74,9 +116,9 @@ void run_set_chunk_state(Chunk *chunk, Settings &settings, State *states) {
   }
 
   // Set an initial state for u
-  for (int jj = 1; jj != chunk->y - 1; ++jj) {
-    for (int kk = 1; kk != chunk->x - 1; ++kk) {
-      const int index1 = kk + jj * chunk->x;
+  for (int64_t jj = 1; jj != chunk->y - 1; ++jj) {
+    for (int64_t kk = 1; kk != chunk->x - 1; ++kk) {
+      const int64_t index1 = kk + jj * chunk->x;
       chunk->u[index1] = chunk->energy0[index1] * chunk->density[index1];
     }
   }
@@ -92,7 +134,7 @@ void run_model_info(Settings &settings) {
 #endif
 }
 
-void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len) {
+void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len, int comms_corner_len) {
 
 #ifdef OMP_TARGET
   int count = omp_get_num_devices();
@@ -115,81 +157,266 @@ void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, i
 #endif
   }
 
-  allocate_buffer(&(chunk->density0), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->density), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->energy0), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->energy), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->u), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->u0), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->p), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->r), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->mi), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->w), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->kx), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->ky), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->sd), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->volume), chunk->x, chunk->y);
-  allocate_buffer(&(chunk->x_area), chunk->x + 1, chunk->y);
-  allocate_buffer(&(chunk->y_area), chunk->x, chunk->y + 1);
-  allocate_buffer(&(chunk->cell_x), chunk->x, 1);
-  allocate_buffer(&(chunk->cell_y), 1, chunk->y);
-  allocate_buffer(&(chunk->cell_dx), chunk->x, 1);
-  allocate_buffer(&(chunk->cell_dy), 1, chunk->y);
-  allocate_buffer(&(chunk->vertex_dx), chunk->x + 1, 1);
-  allocate_buffer(&(chunk->vertex_dy), 1, chunk->y + 1);
-  allocate_buffer(&(chunk->vertex_x), chunk->x + 1, 1);
-  allocate_buffer(&(chunk->vertex_y), 1, chunk->y + 1);
-  allocate_buffer(&(chunk->cg_alphas), settings.max_iters, 1);
-  allocate_buffer(&(chunk->cg_betas), settings.max_iters, 1);
-  allocate_buffer(&(chunk->cheby_alphas), settings.max_iters, 1);
-  allocate_buffer(&(chunk->cheby_betas), settings.max_iters, 1);
-
-  allocate_buffer(&(chunk->left_send), comms_lr_len, 1);
-  allocate_buffer(&(chunk->left_recv), comms_lr_len, 1);
-  allocate_buffer(&(chunk->right_send), comms_lr_len, 1);
-  allocate_buffer(&(chunk->right_recv), comms_lr_len, 1);
-  allocate_buffer(&(chunk->top_send), comms_tb_len, 1);
-  allocate_buffer(&(chunk->top_recv), comms_tb_len, 1);
-  allocate_buffer(&(chunk->bottom_send), comms_tb_len, 1);
-  allocate_buffer(&(chunk->bottom_recv), comms_tb_len, 1); //
+  allocate_buffer(chunk, settings, &(chunk->density0), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->density), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->energy0), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->energy), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->u), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->u0), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->p), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->r), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->mi), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->w), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->kx), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->ky), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->sd), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->s), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->z), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->q), chunk->x, chunk->y);
+
+  // The stored operator and the single precision vectors are only allocated when the run selects them
+  chunk->diag = nullptr;
+  chunk->kx_float = nullptr;
+  chunk->ky_float = nullptr;
+  chunk->u_float = nullptr;
+  chunk->r_float = nullptr;
+  chunk->w_float = nullptr;
+  chunk->u0_float = nullptr;
+  chunk->p_float = nullptr;
+  chunk->sd_float = nullptr;
+  chunk->operator_cells = nullptr;
+  chunk->cp = nullptr;
+  chunk->bfp = nullptr;
+  chunk->mg_levels = 0;
+  chunk->mg_coarse = nullptr;
+  if (settings.stored_diagonal) {
+    allocate_buffer(chunk, settings, &(chunk->diag), chunk->x, chunk->y);
+  }
+  if (settings.float_coefficients || settings.float_fields || settings.solver == Solver::MIXED_CG_SOLVER) {
+    allocate_buffer(chunk, settings, &(chunk->kx_float), chunk->x, chunk->y);
+    allocate_buffer(chunk, settings, &(chunk->ky_float), chunk->x, chunk->y);
+  }
+  if (settings.preconditioner == Preconditioner::JAC_BLOCK) {
+    allocate_buffer(chunk, settings, &(chunk->cp), chunk->x, chunk->y);
+    allocate_buffer(chunk, settings, &(chunk->bfp), chunk->x, chunk->y);
+  }
+  if (settings.preconditioner == Preconditioner::MULTIGRID) {
+    allocate_multigrid(chunk, settings);
+  }
+  if (settings.interleaved_operator) {
+    allocate_buffer(chunk, settings, &(chunk->operator_cells), chunk->x * (settings.stored_diagonal ? 3 : 2), chunk->y);
+  }
+  if (settings.float_fields || settings.solver == Solver::MIXED_CG_SOLVER) {
+    allocate_buffer(chunk, settings, &(chunk->u_float), chunk->x, chunk->y);
+    allocate_buffer(chunk, settings, &(chunk->r_float), chunk->x, chunk->y);
+    allocate_buffer(chunk, settings, &(chunk->w_float), chunk->x, chunk->y);
+  }
+  if (settings.float_fields) {
+    allocate_buffer(chunk, settings, &(chunk->u0_float), chunk->x, chunk->y);
+    allocate_buffer(chunk, settings, &(chunk->p_float), chunk->x, chunk->y);
+    allocate_buffer(chunk, settings, &(chunk->sd_float), chunk->x, chunk->y);
+  }
+
+  allocate_buffer(chunk, settings, &(chunk->volume), chunk->x, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->x_area), chunk->x + 1, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->y_area), chunk->x, chunk->y + 1);
+  allocate_buffer(chunk, settings, &(chunk->cell_x), chunk->x, 1);
+  allocate_buffer(chunk, settings, &(chunk->cell_y), 1, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->cell_dx), chunk->x, 1);
+  allocate_buffer(chunk, settings, &(chunk->cell_dy), 1, chunk->y);
+  allocate_buffer(chunk, settings, &(chunk->vertex_dx), chunk->x + 1, 1);
+  allocate_buffer(chunk, settings, &(chunk->vertex_dy), 1, chunk->y + 1);
+  allocate_buffer(chunk, settings, &(chunk->vertex_x), chunk->x + 1, 1);
+  allocate_buffer(chunk, settings, &(chunk->vertex_y), 1, chunk->y + 1);
+  allocate_buffer(chunk, settings, &(chunk->cg_alphas), settings.max_iters, 1);
+  allocate_buffer(chunk, settings, &(chunk->cg_betas), settings.max_iters, 1);
+  allocate_buffer(chunk, settings, &(chunk->cheby_alphas), settings.max_iters, 1);
+  allocate_buffer(chunk, settings, &(chunk->cheby_betas), settings.max_iters, 1);
+
+  allocate_buffer(chunk, settings, &(chunk->left_send), comms_lr_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->left_recv), comms_lr_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->right_send), comms_lr_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->right_recv), comms_lr_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->top_send), comms_tb_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->top_recv), comms_tb_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->bottom_send), comms_tb_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->bottom_recv), comms_tb_len, 1); //
+  allocate_buffer(chunk, settings, &(chunk->bottom_left_send), comms_corner_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->bottom_left_recv), comms_corner_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->bottom_right_send), comms_corner_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->bottom_right_recv), comms_corner_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->top_left_send), comms_corner_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->top_left_recv), comms_corner_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->top_right_send), comms_corner_len, 1);
+  allocate_buffer(chunk, settings, &(chunk->top_right_recv), comms_corner_len, 1);
 }
 
 void run_kernel_finalise(Chunk *chunk, Settings &) {
-  std::free(chunk->density0);
-  std::free(chunk->density);
-  std::free(chunk->energy0);
-  std::free(chunk->energy);
-  std::free(chunk->u);
-  std::free(chunk->u0);
-  std::free(chunk->p);
-  std::free(chunk->r);
-  std::free(chunk->mi);
-  std::free(chunk->w);
-  std::free(chunk->kx);
-  std::free(chunk->ky);
-  std::free(chunk->sd);
-  std::free(chunk->volume);
-  std::free(chunk->x_area);
-  std::free(chunk->y_area);
-  std::free(chunk->cell_x);
-  std::free(chunk->cell_y);
-  std::free(chunk->cell_dx);
-  std::free(chunk->cell_dy);
-  std::free(chunk->vertex_dx);
-  std::free(chunk->vertex_dy);
-  std::free(chunk->vertex_x);
-  std::free(chunk->vertex_y);
-  std::free(chunk->cg_alphas);
-  std::free(chunk->cg_betas);
-  std::free(chunk->cheby_alphas);
-  std::free(chunk->cheby_betas);
-
-  std::free(chunk->left_send);
-  std::free(chunk->left_recv);
-  std::free(chunk->right_send);
-  std::free(chunk->right_recv);
-  std::free(chunk->top_send);
-  std::free(chunk->top_recv);
-  std::free(chunk->bottom_send);
-  std::free(chunk->bottom_recv);
+  field_free(chunk->density0);
+  field_free(chunk->density);
+  field_free(chunk->energy0);
+  field_free(chunk->energy);
+  field_free(chunk->u);
+  field_free(chunk->u0);
+  field_free(chunk->p);
+  field_free(chunk->r);
+  field_free(chunk->mi);
+  field_free(chunk->w);
+  field_free(chunk->kx);
+  field_free(chunk->ky);
+  field_free(chunk->sd);
+  field_free(chunk->s);
+  field_free(chunk->z);
+  field_free(chunk->q);
+  field_free(chunk->diag);
+  field_free(chunk->kx_float);
+  field_free(chunk->ky_float);
+  field_free(chunk->u_float);
+  field_free(chunk->r_float);
+  field_free(chunk->w_float);
+  field_free(chunk->u0_float);
+  field_free(chunk->p_float);
+  field_free(chunk->sd_float);
+  field_free(chunk->operator_cells);
+  field_free(chunk->cp);
+  field_free(chunk->bfp);
+  for (int ll = 0; ll < chunk->mg_levels; ++ll) {
+    field_free(chunk->mg_coarse[ll].kx);
+    field_free(chunk->mg_coarse[ll].ky);
+    field_free(chunk->mg_coarse[ll].mi);
+    field_free(chunk->mg_coarse[ll].u);
+    field_free(chunk->mg_coarse[ll].r);
+    field_free(chunk->mg_coarse[ll].w);
+  }
+  std::free(chunk->mg_coarse);
+  field_free(chunk->volume);
+  field_free(chunk->x_area);
+  field_free(chunk->y_area);
+  field_free(chunk->cell_x);
+  field_free(chunk->cell_y);
+  field_free(chunk->cell_dx);
+  field_free(chunk->cell_dy);
+  field_free(chunk->vertex_dx);
+  field_free(chunk->vertex_dy);
+  field_free(chunk->vertex_x);
+  field_free(chunk->vertex_y);
+  field_free(chunk->cg_alphas);
+  field_free(chunk->cg_betas);
+  field_free(chunk->cheby_alphas);
+  field_free(chunk->cheby_betas);
+
+  field_free(chunk->left_send);
+  field_free(chunk->left_recv);
+  field_free(chunk->right_send);
+  field_free(chunk->right_recv);
+  field_free(chunk->top_send);
+  field_free(chunk->top_recv);
+  field_free(chunk->bottom_send);
+  field_free(chunk->bottom_recv);
+  field_free(chunk->bottom_left_send);
+  field_free(chunk->bottom_left_recv);
+  field_free(chunk->bottom_right_send);
+  field_free(chunk->bottom_right_recv);
+  field_free(chunk->top_left_send);
+  field_free(chunk->top_left_recv);
+  field_free(chunk->top_right_send);
+  field_free(chunk->top_right_recv);
+}
+
+// Times the STREAM copy, scale and triad kernels and the 5-point matvec over x by y buffers allocated and first touched
+// like the fields, keeping the best time of each kernel in seconds. Target offload maps the buffers to the device first.
+void run_calibrate(Chunk *chunk, Settings &settings, int x, int y, double *seconds) {
+  double *a, *b, *c, *w;
+  allocate_buffer(chunk, settings, &a, x, y);
+  allocate_buffer(chunk, settings, &b, x, y);
+  allocate_buffer(chunk, settings, &c, x, y);
+  allocate_buffer(chunk, settings, &w, x, y);
+
+  const int64_t cells = static_cast<int64_t>(x) * y;
+  const double scalar = 3.0;
+#ifdef OMP_TARGET
+  #pragma omp target enter data map(to : a[ : cells], b[ : cells], c[ : cells], w[ : cells])
+#endif
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd
+#else
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int64_t ii = 0; ii < cells; ++ii) {
+    a[ii] = 1.0;
+    b[ii] = 2.0;
+  }
+
+  for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+    seconds[kk] = 0.0;
+  }
+
+  for (int rep = 0; rep < CALIBRATE_REPEATS; ++rep) {
+    double elapsed[NUM_CALIBRATE_KERNELS];
+    auto start = std::chrono::steady_clock::now();
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd
+#else
+  #pragma omp parallel for schedule(static)
+#endif
+    for (int64_t ii = 0; ii < cells; ++ii) {
+      c[ii] = a[ii];
+    }
+    auto end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_COPY] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd
+#else
+  #pragma omp parallel for schedule(static)
+#endif
+    for (int64_t ii = 0; ii < cells; ++ii) {
+      b[ii] = scalar * c[ii];
+    }
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_SCALE] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd
+#else
+  #pragma omp parallel for schedule(static)
+#endif
+    for (int64_t ii = 0; ii < cells; ++ii) {
+      a[ii] = b[ii] + scalar * c[ii];
+    }
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_TRIAD] = std::chrono::duration<double>(end - start).count();
+
+    // The matvec of the solvers with a as the vector and b and c as the coefficients
+    const double *kx = b;
+    const double *ky = c;
+    start = std::chrono::steady_clock::now();
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for schedule(static)
+#endif
+    for (int64_t jj = 1; jj < y - 1; ++jj) {
+      for (int64_t kk = 1; kk < x - 1; ++kk) {
+        const int64_t index = kk + jj * x;
+        w[index] = tealeaf_SMVP(a);
+      }
+    }
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_STENCIL] = std::chrono::duration<double>(end - start).count();
+
+    for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+      if (rep == 0 || elapsed[kk] < seconds[kk]) seconds[kk] = elapsed[kk];
+    }
+  }
+
+#ifdef OMP_TARGET
+  #pragma omp target exit data map(release : a[ : cells], b[ : cells], c[ : cells], w[ : cells])
+#endif
+  field_free(a);
+  field_free(b);
+  field_free(c);
+  field_free(w);
 }
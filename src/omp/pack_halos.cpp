@@ -3,7 +3,8 @@
 #include "shared.h"
 
 // Packs left data into buffer.
-void pack_left(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int offset,
+template <typename Index, typename Value>
+void pack_left(const int x, const int y, const int depth, const int halo_depth, const Value *field, double *buffer, int offset,
                bool is_offload) {
   const int y_inner = y - 2 * halo_depth;
 #ifdef OMP_TARGET
@@ -11,8 +12,8 @@ void pack_left(const int x, const int y, const int depth, const int halo_depth,
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < halo_depth + depth; ++kk) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < halo_depth + depth; ++kk) {
       int bufIndex = (kk - halo_depth) + (jj - halo_depth) * depth;
       buffer[bufIndex + offset] = field[jj * x + kk];
     }
@@ -20,7 +21,8 @@ void pack_left(const int x, const int y, const int depth, const int halo_depth,
 }
 
 // Packs right data into buffer.
-void pack_right(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int offset,
+template <typename Index, typename Value>
+void pack_right(const int x, const int y, const int depth, const int halo_depth, const Value *field, double *buffer, int offset,
                 bool is_offload) {
   const int y_inner = y - 2 * halo_depth;
 
@@ -29,8 +31,8 @@ void pack_right(const int x, const int y, const int depth, const int halo_depth,
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = x - halo_depth - depth; kk < x - halo_depth; ++kk) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = x - halo_depth - depth; kk < x - halo_depth; ++kk) {
       int bufIndex = (kk - (x - halo_depth - depth)) + (jj - halo_depth) * depth;
       buffer[bufIndex + offset] = field[jj * x + kk];
     }
@@ -38,43 +40,42 @@ void pack_right(const int x, const int y, const int depth, const int halo_depth,
 }
 
 // Packs top data into buffer.
-void pack_top(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int offset,
+template <typename Index, typename Value>
+void pack_top(const int x, const int y, const int depth, const int halo_depth, const Value *field, double *buffer, int offset,
               bool is_offload) {
-  const int x_inner = x - 2 * halo_depth;
-
 #ifdef OMP_TARGET
-  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload) // map(from : buffer[ : depth * x_inner])
+  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload) // map(from : buffer[ : depth * x])
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = y - halo_depth - depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      int bufIndex = (kk - halo_depth) + (jj - (y - halo_depth - depth)) * x_inner;
+  for (Index jj = y - halo_depth - depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      int bufIndex = kk + (jj - (y - halo_depth - depth)) * x;
       buffer[bufIndex + offset] = field[jj * x + kk];
     }
   }
 }
 
 // Packs bottom data into buffer.
-void pack_bottom(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int offset,
+template <typename Index, typename Value>
+void pack_bottom(const int x, const int y, const int depth, const int halo_depth, const Value *field, double *buffer, int offset,
                  bool is_offload) {
-  const int x_inner = x - 2 * halo_depth;
-
 #ifdef OMP_TARGET
-  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload) // map(from : buffer[ : depth * x_inner])
+  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload) // map(from : buffer[ : depth * x])
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < halo_depth + depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      int bufIndex = (kk - halo_depth) + (jj - halo_depth) * x_inner;
+  for (Index jj = halo_depth; jj < halo_depth + depth; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      int bufIndex = kk + (jj - halo_depth) * x;
       buffer[bufIndex + offset] = field[jj * x + kk];
     }
   }
 }
 
 // Unpacks left data from buffer.
-void unpack_left(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int offset,
+template <typename Index, typename Value>
+void unpack_left(const int x, const int y, const int depth, const int halo_depth, Value *field, const double *buffer, int offset,
                  bool is_offload) {
   const int y_inner = y - 2 * halo_depth;
 #ifdef OMP_TARGET
@@ -82,8 +83,8 @@ void unpack_left(const int x, const int y, const int depth, const int halo_depth
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth - depth; kk < halo_depth; ++kk) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth - depth; kk < halo_depth; ++kk) {
       int bufIndex = (kk - (halo_depth - depth)) + (jj - halo_depth) * depth;
       field[jj * x + kk] = buffer[bufIndex + offset];
     }
@@ -91,7 +92,8 @@ void unpack_left(const int x, const int y, const int depth, const int halo_depth
 }
 
 // Unpacks right data from buffer.
-void unpack_right(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int offset,
+template <typename Index, typename Value>
+void unpack_right(const int x, const int y, const int depth, const int halo_depth, Value *field, const double *buffer, int offset,
                   bool is_offload) {
   const int y_inner = y - 2 * halo_depth;
 #ifdef OMP_TARGET
@@ -99,8 +101,8 @@ void unpack_right(const int x, const int y, const int depth, const int halo_dept
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = x - halo_depth; kk < x - halo_depth + depth; ++kk) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = x - halo_depth; kk < x - halo_depth + depth; ++kk) {
       int bufIndex = (kk - (x - halo_depth)) + (jj - halo_depth) * depth;
       field[jj * x + kk] = buffer[bufIndex + offset];
     }
@@ -108,63 +110,109 @@ void unpack_right(const int x, const int y, const int depth, const int halo_dept
 }
 
 // Unpacks top data from buffer.
-void unpack_top(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int offset,
+template <typename Index, typename Value>
+void unpack_top(const int x, const int y, const int depth, const int halo_depth, Value *field, const double *buffer, int offset,
                 bool is_offload) {
-  const int x_inner = x - 2 * halo_depth;
 #ifdef OMP_TARGET
-  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload) // map(to : buffer[ : depth * x_inner])
+  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload) // map(to : buffer[ : depth * x])
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = y - halo_depth; jj < y - halo_depth + depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      int bufIndex = (kk - halo_depth) + (jj - (y - halo_depth)) * x_inner;
+  for (Index jj = y - halo_depth; jj < y - halo_depth + depth; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      int bufIndex = kk + (jj - (y - halo_depth)) * x;
       field[jj * x + kk] = buffer[bufIndex + offset];
     }
   }
 }
 
 // Unpacks bottom data from buffer.
-void unpack_bottom(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int offset,
+template <typename Index, typename Value>
+void unpack_bottom(const int x, const int y, const int depth, const int halo_depth, Value *field, const double *buffer, int offset,
                    bool is_offload) {
-  const int x_inner = x - 2 * halo_depth;
 #ifdef OMP_TARGET
-  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload) // map(to : buffer[ : depth * x_inner])
+  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload) // map(to : buffer[ : depth * x])
 #else
   #pragma omp parallel for
 #endif
-  for (int jj = halo_depth - depth; jj < halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      int bufIndex = (kk - halo_depth) + (jj - (halo_depth - depth)) * x_inner;
+  for (Index jj = halo_depth - depth; jj < halo_depth; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      int bufIndex = kk + (jj - (halo_depth - depth)) * x;
+      field[jj * x + kk] = buffer[bufIndex + offset];
+    }
+  }
+}
+
+// Packs the corner block whose lower left cell is (col, row) into buffer.
+template <typename Index, typename Value>
+void pack_corner(const int x, const int depth, const int col, const int row, const Value *field, double *buffer, int offset,
+                 bool is_offload) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = row; jj < row + depth; ++jj) {
+    for (Index kk = col; kk < col + depth; ++kk) {
+      int bufIndex = (kk - col) + (jj - row) * depth;
+      buffer[bufIndex + offset] = field[jj * x + kk];
+    }
+  }
+}
+
+// Unpacks the corner block whose lower left cell is (col, row) from buffer.
+template <typename Index, typename Value>
+void unpack_corner(const int x, const int depth, const int col, const int row, Value *field, const double *buffer, int offset,
+                   bool is_offload) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2) if (is_offload)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = row; jj < row + depth; ++jj) {
+    for (Index kk = col; kk < col + depth; ++kk) {
+      int bufIndex = (kk - col) + (jj - row) * depth;
       field[jj * x + kk] = buffer[bufIndex + offset];
     }
   }
 }
 
 // Either packs or unpacks data from/to buffers.
-void pack_or_unpack(const int x, const int y, const int depth, const int halo_depth, const int face, bool pack, double *field,
+template <typename Index, typename Value>
+void pack_or_unpack(const int x, const int y, const int depth, const int halo_depth, const int face, bool pack, Value *field,
                     double *buffer, int offset, bool is_offload) {
   switch (face) {
     case CHUNK_LEFT:
-      if (pack) pack_left(x, y, depth, halo_depth, field, buffer, offset, is_offload);
+      if (pack) pack_left<Index>(x, y, depth, halo_depth, field, buffer, offset, is_offload);
       else
-        unpack_left(x, y, depth, halo_depth, field, buffer, offset, is_offload);
+        unpack_left<Index>(x, y, depth, halo_depth, field, buffer, offset, is_offload);
       break;
     case CHUNK_RIGHT:
-      if (pack) pack_right(x, y, depth, halo_depth, field, buffer, offset, is_offload);
+      if (pack) pack_right<Index>(x, y, depth, halo_depth, field, buffer, offset, is_offload);
       else
-        unpack_right(x, y, depth, halo_depth, field, buffer, offset, is_offload);
+        unpack_right<Index>(x, y, depth, halo_depth, field, buffer, offset, is_offload);
       break;
     case CHUNK_TOP:
-      if (pack) pack_top(x, y, depth, halo_depth, field, buffer, offset, is_offload);
+      if (pack) pack_top<Index>(x, y, depth, halo_depth, field, buffer, offset, is_offload);
       else
-        unpack_top(x, y, depth, halo_depth, field, buffer, offset, is_offload);
+        unpack_top<Index>(x, y, depth, halo_depth, field, buffer, offset, is_offload);
       break;
     case CHUNK_BOTTOM:
-      if (pack) pack_bottom(x, y, depth, halo_depth, field, buffer, offset, is_offload);
+      if (pack) pack_bottom<Index>(x, y, depth, halo_depth, field, buffer, offset, is_offload);
       else
-        unpack_bottom(x, y, depth, halo_depth, field, buffer, offset, is_offload);
+        unpack_bottom<Index>(x, y, depth, halo_depth, field, buffer, offset, is_offload);
       break;
+    case CHUNK_BOTTOM_LEFT:
+    case CHUNK_BOTTOM_RIGHT:
+    case CHUNK_TOP_LEFT:
+    case CHUNK_TOP_RIGHT: {
+      int col, row;
+      corner_origin(x, y, depth, halo_depth, face, pack, &col, &row);
+      if (pack) pack_corner<Index>(x, depth, col, row, field, buffer, offset, is_offload);
+      else
+        unpack_corner<Index>(x, depth, col, row, field, buffer, offset, is_offload);
+      break;
+    }
     default: die(__LINE__, __FILE__, "Incorrect face provided: %d.\n", face);
   }
 }
@@ -172,8 +220,72 @@ void pack_or_unpack(const int x, const int y, const int depth, const int halo_de
 void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType field, FieldBufferType buffer,
                         int offset) {
   START_PROFILING(settings.kernel_profile);
-  pack_or_unpack(chunk->x, chunk->y, depth, settings.halo_depth, face, pack, field, buffer, offset, settings.is_offload);
+  // A float_fields solve exchanges its vectors from their single precision copies
+  float *float_copy = settings.float_fields ? float_field(chunk, field) : nullptr;
+  if (float_copy) {
+    tealeaf_INDEX_DISPATCH(settings, pack_or_unpack, chunk->x, chunk->y, depth, settings.halo_depth, face, pack, float_copy, buffer, offset,
+                           settings.is_offload);
+  } else {
+    tealeaf_INDEX_DISPATCH(settings, pack_or_unpack, chunk->x, chunk->y, depth, settings.halo_depth, face, pack, field, buffer, offset,
+                           settings.is_offload);
+  }
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Packs or unpacks the cells [col_min, col_max) of row jj of one field, whose region starts at row_min
+template <typename Index, typename Value>
+void pack_or_unpack_row(const int x, const Index jj, const int col_min, const int col_max, const int row_min, bool pack, Value *field,
+                        double *field_buffer) {
+  const int width = col_max - col_min;
+
+  for (Index kk = col_min; kk < col_max; ++kk) {
+    int bufIndex = (kk - col_min) + (jj - row_min) * width;
+    if (pack) field_buffer[bufIndex] = field[jj * x + kk];
+    else
+      field[jj * x + kk] = field_buffer[bufIndex];
+  }
+}
+
+// Packs or unpacks the face region of every field in one parallel loop, field ff occupies buffer[ff * field_stride, ...).
+// The fields with a single precision copy in float_fields[ff] are exchanged from it.
+template <typename Index>
+void pack_or_unpack_fields(const int x, const int y, const int depth, const int halo_depth, const int face, bool pack,
+                           FieldBufferType *fields, float **float_fields, const int num_fields, FieldBufferType buffer,
+                           const int field_stride) {
+  int col_min, col_max, row_min, row_max;
+  halo_region(x, y, depth, halo_depth, face, pack, &col_min, &col_max, &row_min, &row_max);
+
+#pragma omp parallel for collapse(2)
+  for (int ff = 0; ff < num_fields; ++ff) {
+    for (Index jj = row_min; jj < row_max; ++jj) {
+      double *field_buffer = buffer + ff * field_stride;
+      if (float_fields[ff]) {
+        pack_or_unpack_row<Index>(x, jj, col_min, col_max, row_min, pack, float_fields[ff], field_buffer);
+      } else {
+        pack_or_unpack_row<Index>(x, jj, col_min, col_max, row_min, pack, fields[ff], field_buffer);
+      }
+    }
+  }
+}
+
+void run_pack_or_unpack_fields(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType *fields, int num_fields,
+                               FieldBufferType buffer, int field_stride) {
+#ifdef OMP_TARGET
+  // The array of field pointers cannot be mapped to the device, so each field is packed by its own kernel
+  for (int ff = 0; ff < num_fields; ++ff) {
+    run_pack_or_unpack(chunk, settings, depth, face, pack, fields[ff], buffer, ff * field_stride);
+  }
+#else
+  START_PROFILING(settings.kernel_profile);
+  // A float_fields solve exchanges its vectors from their single precision copies
+  float *float_fields[NUM_FIELDS];
+  for (int ff = 0; ff < num_fields; ++ff) {
+    float_fields[ff] = settings.float_fields ? float_field(chunk, fields[ff]) : nullptr;
+  }
+  tealeaf_INDEX_DISPATCH(settings, pack_or_unpack_fields, chunk->x, chunk->y, depth, settings.halo_depth, face, pack, fields, float_fields,
+                         num_fields, buffer, field_stride);
   STOP_PROFILING(settings.kernel_profile, __func__);
+#endif
 }
 
 void run_send_recv_halo(Chunk *chunk, Settings &settings,                                 //
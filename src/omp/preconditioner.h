@@ -0,0 +1,391 @@
+#pragma once
+
+#include "chunk.h"
+#include "settings.h"
+#include "shared.h"
+
+/*
+ *		PRECONDITIONER KERNELS
+ */
+
+// Calculates the inverse diagonal of the operator for the diagonal Jacobi preconditioner
+template <typename Index>
+void jacobi_diag_init(const int x, const int y, const int halo_depth, const double *kx, const double *ky, double *mi) {
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      mi[index] = 1.0 / (1.0 + (kx[index + 1] + kx[index]) + (ky[index + x] + ky[index]));
+    }
+  }
+}
+
+// Factorises the tridiagonal blocks of the block Jacobi preconditioner, each block couples JAC_BLOCK_SIZE cells of a
+// column through ky and drops the coupling to the cells above and below the block. Every column of every block is
+// solved independently, which gives the offload targets a thread per column.
+template <typename Index>
+void jacobi_block_init(const int x, const int y, const int halo_depth, const double *kx, const double *ky, double *cp, double *bfp) {
+  const Index num_blocks = (y - 2 * halo_depth + JAC_BLOCK_SIZE - 1) / JAC_BLOCK_SIZE;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd collapse(2)
+#else
+  #pragma omp parallel for
+#endif
+  for (Index bb = 0; bb < num_blocks; ++bb) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index bottom = halo_depth + bb * JAC_BLOCK_SIZE;
+      const Index top = tealeaf_MIN(bottom + JAC_BLOCK_SIZE, static_cast<Index>(y - halo_depth));
+      for (Index jj = bottom; jj < top; ++jj) {
+        const Index index = kk + jj * x;
+        const double diagonal = 1.0 + (kx[index + 1] + kx[index]) + (ky[index + x] + ky[index]);
+        bfp[index] = 1.0 / ((jj == bottom) ? diagonal : diagonal + ky[index] * cp[index - x]);
+        cp[index] = -ky[index + x] * bfp[index];
+      }
+    }
+  }
+}
+
+// Solves z = M^-1 r with the block Jacobi preconditioner and returns r.z
+template <typename Index>
+double jacobi_block_solve(const int x, const int y, const int halo_depth, const double *ky, const double *r, double *z, const double *cp,
+                          const double *bfp) {
+  const Index num_blocks = (y - 2 * halo_depth + JAC_BLOCK_SIZE - 1) / JAC_BLOCK_SIZE;
+  double rz = 0.0;
+
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : rz) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : rz)
+#endif
+  for (Index bb = 0; bb < num_blocks; ++bb) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index bottom = halo_depth + bb * JAC_BLOCK_SIZE;
+      const Index top = tealeaf_MIN(bottom + JAC_BLOCK_SIZE, static_cast<Index>(y - halo_depth));
+
+      // Forward elimination
+      z[kk + bottom * x] = r[kk + bottom * x] * bfp[kk + bottom * x];
+      for (Index jj = bottom + 1; jj < top; ++jj) {
+        const Index index = kk + jj * x;
+        z[index] = (r[index] + ky[index] * z[index - x]) * bfp[index];
+      }
+
+      // Back substitution
+      rz += r[kk + (top - 1) * x] * z[kk + (top - 1) * x];
+      for (Index jj = top - 2; jj >= bottom; --jj) {
+        const Index index = kk + jj * x;
+        z[index] -= cp[index] * z[index + x];
+        rz += r[index] * z[index];
+      }
+    }
+  }
+
+  return rz;
+}
+
+// Calculates the inverse diagonal of the operator restricted to the chunk for the finest multigrid level. The coupling
+// across an external face is dropped, as the reflective boundary cancels it, while the coupling across an internal face
+// stays on the diagonal as in the block Jacobi preconditioner. The first halo ring of z is cleared, the smoothers read
+// it as the zero correction beyond the chunk.
+template <typename Index>
+void multigrid_diag_init(const int x, const int y, const int halo_depth, const int *chunk_neighbours, const double *kx, const double *ky,
+                         double *mi, double *z) {
+  const bool left = chunk_neighbours[CHUNK_LEFT] == EXTERNAL_FACE;
+  const bool right = chunk_neighbours[CHUNK_RIGHT] == EXTERNAL_FACE;
+  const bool bottom = chunk_neighbours[CHUNK_BOTTOM] == EXTERNAL_FACE;
+  const bool top = chunk_neighbours[CHUNK_TOP] == EXTERNAL_FACE;
+
+  #pragma omp parallel for
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      double diagonal = 1.0 + (kx[index + 1] + kx[index]) + (ky[index + x] + ky[index]);
+      if (left && kk == halo_depth) diagonal -= kx[index];
+      if (right && kk == x - halo_depth - 1) diagonal -= kx[index + 1];
+      if (bottom && jj == halo_depth) diagonal -= ky[index];
+      if (top && jj == y - halo_depth - 1) diagonal -= ky[index + x];
+      mi[index] = 1.0 / diagonal;
+    }
+  }
+
+  for (Index jj = halo_depth - 1; jj < y - halo_depth + 1; ++jj) {
+    z[halo_depth - 1 + jj * x] = 0.0;
+    z[x - halo_depth + jj * x] = 0.0;
+  }
+  for (Index kk = halo_depth - 1; kk < x - halo_depth + 1; ++kk) {
+    z[kk + (halo_depth - 1) * x] = 0.0;
+    z[kk + static_cast<Index>(y - halo_depth) * x] = 0.0;
+  }
+}
+
+// Forms the operator of a coarse level by aggregating the cells of the level above it 2x2, which keeps the Galerkin
+// product R A P of the piecewise constant transfers a five point operator. Coarse levels have a single halo cell.
+template <typename Index>
+void multigrid_coarsen(const int xf, const int yf, const int halo_depth, const double *kxf, const double *kyf, const double *mif,
+                       const int xc, const int yc, double *kxc, double *kyc, double *mic) {
+  #pragma omp parallel for
+  for (Index jc = 1; jc < yc - 1; ++jc) {
+    for (Index kc = 1; kc < xc - 1; ++kc) {
+      const Index kf = halo_depth + 2 * (kc - 1);
+      const Index jf = halo_depth + 2 * (jc - 1);
+      const bool wide = kf + 1 < xf - halo_depth;
+      const bool tall = jf + 1 < yf - halo_depth;
+      const Index f = kf + jf * xf;
+      const Index index = kc + jc * xc;
+
+      double diagonal = 1.0 / mif[f];
+      kxc[index] = kxf[f];
+      kyc[index] = kyf[f];
+      if (wide) {
+        diagonal += 1.0 / mif[f + 1] - 2.0 * kxf[f + 1];
+        kyc[index] += kyf[f + 1];
+      }
+      if (tall) {
+        diagonal += 1.0 / mif[f + xf] - 2.0 * kyf[f + xf];
+        kxc[index] += kxf[f + xf];
+      }
+      if (wide && tall) {
+        diagonal += 1.0 / mif[f + xf + 1] - 2.0 * (kxf[f + xf + 1] + kyf[f + xf + 1]);
+      }
+      mic[index] = 1.0 / diagonal;
+    }
+  }
+
+  // The coupling across the right and top faces of the level, which the V-cycle reads once the halos are exchanged
+  #pragma omp parallel for
+  for (Index jc = 1; jc < yc - 1; ++jc) {
+    const Index jf = halo_depth + 2 * (jc - 1);
+    const Index f = xf - halo_depth + jf * xf;
+    kxc[xc - 1 + jc * xc] = kxf[f] + ((jf + 1 < yf - halo_depth) ? kxf[f + xf] : 0.0);
+  }
+  #pragma omp parallel for
+  for (Index kc = 1; kc < xc - 1; ++kc) {
+    const Index kf = halo_depth + 2 * (kc - 1);
+    const Index f = kf + static_cast<Index>(yf - halo_depth) * xf;
+    kyc[kc + static_cast<Index>(yc - 1) * xc] = kyf[f] + ((kf + 1 < xf - halo_depth) ? kyf[f + 1] : 0.0);
+  }
+}
+
+// A level of the multigrid hierarchy, e approximates the solution of A e = b and t is scratch
+struct MultigridLevel {
+  int x;
+  int y;
+  int halo_depth;
+  const double *kx;
+  const double *ky;
+  const double *mi;
+  const double *b;
+  double *e;
+  double *t;
+};
+
+// Performs damped Jacobi sweeps on A e = b, the first sweep starts from e = 0 when zero_start is set
+template <typename Index> void multigrid_smooth(const MultigridLevel &level, const int steps, const bool zero_start) {
+  const int x = level.x;
+  const int y = level.y;
+  const int halo_depth = level.halo_depth;
+  const double *kx = level.kx;
+  const double *ky = level.ky;
+  const double *mi = level.mi;
+  const double *b = level.b;
+  double *e = level.e;
+  double *t = level.t;
+
+  for (int ss = 0; ss < steps; ++ss) {
+    if (ss == 0 && zero_start) {
+  #pragma omp parallel for
+      for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+        for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+          const Index index = kk + jj * x;
+          e[index] = MG_JACOBI_WEIGHT * mi[index] * b[index];
+        }
+      }
+      continue;
+    }
+
+  #pragma omp parallel for
+    for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+      for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+        const Index index = kk + jj * x;
+        t[index] = mi[index] * (b[index] + (kx[index + 1] * e[index + 1] + kx[index] * e[index - 1]) +
+                                (ky[index + x] * e[index + x] + ky[index] * e[index - x]));
+      }
+    }
+
+  #pragma omp parallel for
+    for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+      for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+        const Index index = kk + jj * x;
+        e[index] += MG_JACOBI_WEIGHT * (t[index] - e[index]);
+      }
+    }
+  }
+}
+
+// Sums the residual b - A e of each aggregate of cells into the right hand side of the coarse level
+template <typename Index> void multigrid_restrict(const MultigridLevel &fine, const MultigridLevel &coarse, double *bc) {
+  const int x = fine.x;
+  const double *kx = fine.kx;
+  const double *ky = fine.ky;
+  const double *mi = fine.mi;
+  const double *b = fine.b;
+  const double *e = fine.e;
+
+  #pragma omp parallel for
+  for (Index jc = 1; jc < coarse.y - 1; ++jc) {
+    for (Index kc = 1; kc < coarse.x - 1; ++kc) {
+      const Index kf = fine.halo_depth + 2 * (kc - 1);
+      const Index jf = fine.halo_depth + 2 * (jc - 1);
+      const Index k_end = tealeaf_MIN(kf + 2, static_cast<Index>(fine.x - fine.halo_depth));
+      const Index j_end = tealeaf_MIN(jf + 2, static_cast<Index>(fine.y - fine.halo_depth));
+
+      double residual = 0.0;
+      for (Index jj = jf; jj < j_end; ++jj) {
+        for (Index kk = kf; kk < k_end; ++kk) {
+          const Index index = kk + jj * x;
+          residual += b[index] - (e[index] / mi[index] - (kx[index + 1] * e[index + 1] + kx[index] * e[index - 1]) -
+                                  (ky[index + x] * e[index + x] + ky[index] * e[index - x]));
+        }
+      }
+      bc[kc + jc * coarse.x] = residual;
+    }
+  }
+}
+
+// Adds the correction of the coarse level to every cell of its aggregate
+template <typename Index> void multigrid_prolong(const MultigridLevel &fine, const MultigridLevel &coarse) {
+  #pragma omp parallel for
+  for (Index jj = fine.halo_depth; jj < fine.y - fine.halo_depth; ++jj) {
+    for (Index kk = fine.halo_depth; kk < fine.x - fine.halo_depth; ++kk) {
+      const Index kc = 1 + (kk - fine.halo_depth) / 2;
+      const Index jc = 1 + (jj - fine.halo_depth) / 2;
+      fine.e[kk + jj * fine.x] += coarse.e[kc + jc * coarse.x];
+    }
+  }
+}
+
+// Builds the coarse operators of the multigrid preconditioner from the operator of the chunk
+template <typename Index>
+void multigrid_init(const int x, const int y, const int halo_depth, const int *chunk_neighbours, const int mg_levels, Chunk *mg_coarse,
+                    const double *kx, const double *ky, double *mi, double *z) {
+  multigrid_diag_init<Index>(x, y, halo_depth, chunk_neighbours, kx, ky, mi, z);
+
+  for (int ll = 0; ll < mg_levels; ++ll) {
+    Chunk *coarse = &mg_coarse[ll];
+    if (ll == 0) {
+      multigrid_coarsen<Index>(x, y, halo_depth, kx, ky, mi, coarse->x, coarse->y, coarse->kx, coarse->ky, coarse->mi);
+    } else {
+      Chunk *fine = &mg_coarse[ll - 1];
+      multigrid_coarsen<Index>(fine->x, fine->y, 1, fine->kx, fine->ky, fine->mi, coarse->x, coarse->y, coarse->kx, coarse->ky, coarse->mi);
+    }
+  }
+}
+
+// Returns a level of the multigrid V-cycle of the chunk, level 0 solves A z = r over the chunk itself
+inline MultigridLevel multigrid_level(Chunk *chunk, const int halo_depth, const int level) {
+  if (level == 0) {
+    return {chunk->x, chunk->y, halo_depth, chunk->kx, chunk->ky, chunk->mi, chunk->r, chunk->z, chunk->q};
+  }
+  Chunk *coarse = &chunk->mg_coarse[level - 1];
+  return {coarse->x, coarse->y, 1, coarse->kx, coarse->ky, coarse->mi, coarse->r, coarse->u, coarse->w};
+}
+
+// Packs the correction along a face of the level into buffer, or unpacks it from buffer into the halo of that face
+template <typename Index> void multigrid_pack_halo(const MultigridLevel &level, const int face, const bool pack, double *buffer) {
+  const int x = level.x;
+  const int halo_depth = level.halo_depth;
+  const bool lr = (face == CHUNK_LEFT || face == CHUNK_RIGHT);
+  const Index length = lr ? level.y - 2 * halo_depth : x - 2 * halo_depth;
+  const Index stride = lr ? x : 1;
+
+  // Packing reads the outermost ring of the interior, unpacking writes the innermost ring of the halo
+  const Index near = pack ? halo_depth : halo_depth - 1;
+  const Index far_x = pack ? x - halo_depth - 1 : x - halo_depth;
+  const Index far_y = pack ? level.y - halo_depth - 1 : level.y - halo_depth;
+  Index first = 0;
+  switch (face) {
+    case CHUNK_LEFT: first = near + halo_depth * x; break;
+    case CHUNK_RIGHT: first = far_x + halo_depth * x; break;
+    case CHUNK_BOTTOM: first = halo_depth + near * x; break;
+    case CHUNK_TOP: first = halo_depth + far_y * x; break;
+  }
+
+  #pragma omp parallel for
+  for (Index ii = 0; ii < length; ++ii) {
+    if (pack) {
+      buffer[ii] = level.e[first + ii * stride];
+    } else {
+      level.e[first + ii * stride] = buffer[ii];
+    }
+  }
+}
+
+// Copies the operator of the coarsest level of the chunk into the global coarsest level, which holds cell (kc, jc) of
+// the level at kc + jc * cx. The diagonal keeps the coefficients of the faces shared with the neighbouring chunks, while
+// west and south hold the coupling across the left and bottom face of each cell, including the faces of the chunk.
+template <typename Index> void multigrid_global_operator(const MultigridLevel &coarsest, double *diagonal, double *west, double *south) {
+  const int halo_depth = coarsest.halo_depth;
+  const int cx = coarsest.x - 2 * halo_depth;
+
+  #pragma omp parallel for
+  for (Index jc = 0; jc < coarsest.y - 2 * halo_depth; ++jc) {
+    for (Index kc = 0; kc < cx; ++kc) {
+      const Index index = kc + halo_depth + (jc + halo_depth) * coarsest.x;
+      diagonal[kc + jc * cx] = 1.0 / coarsest.mi[index];
+      west[kc + jc * cx] = coarsest.kx[index];
+      south[kc + jc * cx] = coarsest.ky[index];
+    }
+  }
+}
+
+// Copies the right hand side of the coarsest level of the chunk into coarse, or the solution in coarse into its correction
+template <typename Index> void multigrid_copy_coarsest(const MultigridLevel &coarsest, const bool to_coarse, double *coarse) {
+  const int halo_depth = coarsest.halo_depth;
+  const int cx = coarsest.x - 2 * halo_depth;
+
+  #pragma omp parallel for
+  for (Index jc = 0; jc < coarsest.y - 2 * halo_depth; ++jc) {
+    for (Index kc = 0; kc < cx; ++kc) {
+      const Index index = kc + halo_depth + (jc + halo_depth) * coarsest.x;
+      if (to_coarse) {
+        coarse[kc + jc * cx] = coarsest.b[index];
+      } else {
+        coarsest.e[index] = coarse[kc + jc * cx];
+      }
+    }
+  }
+}
+
+// Solves z = M^-1 r with the preconditioner selected for the run and returns r.z
+template <typename Index>
+double apply_preconditioner(const int x, const int y, const int halo_depth, const Preconditioner preconditioner, const double *kx,
+                            const double *ky, const double *r, double *z, const double *mi, const double *cp, const double *bfp,
+                            const int mg_levels, Chunk *mg_coarse, double *q) {
+  if (preconditioner == Preconditioner::JAC_BLOCK) {
+    return jacobi_block_solve<Index>(x, y, halo_depth, ky, r, z, cp, bfp);
+  }
+  // The V-cycle is solved over every chunk on its coarsest level, so the drivers run it around that solve
+  if (preconditioner == Preconditioner::MULTIGRID) {
+    return 0.0;
+  }
+
+  double rz = 0.0;
+#ifdef OMP_TARGET
+  #pragma omp target teams distribute parallel for simd reduction(+ : rz) collapse(2)
+#else
+  #pragma omp parallel for reduction(+ : rz)
+#endif
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      z[index] = mi[index] * r[index];
+      rz += r[index] * z[index];
+    }
+  }
+
+  return rz;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// Explicitly vectorised row helpers for the host kernels, the vector width is the native one of the instruction set
+// the model is built for, e.g. 2 doubles with SSE2, 4 with AVX2 and 8 with AVX-512
+
+#include <cstdint>
+#include <experimental/simd>
+#include <type_traits>
+
+namespace stdx = std::experimental;
+using simd_double = stdx::native_simd<double>;
+
+// Loads a vector of cells starting at src, single precision coefficients are widened to double
+template <typename T> static inline simd_double simd_load(const T *src) {
+  if constexpr (std::is_same_v<T, double>) {
+    return simd_double(src, stdx::element_aligned);
+  } else {
+    return simd_double([src](auto ii) { return static_cast<double>(src[ii]); });
+  }
+}
+
+// The number of cells to peel off the start of a row of n cells so that the vector stores to dst are aligned
+template <typename Index> static inline Index simd_peel(const double *dst, const Index n) {
+  const uintptr_t alignment = stdx::memory_alignment_v<simd_double>;
+  const uintptr_t misalignment = reinterpret_cast<uintptr_t>(dst) % alignment;
+  const Index peel = misalignment ? static_cast<Index>((alignment - misalignment) / sizeof(double)) : 0;
+  return peel < n ? peel : n;
+}
+
+// Sparse Matrix Vector Product on the vector of cells starting at index
+template <typename Index, typename Coefficient, bool StoredDiagonal>
+static inline simd_double simd_smvp(const int x, const Index index, const double *a, const Coefficient *kx, const Coefficient *ky,
+                                    const double *diag) {
+  const simd_double kx_left = simd_load(kx + index);
+  const simd_double kx_right = simd_load(kx + index + 1);
+  const simd_double ky_down = simd_load(ky + index);
+  const simd_double ky_up = simd_load(ky + index + x);
+
+  simd_double diagonal;
+  if constexpr (StoredDiagonal) {
+    diagonal = simd_load(diag + index);
+  } else {
+    diagonal = 1.0 + (kx_right + kx_left) + (ky_up + ky_down);
+  }
+
+  return diagonal * simd_load(a + index) - (kx_right * simd_load(a + index + 1) + kx_left * simd_load(a + index - 1)) -
+         (ky_up * simd_load(a + index + x) + ky_down * simd_load(a + index - x));
+}
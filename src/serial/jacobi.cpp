@@ -2,57 +2,65 @@
 #include "settings.h"
 #include "shared.h"
 #include <cmath>
+#include <utility>
 
 /*
  *		JACOBI SOLVER KERNEL
  */
 
 // Initialises the Jacobi solver
-void jacobi_init(const int x, const int y, const int halo_depth, const int coefficient, double rx, double ry, const double *density,
-                 const double *energy, double *u0, double *u, double *kx, double *ky) {
+template <typename Index, typename Value>
+void jacobi_init(const int x, const int y, const int, const int coefficient, double rx, double ry, const bool float_coefficients,
+                 const double *density, const double *energy, Value *u0, Value *u, Value *kx, Value *ky) {
   if (coefficient < CONDUCTIVITY && coefficient < RECIP_CONDUCTIVITY) {
     die(__LINE__, __FILE__, "Coefficient %d is not valid.\n", coefficient);
   }
 
-  for (int jj = 1; jj < y - 1; ++jj) {
-    for (int kk = 1; kk < x - 1; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = 1; jj < y - 1; ++jj) {
+    for (Index kk = 1; kk < x - 1; ++kk) {
+      const Index index = kk + jj * x;
       double temp = energy[index] * density[index];
       u0[index] = temp;
       u[index] = temp;
     }
   }
 
-  for (int jj = halo_depth; jj < y - 1; ++jj) {
-    for (int kk = halo_depth; kk < x - 1; ++kk) {
-      const int index = kk + jj * x;
+  // The coefficients also cover the halo, the temporally blocked iterations apply the stencil there
+  for (Index jj = 1; jj < y; ++jj) {
+    for (Index kk = 1; kk < x; ++kk) {
+      const Index index = kk + jj * x;
       double densityCentre = (coefficient == CONDUCTIVITY) ? density[index] : 1.0 / density[index];
       double densityLeft = (coefficient == CONDUCTIVITY) ? density[index - 1] : 1.0 / density[index - 1];
       double densityDown = (coefficient == CONDUCTIVITY) ? density[index - x] : 1.0 / density[index - x];
 
       kx[index] = rx * (densityLeft + densityCentre) / (2.0 * densityLeft * densityCentre);
       ky[index] = ry * (densityDown + densityCentre) / (2.0 * densityDown * densityCentre);
+      if (float_coefficients) {
+        kx[index] = static_cast<float>(kx[index]);
+        ky[index] = static_cast<float>(ky[index]);
+      }
     }
   }
 }
 
 // The main Jacobi solve step
-void jacobi_iterate(const int x, const int y, const int halo_depth, double *error, const double *kx, const double *ky, const double *u0,
-                    double *u, double *r) {
-  for (int jj = 0; jj < y; ++jj) {
-    for (int kk = 0; kk < x; ++kk) {
-      const int index = kk + jj * x;
+template <typename Index, typename Value, typename Coefficient, bool StoredDiagonal>
+void jacobi_iterate(const int x, const int y, const int halo_depth, double *error, const Value *u0, Value *u, Value *r,
+                    const Coefficient *kx, const Coefficient *ky, const double *diag) {
+  for (Index jj = 0; jj < y; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      const Index index = kk + jj * x;
       r[index] = u[index];
     }
   }
 
   double err = 0.0;
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
       u[index] = (u0[index] + (kx[index + 1] * r[index + 1] + kx[index] * r[index - 1]) +
                   (ky[index + x] * r[index + x] + ky[index] * r[index - x])) /
-                 (1.0 + (kx[index] + kx[index + 1]) + (ky[index] + ky[index + x]));
+                 tealeaf_DIAG;
 
       err += std::fabs(u[index] - r[index]);
     }
@@ -61,16 +69,98 @@ void jacobi_iterate(const int x, const int y, const int halo_depth, double *erro
   *error = err;
 }
 
+// Runs the Jacobi steps of a block on one tile, alternating between the scratch copies la and lb of u,
+// each step updates the tile grown by the number of steps still to run, and the last step writes the tile back
+template <typename Index>
+static double jacobi_iterate_tile(const int x, const BlockedTile &blocked, const int steps, const double *kx, const double *ky,
+                                  const double *u0, const double *u, double *u_next, double *la, double *lb) {
+  int lx_min, lx_max, ly_min, ly_max;
+  blocked_tile_region(blocked, steps, 1, &lx_min, &lx_max, &ly_min, &ly_max);
+  const int lx = lx_max - lx_min;
+
+  for (Index jj = ly_min; jj < ly_max; ++jj) {
+    for (Index kk = lx_min; kk < lx_max; ++kk) {
+      la[(kk - lx_min) + (jj - ly_min) * lx] = u[kk + jj * x];
+    }
+  }
+
+  double err = 0.0;
+
+  for (int ss = 0; ss < steps; ++ss) {
+    int x_min, x_max, y_min, y_max;
+    blocked_tile_region(blocked, steps - 1 - ss, 0, &x_min, &x_max, &y_min, &y_max);
+    reflect_blocked_tile(blocked, lx_min, ly_min, lx, x_min, x_max, y_min, y_max, la);
+
+    const bool is_last = (ss == steps - 1);
+    for (Index jj = y_min; jj < y_max; ++jj) {
+      for (Index kk = x_min; kk < x_max; ++kk) {
+        const Index index = kk + jj * x;
+        const int local = (kk - lx_min) + (jj - ly_min) * lx;
+        lb[local] = (u0[index] + (kx[index + 1] * la[local + 1] + kx[index] * la[local - 1]) +
+                     (ky[index + x] * la[local + lx] + ky[index] * la[local - lx])) /
+                    (1.0 + (kx[index] + kx[index + 1]) + (ky[index] + ky[index + x]));
+
+        if (is_last) {
+          u_next[index] = lb[local];
+          err += std::fabs(lb[local] - la[local]);
+        }
+      }
+    }
+
+    std::swap(la, lb);
+  }
+
+  return err;
+}
+
+// Runs steps Jacobi iterations with the halo of u exchanged to that depth, sweeping the interior in tiles that
+// each run all of the steps while they are in cache. The tiles read u and write u_next, so that no tile
+// overwrites the cells another tile still reads, and the error is that of the last step.
+template <typename Index>
+void jacobi_iterate_blocked(const int x, const int y, const int halo_depth, const int steps, const int tile_size,
+                            const int *chunk_neighbours, double *error, const double *kx, const double *ky, const double *u0,
+                            const double *u, double *u_next) {
+  const int num_tiles = num_blocked_tiles(x, y, halo_depth, tile_size);
+  const int tile_x = (tile_size > 0) ? tealeaf_MIN(tile_size, x - 2 * halo_depth) : x - 2 * halo_depth;
+  const int tile_y = (tile_size > 0) ? tealeaf_MIN(tile_size, y - 2 * halo_depth) : y - 2 * halo_depth;
+  const size_t scratch_len = (tile_x + 2 * steps) * (tile_y + 2 * steps);
+
+  auto *la = static_cast<double *>(std::malloc(sizeof(double) * scratch_len));
+  auto *lb = static_cast<double *>(std::malloc(sizeof(double) * scratch_len));
+
+  double err = 0.0;
+  for (int tt = 0; tt < num_tiles; ++tt) {
+    BlockedTile blocked;
+    blocked_tile(x, y, halo_depth, tile_size, chunk_neighbours, tt, &blocked);
+    err += jacobi_iterate_tile<Index>(x, blocked, steps, kx, ky, u0, u, u_next, la, lb);
+  }
+
+  std::free(la);
+  std::free(lb);
+
+  *error = err;
+}
+
 // Jacobi solver kernels
 void run_jacobi_init(Chunk *chunk, Settings &settings, double rx, double ry) {
   START_PROFILING(settings.kernel_profile);
-  jacobi_init(chunk->x, chunk->y, settings.halo_depth, settings.coefficient, rx, ry, chunk->density, chunk->energy, chunk->u0, chunk->u,
-              chunk->kx, chunk->ky);
+  tealeaf_VALUE_DISPATCH(settings, chunk, jacobi_init, chunk->x, chunk->y, settings.halo_depth, settings.coefficient, rx, ry,
+                         settings.float_coefficients, chunk->density, chunk->energy, fields.u0, fields.u, fields.kx, fields.ky);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_jacobi_iterate(Chunk *chunk, Settings &settings, double *error) {
   START_PROFILING(settings.kernel_profile);
-  jacobi_iterate(chunk->x, chunk->y, settings.halo_depth, error, chunk->kx, chunk->ky, chunk->u0, chunk->u, chunk->r);
+  tealeaf_OPERATOR_DISPATCH(settings, chunk, jacobi_iterate, chunk->x, chunk->y, settings.halo_depth, error, fields.u0, fields.u, fields.r);
   STOP_PROFILING(settings.kernel_profile, __func__);
-}
\ No newline at end of file
+}
+
+void run_jacobi_iterate_blocked(Chunk *chunk, Settings &settings, int steps, double *error) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, jacobi_iterate_blocked, chunk->x, chunk->y, settings.halo_depth, steps, settings.temporal_block_size,
+                         chunk->neighbours, error, chunk->kx, chunk->ky, chunk->u0, chunk->u, chunk->r);
+
+  // The new u was written to r, which is left holding u from before the block
+  std::swap(chunk->u, chunk->r);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
@@ -3,9 +3,10 @@
 #include "shared.h"
 
 // Packs left data into buffer.
+template <typename Index>
 void pack_left(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int offset) {
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < halo_depth + depth; ++kk) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < halo_depth + depth; ++kk) {
       int bufIndex = (kk - halo_depth) + (jj - halo_depth) * depth;
       buffer[bufIndex + offset] = field[jj * x + kk];
     }
@@ -13,9 +14,10 @@ void pack_left(const int x, const int y, const int depth, const int halo_depth,
 }
 
 // Packs right data into buffer.
+template <typename Index>
 void pack_right(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int offset) {
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = x - halo_depth - depth; kk < x - halo_depth; ++kk) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = x - halo_depth - depth; kk < x - halo_depth; ++kk) {
       int bufIndex = (kk - (x - halo_depth - depth)) + (jj - halo_depth) * depth;
       buffer[bufIndex + offset] = field[jj * x + kk];
     }
@@ -23,33 +25,32 @@ void pack_right(const int x, const int y, const int depth, const int halo_depth,
 }
 
 // Packs top data into buffer.
+template <typename Index>
 void pack_top(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int offset) {
-  const int x_inner = x - 2 * halo_depth;
-
-  for (int jj = y - halo_depth - depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      int bufIndex = (kk - halo_depth) + (jj - (y - halo_depth - depth)) * x_inner;
+  for (Index jj = y - halo_depth - depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      int bufIndex = kk + (jj - (y - halo_depth - depth)) * x;
       buffer[bufIndex + offset] = field[jj * x + kk];
     }
   }
 }
 
 // Packs bottom data into buffer.
+template <typename Index>
 void pack_bottom(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int offset) {
-  const int x_inner = x - 2 * halo_depth;
-
-  for (int jj = halo_depth; jj < halo_depth + depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      int bufIndex = (kk - halo_depth) + (jj - halo_depth) * x_inner;
+  for (Index jj = halo_depth; jj < halo_depth + depth; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      int bufIndex = kk + (jj - halo_depth) * x;
       buffer[bufIndex + offset] = field[jj * x + kk];
     }
   }
 }
 
 // Unpacks left data from buffer.
+template <typename Index>
 void unpack_left(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int offset) {
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth - depth; kk < halo_depth; ++kk) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth - depth; kk < halo_depth; ++kk) {
       int bufIndex = (kk - (halo_depth - depth)) + (jj - halo_depth) * depth;
       field[jj * x + kk] = buffer[bufIndex + offset];
     }
@@ -57,9 +58,10 @@ void unpack_left(const int x, const int y, const int depth, const int halo_depth
 }
 
 // Unpacks right data from buffer.
+template <typename Index>
 void unpack_right(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int offset) {
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = x - halo_depth; kk < x - halo_depth + depth; ++kk) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = x - halo_depth; kk < x - halo_depth + depth; ++kk) {
       int bufIndex = (kk - (x - halo_depth)) + (jj - halo_depth) * depth;
       field[jj * x + kk] = buffer[bufIndex + offset];
     }
@@ -67,60 +69,139 @@ void unpack_right(const int x, const int y, const int depth, const int halo_dept
 }
 
 // Unpacks top data from buffer.
+template <typename Index>
 void unpack_top(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int offset) {
-  const int x_inner = x - 2 * halo_depth;
-
-  for (int jj = y - halo_depth; jj < y - halo_depth + depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      int bufIndex = (kk - halo_depth) + (jj - (y - halo_depth)) * x_inner;
+  for (Index jj = y - halo_depth; jj < y - halo_depth + depth; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      int bufIndex = kk + (jj - (y - halo_depth)) * x;
       field[jj * x + kk] = buffer[bufIndex + offset];
     }
   }
 }
 
 // Unpacks bottom data from buffer.
+template <typename Index>
 void unpack_bottom(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int offset) {
-  const int x_inner = x - 2 * halo_depth;
+  for (Index jj = halo_depth - depth; jj < halo_depth; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      int bufIndex = kk + (jj - (halo_depth - depth)) * x;
+      field[jj * x + kk] = buffer[bufIndex + offset];
+    }
+  }
+}
 
-  for (int jj = halo_depth - depth; jj < halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      int bufIndex = (kk - halo_depth) + (jj - (halo_depth - depth)) * x_inner;
+// Packs the corner block whose lower left cell is (col, row) into buffer.
+template <typename Index>
+void pack_corner(const int x, const int depth, const int col, const int row, const double *field, double *buffer, int offset) {
+  for (Index jj = row; jj < row + depth; ++jj) {
+    for (Index kk = col; kk < col + depth; ++kk) {
+      int bufIndex = (kk - col) + (jj - row) * depth;
+      buffer[bufIndex + offset] = field[jj * x + kk];
+    }
+  }
+}
+
+// Unpacks the corner block whose lower left cell is (col, row) from buffer.
+template <typename Index>
+void unpack_corner(const int x, const int depth, const int col, const int row, double *field, const double *buffer, int offset) {
+  for (Index jj = row; jj < row + depth; ++jj) {
+    for (Index kk = col; kk < col + depth; ++kk) {
+      int bufIndex = (kk - col) + (jj - row) * depth;
       field[jj * x + kk] = buffer[bufIndex + offset];
     }
   }
 }
 
 // Either packs or unpacks data from/to buffers.
+template <typename Index>
 void pack_or_unpack(const int x, const int y, const int depth, const int halo_depth, const int face, bool pack, double *field,
                     double *buffer, int offset) {
   switch (face) {
     case CHUNK_LEFT:
-      if (pack) pack_left(x, y, depth, halo_depth, field, buffer, offset);
+      if (pack) pack_left<Index>(x, y, depth, halo_depth, field, buffer, offset);
       else
-        unpack_left(x, y, depth, halo_depth, field, buffer, offset);
+        unpack_left<Index>(x, y, depth, halo_depth, field, buffer, offset);
       break;
     case CHUNK_RIGHT:
-      if (pack) pack_right(x, y, depth, halo_depth, field, buffer, offset);
+      if (pack) pack_right<Index>(x, y, depth, halo_depth, field, buffer, offset);
       else
-        unpack_right(x, y, depth, halo_depth, field, buffer, offset);
+        unpack_right<Index>(x, y, depth, halo_depth, field, buffer, offset);
       break;
     case CHUNK_TOP:
-      if (pack) pack_top(x, y, depth, halo_depth, field, buffer, offset);
+      if (pack) pack_top<Index>(x, y, depth, halo_depth, field, buffer, offset);
       else
-        unpack_top(x, y, depth, halo_depth, field, buffer, offset);
+        unpack_top<Index>(x, y, depth, halo_depth, field, buffer, offset);
       break;
     case CHUNK_BOTTOM:
-      if (pack) pack_bottom(x, y, depth, halo_depth, field, buffer, offset);
+      if (pack) pack_bottom<Index>(x, y, depth, halo_depth, field, buffer, offset);
       else
-        unpack_bottom(x, y, depth, halo_depth, field, buffer, offset);
+        unpack_bottom<Index>(x, y, depth, halo_depth, field, buffer, offset);
       break;
+    case CHUNK_BOTTOM_LEFT:
+    case CHUNK_BOTTOM_RIGHT:
+    case CHUNK_TOP_LEFT:
+    case CHUNK_TOP_RIGHT: {
+      int col, row;
+      corner_origin(x, y, depth, halo_depth, face, pack, &col, &row);
+      if (pack) pack_corner<Index>(x, depth, col, row, field, buffer, offset);
+      else
+        unpack_corner<Index>(x, depth, col, row, field, buffer, offset);
+      break;
+    }
     default: die(__LINE__, __FILE__, "Incorrect face provided: %d.\n", face);
   }
 }
 
 void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool pack, double *field, double *buffer, int offset) {
   START_PROFILING(settings.kernel_profile);
-  pack_or_unpack(chunk->x, chunk->y, depth, settings.halo_depth, face, pack, field, buffer, offset);
+  tealeaf_INDEX_DISPATCH(settings, pack_or_unpack, chunk->x, chunk->y, depth, settings.halo_depth, face, pack, field, buffer, offset);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Packs or unpacks the cells [col_min, col_max) x [row_min, row_max) of one field
+template <typename Index, typename Value>
+void pack_or_unpack_region(const int x, const int col_min, const int col_max, const int row_min, const int row_max, bool pack, Value *field,
+                           double *field_buffer) {
+  const int width = col_max - col_min;
+
+  for (Index jj = row_min; jj < row_max; ++jj) {
+    for (Index kk = col_min; kk < col_max; ++kk) {
+      int bufIndex = (kk - col_min) + (jj - row_min) * width;
+      if (pack) field_buffer[bufIndex] = field[jj * x + kk];
+      else
+        field[jj * x + kk] = field_buffer[bufIndex];
+    }
+  }
+}
+
+// Packs or unpacks the face region of every field in one sweep, field ff occupies buffer[ff * field_stride, ...).
+// The fields with a single precision copy in float_fields[ff] are exchanged from it.
+template <typename Index>
+void pack_or_unpack_fields(const int x, const int y, const int depth, const int halo_depth, const int face, bool pack, double **fields,
+                           float **float_fields, const int num_fields, double *buffer, const int field_stride) {
+  int col_min, col_max, row_min, row_max;
+  halo_region(x, y, depth, halo_depth, face, pack, &col_min, &col_max, &row_min, &row_max);
+
+  for (int ff = 0; ff < num_fields; ++ff) {
+    double *field_buffer = buffer + ff * field_stride;
+    if (float_fields[ff]) {
+      pack_or_unpack_region<Index>(x, col_min, col_max, row_min, row_max, pack, float_fields[ff], field_buffer);
+    } else {
+      pack_or_unpack_region<Index>(x, col_min, col_max, row_min, row_max, pack, fields[ff], field_buffer);
+    }
+  }
+}
+
+void run_pack_or_unpack_fields(Chunk *chunk, Settings &settings, int depth, int face, bool pack, double **fields, int num_fields,
+                               double *buffer, int field_stride) {
+  START_PROFILING(settings.kernel_profile);
+  // A float_fields solve exchanges its vectors from their single precision copies
+  float *float_fields[NUM_FIELDS];
+  for (int ff = 0; ff < num_fields; ++ff) {
+    float_fields[ff] = settings.float_fields ? float_field(chunk, fields[ff]) : nullptr;
+  }
+  tealeaf_INDEX_DISPATCH(settings, pack_or_unpack_fields, chunk->x, chunk->y, depth, settings.halo_depth, face, pack, fields, float_fields,
+                         num_fields, buffer, field_stride);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
@@ -1,4 +1,5 @@
 #include "chunk.h"
+#include "preconditioner.h"
 #include "shared.h"
 
 /*
@@ -6,30 +7,176 @@
  */
 
 // Initialises the PPCG solver
-void ppcg_init(const int x, const int y, const int halo_depth, double theta, const double *r, double *sd) {
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+template <typename Index, typename Value>
+void ppcg_init(const int x, const int y, const int halo_depth, double theta, const Value *r, Value *sd) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
       sd[index] = r[index] / theta;
     }
   }
 }
 
 // The PPCG inner iteration
-void ppcg_inner_iteration(const int x, const int y, const int halo_depth, double alpha, double beta, double *u, double *r, const double *kx,
-                          const double *ky, double *sd) {
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+template <typename Index, typename Value, typename Coefficient, bool StoredDiagonal>
+void ppcg_inner_iteration(const int x, const int y, const int halo_depth, double alpha, double beta, Value *u, Value *r, Value *sd,
+                          const Coefficient *kx, const Coefficient *ky, const double *diag) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP_STORED(sd);
+      r[index] -= smvp;
+      u[index] += sd[index];
+    }
+  }
+
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      sd[index] = alpha * sd[index] + beta * r[index];
+    }
+  }
+}
+
+// The PPCG inner iteration with the preconditioner selected for the run, sd is updated from z = M^-1 r
+template <typename Index>
+void ppcg_inner_iteration_preconditioned(const int x, const int y, const int halo_depth, const Preconditioner preconditioner, double alpha,
+                                         double beta, double *u, double *r, double *sd, double *z, const double *kx, const double *ky,
+                                         const double *mi, const double *cp, const double *bfp, const int mg_levels, Chunk *mg_coarse,
+                                         double *q) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP(sd);
+      r[index] -= smvp;
+      u[index] += sd[index];
+    }
+  }
+
+  // The multigrid V-cycle runs over every chunk before ppcg_calc_sd finishes the iteration
+  if (preconditioner == Preconditioner::MULTIGRID) return;
+
+  if (preconditioner != Preconditioner::JAC_DIAG) {
+    apply_preconditioner<Index>(x, y, halo_depth, preconditioner, kx, ky, r, z, mi, cp, bfp, mg_levels, mg_coarse, q);
+  }
+
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      if (preconditioner == Preconditioner::JAC_DIAG) z[index] = mi[index] * r[index];
+      sd[index] = alpha * sd[index] + beta * z[index];
+    }
+  }
+}
+
+// Finishes the PPCG inner iteration of the multigrid preconditioner from the z = M^-1 r of the V-cycle
+template <typename Index>
+void ppcg_calc_sd(const int x, const int y, const int halo_depth, double alpha, double beta, const double *z, double *sd) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      sd[index] = alpha * sd[index] + beta * z[index];
+    }
+  }
+}
+
+// The PPCG inner iteration over the interleaved operator
+template <typename Index, bool StoredDiagonal>
+void ppcg_inner_iteration_interleaved(const int x, const int y, const int halo_depth, double alpha, double beta, double *u, double *r,
+                                      double *sd, const double *op) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP_INTERLEAVED(sd);
+      r[index] -= smvp;
+      u[index] += sd[index];
+    }
+  }
+
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      sd[index] = alpha * sd[index] + beta * r[index];
+    }
+  }
+}
+
+// The PPCG inner iteration over the interior grown by ext cells into the halo at internal faces
+template <typename Index>
+void ppcg_inner_iteration_ca(const int x, const int y, const int halo_depth, const int ext, const int *chunk_neighbours, double alpha,
+                             double beta, double *u, double *r, const double *kx, const double *ky, double *sd) {
+  const int x_min = halo_depth - (chunk_neighbours[CHUNK_LEFT] == EXTERNAL_FACE ? 0 : ext);
+  const int x_max = x - halo_depth + (chunk_neighbours[CHUNK_RIGHT] == EXTERNAL_FACE ? 0 : ext);
+  const int y_min = halo_depth - (chunk_neighbours[CHUNK_BOTTOM] == EXTERNAL_FACE ? 0 : ext);
+  const int y_max = y - halo_depth + (chunk_neighbours[CHUNK_TOP] == EXTERNAL_FACE ? 0 : ext);
+
+  // Reflect sd at external faces, including the rows and columns grown into the halo
+  if (chunk_neighbours[CHUNK_LEFT] == EXTERNAL_FACE) {
+    for (Index jj = y_min; jj < y_max; ++jj) {
+      sd[jj * x + halo_depth - 1] = sd[jj * x + halo_depth];
+    }
+  }
+  if (chunk_neighbours[CHUNK_RIGHT] == EXTERNAL_FACE) {
+    for (Index jj = y_min; jj < y_max; ++jj) {
+      sd[jj * x + x - halo_depth] = sd[jj * x + x - halo_depth - 1];
+    }
+  }
+  if (chunk_neighbours[CHUNK_BOTTOM] == EXTERNAL_FACE) {
+    for (Index kk = x_min; kk < x_max; ++kk) {
+      sd[(halo_depth - 1) * x + kk] = sd[halo_depth * x + kk];
+    }
+  }
+  if (chunk_neighbours[CHUNK_TOP] == EXTERNAL_FACE) {
+    for (Index kk = x_min; kk < x_max; ++kk) {
+      sd[(y - halo_depth) * x + kk] = sd[(y - halo_depth - 1) * x + kk];
+    }
+  }
+
+  for (Index jj = y_min; jj < y_max; ++jj) {
+    for (Index kk = x_min; kk < x_max; ++kk) {
+      const Index index = kk + jj * x;
       const double smvp = tealeaf_SMVP(sd);
       r[index] -= smvp;
       u[index] += sd[index];
     }
   }
 
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = y_min; jj < y_max; ++jj) {
+    for (Index kk = x_min; kk < x_max; ++kk) {
+      const Index index = kk + jj * x;
+      sd[index] = alpha * sd[index] + beta * r[index];
+    }
+  }
+}
+
+// Calculates r and u of the PPCG inner iteration over the cells [x_min, x_max) x [y_min, y_max)
+template <typename Index>
+void ppcg_calc_ur_region(const int x, const int x_min, const int x_max, const int y_min, const int y_max, double *u, double *r,
+                         const double *kx, const double *ky, const double *sd) {
+  for (Index jj = y_min; jj < y_max; ++jj) {
+    for (Index kk = x_min; kk < x_max; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP(sd);
+      r[index] -= smvp;
+      u[index] += sd[index];
+    }
+  }
+}
+
+// Finishes the PPCG inner iteration on the outermost ring of the interior, then updates sd everywhere
+template <typename Index>
+void ppcg_inner_iteration_boundary(const int x, const int y, const int halo_depth, double alpha, double beta, double *u, double *r,
+                                   const double *kx, const double *ky, double *sd) {
+  const int top = tealeaf_MAX(y - halo_depth - 1, halo_depth + 1);
+  const int right = tealeaf_MAX(x - halo_depth - 1, halo_depth + 1);
+  ppcg_calc_ur_region<Index>(x, halo_depth, x - halo_depth, halo_depth, halo_depth + 1, u, r, kx, ky, sd);
+  ppcg_calc_ur_region<Index>(x, halo_depth, x - halo_depth, top, y - halo_depth, u, r, kx, ky, sd);
+  ppcg_calc_ur_region<Index>(x, halo_depth, halo_depth + 1, halo_depth + 1, y - halo_depth - 1, u, r, kx, ky, sd);
+  ppcg_calc_ur_region<Index>(x, right, x - halo_depth, halo_depth + 1, y - halo_depth - 1, u, r, kx, ky, sd);
+
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
       sd[index] = alpha * sd[index] + beta * r[index];
     }
   }
@@ -38,12 +185,56 @@ void ppcg_inner_iteration(const int x, const int y, const int halo_depth, double
 // PPCG solver kernels
 void run_ppcg_init(Chunk *chunk, Settings &settings) {
   START_PROFILING(settings.kernel_profile);
-  ppcg_init(chunk->x, chunk->y, settings.halo_depth, chunk->theta, chunk->r, chunk->sd);
+  // The preconditioned inner iterations start from z rather than r
+  if (settings.preconditioner != Preconditioner::NONE) {
+    tealeaf_INDEX_DISPATCH(settings, ppcg_init, chunk->x, chunk->y, settings.halo_depth, chunk->theta, chunk->z, chunk->sd);
+  } else {
+    tealeaf_VALUE_DISPATCH(settings, chunk, ppcg_init, chunk->x, chunk->y, settings.halo_depth, chunk->theta, fields.r, fields.sd);
+  }
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_ppcg_inner_iteration(Chunk *chunk, Settings &settings, double alpha, double beta) {
   START_PROFILING(settings.kernel_profile);
-  ppcg_inner_iteration(chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->u, chunk->r, chunk->kx, chunk->ky, chunk->sd);
+  if (settings.preconditioner != Preconditioner::NONE) {
+    tealeaf_INDEX_DISPATCH(settings, ppcg_inner_iteration_preconditioned, chunk->x, chunk->y, settings.halo_depth, settings.preconditioner,
+                           alpha, beta, chunk->u, chunk->r, chunk->sd, chunk->z, chunk->kx, chunk->ky, chunk->mi, chunk->cp, chunk->bfp,
+                           chunk->mg_levels, chunk->mg_coarse, chunk->q);
+  } else if (settings.interleaved_operator) {
+    tealeaf_INTERLEAVED_DISPATCH(settings, chunk, ppcg_inner_iteration_interleaved, chunk->x, chunk->y, settings.halo_depth, alpha, beta,
+                                 chunk->u, chunk->r, chunk->sd);
+  } else {
+    tealeaf_OPERATOR_DISPATCH(settings, chunk, ppcg_inner_iteration, chunk->x, chunk->y, settings.halo_depth, alpha, beta, fields.u,
+                              fields.r, fields.sd);
+  }
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_ppcg_calc_sd(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, ppcg_calc_sd, chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->z, chunk->sd);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_ppcg_inner_iteration_ca(Chunk *chunk, Settings &settings, int ext, double alpha, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, ppcg_inner_iteration_ca, chunk->x, chunk->y, settings.halo_depth, ext, chunk->neighbours, alpha, beta,
+                         chunk->u, chunk->r, chunk->kx, chunk->ky, chunk->sd);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Split PPCG kernels, the interior runs while the halo exchange is in flight
+void run_ppcg_inner_iteration_interior(Chunk *chunk, Settings &settings) {
+  START_PROFILING(settings.kernel_profile);
+  const int halo_depth = settings.halo_depth;
+  tealeaf_INDEX_DISPATCH(settings, ppcg_calc_ur_region, chunk->x, halo_depth + 1, chunk->x - halo_depth - 1, halo_depth + 1,
+                         chunk->y - halo_depth - 1, chunk->u, chunk->r, chunk->kx, chunk->ky, chunk->sd);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_ppcg_inner_iteration_boundary(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, ppcg_inner_iteration_boundary, chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->u, chunk->r,
+                         chunk->kx, chunk->ky, chunk->sd);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
@@ -6,16 +6,17 @@
  */
 
 // The field summary kernel
+template <typename Index, typename Value>
 void field_summary(const int x, const int y, const int halo_depth, const double *volume, const double *density, const double *energy0,
-                   double *u, double *volOut, double *massOut, double *ieOut, double *tempOut) {
+                   const Value *u, double *volOut, double *massOut, double *ieOut, double *tempOut) {
   double vol = 0.0;
   double ie = 0.0;
   double temp = 0.0;
   double mass = 0.0;
 
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
       double cellVol = volume[index];
       double cellMass = cellVol * density[index];
       vol += cellVol;
@@ -32,41 +33,43 @@ void field_summary(const int x, const int y, const int halo_depth, const double
 }
 
 // Store original energy state
-void store_energy(int x, int y, const double *energy0, double *energy) {
-  for (int ii = 0; ii < x * y; ++ii) {
+template <typename Index> void store_energy(int x, int y, const double *energy0, double *energy) {
+  for (Index ii = 0; ii < static_cast<Index>(x) * y; ++ii) {
     energy[ii] = energy0[ii];
   }
 }
 
-// Copies the current u into u0
-void copy_u(const int x, const int y, const int halo_depth, double *u0, const double *u) {
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+// Copies the current u into u0, including the halo that the temporally blocked Chebyshev iterations read
+template <typename Index, typename Value> void copy_u(const int x, const int y, const int, Value *u0, const Value *u) {
+  for (Index jj = 0; jj < y; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      const Index index = kk + jj * x;
       u0[index] = u[index];
     }
   }
 }
 
 // Calculates the current value of r
-void calculate_residual(const int x, const int y, const int halo_depth, const double *u, const double *u0, double *r, const double *kx,
-                        const double *ky) {
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
-      const double smvp = tealeaf_SMVP(u);
+template <typename Index, typename Value, typename Coefficient, bool StoredDiagonal>
+void calculate_residual(const int x, const int y, const int halo_depth, const Value *u, const Value *u0, Value *r,
+                        const Coefficient *kx, const Coefficient *ky, const double *diag) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      const double smvp = tealeaf_SMVP_STORED(u);
       r[index] = u0[index] - smvp;
     }
   }
 }
 
 // Calculates the 2 norm of a given buffer
-void calculate_2norm(const int x, const int y, const int halo_depth, const double *buffer, double *norm) {
+template <typename Index, typename Value>
+void calculate_2norm(const int x, const int y, const int halo_depth, const Value *buffer, double *norm) {
   double norm_temp = 0.0;
 
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
       norm_temp += buffer[index] * buffer[index];
     }
   }
@@ -74,11 +77,26 @@ void calculate_2norm(const int x, const int y, const int halo_depth, const doubl
   *norm += norm_temp;
 }
 
+// Calculates r.z for the preconditioned solvers
+template <typename Index> void calculate_rz(const int x, const int y, const int halo_depth, const double *r, const double *z, double *rz) {
+  double rz_temp = 0.0;
+
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
+      rz_temp += r[index] * z[index];
+    }
+  }
+
+  *rz += rz_temp;
+}
+
 // Finalises the solution
-void finalise(const int x, const int y, const int halo_depth, double *energy, const double *density, const double *u) {
-  for (int jj = halo_depth; jj < y - halo_depth; ++jj) {
-    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
-      const int index = kk + jj * x;
+template <typename Index, typename Value>
+void finalise(const int x, const int y, const int halo_depth, double *energy, const double *density, const Value *u) {
+  for (Index jj = halo_depth; jj < y - halo_depth; ++jj) {
+    for (Index kk = halo_depth; kk < x - halo_depth; ++kk) {
+      const Index index = kk + jj * x;
       energy[index] = u[index] / density[index];
     }
   }
@@ -86,37 +104,121 @@ void finalise(const int x, const int y, const int halo_depth, double *energy, co
 
 void run_store_energy(Chunk *chunk, Settings &settings) {
   START_PROFILING(settings.kernel_profile);
-  store_energy(chunk->x, chunk->y, chunk->energy0, chunk->energy);
+  tealeaf_INDEX_DISPATCH(settings, store_energy, chunk->x, chunk->y, chunk->energy0, chunk->energy);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_field_summary(Chunk *chunk, Settings &settings, double *vol, double *mass, double *ie, double *temp) {
   START_PROFILING(settings.kernel_profile);
-  field_summary(chunk->x, chunk->y, settings.halo_depth, chunk->volume, chunk->density, chunk->energy0, chunk->u, vol, mass, ie, temp);
+  tealeaf_VALUE_DISPATCH(settings, chunk, field_summary, chunk->x, chunk->y, settings.halo_depth, chunk->volume, chunk->density,
+                         chunk->energy0, fields.u, vol, mass, ie, temp);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
+// Stores single precision copies of kx and ky when float_coefficients is set, the solver initialisation has already
+// rounded kx and ky to them so that every kernel applies the same operator, and the diagonal when stored_diagonal is set
+template <typename Index>
+void store_operator(const int x, const int y, const bool stored_diagonal, const bool float_coefficients, const double *kx,
+                    const double *ky, double *diag, float *kx_float, float *ky_float) {
+  if (float_coefficients) {
+    for (Index jj = 0; jj < y; ++jj) {
+      for (Index kk = 0; kk < x; ++kk) {
+        const Index index = kk + jj * x;
+        kx_float[index] = static_cast<float>(kx[index]);
+        ky_float[index] = static_cast<float>(ky[index]);
+      }
+    }
+  }
+
+  if (stored_diagonal) {
+    for (Index jj = 1; jj < y - 1; ++jj) {
+      for (Index kk = 1; kk < x - 1; ++kk) {
+        const Index index = kk + jj * x;
+        diag[index] = 1.0 + (kx[index + 1] + kx[index]) + (ky[index + x] + ky[index]);
+      }
+    }
+  }
+}
+
+// Copies kx, ky and, when StoredDiagonal is set, the stored diagonal of each cell next to each other into op
+template <typename Index, bool StoredDiagonal>
+void store_interleaved_operator(const int x, const int y, const double *kx, const double *ky, const double *diag, double *op) {
+  for (Index jj = 0; jj < y; ++jj) {
+    for (Index kk = 0; kk < x; ++kk) {
+      const Index index = kk + jj * x;
+      tealeaf_OP_KX(index) = kx[index];
+      tealeaf_OP_KY(index) = ky[index];
+      if constexpr (StoredDiagonal) op[index * 3 + 2] = diag[index];
+    }
+  }
+}
+
+// The vectors of a double precision solve
+template <> SolveFields<double> solve_fields(Chunk *chunk) {
+  return {chunk->u, chunk->u0, chunk->p, chunk->r, chunk->w, chunk->sd, chunk->kx, chunk->ky};
+}
+
+// The vectors of a float_fields solve, which initialises them from the double precision fields and finalises the energy
+// from u_float
+template <> SolveFields<float> solve_fields(Chunk *chunk) {
+  return {chunk->u_float,  chunk->u0_float, chunk->p_float,  chunk->r_float,
+          chunk->w_float,  chunk->sd_float, chunk->kx_float, chunk->ky_float};
+}
+
+float *float_field(Chunk *chunk, const double *field) {
+  const SolveFields<double> fields = solve_fields<double>(chunk);
+  const SolveFields<float> floats = solve_fields<float>(chunk);
+  if (field == fields.u) return floats.u;
+  if (field == fields.u0) return floats.u0;
+  if (field == fields.p) return floats.p;
+  if (field == fields.r) return floats.r;
+  if (field == fields.w) return floats.w;
+  if (field == fields.sd) return floats.sd;
+  return nullptr;
+}
+
 // Shared solver kernels
 void run_copy_u(Chunk *chunk, Settings &settings) {
   START_PROFILING(settings.kernel_profile);
-  copy_u(chunk->x, chunk->y, settings.halo_depth, chunk->u0, chunk->u);
+  tealeaf_VALUE_DISPATCH(settings, chunk, copy_u, chunk->x, chunk->y, settings.halo_depth, fields.u0, fields.u);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_calculate_residual(Chunk *chunk, Settings &settings) {
   START_PROFILING(settings.kernel_profile);
-  calculate_residual(chunk->x, chunk->y, settings.halo_depth, chunk->u, chunk->u0, chunk->r, chunk->kx, chunk->ky);
+  tealeaf_OPERATOR_DISPATCH(settings, chunk, calculate_residual, chunk->x, chunk->y, settings.halo_depth, fields.u, fields.u0, fields.r);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_calculate_2norm(Chunk *chunk, Settings &settings, double *buffer, double *norm) {
   START_PROFILING(settings.kernel_profile);
-  calculate_2norm(chunk->x, chunk->y, settings.halo_depth, buffer, norm);
+  // A float_fields solve holds the vector in its single precision copy
+  if (settings.float_fields) {
+    tealeaf_INDEX_DISPATCH(settings, calculate_2norm, chunk->x, chunk->y, settings.halo_depth, float_field(chunk, buffer), norm);
+  } else {
+    tealeaf_INDEX_DISPATCH(settings, calculate_2norm, chunk->x, chunk->y, settings.halo_depth, buffer, norm);
+  }
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_calculate_rz(Chunk *chunk, Settings &settings, double *rz) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, calculate_rz, chunk->x, chunk->y, settings.halo_depth, chunk->r, chunk->z, rz);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_finalise(Chunk *chunk, Settings &settings) {
   START_PROFILING(settings.kernel_profile);
-  finalise(chunk->x, chunk->y, settings.halo_depth, chunk->energy, chunk->density, chunk->u);
+  tealeaf_VALUE_DISPATCH(settings, chunk, finalise, chunk->x, chunk->y, settings.halo_depth, chunk->energy, chunk->density, fields.u);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_store_operator(Chunk *chunk, Settings &settings) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, store_operator, chunk->x, chunk->y, settings.stored_diagonal, settings.float_coefficients, chunk->kx,
+                         chunk->ky, chunk->diag, chunk->kx_float, chunk->ky_float);
+  if (settings.interleaved_operator) {
+    tealeaf_INTERLEAVED_DISPATCH(settings, chunk, store_interleaved_operator, chunk->x, chunk->y, chunk->kx, chunk->ky, chunk->diag);
+  }
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
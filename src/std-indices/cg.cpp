@@ -3,6 +3,7 @@
 
 #include "chunk.h"
 #include "dpl_shim.h"
+#include "preconditioner.h"
 #include "ranged.h"
 #include "shared.h"
 #include "std_shared.h"
@@ -11,31 +12,41 @@
  *		CONJUGATE GRADIENT SOLVER KERNEL
  */
 
+struct Dots {
+  double rr;
+  double wr;
+  [[nodiscard]] constexpr Dots operator+(const Dots &that) const { //
+    return {rr + that.rr, wr + that.wr};
+  }
+};
+
 // Initialises the CG solver
-void cg_init(const int x,           //
-             const int y,           //
-             const int halo_depth,  //
-             const int coefficient, //
-             double rx,             //
-             double ry,             //
-             double *rro,           //
-             const double *density, //
-             const double *energy,  //
-             double *u,             //
-             double *p,             //
-             double *r,             //
-             double *w,             //
-             double *kx,            //
-             double *ky) {
+template <typename Index, typename Value>
+void cg_init(const int x,                   //
+             const int y,                   //
+             const int halo_depth,          //
+             const int coefficient,         //
+             double rx,                     //
+             double ry,                     //
+             const bool float_coefficients, //
+             double *rro,                   //
+             const double *density,         //
+             const double *energy,          //
+             Value *u,                      //
+             Value *p,                      //
+             Value *r,                      //
+             Value *w,                      //
+             Value *kx,                     //
+             Value *ky) {
   if (coefficient != CONDUCTIVITY && coefficient != RECIP_CONDUCTIVITY) {
     die(__LINE__, __FILE__, "Coefficient %d is not valid.\n", coefficient);
   }
 
   {
-    Range2d range(0, 0, x, y);
-    ranged<int> it(0, range.sizeXY());
-    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-      const int index = range.restore(i, x);
+    Range2d<Index> range(0, 0, x, y);
+    ranged<Index> it(0, range.sizeXY());
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+      const Index index = range.restore(i, x);
       p[index] = 0.0;
       r[index] = 0.0;
       u[index] = energy[index] * density[index];
@@ -51,16 +62,17 @@ void cg_init(const int x,           //
     //    });
   }
 
+  // The coefficients also cover the halo, the communication-avoiding PPCG inner steps apply the stencil there
   {
-    Range2d range(1, 1, x - 1, y - 1);
-    ranged<int> it(0, range.sizeXY());
-    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-      const int index = range.restore(i, x);
+    Range2d<Index> range(0, 0, x, y);
+    ranged<Index> it(0, range.sizeXY());
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+      const Index index = range.restore(i, x);
       w[index] = (coefficient == CONDUCTIVITY) ? density[index] : 1.0 / density[index];
     });
-    //    ranged<int> it(1, y - 1);
+    //    ranged<int> it(0, y);
     //    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int jj) {
-    //      for (int kk = 1; kk < x - 1; ++kk) {
+    //      for (int kk = 0; kk < x; ++kk) {
     //        const int index = kk + jj * x;
     //        w[index] = (coefficient == CONDUCTIVITY) ? density[index] : 1.0 / density[index];
     //      }
@@ -68,16 +80,20 @@ void cg_init(const int x,           //
   }
 
   {
-    Range2d range(halo_depth, halo_depth, x - 1, y - 1);
-    ranged<int> it(0, range.sizeXY());
-    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-      const int index = range.restore(i, x);
+    Range2d<Index> range(1, 1, x, y);
+    ranged<Index> it(0, range.sizeXY());
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+      const Index index = range.restore(i, x);
       kx[index] = rx * (w[index - 1] + w[index]) / (2.0 * w[index - 1] * w[index]);
       ky[index] = ry * (w[index - x] + w[index]) / (2.0 * w[index - x] * w[index]);
+      if (float_coefficients) {
+        kx[index] = static_cast<float>(kx[index]);
+        ky[index] = static_cast<float>(ky[index]);
+      }
     });
-    //    ranged<int> it(halo_depth, y - 1);
+    //    ranged<int> it(1, y);
     //    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int jj) {
-    //      for (int kk = halo_depth; kk < x - 1; ++kk) {
+    //      for (int kk = 1; kk < x; ++kk) {
     //        const int index = kk + jj * x;
     //        kx[index] = rx * (w[index - 1] + w[index]) / (2.0 * w[index - 1] * w[index]);
     //        ky[index] = ry * (w[index - x] + w[index]) / (2.0 * w[index - x] * w[index]);
@@ -86,10 +102,10 @@ void cg_init(const int x,           //
   }
 
   {
-    Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-    ranged<int> it(0, range.sizeXY());
-    *rro += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](int i) {
-      const int index = range.restore(i, x);
+    Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+    ranged<Index> it(0, range.sizeXY());
+    *rro += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+      const Index index = range.restore(i, x);
       const double smvp = tealeaf_SMVP(u);
       w[index] = smvp;
       r[index] = u[index] - w[index];
@@ -112,19 +128,21 @@ void cg_init(const int x,           //
 }
 
 // Calculates w
-void cg_calc_w(const int x,          //
-               const int y,          //
-               const int halo_depth, //
-               double *pw,           //
-               const double *p,      //
-               double *w,            //
-               const double *kx,     //
-               const double *ky) {
-  Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-  *pw += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](int i) {
-    const int index = range.restore(i, x);
-    const double smvp = tealeaf_SMVP(p);
+template <typename Index, typename Value, typename Coefficient, bool StoredDiagonal>
+void cg_calc_w(const int x,           //
+               const int y,           //
+               const int halo_depth,  //
+               double *pw,            //
+               const Value *p,        //
+               Value *w,              //
+               const Coefficient *kx, //
+               const Coefficient *ky, //
+               const double *diag) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  *pw += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    const double smvp = tealeaf_SMVP_STORED(p);
     w[index] = smvp;
     return w[index] * p[index];
   });
@@ -133,7 +151,7 @@ void cg_calc_w(const int x,          //
   //    double pw_temp = 0.0;
   //    for (int kk = halo_depth; kk < x - halo_depth; ++kk) {
   //      const int index = kk + jj * x;
-  //      const double smvp = tealeaf_SMVP(p);
+  //      const double smvp = tealeaf_SMVP_STORED(p);
   //      w[index] = smvp;
   //      pw_temp += w[index] * p[index];
   //    }
@@ -142,19 +160,20 @@ void cg_calc_w(const int x,          //
 }
 
 // Calculates u and r
+template <typename Index, typename Value>
 void cg_calc_ur(const int x,          //
                 const int y,          //
                 const int halo_depth, //
                 const double alpha,   //
                 double *rrn,          //
-                double *u,            //
-                const double *p,      //
-                double *r,            //
-                const double *w) {
-  Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-  *rrn += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](int i) {
-    const int index = range.restore(i, x);
+                Value *u,             //
+                const Value *p,       //
+                Value *r,             //
+                const Value *w) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  *rrn += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
     u[index] += alpha * p[index];
     r[index] -= alpha * w[index];
     return r[index] * r[index];
@@ -172,17 +191,87 @@ void cg_calc_ur(const int x,          //
   //  });
 }
 
+// Sets up the preconditioner and starts the preconditioned CG recurrences from p = z = M^-1 r
+template <typename Index>
+void cg_init_preconditioner(const int x,                         //
+                            const int y,                         //
+                            const int halo_depth,                //
+                            const Preconditioner preconditioner, //
+                            double *rro,                         //
+                            const double *r,                     //
+                            double *p,                           //
+                            double *z,                           //
+                            const double *kx,                    //
+                            const double *ky,                    //
+                            double *mi,                          //
+                            double *cp,                          //
+                            double *bfp) {
+  if (preconditioner == Preconditioner::JAC_BLOCK) {
+    jacobi_block_init<Index>(x, y, halo_depth, kx, ky, cp, bfp);
+  } else {
+    jacobi_diag_init<Index>(x, y, halo_depth, kx, ky, mi);
+  }
+
+  *rro += apply_preconditioner<Index>(x, y, halo_depth, preconditioner, ky, r, z, mi, cp, bfp);
+
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    p[index] = z[index];
+  });
+}
+
+// Calculates u, r and the preconditioned residual z, rrn accumulates r.z
+template <typename Index>
+void cg_calc_ur_preconditioned(const int x,                         //
+                               const int y,                         //
+                               const int halo_depth,                //
+                               const Preconditioner preconditioner, //
+                               const double alpha,                  //
+                               double *rrn,                         //
+                               double *u,                           //
+                               const double *p,                     //
+                               double *r,                           //
+                               const double *w,                     //
+                               double *z,                           //
+                               const double *ky,                    //
+                               const double *mi,                    //
+                               const double *cp,                    //
+                               const double *bfp) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  if (preconditioner == Preconditioner::JAC_BLOCK) {
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+      const Index index = range.restore(i, x);
+      u[index] += alpha * p[index];
+      r[index] -= alpha * w[index];
+    });
+    *rrn += jacobi_block_solve<Index>(x, y, halo_depth, ky, r, z, cp, bfp);
+    return;
+  }
+
+  *rrn += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    u[index] += alpha * p[index];
+    r[index] -= alpha * w[index];
+    z[index] = mi[index] * r[index];
+    return r[index] * z[index];
+  });
+}
+
 // Calculates p
+template <typename Index, typename Value>
 void cg_calc_p(const int x,          //
                const int y,          //
                const int halo_depth, //
                const double beta,    //
-               double *p,            //
-               const double *r) {
-  Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-    const int index = range.restore(i, x);
+               Value *p,             //
+               const Value *r) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
     p[index] = beta * p[index] + r[index];
   });
   //  ranged<int> it(halo_depth, y - halo_depth);
@@ -194,28 +283,439 @@ void cg_calc_p(const int x,          //
   //  });
 }
 
+// Calculates w = Ar and the dot products needed by the pipelined CG step
+template <typename Index>
+void pipelined_cg_calc_w(const int x,          //
+                         const int y,          //
+                         const int halo_depth, //
+                         double *rr,           //
+                         double *wr,           //
+                         const double *r,      //
+                         double *w,            //
+                         const double *kx,     //
+                         const double *ky) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  Dots dots = std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), Dots{0.0, 0.0}, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    const double smvp = tealeaf_SMVP(r);
+    w[index] = smvp;
+    return Dots{r[index] * r[index], w[index] * r[index]};
+  });
+
+  *rr += dots.rr;
+  *wr += dots.wr;
+}
+
+// Calculates p, s = Ap, u and r in a single sweep
+template <typename Index>
+void pipelined_cg_calc_ur(const int x,          //
+                          const int y,          //
+                          const int halo_depth, //
+                          const double alpha,   //
+                          const double beta,    //
+                          double *u,            //
+                          double *p,            //
+                          double *r,            //
+                          double *s,            //
+                          const double *w) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    p[index] = beta * p[index] + r[index];
+    s[index] = beta * s[index] + w[index];
+    u[index] += alpha * p[index];
+    r[index] -= alpha * s[index];
+  });
+}
+
+// Calculates q = Aw for the Ghysels pipelined CG step
+template <typename Index>
+void ghysels_cg_calc_q(const int x,          //
+                       const int y,          //
+                       const int halo_depth, //
+                       const double *w,      //
+                       double *q,            //
+                       const double *kx,     //
+                       const double *ky) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    const double smvp = tealeaf_SMVP(w);
+    q[index] = smvp;
+  });
+}
+
+// Updates the Ghysels pipelined CG recurrences and calculates the dot products for the next step
+template <typename Index>
+void ghysels_cg_calc_urw(const int x,          //
+                         const int y,          //
+                         const int halo_depth, //
+                         const double alpha,   //
+                         const double beta,    //
+                         double *rr,           //
+                         double *wr,           //
+                         double *u,            //
+                         double *p,            //
+                         double *r,            //
+                         double *s,            //
+                         double *w,            //
+                         double *z,            //
+                         const double *q) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  Dots dots = std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), Dots{0.0, 0.0}, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    z[index] = beta * z[index] + q[index];
+    s[index] = beta * s[index] + w[index];
+    p[index] = beta * p[index] + r[index];
+    u[index] += alpha * p[index];
+    r[index] -= alpha * s[index];
+    w[index] -= alpha * z[index];
+    return Dots{r[index] * r[index], w[index] * r[index]};
+  });
+
+  *rr += dots.rr;
+  *wr += dots.wr;
+}
+
+struct FusedDots {
+  double rr;
+  double pw;
+  double rw;
+  double ww;
+  [[nodiscard]] constexpr FusedDots operator+(const FusedDots &that) const { //
+    return {rr + that.rr, pw + that.pw, rw + that.rw, ww + that.ww};
+  }
+};
+
+// Calculates w = Ap and the dot products r.r, p.w, r.w and w.w that a fused CG iteration needs
+template <typename Index>
+void cg_fused_calc_w(const int x,          //
+                     const int y,          //
+                     const int halo_depth, //
+                     double *dots,         //
+                     const double *p,      //
+                     const double *r,      //
+                     double *w,            //
+                     const double *kx,     //
+                     const double *ky) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  FusedDots sums = std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), FusedDots{0.0, 0.0, 0.0, 0.0}, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    const double smvp = tealeaf_SMVP(p);
+    w[index] = smvp;
+    return FusedDots{r[index] * r[index], p[index] * smvp, r[index] * smvp, smvp * smvp};
+  });
+
+  dots[0] += sums.rr;
+  dots[1] += sums.pw;
+  dots[2] += sums.rw;
+  dots[3] += sums.ww;
+}
+
+// Performs a fused CG iteration: u += alpha p, r -= alpha w and p = beta p + r, then w = Ap and the dot products of the
+// next iteration. The halo ring around the interior only gets p = beta p + r - alpha w from the exchanged r and w, this
+// model runs the update and the matvec as two sweeps.
+template <typename Index>
+void cg_fused_step(const int x,          //
+                   const int y,          //
+                   const int halo_depth, //
+                   const double alpha,   //
+                   const double beta,    //
+                   double *dots,         //
+                   double *u,            //
+                   double *p,            //
+                   double *r,            //
+                   double *w,            //
+                   const double *kx,     //
+                   const double *ky) {
+  Range2d<Index> range(halo_depth - 1, halo_depth - 1, x - halo_depth + 1, y - halo_depth + 1);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    const Index jj = index / x;
+    const Index kk = index % x;
+    const bool is_ring_row = jj == halo_depth - 1 || jj == y - halo_depth;
+    const bool is_ring_column = kk == halo_depth - 1 || kk == x - halo_depth;
+
+    if (is_ring_row && is_ring_column) return;
+    if (is_ring_row || is_ring_column) {
+      p[index] = beta * p[index] + r[index] - alpha * w[index];
+    } else {
+      u[index] += alpha * p[index];
+      r[index] -= alpha * w[index];
+      p[index] = beta * p[index] + r[index];
+    }
+  });
+
+  cg_fused_calc_w<Index>(x, y, halo_depth, dots, p, r, w, kx, ky);
+}
+
+// Starts a mixed precision CG inner solve of Ae = r from e = 0, the coefficients, r and the correction e are held in single
+// precision, p stays in double precision so that it can be exchanged with the other fields
+template <typename Index>
+void mixed_cg_init(const int x,          //
+                   const int y,          //
+                   const int halo_depth, //
+                   double *rro,          //
+                   const double *r,      //
+                   double *p,            //
+                   const double *kx,     //
+                   const double *ky,     //
+                   float *u_float,       //
+                   float *r_float,       //
+                   float *kx_float,      //
+                   float *ky_float) {
+  {
+    Range2d<Index> range(0, 0, x, y);
+    ranged<Index> it(0, range.sizeXY());
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+      const Index index = range.restore(i, x);
+      kx_float[index] = static_cast<float>(kx[index]);
+      ky_float[index] = static_cast<float>(ky[index]);
+    });
+  }
+
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  *rro += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    u_float[index] = 0.0f;
+    r_float[index] = static_cast<float>(r[index]);
+    p[index] = r_float[index];
+    return p[index] * p[index];
+  });
+}
+
+// Calculates w = Ap with the single precision coefficients
+template <typename Index>
+void mixed_cg_calc_w(const int x,          //
+                     const int y,          //
+                     const int halo_depth, //
+                     double *pw,           //
+                     const double *p,      //
+                     float *w_float,       //
+                     const float *kx,      //
+                     const float *ky) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  *pw += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    const float smvp = tealeaf_SMVP(p);
+    w_float[index] = smvp;
+    return smvp * p[index];
+  });
+}
+
+// Calculates the single precision correction and residual
+template <typename Index>
+void mixed_cg_calc_ur(const int x,          //
+                      const int y,          //
+                      const int halo_depth, //
+                      const double alpha,   //
+                      double *rrn,          //
+                      float *u_float,       //
+                      const double *p,      //
+                      float *r_float,       //
+                      const float *w_float) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  *rrn += std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    u_float[index] += static_cast<float>(alpha * p[index]);
+    r_float[index] -= static_cast<float>(alpha * w_float[index]);
+    return static_cast<double>(r_float[index]) * r_float[index];
+  });
+}
+
+// Calculates p from the single precision residual
+template <typename Index>
+void mixed_cg_calc_p(const int x,          //
+                     const int y,          //
+                     const int halo_depth, //
+                     const double beta,    //
+                     double *p,            //
+                     const float *r_float) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    p[index] = beta * p[index] + r_float[index];
+  });
+}
+
+// Adds the correction of an inner solve to u in double precision
+template <typename Index>
+void mixed_cg_correct(const int x,          //
+                      const int y,          //
+                      const int halo_depth, //
+                      double *u,            //
+                      const float *u_float) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    u[index] += u_float[index];
+  });
+}
+
 // CG solver kernels
 void run_cg_init(Chunk *chunk, Settings &settings, double rx, double ry, double *rro) {
   START_PROFILING(settings.kernel_profile);
-  cg_init(chunk->x, chunk->y, settings.halo_depth, settings.coefficient, rx, ry, rro, chunk->density, chunk->energy, chunk->u, chunk->p,
-          chunk->r, chunk->w, chunk->kx, chunk->ky);
+  tealeaf_VALUE_DISPATCH(settings, chunk, cg_init, chunk->x, chunk->y, settings.halo_depth, settings.coefficient, rx, ry,
+                         settings.float_coefficients, rro, chunk->density, chunk->energy, fields.u, fields.p, fields.r, fields.w, fields.kx,
+                         fields.ky);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_cg_calc_w(Chunk *chunk, Settings &settings, double *pw) {
   START_PROFILING(settings.kernel_profile);
-  cg_calc_w(chunk->x, chunk->y, settings.halo_depth, pw, chunk->p, chunk->w, chunk->kx, chunk->ky);
+  tealeaf_OPERATOR_DISPATCH(settings, chunk, cg_calc_w, chunk->x, chunk->y, settings.halo_depth, pw, fields.p, fields.w);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_cg_calc_ur(Chunk *chunk, Settings &settings, double alpha, double *rrn) {
   START_PROFILING(settings.kernel_profile);
-  cg_calc_ur(chunk->x, chunk->y, settings.halo_depth, alpha, rrn, chunk->u, chunk->p, chunk->r, chunk->w);
+  if (settings.preconditioner != Preconditioner::NONE) {
+    tealeaf_INDEX_DISPATCH(settings, cg_calc_ur_preconditioned, chunk->x, chunk->y, settings.halo_depth, settings.preconditioner, alpha,
+                           rrn, chunk->u, chunk->p, chunk->r, chunk->w, chunk->z, chunk->ky, chunk->mi, chunk->cp, chunk->bfp);
+  } else {
+    tealeaf_VALUE_DISPATCH(settings, chunk, cg_calc_ur, chunk->x, chunk->y, settings.halo_depth, alpha, rrn, fields.u, fields.p,
+                           fields.r, fields.w);
+  }
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_cg_calc_p(Chunk *chunk, Settings &settings, double beta) {
   START_PROFILING(settings.kernel_profile);
-  cg_calc_p(chunk->x, chunk->y, settings.halo_depth, beta, chunk->p, chunk->r);
+  // The preconditioned search direction is built from z rather than r
+  if (settings.preconditioner != Preconditioner::NONE) {
+    tealeaf_INDEX_DISPATCH(settings, cg_calc_p, chunk->x, chunk->y, settings.halo_depth, beta, chunk->p, chunk->z);
+  } else {
+    tealeaf_VALUE_DISPATCH(settings, chunk, cg_calc_p, chunk->x, chunk->y, settings.halo_depth, beta, fields.p, fields.r);
+  }
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_cg_init_preconditioner(Chunk *chunk, Settings &settings, double *rro) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, cg_init_preconditioner, chunk->x, chunk->y, settings.halo_depth, settings.preconditioner, rro, chunk->r,
+                         chunk->p, chunk->z, chunk->kx, chunk->ky, chunk->mi, chunk->cp, chunk->bfp);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Split CG kernels, this model computes the whole sweep once the halo exchange has completed
+void run_cg_calc_w_interior(Chunk *, Settings &, double *) {}
+
+void run_cg_calc_w_boundary(Chunk *chunk, Settings &settings, double *pw) { run_cg_calc_w(chunk, settings, pw); }
+
+// Pipelined CG solver kernels
+void run_pipelined_cg_calc_w(Chunk *chunk, Settings &settings, double *rr, double *wr) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, pipelined_cg_calc_w, chunk->x, chunk->y, settings.halo_depth, rr, wr, chunk->r, chunk->w, chunk->kx,
+                         chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_pipelined_cg_calc_ur(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, pipelined_cg_calc_ur, chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->u, chunk->p, chunk->r,
+                         chunk->s, chunk->w);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Ghysels pipelined CG solver kernels
+void run_ghysels_cg_calc_q(Chunk *chunk, Settings &settings) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, ghysels_cg_calc_q, chunk->x, chunk->y, settings.halo_depth, chunk->w, chunk->q, chunk->kx, chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_ghysels_cg_calc_urw(Chunk *chunk, Settings &settings, double alpha, double beta, double *rr, double *wr) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, ghysels_cg_calc_urw, chunk->x, chunk->y, settings.halo_depth, alpha, beta, rr, wr, chunk->u, chunk->p,
+                         chunk->r, chunk->s, chunk->w, chunk->z, chunk->q);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Fused CG solver kernels
+void run_cg_fused_calc_w(Chunk *chunk, Settings &settings, double *dots) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, cg_fused_calc_w, chunk->x, chunk->y, settings.halo_depth, dots, chunk->p, chunk->r, chunk->w, chunk->kx,
+                         chunk->ky);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_cg_fused_step(Chunk *chunk, Settings &settings, double alpha, double beta, double *dots) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, cg_fused_step, chunk->x, chunk->y, settings.halo_depth, alpha, beta, dots, chunk->u, chunk->p, chunk->r,
+                         chunk->w, chunk->kx, chunk->ky);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
+
+// Mixed precision CG solver kernels
+void run_mixed_cg_init(Chunk *chunk, Settings &settings, double *rro) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_init, chunk->x, chunk->y, settings.halo_depth, rro, chunk->r, chunk->p, chunk->kx, chunk->ky,
+                         chunk->u_float, chunk->r_float, chunk->kx_float, chunk->ky_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_mixed_cg_calc_w(Chunk *chunk, Settings &settings, double *pw) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_calc_w, chunk->x, chunk->y, settings.halo_depth, pw, chunk->p, chunk->w_float, chunk->kx_float,
+                         chunk->ky_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_mixed_cg_calc_ur(Chunk *chunk, Settings &settings, double alpha, double *rrn) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_calc_ur, chunk->x, chunk->y, settings.halo_depth, alpha, rrn, chunk->u_float, chunk->p,
+                         chunk->r_float, chunk->w_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_mixed_cg_calc_p(Chunk *chunk, Settings &settings, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_calc_p, chunk->x, chunk->y, settings.halo_depth, beta, chunk->p, chunk->r_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_mixed_cg_correct(Chunk *chunk, Settings &settings) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, mixed_cg_correct, chunk->x, chunk->y, settings.halo_depth, chunk->u, chunk->u_float);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Multigrid kernels
+void run_multigrid_smooth(Chunk *, Settings &settings, int, bool) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_restrict(Chunk *, Settings &settings, int) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_prolong(Chunk *, Settings &settings, int) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_pack_halo(Chunk *, Settings &settings, int, int, bool, FieldBufferType) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_global_operator(Chunk *, Settings &settings, double *, double *, double *) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_multigrid_copy_coarsest(Chunk *, Settings &settings, bool, double *) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+void run_mg_calc_u(Chunk *, Settings &settings) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
@@ -8,81 +8,96 @@
  */
 
 // Calculates the new value for u.
+template <typename Index, typename Value>
 void cheby_calc_u(const int x,          //
                   const int y,          //
                   const int halo_depth, //
-                  double *u,            //
-                  const double *p) {
-  Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-    const int index = range.restore(i, x);
+                  Value *u,             //
+                  const Value *p) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
     u[index] += p[index];
   });
 }
 
 // Initialises the Chebyshev solver
+template <typename Index, typename Value>
 void cheby_init(const int x,          //
                 const int y,          //
                 const int halo_depth, //
                 const double theta,   //
-                double *u,            //
-                const double *u0,     //
-                double *p,            //
-                double *r,            //
-                double *w,            //
-                const double *kx,     //
-                const double *ky) {
-  Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-    const int index = range.restore(i, x);
+                Value *u,             //
+                const Value *u0,      //
+                Value *p,             //
+                Value *r,             //
+                Value *w,             //
+                const Value *kx,      //
+                const Value *ky) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
     const double smvp = tealeaf_SMVP(u);
     w[index] = smvp;
     r[index] = u0[index] - w[index];
     p[index] = r[index] / theta;
   });
 
-  cheby_calc_u(x, y, halo_depth, u, p);
+  cheby_calc_u<Index>(x, y, halo_depth, u, p);
 }
 
 // The main chebyshev iteration
-void cheby_iterate(const int x,          //
-                   const int y,          //
-                   const int halo_depth, //
-                   double alpha,         //
-                   double beta,          //
-                   double *u,            //
-                   const double *u0,     //
-                   double *p,            //
-                   double *r,            //
-                   double *w,            //
-                   const double *kx,     //
-                   const double *ky) {
-  Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-    const int index = range.restore(i, x);
-    const double smvp = tealeaf_SMVP(u);
+template <typename Index, typename Value, typename Coefficient, bool StoredDiagonal>
+void cheby_iterate(const int x,           //
+                   const int y,           //
+                   const int halo_depth,  //
+                   double alpha,          //
+                   double beta,           //
+                   Value *u,              //
+                   const Value *u0,       //
+                   Value *p,              //
+                   Value *r,              //
+                   Value *w,              //
+                   const Coefficient *kx, //
+                   const Coefficient *ky, //
+                   const double *diag) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    const double smvp = tealeaf_SMVP_STORED(u);
     w[index] = smvp;
     r[index] = u0[index] - w[index];
     p[index] = alpha * p[index] + beta * r[index];
   });
 
-  cheby_calc_u(x, y, halo_depth, u, p);
+  cheby_calc_u<Index>(x, y, halo_depth, u, p);
 }
 
 // Chebyshev solver kernels
 void run_cheby_init(Chunk *chunk, Settings &settings) {
   START_PROFILING(settings.kernel_profile);
-  cheby_init(chunk->x, chunk->y, settings.halo_depth, chunk->theta, chunk->u, chunk->u0, chunk->p, chunk->r, chunk->w, chunk->kx,
-             chunk->ky);
+  tealeaf_VALUE_DISPATCH(settings, chunk, cheby_init, chunk->x, chunk->y, settings.halo_depth, chunk->theta, fields.u, fields.u0,
+                         fields.p, fields.r, fields.w, fields.kx, fields.ky);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_cheby_iterate(Chunk *chunk, Settings &settings, double alpha, double beta) {
   START_PROFILING(settings.kernel_profile);
-  cheby_iterate(chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->u, chunk->u0, chunk->p, chunk->r, chunk->w, chunk->kx,
-                chunk->ky);
+  tealeaf_OPERATOR_DISPATCH(settings, chunk, cheby_iterate, chunk->x, chunk->y, settings.halo_depth, alpha, beta, fields.u, fields.u0,
+                            fields.p, fields.r, fields.w);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
+
+// Split Chebyshev kernels, this model computes the whole sweep once the halo exchange has completed
+void run_cheby_iterate_interior(Chunk *, Settings &, double, double) {}
+
+void run_cheby_iterate_boundary(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  run_cheby_iterate(chunk, settings, alpha, beta);
+}
+
+void run_cheby_iterate_blocked(Chunk *, Settings &settings, int, const double *, const double *) {
+  die(__LINE__, __FILE__, "temporal_block_steps > 1 is not implemented for the %s model\n", settings.model_name.c_str());
+}
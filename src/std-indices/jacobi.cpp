@@ -10,69 +10,77 @@
  */
 
 // Initialises the Jacobi solver
-void jacobi_init(const int x,           //
-                 const int y,           //
-                 const int halo_depth,  //
-                 const int coefficient, //
-                 double rx,             //
-                 double ry,             //
-                 const double *density, //
-                 const double *energy,  //
-                 double *u0,            //
-                 double *u,             //
-                 double *kx,            //
-                 double *ky) {
+template <typename Index, typename Value>
+void jacobi_init(const int x,                   //
+                 const int y,                   //
+                 const int halo_depth,          //
+                 const int coefficient,         //
+                 double rx,                     //
+                 double ry,                     //
+                 const bool float_coefficients, //
+                 const double *density,         //
+                 const double *energy,          //
+                 Value *u0,                     //
+                 Value *u,                      //
+                 Value *kx,                     //
+                 Value *ky) {
   if (coefficient < CONDUCTIVITY && coefficient < RECIP_CONDUCTIVITY) {
     die(__LINE__, __FILE__, "Coefficient %d is not valid.\n", coefficient);
   }
-  Range2d range(1, 1, x - 1, y - 1);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-    const int index = range.restore(i, x);
+  Range2d<Index> range(1, 1, x - 1, y - 1);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
     double temp = energy[index] * density[index];
     u0[index] = temp;
     u[index] = temp;
   });
 
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-    const int index = range.restore(i, x);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
     double densityCentre = (coefficient == CONDUCTIVITY) ? density[index] : 1.0 / density[index];
     double densityLeft = (coefficient == CONDUCTIVITY) ? density[index - 1] : 1.0 / density[index - 1];
     double densityDown = (coefficient == CONDUCTIVITY) ? density[index - x] : 1.0 / density[index - x];
 
     kx[index] = rx * (densityLeft + densityCentre) / (2.0 * densityLeft * densityCentre);
     ky[index] = ry * (densityDown + densityCentre) / (2.0 * densityDown * densityCentre);
+    if (float_coefficients) {
+      kx[index] = static_cast<float>(kx[index]);
+      ky[index] = static_cast<float>(ky[index]);
+    }
   });
 }
 
 // The main Jacobi solve step
-void jacobi_iterate(const int x,          //
-                    const int y,          //
-                    const int halo_depth, //
-                    double *error,        //
-                    const double *kx,     //
-                    const double *ky,     //
-                    const double *u0,     //
-                    double *u,            //
-                    double *r) {
+template <typename Index, typename Value, typename Coefficient, bool StoredDiagonal>
+void jacobi_iterate(const int x,           //
+                    const int y,           //
+                    const int halo_depth,  //
+                    double *error,         //
+                    const Value *u0,       //
+                    Value *u,              //
+                    Value *r,              //
+                    const Coefficient *kx, //
+                    const Coefficient *ky, //
+                    const double *diag) {
 
   {
-    Range2d range(0, 0, x, y);
-    ranged<int> it(0, range.sizeXY());
-    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-      const int index = range.restore(i, x);
+    Range2d<Index> range(0, 0, x, y);
+    ranged<Index> it(0, range.sizeXY());
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+      const Index index = range.restore(i, x);
       r[index] = u[index];
     });
   }
 
   {
-    Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-    ranged<int> it(0, range.sizeXY());
-    *error = std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](int i) {
-      const int index = range.restore(i, x);
+    Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+    ranged<Index> it(0, range.sizeXY());
+    *error = std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+      const Index index = range.restore(i, x);
       u[index] = (u0[index] + (kx[index + 1] * r[index + 1] + kx[index] * r[index - 1]) +
                   (ky[index + x] * r[index + x] + ky[index] * r[index - x])) /
-                 (1.0 + (kx[index] + kx[index + 1]) + (ky[index] + ky[index + x]));
+                 tealeaf_DIAG;
 
       return fabs(u[index] - r[index]);
     });
@@ -82,13 +90,17 @@ void jacobi_iterate(const int x,          //
 // Jacobi solver kernels
 void run_jacobi_init(Chunk *chunk, Settings &settings, double rx, double ry) {
   START_PROFILING(settings.kernel_profile);
-  jacobi_init(chunk->x, chunk->y, settings.halo_depth, settings.coefficient, rx, ry, chunk->density, chunk->energy, chunk->u0, chunk->u,
-              chunk->kx, chunk->ky);
+  tealeaf_VALUE_DISPATCH(settings, chunk, jacobi_init, chunk->x, chunk->y, settings.halo_depth, settings.coefficient, rx, ry,
+                         settings.float_coefficients, chunk->density, chunk->energy, fields.u0, fields.u, fields.kx, fields.ky);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_jacobi_iterate(Chunk *chunk, Settings &settings, double *error) {
   START_PROFILING(settings.kernel_profile);
-  jacobi_iterate(chunk->x, chunk->y, settings.halo_depth, error, chunk->kx, chunk->ky, chunk->u0, chunk->u, chunk->r);
+  tealeaf_OPERATOR_DISPATCH(settings, chunk, jacobi_iterate, chunk->x, chunk->y, settings.halo_depth, error, fields.u0, fields.u, fields.r);
   STOP_PROFILING(settings.kernel_profile, __func__);
-}
\ No newline at end of file
+}
+
+void run_jacobi_iterate_blocked(Chunk *, Settings &settings, int, double *) {
+  die(__LINE__, __FILE__, "temporal_block_steps > 1 is not implemented for the %s model\n", settings.model_name.c_str());
+}
@@ -1,6 +1,8 @@
 #include "dpl_shim.h"
 #include "kernel_interface.h"
 #include "ranged.h"
+#include "std_shared.h"
+#include <chrono>
 
 // Initialisation kernels
 void run_set_chunk_data(Chunk *chunk, Settings &settings) {
@@ -18,13 +20,13 @@ void run_set_chunk_data(Chunk *chunk, Settings &settings) {
   std::for_each(EXEC_POLICY, vy.begin(), vy.end(),
                 [=, vertex_y = chunk->vertex_y](const int ii) { vertex_y[ii] = y_min + dy * (ii - halo_depth); });
 
-  ranged<int> it(0, chunk->x * chunk->y);
+  ranged<int64_t> it(0, static_cast<int64_t>(chunk->x) * chunk->y);
   std::for_each(EXEC_POLICY, it.begin(), it.end(),
                 [=, x = chunk->x, y = chunk->y,                          //
                  vertex_x = chunk->vertex_x, vertex_y = chunk->vertex_y, //
                  cell_x = chunk->cell_x, cell_y = chunk->cell_y,         //
                  x_area = chunk->x_area, y_area = chunk->y_area,         //
-                 volume = chunk->volume](const int ii) {
+                 volume = chunk->volume](const int64_t ii) {
                   if (ii < x) {
                     cell_x[ii] = 0.5 * (vertex_x[ii] + vertex_x[ii + 1]);
                   }
@@ -45,8 +47,8 @@ void run_set_chunk_state(Chunk *chunk, Settings &settings, State *states) {
   {
     double defaultEnergy = states[0].energy;
     double defaultDensity = states[0].density;
-    ranged<int> it(0, chunk->x * chunk->y);
-    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=, density = chunk->density, energy0 = chunk->energy0](int index) {
+    ranged<int64_t> it(0, static_cast<int64_t>(chunk->x) * chunk->y);
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=, density = chunk->density, energy0 = chunk->energy0](int64_t index) {
       energy0[index] = defaultEnergy;
       density[index] = defaultDensity;
     });
@@ -55,12 +57,12 @@ void run_set_chunk_state(Chunk *chunk, Settings &settings, State *states) {
   // Apply all of the states in turn
   for (int ss = 1; ss < settings.num_states; ++ss) {
     State &state = states[ss];
-    ranged<int> it(0, chunk->x * chunk->y);
+    ranged<int64_t> it(0, static_cast<int64_t>(chunk->x) * chunk->y);
     std::for_each(EXEC_POLICY, it.begin(), it.end(),
                   [=, x = chunk->x, y = chunk->y,                          //
                    vertex_x = chunk->vertex_x, vertex_y = chunk->vertex_y, //
                    cell_x = chunk->cell_x, cell_y = chunk->cell_y,         //
-                   density = chunk->density, energy0 = chunk->energy0, u = chunk->u](int ii) {
+                   density = chunk->density, energy0 = chunk->energy0, u = chunk->u](int64_t ii) {
                     const int kk = ii % x;
                     const int jj = ii / x;
 
@@ -94,12 +96,12 @@ void run_set_chunk_state(Chunk *chunk, Settings &settings, State *states) {
 }
 
 // Allocates, and zeroes and individual buffer
-static inline void allocate_buffer(double **a, int x, int y) {
-  *a = alloc_raw<double>(x * y);
+template <typename T> static inline void allocate_buffer(T **a, int x, int y) {
+  *a = alloc_raw<T>(static_cast<int64_t>(x) * y);
   if (!*a) {
     die(__LINE__, __FILE__, "Error allocating buffer %s\n");
   }
-  std::fill(EXEC_POLICY, *a, *a + (x * y), 0.0);
+  std::fill(EXEC_POLICY, *a, *a + static_cast<int64_t>(x) * y, T(0));
 }
 
 void run_model_info(Settings &settings) {
@@ -107,7 +109,7 @@ void run_model_info(Settings &settings) {
   settings.model_kind = ModelKind::Unified;
 }
 
-void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len) {
+void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len, int comms_corner_len) {
 
   if (settings.device_selector) {
     print_and_log(settings, "# Device selection is unsupported for this model, ignoring selector `%s`\n", settings.device_selector);
@@ -126,6 +128,49 @@ void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, i
   allocate_buffer(&chunk->kx, chunk->x, chunk->y);
   allocate_buffer(&chunk->ky, chunk->x, chunk->y);
   allocate_buffer(&chunk->sd, chunk->x, chunk->y);
+  allocate_buffer(&chunk->s, chunk->x, chunk->y);
+  allocate_buffer(&chunk->z, chunk->x, chunk->y);
+  allocate_buffer(&chunk->q, chunk->x, chunk->y);
+
+  // The stored operator and the single precision vectors are only allocated when the run selects them
+  chunk->diag = nullptr;
+  chunk->kx_float = nullptr;
+  chunk->ky_float = nullptr;
+  chunk->u_float = nullptr;
+  chunk->r_float = nullptr;
+  chunk->w_float = nullptr;
+  chunk->u0_float = nullptr;
+  chunk->p_float = nullptr;
+  chunk->sd_float = nullptr;
+  chunk->cp = nullptr;
+  chunk->bfp = nullptr;
+  chunk->mg_levels = 0;
+  chunk->mg_coarse = nullptr;
+  if (settings.stored_diagonal) {
+    allocate_buffer(&chunk->diag, chunk->x, chunk->y);
+  }
+  if (settings.float_coefficients || settings.float_fields || settings.solver == Solver::MIXED_CG_SOLVER) {
+    allocate_buffer(&chunk->kx_float, chunk->x, chunk->y);
+    allocate_buffer(&chunk->ky_float, chunk->x, chunk->y);
+  }
+  if (settings.preconditioner == Preconditioner::JAC_BLOCK) {
+    allocate_buffer(&chunk->cp, chunk->x, chunk->y);
+    allocate_buffer(&chunk->bfp, chunk->x, chunk->y);
+  }
+  if (settings.preconditioner == Preconditioner::MULTIGRID) {
+    die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+  }
+  if (settings.float_fields || settings.solver == Solver::MIXED_CG_SOLVER) {
+    allocate_buffer(&chunk->u_float, chunk->x, chunk->y);
+    allocate_buffer(&chunk->r_float, chunk->x, chunk->y);
+    allocate_buffer(&chunk->w_float, chunk->x, chunk->y);
+  }
+  if (settings.float_fields) {
+    allocate_buffer(&chunk->u0_float, chunk->x, chunk->y);
+    allocate_buffer(&chunk->p_float, chunk->x, chunk->y);
+    allocate_buffer(&chunk->sd_float, chunk->x, chunk->y);
+  }
+
   allocate_buffer(&chunk->volume, chunk->x, chunk->y);
   allocate_buffer(&chunk->x_area, chunk->x + 1, chunk->y);
   allocate_buffer(&chunk->y_area, chunk->x, chunk->y + 1);
@@ -150,6 +195,14 @@ void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, i
   allocate_buffer(&chunk->top_recv, comms_tb_len, 1);
   allocate_buffer(&chunk->bottom_send, comms_tb_len, 1);
   allocate_buffer(&chunk->bottom_recv, comms_tb_len, 1);
+  allocate_buffer(&chunk->bottom_left_send, comms_corner_len, 1);
+  allocate_buffer(&chunk->bottom_left_recv, comms_corner_len, 1);
+  allocate_buffer(&chunk->bottom_right_send, comms_corner_len, 1);
+  allocate_buffer(&chunk->bottom_right_recv, comms_corner_len, 1);
+  allocate_buffer(&chunk->top_left_send, comms_corner_len, 1);
+  allocate_buffer(&chunk->top_left_recv, comms_corner_len, 1);
+  allocate_buffer(&chunk->top_right_send, comms_corner_len, 1);
+  allocate_buffer(&chunk->top_right_recv, comms_corner_len, 1);
 }
 
 void run_kernel_finalise(Chunk *chunk, Settings &) {
@@ -166,6 +219,20 @@ void run_kernel_finalise(Chunk *chunk, Settings &) {
   dealloc_raw(chunk->kx);
   dealloc_raw(chunk->ky);
   dealloc_raw(chunk->sd);
+  dealloc_raw(chunk->s);
+  dealloc_raw(chunk->z);
+  dealloc_raw(chunk->q);
+  dealloc_raw(chunk->diag);
+  dealloc_raw(chunk->kx_float);
+  dealloc_raw(chunk->ky_float);
+  dealloc_raw(chunk->u_float);
+  dealloc_raw(chunk->r_float);
+  dealloc_raw(chunk->w_float);
+  dealloc_raw(chunk->u0_float);
+  dealloc_raw(chunk->p_float);
+  dealloc_raw(chunk->sd_float);
+  dealloc_raw(chunk->cp);
+  dealloc_raw(chunk->bfp);
   dealloc_raw(chunk->volume);
   dealloc_raw(chunk->x_area);
   dealloc_raw(chunk->y_area);
@@ -190,4 +257,70 @@ void run_kernel_finalise(Chunk *chunk, Settings &) {
   dealloc_raw(chunk->top_recv);
   dealloc_raw(chunk->bottom_send);
   dealloc_raw(chunk->bottom_recv);
+  dealloc_raw(chunk->bottom_left_send);
+  dealloc_raw(chunk->bottom_left_recv);
+  dealloc_raw(chunk->bottom_right_send);
+  dealloc_raw(chunk->bottom_right_recv);
+  dealloc_raw(chunk->top_left_send);
+  dealloc_raw(chunk->top_left_recv);
+  dealloc_raw(chunk->top_right_send);
+  dealloc_raw(chunk->top_right_recv);
+}
+
+// Times the STREAM copy, scale and triad kernels and the 5-point matvec over x by y buffers allocated like the fields,
+// keeping the best time of each kernel in seconds
+void run_calibrate(Chunk *, Settings &, int x, int y, double *seconds) {
+  double *a, *b, *c, *w;
+  allocate_buffer(&a, x, y);
+  allocate_buffer(&b, x, y);
+  allocate_buffer(&c, x, y);
+  allocate_buffer(&w, x, y);
+
+  const int64_t cells = static_cast<int64_t>(x) * y;
+  const double scalar = 3.0;
+  std::fill(EXEC_POLICY, a, a + cells, 1.0);
+  std::fill(EXEC_POLICY, b, b + cells, 2.0);
+
+  for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+    seconds[kk] = 0.0;
+  }
+
+  ranged<int64_t> it(0, cells);
+  Range2d<int64_t> range(1, 1, x - 1, y - 1);
+  ranged<int64_t> inner(0, range.sizeXY());
+  for (int rep = 0; rep < CALIBRATE_REPEATS; ++rep) {
+    double elapsed[NUM_CALIBRATE_KERNELS];
+    auto start = std::chrono::steady_clock::now();
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int64_t ii) { c[ii] = a[ii]; });
+    auto end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_COPY] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int64_t ii) { b[ii] = scalar * c[ii]; });
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_SCALE] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int64_t ii) { a[ii] = b[ii] + scalar * c[ii]; });
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_TRIAD] = std::chrono::duration<double>(end - start).count();
+
+    // The matvec of the solvers with a as the vector and b and c as the coefficients
+    start = std::chrono::steady_clock::now();
+    std::for_each(EXEC_POLICY, inner.begin(), inner.end(), [=, kx = b, ky = c](int64_t i) {
+      const int64_t index = range.restore(i, x);
+      w[index] = tealeaf_SMVP(a);
+    });
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_STENCIL] = std::chrono::duration<double>(end - start).count();
+
+    for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+      if (rep == 0 || elapsed[kk] < seconds[kk]) seconds[kk] = elapsed[kk];
+    }
+  }
+
+  dealloc_raw(a);
+  dealloc_raw(b);
+  dealloc_raw(c);
+  dealloc_raw(w);
 }
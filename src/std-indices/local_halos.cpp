@@ -9,17 +9,18 @@
  */
 
 // Update left halo.
+template <typename Index, typename Value>
 void update_left(const int x,          //
                  const int y,          //
                  const int halo_depth, //
                  const int depth,      //
-                 double *buffer) {
-  Range2d range(0, halo_depth, depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
+                 Value *buffer) {
+  Range2d<Index> range(0, halo_depth, depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
     const auto kk = (i / range.sizeY()) + range.fromX;
     const auto jj = (i % range.sizeY()) + range.fromY;
-    int base = jj * x;
+    Index base = jj * x;
     buffer[base + (halo_depth - kk - 1)] = buffer[base + (halo_depth + kk)];
   });
 
@@ -33,17 +34,18 @@ void update_left(const int x,          //
 }
 
 // Update right halo.
+template <typename Index, typename Value>
 void update_right(const int x,          //
                   const int y,          //
                   const int halo_depth, //
                   const int depth,      //
-                  double *buffer) {
-  Range2d range(0, halo_depth, depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
+                  Value *buffer) {
+  Range2d<Index> range(0, halo_depth, depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
     const auto kk = (i / range.sizeY()) + range.fromX;
     const auto jj = (i % range.sizeY()) + range.fromY;
-    int base = jj * x;
+    Index base = jj * x;
     buffer[base + (x - halo_depth + kk)] = buffer[base + (x - halo_depth - 1 - kk)];
   });
 
@@ -57,18 +59,19 @@ void update_right(const int x,          //
 }
 
 // Update top halo.
+template <typename Index, typename Value>
 void update_top(const int x,          //
                 const int y,          //
                 const int halo_depth, //
                 const int depth,      //
-                double *buffer) {
+                Value *buffer) {
 
-  Range2d range(halo_depth, 0, x - halo_depth, depth);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
+  Range2d<Index> range(halo_depth, 0, x - halo_depth, depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
     const auto kk = (i / range.sizeY()) + range.fromX;
     const auto jj = (i % range.sizeY()) + range.fromY;
-    int base = kk;
+    Index base = kk;
     buffer[base + (y - halo_depth + jj) * x] = buffer[base + (y - halo_depth - 1 - jj) * x];
   });
 
@@ -82,17 +85,18 @@ void update_top(const int x,          //
 }
 
 // Updates bottom halo.
+template <typename Index, typename Value>
 void update_bottom(const int x,          //
                    const int y,          //
                    const int halo_depth, //
                    const int depth,      //
-                   double *buffer) {
-  Range2d range(halo_depth, 0, x - halo_depth, depth);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
+                   Value *buffer) {
+  Range2d<Index> range(halo_depth, 0, x - halo_depth, depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
     const auto kk = (i / range.sizeY()) + range.fromX;
     const auto jj = (i % range.sizeY()) + range.fromY;
-    int base = kk;
+    Index base = kk;
     buffer[base + (halo_depth - jj - 1) * x] = buffer[base + (halo_depth + jj) * x];
   });
 
@@ -106,48 +110,57 @@ void update_bottom(const int x,          //
 }
 
 // Updates faces in turn.
-void update_face(const int x, const int y, const int halo_depth, const int *chunk_neighbours, const int depth, double *buffer) {
+template <typename Index, typename Value>
+void update_face(const int x, const int y, const int halo_depth, const int *chunk_neighbours, const int depth, Value *buffer) {
   if (chunk_neighbours[CHUNK_LEFT] == EXTERNAL_FACE) {
-    update_left(x, y, halo_depth, depth, buffer);
+    update_left<Index>(x, y, halo_depth, depth, buffer);
   }
   if (chunk_neighbours[CHUNK_RIGHT] == EXTERNAL_FACE) {
-    update_right(x, y, halo_depth, depth, buffer);
+    update_right<Index>(x, y, halo_depth, depth, buffer);
   }
   if (chunk_neighbours[CHUNK_TOP] == EXTERNAL_FACE) {
-    update_top(x, y, halo_depth, depth, buffer);
+    update_top<Index>(x, y, halo_depth, depth, buffer);
   }
   if (chunk_neighbours[CHUNK_BOTTOM] == EXTERNAL_FACE) {
-    update_bottom(x, y, halo_depth, depth, buffer);
+    update_bottom<Index>(x, y, halo_depth, depth, buffer);
   }
 }
 
-// The kernel for updating halos locally
+// The kernel for updating halos locally, the vectors of the solve are held in its precision Value
+template <typename Index, typename Value>
 void local_halos(int x, int y, int depth, int halo_depth, const int *chunk_neighbours, const bool *fields_to_exchange, double *density,
-                 double *energy0, double *energy, double *u, double *p, double *sd) {
+                 double *energy0, double *energy, Value *u, Value *p, Value *sd, Value *r, Value *w) {
   if (fields_to_exchange[FIELD_DENSITY]) {
-    update_face(x, y, halo_depth, chunk_neighbours, depth, density);
+    update_face<Index>(x, y, halo_depth, chunk_neighbours, depth, density);
   }
   if (fields_to_exchange[FIELD_P]) {
-    update_face(x, y, halo_depth, chunk_neighbours, depth, p);
+    update_face<Index>(x, y, halo_depth, chunk_neighbours, depth, p);
   }
   if (fields_to_exchange[FIELD_ENERGY0]) {
-    update_face(x, y, halo_depth, chunk_neighbours, depth, energy0);
+    update_face<Index>(x, y, halo_depth, chunk_neighbours, depth, energy0);
   }
   if (fields_to_exchange[FIELD_ENERGY1]) {
-    update_face(x, y, halo_depth, chunk_neighbours, depth, energy);
+    update_face<Index>(x, y, halo_depth, chunk_neighbours, depth, energy);
   }
   if (fields_to_exchange[FIELD_U]) {
-    update_face(x, y, halo_depth, chunk_neighbours, depth, u);
+    update_face<Index>(x, y, halo_depth, chunk_neighbours, depth, u);
   }
   if (fields_to_exchange[FIELD_SD]) {
-    update_face(x, y, halo_depth, chunk_neighbours, depth, sd);
+    update_face<Index>(x, y, halo_depth, chunk_neighbours, depth, sd);
+  }
+  if (fields_to_exchange[FIELD_R]) {
+    update_face<Index>(x, y, halo_depth, chunk_neighbours, depth, r);
+  }
+  if (fields_to_exchange[FIELD_W]) {
+    update_face<Index>(x, y, halo_depth, chunk_neighbours, depth, w);
   }
 }
 
 // Solver-wide kernels
 void run_local_halos(Chunk *chunk, Settings &settings, int depth) {
   START_PROFILING(settings.kernel_profile);
-  local_halos(chunk->x, chunk->y, depth, settings.halo_depth, chunk->neighbours, settings.fields_to_exchange, chunk->density,
-              chunk->energy0, chunk->energy, chunk->u, chunk->p, chunk->sd);
+  tealeaf_VALUE_DISPATCH(settings, chunk, local_halos, chunk->x, chunk->y, depth, settings.halo_depth, chunk->neighbours,
+                         settings.fields_to_exchange, chunk->density, chunk->energy0, chunk->energy, fields.u, fields.p, fields.sd,
+                         fields.r, fields.w);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
\ No newline at end of file
@@ -3,110 +3,201 @@
 #include "dpl_shim.h"
 #include "ranged.h"
 #include "shared.h"
+#include <array>
 
 // Packs top data into buffer.
+template <typename Index>
 void pack_top(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int buffer_offset) {
-  ranged<int> it(0, x * depth);
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const int index) {
-    const int offset = x * (y - halo_depth - depth);
+  ranged<Index> it(0, x * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index offset = static_cast<Index>(x) * (y - halo_depth - depth);
     buffer[index + buffer_offset] = field[offset + index];
   });
 }
 
 // Packs bottom data into buffer.
+template <typename Index>
 void pack_bottom(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int buffer_offset) {
-  ranged<int> it(0, x * depth);
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const int index) {
-    const int offset = x * halo_depth;
+  ranged<Index> it(0, x * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index offset = x * halo_depth;
     buffer[index + buffer_offset] = field[offset + index];
   });
 }
 
 // Packs left data into buffer.
+template <typename Index>
 void pack_left(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int buffer_offset) {
-  ranged<int> it(0, y * depth);
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const int index) {
-    const int lines = index / depth;
-    const int offset = halo_depth + lines * (x - depth);
+  ranged<Index> it(0, y * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index lines = index / depth;
+    const Index offset = halo_depth + lines * (x - depth);
     buffer[index + buffer_offset] = field[offset + index];
   });
 }
 
 // Packs right data into buffer.
+template <typename Index>
 void pack_right(const int x, const int y, const int depth, const int halo_depth, const double *field, double *buffer, int buffer_offset) {
-  ranged<int> it(0, y * depth);
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const int index) {
-    const int lines = index / depth;
-    const int offset = x - halo_depth - depth + lines * (x - depth);
+  ranged<Index> it(0, y * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index lines = index / depth;
+    const Index offset = x - halo_depth - depth + lines * (x - depth);
     buffer[index + buffer_offset] = field[offset + index];
   });
 }
 
 // Unpacks top data from buffer.
+template <typename Index>
 void unpack_top(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int buffer_offset) {
-  ranged<int> it(0, x * depth);
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const int index) {
-    const int offset = x * (y - halo_depth);
+  ranged<Index> it(0, x * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index offset = static_cast<Index>(x) * (y - halo_depth);
     field[offset + index] = buffer[index + buffer_offset];
   });
 }
 
 // Unpacks bottom data from buffer.
+template <typename Index>
 void unpack_bottom(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int buffer_offset) {
-  ranged<int> it(0, x * depth);
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const int index) {
-    const int offset = x * (halo_depth - depth);
+  ranged<Index> it(0, x * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index offset = static_cast<Index>(x) * (halo_depth - depth);
     field[offset + index] = buffer[index + buffer_offset];
   });
 }
 
 // Unpacks left data from buffer.
+template <typename Index>
 void unpack_left(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int buffer_offset) {
-  ranged<int> it(0, y * depth);
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const int index) {
-    const int lines = index / depth;
-    const int offset = halo_depth - depth + lines * (x - depth);
+  ranged<Index> it(0, y * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index lines = index / depth;
+    const Index offset = halo_depth - depth + lines * (x - depth);
     field[offset + index] = buffer[index + buffer_offset];
   });
 }
 
 // Unpacks right data from buffer.
+template <typename Index>
 void unpack_right(const int x, const int y, const int depth, const int halo_depth, double *field, const double *buffer, int buffer_offset) {
-  ranged<int> it(0, y * depth);
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const int index) {
-    const int lines = index / depth;
-    const int offset = x - halo_depth + lines * (x - depth);
+  ranged<Index> it(0, y * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index lines = index / depth;
+    const Index offset = x - halo_depth + lines * (x - depth);
     field[offset + index] = buffer[index + buffer_offset];
   });
 }
 
+// Packs the corner block whose lower left cell is (col, row) into buffer.
+template <typename Index>
+void pack_corner(const int x, const int depth, const int col, const int row, const double *field, double *buffer, int buffer_offset) {
+  ranged<Index> it(0, depth * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index offset = col + (row + index / depth) * static_cast<Index>(x) + index % depth;
+    buffer[index + buffer_offset] = field[offset];
+  });
+}
+
+// Unpacks the corner block whose lower left cell is (col, row) from buffer.
+template <typename Index>
+void unpack_corner(const int x, const int depth, const int col, const int row, double *field, const double *buffer, int buffer_offset) {
+  ranged<Index> it(0, depth * depth);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const Index index) {
+    const Index offset = col + (row + index / depth) * static_cast<Index>(x) + index % depth;
+    field[offset] = buffer[index + buffer_offset];
+  });
+}
+
 // Either packs or unpacks data from/to buffers.
-void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType field, FieldBufferType buffer,
-                        int offset) {
-  START_PROFILING(settings.kernel_profile);
+template <typename Index>
+void pack_or_unpack(const int x, const int y, const int depth, const int halo_depth, const int face, bool pack, double *field,
+                    double *buffer, int offset) {
   switch (face) {
     case CHUNK_LEFT:
-      if (pack) pack_left(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
+      if (pack) pack_left<Index>(x, y, depth, halo_depth, field, buffer, offset);
       else
-        unpack_left(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
+        unpack_left<Index>(x, y, depth, halo_depth, field, buffer, offset);
       break;
     case CHUNK_RIGHT:
-      if (pack) pack_right(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
+      if (pack) pack_right<Index>(x, y, depth, halo_depth, field, buffer, offset);
       else
-        unpack_right(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
+        unpack_right<Index>(x, y, depth, halo_depth, field, buffer, offset);
       break;
     case CHUNK_TOP:
-      if (pack) pack_top(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
+      if (pack) pack_top<Index>(x, y, depth, halo_depth, field, buffer, offset);
       else
-        unpack_top(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
+        unpack_top<Index>(x, y, depth, halo_depth, field, buffer, offset);
       break;
     case CHUNK_BOTTOM:
-      if (pack) pack_bottom(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
+      if (pack) pack_bottom<Index>(x, y, depth, halo_depth, field, buffer, offset);
+      else
+        unpack_bottom<Index>(x, y, depth, halo_depth, field, buffer, offset);
+      break;
+    case CHUNK_BOTTOM_LEFT:
+    case CHUNK_BOTTOM_RIGHT:
+    case CHUNK_TOP_LEFT:
+    case CHUNK_TOP_RIGHT: {
+      int col, row;
+      corner_origin(x, y, depth, halo_depth, face, pack, &col, &row);
+      if (pack) pack_corner<Index>(x, depth, col, row, field, buffer, offset);
       else
-        unpack_bottom(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset);
+        unpack_corner<Index>(x, depth, col, row, field, buffer, offset);
       break;
+    }
     default: die(__LINE__, __FILE__, "Incorrect face provided: %d.\n", face);
   }
+}
+
+void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType field, FieldBufferType buffer,
+                        int offset) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, pack_or_unpack, chunk->x, chunk->y, depth, settings.halo_depth, face, pack, field, buffer, offset);
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+// Packs or unpacks the face region of every field in one parallel loop, field ff occupies buffer[ff * field_stride, ...).
+// The fields with a single precision copy in float_fields[ff] are exchanged from it.
+template <typename Index>
+void pack_or_unpack_fields(const int x, const int y, const int depth, const int halo_depth, const int face, bool pack, double **fields,
+                           float **float_fields, const int num_fields, double *buffer, const int field_stride) {
+  int col_min, col_max, row_min, row_max;
+  halo_region(x, y, depth, halo_depth, face, pack, &col_min, &col_max, &row_min, &row_max);
+  const int width = col_max - col_min;
+  const int cells = width * (row_max - row_min);
+
+  std::array<double *, NUM_FIELDS> field_ptrs{};
+  std::copy(fields, fields + num_fields, field_ptrs.begin());
+  std::array<float *, NUM_FIELDS> float_ptrs{};
+  std::copy(float_fields, float_fields + num_fields, float_ptrs.begin());
+
+  ranged<int> it(0, num_fields * cells);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](const int index) {
+    const int ff = index / cells;
+    const int cell = index % cells;
+    const Index offset = col_min + cell % width + (row_min + cell / width) * static_cast<Index>(x);
+    if (float_ptrs[ff]) {
+      if (pack) buffer[ff * field_stride + cell] = float_ptrs[ff][offset];
+      else
+        float_ptrs[ff][offset] = buffer[ff * field_stride + cell];
+    } else {
+      if (pack) buffer[ff * field_stride + cell] = field_ptrs[ff][offset];
+      else
+        field_ptrs[ff][offset] = buffer[ff * field_stride + cell];
+    }
+  });
+}
+
+void run_pack_or_unpack_fields(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType *fields, int num_fields,
+                               FieldBufferType buffer, int field_stride) {
+  START_PROFILING(settings.kernel_profile);
+  // A float_fields solve exchanges its vectors from their single precision copies
+  float *float_fields[NUM_FIELDS];
+  for (int ff = 0; ff < num_fields; ++ff) {
+    float_fields[ff] = settings.float_fields ? float_field(chunk, fields[ff]) : nullptr;
+  }
+  tealeaf_INDEX_DISPATCH(settings, pack_or_unpack_fields, chunk->x, chunk->y, depth, settings.halo_depth, face, pack, fields, float_fields,
+                         num_fields, buffer, field_stride);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
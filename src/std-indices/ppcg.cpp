@@ -1,5 +1,6 @@
 #include "chunk.h"
 #include "dpl_shim.h"
+#include "preconditioner.h"
 #include "ranged.h"
 #include "shared.h"
 #include "std_shared.h"
@@ -8,44 +9,138 @@
  */
 
 // Initialises the PPCG solver
+template <typename Index, typename Value>
 void ppcg_init(const int x,          //
                const int y,          //
                const int halo_depth, //
                double theta,         //
-               const double *r,      //
-               double *sd) {
-  Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-    const int index = range.restore(i, x);
+               const Value *r,       //
+               Value *sd) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
     sd[index] = r[index] / theta;
   });
 }
 
 // The PPCG inner iteration
-void ppcg_inner_iteration(const int x,          //
-                          const int y,          //
-                          const int halo_depth, //
-                          double alpha,         //
-                          double beta,          //
-                          double *u,            //
-                          double *r,            //
-                          const double *kx,     //
-                          const double *ky,     //
-                          double *sd) {
-
-  Range2d range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
-  ranged<int> it(0, range.sizeXY());
-
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-    const int index = range.restore(i, x);
+template <typename Index, typename Value, typename Coefficient, bool StoredDiagonal>
+void ppcg_inner_iteration(const int x,           //
+                          const int y,           //
+                          const int halo_depth,  //
+                          double alpha,          //
+                          double beta,           //
+                          Value *u,              //
+                          Value *r,              //
+                          Value *sd,             //
+                          const Coefficient *kx, //
+                          const Coefficient *ky, //
+                          const double *diag) {
+
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    const double smvp = tealeaf_SMVP_STORED(sd);
+    r[index] -= smvp;
+    u[index] += sd[index];
+  });
+
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    sd[index] = alpha * sd[index] + beta * r[index];
+  });
+}
+
+// The PPCG inner iteration with the preconditioner selected for the run, sd is updated from z = M^-1 r
+template <typename Index>
+void ppcg_inner_iteration_preconditioned(const int x,                         //
+                                         const int y,                         //
+                                         const int halo_depth,                //
+                                         const Preconditioner preconditioner, //
+                                         double alpha,                        //
+                                         double beta,                         //
+                                         double *u,                           //
+                                         double *r,                           //
+                                         double *sd,                          //
+                                         double *z,                           //
+                                         const double *kx,                    //
+                                         const double *ky,                    //
+                                         const double *mi,                    //
+                                         const double *cp,                    //
+                                         const double *bfp) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    const double smvp = tealeaf_SMVP(sd);
+    r[index] -= smvp;
+    u[index] += sd[index];
+  });
+
+  if (preconditioner == Preconditioner::JAC_BLOCK) {
+    jacobi_block_solve<Index>(x, y, halo_depth, ky, r, z, cp, bfp);
+  }
+
+  const bool jac_diag = preconditioner == Preconditioner::JAC_DIAG;
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    if (jac_diag) z[index] = mi[index] * r[index];
+    sd[index] = alpha * sd[index] + beta * z[index];
+  });
+}
+
+// The PPCG inner iteration over the interior grown by ext cells into the halo at internal faces
+template <typename Index>
+void ppcg_inner_iteration_ca(const int x,                 //
+                             const int y,                 //
+                             const int halo_depth,        //
+                             const int ext,               //
+                             const int *chunk_neighbours, //
+                             double alpha,                //
+                             double beta,                 //
+                             double *u,                   //
+                             double *r,                   //
+                             const double *kx,            //
+                             const double *ky,            //
+                             double *sd) {
+  const int x_min = halo_depth - (chunk_neighbours[CHUNK_LEFT] == EXTERNAL_FACE ? 0 : ext);
+  const int x_max = x - halo_depth + (chunk_neighbours[CHUNK_RIGHT] == EXTERNAL_FACE ? 0 : ext);
+  const int y_min = halo_depth - (chunk_neighbours[CHUNK_BOTTOM] == EXTERNAL_FACE ? 0 : ext);
+  const int y_max = y - halo_depth + (chunk_neighbours[CHUNK_TOP] == EXTERNAL_FACE ? 0 : ext);
+
+  // Reflect sd at external faces, including the rows and columns grown into the halo
+  ranged<Index> rows(y_min, y_max);
+  ranged<Index> cols(x_min, x_max);
+  if (chunk_neighbours[CHUNK_LEFT] == EXTERNAL_FACE) {
+    std::for_each(EXEC_POLICY, rows.begin(), rows.end(), [=](Index jj) { sd[jj * x + halo_depth - 1] = sd[jj * x + halo_depth]; });
+  }
+  if (chunk_neighbours[CHUNK_RIGHT] == EXTERNAL_FACE) {
+    std::for_each(EXEC_POLICY, rows.begin(), rows.end(), [=](Index jj) { sd[jj * x + x - halo_depth] = sd[jj * x + x - halo_depth - 1]; });
+  }
+  if (chunk_neighbours[CHUNK_BOTTOM] == EXTERNAL_FACE) {
+    std::for_each(EXEC_POLICY, cols.begin(), cols.end(), [=](Index kk) { sd[(halo_depth - 1) * x + kk] = sd[halo_depth * x + kk]; });
+  }
+  if (chunk_neighbours[CHUNK_TOP] == EXTERNAL_FACE) {
+    std::for_each(EXEC_POLICY, cols.begin(), cols.end(),
+                  [=](Index kk) { sd[static_cast<Index>(y - halo_depth) * x + kk] = sd[static_cast<Index>(y - halo_depth - 1) * x + kk]; });
+  }
+
+  Range2d<Index> range(x_min, y_min, x_max, y_max);
+  ranged<Index> it(0, range.sizeXY());
+
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
     const double smvp = tealeaf_SMVP(sd);
     r[index] -= smvp;
     u[index] += sd[index];
   });
 
-  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](int i) {
-    const int index = range.restore(i, x);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
     sd[index] = alpha * sd[index] + beta * r[index];
   });
 }
@@ -53,12 +148,41 @@ void ppcg_inner_iteration(const int x,          //
 // PPCG solver kernels
 void run_ppcg_init(Chunk *chunk, Settings &settings) {
   START_PROFILING(settings.kernel_profile);
-  ppcg_init(chunk->x, chunk->y, settings.halo_depth, chunk->theta, chunk->r, chunk->sd);
+  // The preconditioned inner iterations start from z rather than r
+  if (settings.preconditioner != Preconditioner::NONE) {
+    tealeaf_INDEX_DISPATCH(settings, ppcg_init, chunk->x, chunk->y, settings.halo_depth, chunk->theta, chunk->z, chunk->sd);
+  } else {
+    tealeaf_VALUE_DISPATCH(settings, chunk, ppcg_init, chunk->x, chunk->y, settings.halo_depth, chunk->theta, fields.r, fields.sd);
+  }
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
 void run_ppcg_inner_iteration(Chunk *chunk, Settings &settings, double alpha, double beta) {
   START_PROFILING(settings.kernel_profile);
-  ppcg_inner_iteration(chunk->x, chunk->y, settings.halo_depth, alpha, beta, chunk->u, chunk->r, chunk->kx, chunk->ky, chunk->sd);
+  if (settings.preconditioner != Preconditioner::NONE) {
+    tealeaf_INDEX_DISPATCH(settings, ppcg_inner_iteration_preconditioned, chunk->x, chunk->y, settings.halo_depth, settings.preconditioner,
+                           alpha, beta, chunk->u, chunk->r, chunk->sd, chunk->z, chunk->kx, chunk->ky, chunk->mi, chunk->cp, chunk->bfp);
+  } else {
+    tealeaf_OPERATOR_DISPATCH(settings, chunk, ppcg_inner_iteration, chunk->x, chunk->y, settings.halo_depth, alpha, beta, fields.u,
+                              fields.r, fields.sd);
+  }
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
+void run_ppcg_inner_iteration_ca(Chunk *chunk, Settings &settings, int ext, double alpha, double beta) {
+  START_PROFILING(settings.kernel_profile);
+  tealeaf_INDEX_DISPATCH(settings, ppcg_inner_iteration_ca, chunk->x, chunk->y, settings.halo_depth, ext, chunk->neighbours, alpha, beta,
+                         chunk->u, chunk->r, chunk->kx, chunk->ky, chunk->sd);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
+
+// Split PPCG kernels, this model computes the whole sweep once the halo exchange has completed
+void run_ppcg_inner_iteration_interior(Chunk *, Settings &) {}
+
+void run_ppcg_inner_iteration_boundary(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  run_ppcg_inner_iteration(chunk, settings, alpha, beta);
+}
+
+void run_ppcg_calc_sd(Chunk *, Settings &settings, double, double) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "dpl_shim.h"
+#include "ranged.h"
+#include "settings.h"
+#include "shared.h"
+#include "std_shared.h"
+
+/*
+ *		PRECONDITIONER KERNELS
+ */
+
+// Calculates the inverse diagonal of the operator for the diagonal Jacobi preconditioner
+template <typename Index>
+void jacobi_diag_init(const int x,          //
+                      const int y,          //
+                      const int halo_depth, //
+                      const double *kx,     //
+                      const double *ky,     //
+                      double *mi) {
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    mi[index] = 1.0 / (1.0 + (kx[index + 1] + kx[index]) + (ky[index + x] + ky[index]));
+  });
+}
+
+// Factorises the tridiagonal blocks of the block Jacobi preconditioner, each block couples JAC_BLOCK_SIZE cells of a
+// column through ky and drops the coupling to the cells above and below the block. Every column of every block is
+// solved independently.
+template <typename Index>
+void jacobi_block_init(const int x,          //
+                       const int y,          //
+                       const int halo_depth, //
+                       const double *kx,     //
+                       const double *ky,     //
+                       double *cp,           //
+                       double *bfp) {
+  const Index x_inner = x - 2 * halo_depth;
+  const Index num_blocks = (y - 2 * halo_depth + JAC_BLOCK_SIZE - 1) / JAC_BLOCK_SIZE;
+  ranged<Index> it(0, num_blocks * x_inner);
+  std::for_each(EXEC_POLICY, it.begin(), it.end(), [=](Index i) {
+    const Index kk = halo_depth + i % x_inner;
+    const Index bottom = halo_depth + (i / x_inner) * JAC_BLOCK_SIZE;
+    const Index top = tealeaf_MIN(bottom + JAC_BLOCK_SIZE, static_cast<Index>(y - halo_depth));
+    for (Index jj = bottom; jj < top; ++jj) {
+      const Index index = kk + jj * x;
+      const double diagonal = 1.0 + (kx[index + 1] + kx[index]) + (ky[index + x] + ky[index]);
+      bfp[index] = 1.0 / ((jj == bottom) ? diagonal : diagonal + ky[index] * cp[index - x]);
+      cp[index] = -ky[index + x] * bfp[index];
+    }
+  });
+}
+
+// Solves z = M^-1 r with the block Jacobi preconditioner and returns r.z
+template <typename Index>
+double jacobi_block_solve(const int x,          //
+                          const int y,          //
+                          const int halo_depth, //
+                          const double *ky,     //
+                          const double *r,      //
+                          double *z,            //
+                          const double *cp,     //
+                          const double *bfp) {
+  const Index x_inner = x - 2 * halo_depth;
+  const Index num_blocks = (y - 2 * halo_depth + JAC_BLOCK_SIZE - 1) / JAC_BLOCK_SIZE;
+  ranged<Index> it(0, num_blocks * x_inner);
+  return std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+    const Index kk = halo_depth + i % x_inner;
+    const Index bottom = halo_depth + (i / x_inner) * JAC_BLOCK_SIZE;
+    const Index top = tealeaf_MIN(bottom + JAC_BLOCK_SIZE, static_cast<Index>(y - halo_depth));
+
+    // Forward elimination
+    z[kk + bottom * x] = r[kk + bottom * x] * bfp[kk + bottom * x];
+    for (Index jj = bottom + 1; jj < top; ++jj) {
+      const Index index = kk + jj * x;
+      z[index] = (r[index] + ky[index] * z[index - x]) * bfp[index];
+    }
+
+    // Back substitution
+    double rz = r[kk + (top - 1) * x] * z[kk + (top - 1) * x];
+    for (Index jj = top - 2; jj >= bottom; --jj) {
+      const Index index = kk + jj * x;
+      z[index] -= cp[index] * z[index + x];
+      rz += r[index] * z[index];
+    }
+    return rz;
+  });
+}
+
+// Solves z = M^-1 r with the preconditioner selected for the run and returns r.z
+template <typename Index>
+double apply_preconditioner(const int x,                         //
+                            const int y,                         //
+                            const int halo_depth,                //
+                            const Preconditioner preconditioner, //
+                            const double *ky,                    //
+                            const double *r,                     //
+                            double *z,                           //
+                            const double *mi,                    //
+                            const double *cp,                    //
+                            const double *bfp) {
+  if (preconditioner == Preconditioner::JAC_BLOCK) {
+    return jacobi_block_solve<Index>(x, y, halo_depth, ky, r, z, cp, bfp);
+  }
+
+  Range2d<Index> range(halo_depth, halo_depth, x - halo_depth, y - halo_depth);
+  ranged<Index> it(0, range.sizeXY());
+  return std::transform_reduce(EXEC_POLICY, it.begin(), it.end(), 0.0, std::plus<>(), [=](Index i) {
+    const Index index = range.restore(i, x);
+    z[index] = mi[index] * r[index];
+    return r[index] * z[index];
+  });
+}
@@ -18,8 +18,8 @@ template <typename N = int> struct Range2d {
   [[nodiscard]] constexpr inline N sizeXY() const { return sizeX() * sizeY(); }
 
   constexpr inline N restore(N i, N xLimit) const {
-    const int jj = (i / sizeX()) + fromX;
-    const int kk = (i % sizeX()) + fromY;
+    const N jj = (i / sizeX()) + fromY;
+    const N kk = (i % sizeX()) + fromX;
     return kk + jj * xLimit;
   }
 
@@ -121,4 +121,8 @@ void run_jacobi_iterate(Chunk *chunk, Settings &settings, double *error) {
                  *(chunk->ext->device_queue));
 
   STOP_PROFILING(settings.kernel_profile, __func__);
-}
\ No newline at end of file
+}
+
+void run_jacobi_iterate_blocked(Chunk *, Settings &settings, int, double *) {
+  die(__LINE__, __FILE__, "temporal_block_steps > 1 is not implemented for the %s model\n", settings.model_name.c_str());
+}
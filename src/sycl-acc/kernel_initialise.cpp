@@ -2,6 +2,7 @@
 #include "settings.h"
 #include "shared.h"
 #include "sycl_shared.hpp"
+#include <chrono>
 
 using namespace cl::sycl;
 
@@ -208,7 +209,10 @@ void run_model_info(Settings &settings) {
   settings.model_kind = ModelKind::Offload;
 }
 
-void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len) {
+void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len, int comms_corner_len) {
+  if (settings.float_fields) {
+    die(__LINE__, __FILE__, "float_fields is not implemented for the %s model\n", settings.model_name.c_str());
+  }
   auto selector = !settings.device_selector ? "0" : std::string(settings.device_selector);
   auto devices = sycl::device::get_devices();
 
@@ -276,6 +280,14 @@ void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, i
   chunk->top_recv = new SyclBuffer{range<1>(size_t(comms_tb_len))};
   chunk->bottom_send = new SyclBuffer{range<1>(size_t(comms_tb_len))};
   chunk->bottom_recv = new SyclBuffer{range<1>(size_t(comms_tb_len))};
+  chunk->bottom_left_send = new SyclBuffer{range<1>(size_t(comms_corner_len))};
+  chunk->bottom_left_recv = new SyclBuffer{range<1>(size_t(comms_corner_len))};
+  chunk->bottom_right_send = new SyclBuffer{range<1>(size_t(comms_corner_len))};
+  chunk->bottom_right_recv = new SyclBuffer{range<1>(size_t(comms_corner_len))};
+  chunk->top_left_send = new SyclBuffer{range<1>(size_t(comms_corner_len))};
+  chunk->top_left_recv = new SyclBuffer{range<1>(size_t(comms_corner_len))};
+  chunk->top_right_send = new SyclBuffer{range<1>(size_t(comms_corner_len))};
+  chunk->top_right_recv = new SyclBuffer{range<1>(size_t(comms_corner_len))};
 
   allocate_buffer(&(chunk->cg_alphas), settings.max_iters, 1);
   allocate_buffer(&(chunk->cg_betas), settings.max_iters, 1);
@@ -322,6 +334,100 @@ void run_kernel_finalise(Chunk *chunk, Settings &) {
   delete chunk->top_recv;
   delete chunk->bottom_send;
   delete chunk->bottom_recv;
+  delete chunk->bottom_left_send;
+  delete chunk->bottom_left_recv;
+  delete chunk->bottom_right_send;
+  delete chunk->bottom_right_recv;
+  delete chunk->top_left_send;
+  delete chunk->top_left_recv;
+  delete chunk->top_right_send;
+  delete chunk->top_right_recv;
 
   delete chunk->ext->device_queue;
 }
+
+void run_calibrate(Chunk *chunk, Settings &, int x, int y, double *seconds) {
+  queue &device_queue = *chunk->ext->device_queue;
+  const size_t cells = static_cast<size_t>(x) * y;
+  SyclBuffer aBuff{range<1>{cells}};
+  SyclBuffer bBuff{range<1>{cells}};
+  SyclBuffer cBuff{range<1>{cells}};
+  SyclBuffer wBuff{range<1>{cells}};
+
+  const double scalar = 3.0;
+  device_queue.submit([&](handler &h) {
+    auto a = aBuff.get_access<access::mode::discard_write>(h);
+    auto b = bBuff.get_access<access::mode::discard_write>(h);
+    auto c = cBuff.get_access<access::mode::discard_write>(h);
+    auto w = wBuff.get_access<access::mode::discard_write>(h);
+    h.parallel_for<class calibrate_init>(range<1>(cells), [=](id<1> idx) {
+      a[idx[0]] = 1.0;
+      b[idx[0]] = 2.0;
+      c[idx[0]] = 0.0;
+      w[idx[0]] = 0.0;
+    });
+  });
+  device_queue.wait_and_throw();
+
+  for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+    seconds[kk] = 0.0;
+  }
+
+  for (int rep = 0; rep < CALIBRATE_REPEATS; ++rep) {
+    double elapsed[NUM_CALIBRATE_KERNELS];
+    auto start = std::chrono::steady_clock::now();
+    device_queue.submit([&](handler &h) {
+      auto a = aBuff.get_access<access::mode::read>(h);
+      auto c = cBuff.get_access<access::mode::discard_write>(h);
+      h.parallel_for<class calibrate_copy>(range<1>(cells), [=](id<1> idx) { c[idx[0]] = a[idx[0]]; });
+    });
+    device_queue.wait_and_throw();
+    auto end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_COPY] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    device_queue.submit([&](handler &h) {
+      auto c = cBuff.get_access<access::mode::read>(h);
+      auto b = bBuff.get_access<access::mode::discard_write>(h);
+      h.parallel_for<class calibrate_scale>(range<1>(cells), [=](id<1> idx) { b[idx[0]] = scalar * c[idx[0]]; });
+    });
+    device_queue.wait_and_throw();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_SCALE] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    device_queue.submit([&](handler &h) {
+      auto b = bBuff.get_access<access::mode::read>(h);
+      auto c = cBuff.get_access<access::mode::read>(h);
+      auto a = aBuff.get_access<access::mode::discard_write>(h);
+      h.parallel_for<class calibrate_triad>(range<1>(cells), [=](id<1> idx) { a[idx[0]] = b[idx[0]] + scalar * c[idx[0]]; });
+    });
+    device_queue.wait_and_throw();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_TRIAD] = std::chrono::duration<double>(end - start).count();
+
+    // The matvec of the solvers with a as the vector and b and c as the coefficients
+    start = std::chrono::steady_clock::now();
+    device_queue.submit([&](handler &h) {
+      auto a = aBuff.get_access<access::mode::read>(h);
+      auto kx = bBuff.get_access<access::mode::read>(h);
+      auto ky = cBuff.get_access<access::mode::read>(h);
+      auto w = wBuff.get_access<access::mode::write>(h);
+      h.parallel_for<class calibrate_stencil>(range<1>(cells), [=](id<1> idx) {
+        const auto kk = idx[0] % x;
+        const auto jj = idx[0] / x;
+        const size_t index = idx[0];
+        if (kk > 0 && kk < x - 1 && jj > 0 && jj < y - 1) {
+          w[index] = tealeaf_SMVP(a);
+        }
+      });
+    });
+    device_queue.wait_and_throw();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_STENCIL] = std::chrono::duration<double>(end - start).count();
+
+    for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+      if (rep == 0 || elapsed[kk] < seconds[kk]) seconds[kk] = elapsed[kk];
+    }
+  }
+}
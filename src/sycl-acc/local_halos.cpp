@@ -113,7 +113,8 @@ void update_face(const int x, const int y, const int halo_depth, const int *chun
 
 // The kernel for updating halos locally
 void local_halos(int x, int y, int depth, int halo_depth, const int *chunk_neighbours, const bool *fields_to_exchange, SyclBuffer &density,
-                 SyclBuffer &energy0, SyclBuffer &energy, SyclBuffer &u, SyclBuffer &p, SyclBuffer &sd, queue &queue) {
+                 SyclBuffer &energy0, SyclBuffer &energy, SyclBuffer &u, SyclBuffer &p, SyclBuffer &sd, SyclBuffer &r, SyclBuffer &w,
+                 queue &queue) {
   if (fields_to_exchange[FIELD_DENSITY]) {
     update_face(x, y, halo_depth, chunk_neighbours, depth, density, queue);
   }
@@ -132,12 +133,19 @@ void local_halos(int x, int y, int depth, int halo_depth, const int *chunk_neigh
   if (fields_to_exchange[FIELD_SD]) {
     update_face(x, y, halo_depth, chunk_neighbours, depth, sd, queue);
   }
+  if (fields_to_exchange[FIELD_R]) {
+    update_face(x, y, halo_depth, chunk_neighbours, depth, r, queue);
+  }
+  if (fields_to_exchange[FIELD_W]) {
+    update_face(x, y, halo_depth, chunk_neighbours, depth, w, queue);
+  }
 }
 
 // Solver-wide kernels
 void run_local_halos(Chunk *chunk, Settings &settings, int depth) {
   START_PROFILING(settings.kernel_profile);
   local_halos(chunk->x, chunk->y, depth, settings.halo_depth, chunk->neighbours, settings.fields_to_exchange, *chunk->density,
-              *chunk->energy0, *chunk->energy, *chunk->u, *chunk->p, *chunk->sd, *chunk->ext->device_queue);
+              *chunk->energy0, *chunk->energy, *chunk->u, *chunk->p, *chunk->sd, *chunk->r, *chunk->w,
+              *chunk->ext->device_queue);
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
\ No newline at end of file
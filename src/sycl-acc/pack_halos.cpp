@@ -177,6 +177,48 @@ void unpack_right(const int x,            //
 #endif
 }
 
+// Packs the corner block whose lower left cell is (col, row)
+void pack_corner(const int x,            //
+                 const int depth,        //
+                 const int col,          //
+                 const int row,          //
+                 SyclBuffer &fieldBuff,  //
+                 SyclBuffer &bufferBuff, //
+                 const int buffer_offset, queue &device_queue) {
+  device_queue.submit([&](handler &h) {
+    auto buffer = bufferBuff.get_access<access::mode::write>(h);
+    auto field = fieldBuff.get_access<access::mode::read>(h);
+    h.parallel_for<class pack_corner>(range<1>(depth * depth), [=](id<1> idx) {
+      const auto offset = col + (row + idx[0] / depth) * x + idx[0] % depth;
+      buffer[idx[0] + buffer_offset] = field[offset];
+    });
+  });
+#ifdef ENABLE_PROFILING
+  device_queue.wait_and_throw();
+#endif
+}
+
+// Unpacks the corner block whose lower left cell is (col, row)
+void unpack_corner(const int x,            //
+                   const int depth,        //
+                   const int col,          //
+                   const int row,          //
+                   SyclBuffer &fieldBuff,  //
+                   SyclBuffer &bufferBuff, //
+                   const int buffer_offset, queue &device_queue) {
+  device_queue.submit([&](handler &h) {
+    auto buffer = bufferBuff.get_access<access::mode::read>(h);
+    auto field = fieldBuff.get_access<access::mode::write>(h);
+    h.parallel_for<class unpack_corner>(range<1>(depth * depth), [=](id<1> idx) {
+      const auto offset = col + (row + idx[0] / depth) * x + idx[0] % depth;
+      field[offset] = buffer[idx[0] + buffer_offset];
+    });
+  });
+#ifdef ENABLE_PROFILING
+  device_queue.wait_and_throw();
+#endif
+}
+
 void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType field, FieldBufferType buffer,
                         int offset) {
   START_PROFILING(settings.kernel_profile);
@@ -201,6 +243,17 @@ void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, b
       else
         unpack_bottom(chunk->x, chunk->y, depth, settings.halo_depth, *field, *buffer, offset, *chunk->ext->device_queue);
       break;
+    case CHUNK_BOTTOM_LEFT:
+    case CHUNK_BOTTOM_RIGHT:
+    case CHUNK_TOP_LEFT:
+    case CHUNK_TOP_RIGHT: {
+      int col, row;
+      corner_origin(chunk->x, chunk->y, depth, settings.halo_depth, face, pack, &col, &row);
+      if (pack) pack_corner(chunk->x, depth, col, row, *field, *buffer, offset, *chunk->ext->device_queue);
+      else
+        unpack_corner(chunk->x, depth, col, row, *field, *buffer, offset, *chunk->ext->device_queue);
+      break;
+    }
     default: die(__LINE__, __FILE__, "Incorrect face provided: %d.\n", face);
   }
   STOP_PROFILING(settings.kernel_profile, __func__);
@@ -227,6 +280,14 @@ template <typename A> decltype(auto) get_native_ptr_or_throw(sycl::interop_handl
 }
 #endif
 
+// Buffers cannot be gathered into one accessor list of runtime length, so each field is packed by its own kernel
+void run_pack_or_unpack_fields(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType *fields, int num_fields,
+                               FieldBufferType buffer, int field_stride) {
+  for (int ff = 0; ff < num_fields; ++ff) {
+    run_pack_or_unpack(chunk, settings, depth, face, pack, fields[ff], buffer, ff * field_stride);
+  }
+}
+
 void run_send_recv_halo(Chunk *chunk, Settings &settings,                                 //
                         FieldBufferType src_send_buffer, FieldBufferType src_recv_buffer, //
                         StagingBufferType, StagingBufferType,                             //
@@ -108,3 +108,7 @@ void run_jacobi_iterate(Chunk *chunk, Settings &settings, double *error) {
 
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
+
+void run_jacobi_iterate_blocked(Chunk *, Settings &settings, int, double *) {
+  die(__LINE__, __FILE__, "temporal_block_steps > 1 is not implemented for the %s model\n", settings.model_name.c_str());
+}
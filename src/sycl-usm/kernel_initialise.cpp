@@ -2,6 +2,7 @@
 #include "settings.h"
 #include "shared.h"
 #include "sycl_shared.hpp"
+#include <chrono>
 
 using namespace cl::sycl;
 
@@ -195,7 +196,10 @@ void run_model_info(Settings &settings) {
   settings.model_kind = ModelKind::Unified;
 }
 
-void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len) {
+void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, int comms_tb_len, int comms_corner_len) {
+  if (settings.float_fields) {
+    die(__LINE__, __FILE__, "float_fields is not implemented for the %s model\n", settings.model_name.c_str());
+  }
   auto selector = !settings.device_selector ? "0" : std::string(settings.device_selector);
   auto devices = sycl::device::get_devices();
 
@@ -263,6 +267,14 @@ void run_kernel_initialise(Chunk *chunk, Settings &settings, int comms_lr_len, i
   chunk->top_recv = sycl::malloc_shared<double>(comms_tb_len, *chunk->ext->device_queue);
   chunk->bottom_send = sycl::malloc_shared<double>(comms_tb_len, *chunk->ext->device_queue);
   chunk->bottom_recv = sycl::malloc_shared<double>(comms_tb_len, *chunk->ext->device_queue);
+  chunk->bottom_left_send = sycl::malloc_shared<double>(comms_corner_len, *chunk->ext->device_queue);
+  chunk->bottom_left_recv = sycl::malloc_shared<double>(comms_corner_len, *chunk->ext->device_queue);
+  chunk->bottom_right_send = sycl::malloc_shared<double>(comms_corner_len, *chunk->ext->device_queue);
+  chunk->bottom_right_recv = sycl::malloc_shared<double>(comms_corner_len, *chunk->ext->device_queue);
+  chunk->top_left_send = sycl::malloc_shared<double>(comms_corner_len, *chunk->ext->device_queue);
+  chunk->top_left_recv = sycl::malloc_shared<double>(comms_corner_len, *chunk->ext->device_queue);
+  chunk->top_right_send = sycl::malloc_shared<double>(comms_corner_len, *chunk->ext->device_queue);
+  chunk->top_right_recv = sycl::malloc_shared<double>(comms_corner_len, *chunk->ext->device_queue);
 
   chunk->ext->reduction_cg_rro = sycl::malloc_shared<double>(1, *chunk->ext->device_queue);
   chunk->ext->reduction_cg_pw = sycl::malloc_shared<double>(1, *chunk->ext->device_queue);
@@ -316,6 +328,14 @@ void run_kernel_finalise(Chunk *chunk, Settings &) {
   sycl::free(chunk->top_recv, *chunk->ext->device_queue);
   sycl::free(chunk->bottom_send, *chunk->ext->device_queue);
   sycl::free(chunk->bottom_recv, *chunk->ext->device_queue);
+  sycl::free(chunk->bottom_left_send, *chunk->ext->device_queue);
+  sycl::free(chunk->bottom_left_recv, *chunk->ext->device_queue);
+  sycl::free(chunk->bottom_right_send, *chunk->ext->device_queue);
+  sycl::free(chunk->bottom_right_recv, *chunk->ext->device_queue);
+  sycl::free(chunk->top_left_send, *chunk->ext->device_queue);
+  sycl::free(chunk->top_left_recv, *chunk->ext->device_queue);
+  sycl::free(chunk->top_right_send, *chunk->ext->device_queue);
+  sycl::free(chunk->top_right_recv, *chunk->ext->device_queue);
 
   sycl::free(chunk->ext->reduction_cg_rro, *chunk->ext->device_queue);
   sycl::free(chunk->ext->reduction_cg_pw, *chunk->ext->device_queue);
@@ -326,3 +346,84 @@ void run_kernel_finalise(Chunk *chunk, Settings &) {
 
   delete chunk->ext->device_queue;
 }
+
+void run_calibrate(Chunk *chunk, Settings &, int x, int y, double *seconds) {
+  queue &device_queue = *chunk->ext->device_queue;
+  const size_t cells = static_cast<size_t>(x) * y;
+  double *a = sycl::malloc_shared<double>(cells, device_queue);
+  double *b = sycl::malloc_shared<double>(cells, device_queue);
+  double *c = sycl::malloc_shared<double>(cells, device_queue);
+  double *w = sycl::malloc_shared<double>(cells, device_queue);
+
+  const double scalar = 3.0;
+  device_queue
+      .submit([&](handler &h) {
+        h.parallel_for<class calibrate_init>(range<1>(cells), [=](id<1> idx) {
+          a[idx[0]] = 1.0;
+          b[idx[0]] = 2.0;
+          c[idx[0]] = 0.0;
+          w[idx[0]] = 0.0;
+        });
+      })
+      .wait_and_throw();
+
+  for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+    seconds[kk] = 0.0;
+  }
+
+  for (int rep = 0; rep < CALIBRATE_REPEATS; ++rep) {
+    double elapsed[NUM_CALIBRATE_KERNELS];
+    auto start = std::chrono::steady_clock::now();
+    device_queue
+        .submit([&](handler &h) { h.parallel_for<class calibrate_copy>(range<1>(cells), [=](id<1> idx) { c[idx[0]] = a[idx[0]]; }); })
+        .wait_and_throw();
+    auto end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_COPY] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    device_queue
+        .submit([&](handler &h) {
+          h.parallel_for<class calibrate_scale>(range<1>(cells), [=](id<1> idx) { b[idx[0]] = scalar * c[idx[0]]; });
+        })
+        .wait_and_throw();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_SCALE] = std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    device_queue
+        .submit([&](handler &h) {
+          h.parallel_for<class calibrate_triad>(range<1>(cells), [=](id<1> idx) { a[idx[0]] = b[idx[0]] + scalar * c[idx[0]]; });
+        })
+        .wait_and_throw();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_TRIAD] = std::chrono::duration<double>(end - start).count();
+
+    // The matvec of the solvers with a as the vector and b and c as the coefficients
+    const double *kx = b;
+    const double *ky = c;
+    start = std::chrono::steady_clock::now();
+    device_queue
+        .submit([&](handler &h) {
+          h.parallel_for<class calibrate_stencil>(range<1>(cells), [=](id<1> idx) {
+            const auto kk = idx[0] % x;
+            const auto jj = idx[0] / x;
+            const size_t index = idx[0];
+            if (kk > 0 && kk < x - 1 && jj > 0 && jj < y - 1) {
+              w[index] = tealeaf_SMVP(a);
+            }
+          });
+        })
+        .wait_and_throw();
+    end = std::chrono::steady_clock::now();
+    elapsed[CALIBRATE_STENCIL] = std::chrono::duration<double>(end - start).count();
+
+    for (int kk = 0; kk < NUM_CALIBRATE_KERNELS; ++kk) {
+      if (rep == 0 || elapsed[kk] < seconds[kk]) seconds[kk] = elapsed[kk];
+    }
+  }
+
+  sycl::free(a, device_queue);
+  sycl::free(b, device_queue);
+  sycl::free(c, device_queue);
+  sycl::free(w, device_queue);
+}
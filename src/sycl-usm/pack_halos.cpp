@@ -2,6 +2,7 @@
 #include "comms.h"
 #include "shared.h"
 #include "sycl_shared.hpp"
+#include <array>
 
 using namespace cl::sycl;
 
@@ -153,6 +154,42 @@ void unpack_right(const int x,          //
       .wait_and_throw();
 }
 
+// Packs the corner block whose lower left cell is (col, row)
+void pack_corner(const int x,        //
+                 const int depth,    //
+                 const int col,      //
+                 const int row,      //
+                 SyclBuffer &field,  //
+                 SyclBuffer &buffer, //
+                 int buffer_offset, queue &device_queue) {
+  device_queue
+      .submit([&](handler &h) {
+        h.parallel_for<class pack_corner>(range<1>(depth * depth), [=](id<1> idx) {
+          const auto offset = col + (row + idx[0] / depth) * x + idx[0] % depth;
+          buffer[idx[0] + buffer_offset] = field[offset];
+        });
+      })
+      .wait_and_throw();
+}
+
+// Unpacks the corner block whose lower left cell is (col, row)
+void unpack_corner(const int x,        //
+                   const int depth,    //
+                   const int col,      //
+                   const int row,      //
+                   SyclBuffer &field,  //
+                   SyclBuffer &buffer, //
+                   int buffer_offset, queue &device_queue) {
+  device_queue
+      .submit([&](handler &h) {
+        h.parallel_for<class unpack_corner>(range<1>(depth * depth), [=](id<1> idx) {
+          const auto offset = col + (row + idx[0] / depth) * x + idx[0] % depth;
+          field[offset] = buffer[idx[0] + buffer_offset];
+        });
+      })
+      .wait_and_throw();
+}
+
 void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType field, FieldBufferType buffer,
                         int offset) {
   START_PROFILING(settings.kernel_profile);
@@ -177,11 +214,50 @@ void run_pack_or_unpack(Chunk *chunk, Settings &settings, int depth, int face, b
       else
         unpack_bottom(chunk->x, chunk->y, depth, settings.halo_depth, field, buffer, offset, *chunk->ext->device_queue);
       break;
+    case CHUNK_BOTTOM_LEFT:
+    case CHUNK_BOTTOM_RIGHT:
+    case CHUNK_TOP_LEFT:
+    case CHUNK_TOP_RIGHT: {
+      int col, row;
+      corner_origin(chunk->x, chunk->y, depth, settings.halo_depth, face, pack, &col, &row);
+      if (pack) pack_corner(chunk->x, depth, col, row, field, buffer, offset, *chunk->ext->device_queue);
+      else
+        unpack_corner(chunk->x, depth, col, row, field, buffer, offset, *chunk->ext->device_queue);
+      break;
+    }
     default: die(__LINE__, __FILE__, "Incorrect face provided: %d.\n", face);
   }
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
+// Packs or unpacks the face region of every field in one kernel, field ff occupies buffer[ff * field_stride, ...).
+void run_pack_or_unpack_fields(Chunk *chunk, Settings &settings, int depth, int face, bool pack, FieldBufferType *fields, int num_fields,
+                               FieldBufferType buffer, int field_stride) {
+  START_PROFILING(settings.kernel_profile);
+  const int x = chunk->x;
+  int col_min, col_max, row_min, row_max;
+  halo_region(x, chunk->y, depth, settings.halo_depth, face, pack, &col_min, &col_max, &row_min, &row_max);
+  const int width = col_max - col_min;
+  const int cells = width * (row_max - row_min);
+
+  std::array<double *, NUM_FIELDS> field_ptrs{};
+  std::copy(fields, fields + num_fields, field_ptrs.begin());
+
+  chunk->ext->device_queue
+      ->submit([&](handler &h) {
+        h.parallel_for<class pack_or_unpack_fields>(range<1>(num_fields * cells), [=](id<1> idx) {
+          const int ff = idx[0] / cells;
+          const int cell = idx[0] % cells;
+          const int offset = col_min + cell % width + (row_min + cell / width) * x;
+          if (pack) buffer[ff * field_stride + cell] = field_ptrs[ff][offset];
+          else
+            field_ptrs[ff][offset] = buffer[ff * field_stride + cell];
+        });
+      })
+      .wait_and_throw();
+  STOP_PROFILING(settings.kernel_profile, __func__);
+}
+
 void run_send_recv_halo(Chunk *chunk, Settings &settings,                                 //
                         FieldBufferType src_send_buffer, FieldBufferType src_recv_buffer, //
                         StagingBufferType, StagingBufferType,                             //
@@ -97,3 +97,18 @@ void run_ppcg_inner_iteration(Chunk *chunk, Settings &settings, double alpha, do
 
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
+
+void run_ppcg_inner_iteration_ca(Chunk *, Settings &settings, int, double, double) {
+  die(__LINE__, __FILE__, "ppcg_steps_per_exchange > 1 is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
+// Split PPCG kernels, this model computes the whole sweep once the halo exchange has completed
+void run_ppcg_inner_iteration_interior(Chunk *, Settings &) {}
+
+void run_ppcg_inner_iteration_boundary(Chunk *chunk, Settings &settings, double alpha, double beta) {
+  run_ppcg_inner_iteration(chunk, settings, alpha, beta);
+}
+
+void run_ppcg_calc_sd(Chunk *, Settings &settings, double, double) {
+  die(__LINE__, __FILE__, "The multigrid preconditioner is not implemented for the %s model\n", settings.model_name.c_str());
+}
@@ -184,9 +184,18 @@ void run_calculate_2norm(Chunk *chunk, Settings &settings, SyclBuffer buffer, do
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
 
+void run_calculate_rz(Chunk *, Settings &settings, double *) {
+  die(__LINE__, __FILE__, "Preconditioning is not implemented for the %s model\n", settings.model_name.c_str());
+}
+
 void run_finalise(Chunk *chunk, Settings &settings) {
   START_PROFILING(settings.kernel_profile);
   finalise(chunk->x, chunk->y, settings.halo_depth, (chunk->u), (chunk->density), (chunk->energy), *(chunk->ext->device_queue));
 
   STOP_PROFILING(settings.kernel_profile, __func__);
 }
+
+void run_store_operator(Chunk *, Settings &settings) {
+  die(__LINE__, __FILE__, "stored_diagonal, float_coefficients and interleaved_operator are not implemented for the %s model\n",
+      settings.model_name.c_str());
+}